@@ -260,6 +260,84 @@ int MPIComms::receiveImpl(void* buf, size_t size, int source, int tag, size_t co
     return actualSource;
 }
 
+size_t MPIComms::newRequest()
+{
+    for (size_t request = 0; request < itsRequests.size(); ++request) {
+        if (itsRequests[request].empty()) {
+            return request;
+        }
+    }
+    itsRequests.push_back(std::vector<MPI_Request>());
+    return itsRequests.size() - 1;
+}
+
+size_t MPIComms::sendNonBlocking(const void* buf, size_t size, int dest, int tag, size_t comm)
+{
+    ASKAPDEBUGASSERT(comm < itsCommunicators.size());
+    ASKAPDEBUGASSERT(itsCommunicators[comm] != MPI_COMM_NULL);
+    const unsigned int c_maxint = std::numeric_limits<int>::max();
+
+    const size_t request = newRequest();
+    std::vector<MPI_Request> &chunks = itsRequests[request];
+    chunks.reserve(size / c_maxint + 1);
+
+    // Send in chunks of size MAXINT until complete. An empty message is
+    // sent for a zero-sized buffer, so the request is never empty.
+    size_t remaining = size;
+
+    do {
+        const size_t offset = size - remaining;
+        const size_t thisChunk = remaining >= c_maxint ? c_maxint : remaining;
+        MPI_Request chunkRequest = MPI_REQUEST_NULL;
+        const int result = MPI_Isend(addOffset(buf, offset), int(thisChunk), MPI_BYTE,
+                                     dest, tag, itsCommunicators[comm], &chunkRequest);
+        checkError(result, "MPI_Isend");
+        chunks.push_back(chunkRequest);
+        remaining -= thisChunk;
+    } while (remaining > 0);
+
+    return request;
+}
+
+size_t MPIComms::receiveNonBlocking(void* buf, size_t size, int source, int tag, size_t comm)
+{
+    ASKAPDEBUGASSERT(comm < itsCommunicators.size());
+    ASKAPDEBUGASSERT(itsCommunicators[comm] != MPI_COMM_NULL);
+    const unsigned int c_maxint = std::numeric_limits<int>::max();
+
+    const size_t request = newRequest();
+    std::vector<MPI_Request> &chunks = itsRequests[request];
+    chunks.reserve(size / c_maxint + 1);
+
+    // Receive in chunks of size MAXINT until complete, this must match
+    // the chunking done in sendNonBlocking
+    size_t remaining = size;
+
+    do {
+        const size_t offset = size - remaining;
+        const size_t thisChunk = remaining >= c_maxint ? c_maxint : remaining;
+        MPI_Request chunkRequest = MPI_REQUEST_NULL;
+        const int result = MPI_Irecv(addOffset(buf, offset), int(thisChunk), MPI_BYTE,
+                                     source, tag, itsCommunicators[comm], &chunkRequest);
+        checkError(result, "MPI_Irecv");
+        chunks.push_back(chunkRequest);
+        remaining -= thisChunk;
+    } while (remaining > 0);
+
+    return request;
+}
+
+void MPIComms::wait(size_t request)
+{
+    ASKAPCHECK(request < itsRequests.size() && !itsRequests[request].empty(),
+               "MPIComms::wait() Request " << request << " is not outstanding");
+    std::vector<MPI_Request> &chunks = itsRequests[request];
+    const int result = MPI_Waitall(int(chunks.size()), &chunks[0], MPI_STATUSES_IGNORE);
+    // free the slot before checking the error, so it can be reused
+    chunks.clear();
+    checkError(result, "MPI_Waitall");
+}
+
 void MPIComms::broadcast(void* buf, size_t size, int root, size_t comm)
 {
     ASKAPDEBUGASSERT(comm < itsCommunicators.size());
@@ -302,6 +380,52 @@ void MPIComms::sumAndBroadcast(float *buf, size_t size, size_t comm)
    checkError(result,"MPI_Allreduce");
 }
 
+/// @brief sum raw double buffers across all ranks of the communicator via MPI_Allreduce
+/// @details This method does an in place operation, so all buffers will have the
+/// same content equal to the sum of initial values (element-wise) sent to individual ranks
+/// @param[in,out] buf data buffer (double type is assumed)
+/// @param[in] size number of elements in the buffer (double type is assumed)
+/// @param[in] comm communicator index
+void MPIComms::sumAndBroadcast(double *buf, size_t size, size_t comm)
+{
+   ASKAPDEBUGASSERT(comm < itsCommunicators.size());
+   ASKAPDEBUGASSERT(itsCommunicators[comm] != MPI_COMM_NULL);
+   const size_t c_maxint = std::numeric_limits<int>::max();
+
+   // Reduce in chunks of MAXINT elements until complete
+   for (size_t offset = 0; offset < size; offset += c_maxint) {
+        const size_t thisChunk = std::min(size - offset, c_maxint);
+        const int result = MPI_Allreduce(MPI_IN_PLACE, (void*)(buf + offset),
+              int(thisChunk), MPI_DOUBLE, MPI_SUM, itsCommunicators[comm]);
+        checkError(result,"MPI_Allreduce");
+   }
+}
+
+/// @brief sum raw double buffers across all ranks of the communicator via MPI_Reduce
+/// @details This method does an in place operation on the root rank, which gets
+/// the sum of initial values (element-wise) sent to individual ranks. Buffers
+/// on other ranks are left unchanged.
+/// @param[in,out] buf data buffer (double type is assumed)
+/// @param[in] size number of elements in the buffer (double type is assumed)
+/// @param[in] root rank which receives the result
+/// @param[in] comm communicator index
+void MPIComms::sumToRoot(double *buf, size_t size, int root, size_t comm)
+{
+   ASKAPDEBUGASSERT(comm < itsCommunicators.size());
+   ASKAPDEBUGASSERT(itsCommunicators[comm] != MPI_COMM_NULL);
+   const size_t c_maxint = std::numeric_limits<int>::max();
+   const bool isRoot = (rank(comm) == root);
+
+   // Reduce in chunks of MAXINT elements until complete
+   for (size_t offset = 0; offset < size; offset += c_maxint) {
+        const size_t thisChunk = std::min(size - offset, c_maxint);
+        const int result = MPI_Reduce(isRoot ? MPI_IN_PLACE : (void*)(buf + offset),
+              isRoot ? (void*)(buf + offset) : 0, int(thisChunk), MPI_DOUBLE, MPI_SUM,
+              root, itsCommunicators[comm]);
+        checkError(result,"MPI_Reduce");
+   }
+}
+
 /// @brief reduce a boolean flag across the number of ranks
 /// @details This method aggregates a flag (i.e. single boolean variable) across
 /// a number of ranks with the logical or operation. All ranks will have the same
@@ -392,6 +516,30 @@ void MPIComms::sumAndBroadcast(float *, size_t, size_t)
     ASKAPTHROW(AskapError, "MPIComms::sumAndBroadcast() cannot be used - configured without MPI");
 }
 
+/// @brief sum raw double buffers across all ranks of the communicator via MPI_Allreduce
+/// @details This method does an in place operation, so all buffers will have the
+/// same content equal to the sum of initial values (element-wise) sent to individual ranks
+/// @param[in,out] buf data buffer (double type is assumed)
+/// @param[in] size number of elements in the buffer (double type is assumed)
+/// @param[in] comm communicator index
+void MPIComms::sumAndBroadcast(double *, size_t, size_t)
+{
+    ASKAPTHROW(AskapError, "MPIComms::sumAndBroadcast() cannot be used - configured without MPI");
+}
+
+/// @brief sum raw double buffers across all ranks of the communicator via MPI_Reduce
+/// @details This method does an in place operation on the root rank, which gets
+/// the sum of initial values (element-wise) sent to individual ranks. Buffers
+/// on other ranks are left unchanged.
+/// @param[in,out] buf data buffer (double type is assumed)
+/// @param[in] size number of elements in the buffer (double type is assumed)
+/// @param[in] root rank which receives the result
+/// @param[in] comm communicator index
+void MPIComms::sumToRoot(double *, size_t, int, size_t)
+{
+    ASKAPTHROW(AskapError, "MPIComms::sumToRoot() cannot be used - configured without MPI");
+}
+
 /// @brief reduce a boolean flag across the number of ranks
 /// @details This method aggregates a flag (i.e. single boolean variable) across
 /// a number of ranks with the logical or operation. All ranks will have the same
@@ -432,6 +580,21 @@ int MPIComms::receiveAnySrc(void* buf, size_t size, int tag, size_t)
     ASKAPTHROW(AskapError, "MPIComms::receiveAnySrc() cannot be used - configured without MPI");
 }
 
+size_t MPIComms::sendNonBlocking(const void*, size_t, int, int, size_t)
+{
+    ASKAPTHROW(AskapError, "MPIComms::sendNonBlocking() cannot be used - configured without MPI");
+}
+
+size_t MPIComms::receiveNonBlocking(void*, size_t, int, int, size_t)
+{
+    ASKAPTHROW(AskapError, "MPIComms::receiveNonBlocking() cannot be used - configured without MPI");
+}
+
+void MPIComms::wait(size_t)
+{
+    ASKAPTHROW(AskapError, "MPIComms::wait() cannot be used - configured without MPI");
+}
+
 void MPIComms::broadcast(void* buf, size_t size, int root, size_t)
 {
     ASKAPTHROW(AskapError, "MPIComms::broadcast() cannot be used - configured without MPI");
@@ -104,6 +104,41 @@ class MPIComms {
         /// world communicator)
         virtual int receiveAnySrc(void* buf, size_t size, int tag = 0, size_t comm = 0);
 
+        /// @brief MPI_Isend a raw buffer to the specified destination process.
+        /// @details This method returns immediately, the buffer must not be
+        /// modified or deallocated until the returned request is completed by a call
+        /// to wait. Unlike send, the size of the buffer is not sent ahead of the data,
+        /// so the receiver must know exactly how many bytes to expect. The
+        /// matching receive should be done with receiveNonBlocking.
+        ///
+        /// @param[in] buf a pointer to the buffer to send.
+        /// @param[in] size    the number of bytes to send.
+        /// @param[in] dest    the id of the process to send to.
+        /// @param[in] tag the MPI tag to be used in the communication.
+        /// @param[in] comm communicator index, defaults to 0 (copy of the default
+        /// world communicator)
+        /// @return request index to be passed to wait
+        virtual size_t sendNonBlocking(const void* buf, size_t size, int dest, int tag = 0, size_t comm = 0);
+
+        /// @brief MPI_Irecv a raw buffer from the specified source process.
+        /// @details This method returns immediately, the buffer must not be
+        /// accessed until the returned request is completed by a call to wait.
+        ///
+        /// @param[out] buf a pointer to the buffer to receive data into.
+        /// @param[in] size    the number of bytes to receive.
+        /// @param[in] source  the id of the process to receive from.
+        /// @param[in] tag the MPI tag to be used in the communication.
+        /// @param[in] comm communicator index, defaults to 0 (copy of the default
+        /// world communicator)
+        /// @return request index to be passed to wait
+        virtual size_t receiveNonBlocking(void* buf, size_t size, int source, int tag = 0, size_t comm = 0);
+
+        /// @brief wait for a non-blocking operation to complete
+        /// @details The request index becomes invalid after this call and may be
+        /// reused by subsequent non-blocking operations.
+        /// @param[in] request request index returned by sendNonBlocking or receiveNonBlocking
+        virtual void wait(size_t request);
+
         /// @brief MPI_Bcast a raw buffer.
         ///
         /// @param[in,out] buf    data buffer.
@@ -120,6 +155,24 @@ class MPIComms {
         /// @param[in] size number of elements in the buffer (float type is assumed)
         /// @param[in] comm communicator index
         virtual void sumAndBroadcast(float *buf, size_t size, size_t comm);
+
+        /// @brief sum raw double buffers across all ranks of the communicator via MPI_Allreduce
+        /// @details This method does an in place operation, so all buffers will have the
+        /// same content equal to the sum of initial values (element-wise) sent to individual ranks
+        /// @param[in,out] buf data buffer (double type is assumed)
+        /// @param[in] size number of elements in the buffer (double type is assumed)
+        /// @param[in] comm communicator index
+        virtual void sumAndBroadcast(double *buf, size_t size, size_t comm);
+
+        /// @brief sum raw double buffers across all ranks of the communicator via MPI_Reduce
+        /// @details This method does an in place operation on the root rank, which gets
+        /// the sum of initial values (element-wise) sent to individual ranks. Buffers
+        /// on other ranks are left unchanged.
+        /// @param[in,out] buf data buffer (double type is assumed)
+        /// @param[in] size number of elements in the buffer (double type is assumed)
+        /// @param[in] root rank which receives the result
+        /// @param[in] comm communicator index
+        virtual void sumToRoot(double *buf, size_t size, int root, size_t comm);
         
         /// @brief reduce a boolean flag across the number of ranks
         /// @details This method aggregates a flag (i.e. single boolean variable) across
@@ -155,6 +208,14 @@ class MPIComms {
         // world communicator)
         int receiveImpl(void* buf, size_t size, int source, int tag, size_t comm = 0);
 
+        // Allocate a slot for a new non-blocking request, returning its index
+        size_t newRequest();
+
+        // Outstanding non-blocking requests. Buffers larger than MAXINT
+        // are transferred in chunks, so each request may consist of a number
+        // of MPI requests. Empty vectors are free slots.
+        std::vector<std::vector<MPI_Request> > itsRequests;
+
         // Specific MPI Communicator for this class
         std::vector<MPI_Comm> itsCommunicators;
 #endif
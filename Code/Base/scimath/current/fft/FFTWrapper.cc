@@ -39,20 +39,178 @@
 #include "casa/Arrays/ArrayIter.h"
 #include "fftw3.h"
 
-#ifdef _OPENMP
 // boost include
 #include "boost/thread/mutex.hpp"
-#endif
+
+// std includes
+#include <map>
+#include <algorithm>
 
 using namespace casa;
 
 namespace askap {
     namespace scimath {
 
-#ifdef _OPENMP
-        /// @brief mutex to ensure thread safety in the calls to fft
+        /// @brief mutex to protect the plan cache and FFTW planner
+        /// @details Only execution of FFTW plans is thread safe, therefore
+        /// plan creation and destruction as well as wisdom import/export
+        /// is done under this lock. Plans are executed outside the lock.
         static boost::mutex fftWrapperMutex;
-#endif
+
+        /// @brief number of threads used by each transform
+        static int fftNumberOfThreads = 1;
+
+        /// @brief true if fftw_init_threads has been called
+        static bool fftThreadsInitialised = false;
+
+        /// @brief planner rigour
+        /// @details FFTW_ESTIMATE by default, set with fftSetPlannerRigour. Wisdom
+        /// only speeds up planning if it was made with the same (or a higher) rigour,
+        /// so it is not changed by importing wisdom. The planner never touches the
+        /// data being transformed because plans are made on a scratch buffer.
+        static unsigned fftPlannerFlags = FFTW_ESTIMATE;
+
+        /**
+         * Key of the plan cache. Plans are made for a particular shape,
+         * direction and data alignment. Single and double precision plans
+         * are kept in different maps. The number of threads is part of the key
+         * because it is fixed at the time the plan is created.
+         */
+        struct PlanKey {
+            PlanKey(const int nx, const int ny, const bool forward,
+                    const bool aligned) : itsNx(nx), itsNy(ny),
+                    itsForward(forward), itsAligned(aligned), itsNThreads(fftNumberOfThreads) {}
+
+            bool operator<(const PlanKey &other) const {
+                if (itsNx != other.itsNx) {
+                    return itsNx < other.itsNx;
+                }
+                if (itsNy != other.itsNy) {
+                    return itsNy < other.itsNy;
+                }
+                if (itsForward != other.itsForward) {
+                    return itsForward < other.itsForward;
+                }
+                if (itsAligned != other.itsAligned) {
+                    return itsAligned < other.itsAligned;
+                }
+                return itsNThreads < other.itsNThreads;
+            }
+
+            /// @brief number of elements along the first (fastest varying) axis
+            int itsNx;
+            /// @brief number of elements along the second axis, 0 for 1-D plans
+            int itsNy;
+            /// @brief direction
+            bool itsForward;
+            /// @brief true if the plan is for SIMD-aligned data
+            bool itsAligned;
+            /// @brief number of threads
+            int itsNThreads;
+        };
+
+        /**
+         * Precision-specific part of the FFTW interface. The generic code below
+         * is written in terms of this traits class.
+         */
+        template<typename T>
+        struct FFTWTraits;
+
+        template<>
+        struct FFTWTraits<casa::DComplex> {
+            typedef fftw_plan Plan;
+            typedef fftw_complex FFTWComplex;
+
+            static Plan plan(const PlanKey &key, FFTWComplex* buf) {
+                // the threaded planner is only available after fftw_init_threads
+                if (fftThreadsInitialised) {
+                    fftw_plan_with_nthreads(key.itsNThreads);
+                }
+                const unsigned flags = fftPlannerFlags | (key.itsAligned ? 0u : unsigned(FFTW_UNALIGNED));
+                const int sign = key.itsForward ? FFTW_FORWARD : FFTW_BACKWARD;
+                if (key.itsNy == 0) {
+                    return fftw_plan_dft_1d(key.itsNx, buf, buf, sign, flags);
+                }
+                // FFTW uses row-major order, so the slowest varying axis goes first
+                return fftw_plan_dft_2d(key.itsNy, key.itsNx, buf, buf, sign, flags);
+            }
+            static void execute(const Plan &p, casa::DComplex* data) {
+                fftw_execute_dft(p, reinterpret_cast<FFTWComplex*>(data), reinterpret_cast<FFTWComplex*>(data));
+            }
+            static bool isAligned(const casa::DComplex* data) {
+                return fftw_alignment_of(reinterpret_cast<double*>(const_cast<casa::DComplex*>(data))) == 0;
+            }
+            static FFTWComplex* allocate(const size_t n) {
+                return static_cast<FFTWComplex*>(fftw_malloc(sizeof(FFTWComplex) * n));
+            }
+            static void free(void *buf) { fftw_free(buf); }
+            static void destroy(Plan &p) { fftw_destroy_plan(p); }
+            static std::map<PlanKey, Plan>& cache() {
+                static std::map<PlanKey, Plan> theCache;
+                return theCache;
+            }
+        };
+
+        template<>
+        struct FFTWTraits<casa::Complex> {
+            typedef fftwf_plan Plan;
+            typedef fftwf_complex FFTWComplex;
+
+            static Plan plan(const PlanKey &key, FFTWComplex* buf) {
+                // the threaded planner is only available after fftwf_init_threads
+                if (fftThreadsInitialised) {
+                    fftwf_plan_with_nthreads(key.itsNThreads);
+                }
+                const unsigned flags = fftPlannerFlags | (key.itsAligned ? 0u : unsigned(FFTW_UNALIGNED));
+                const int sign = key.itsForward ? FFTW_FORWARD : FFTW_BACKWARD;
+                if (key.itsNy == 0) {
+                    return fftwf_plan_dft_1d(key.itsNx, buf, buf, sign, flags);
+                }
+                // FFTW uses row-major order, so the slowest varying axis goes first
+                return fftwf_plan_dft_2d(key.itsNy, key.itsNx, buf, buf, sign, flags);
+            }
+            static void execute(const Plan &p, casa::Complex* data) {
+                fftwf_execute_dft(p, reinterpret_cast<FFTWComplex*>(data), reinterpret_cast<FFTWComplex*>(data));
+            }
+            static bool isAligned(const casa::Complex* data) {
+                return fftwf_alignment_of(reinterpret_cast<float*>(const_cast<casa::Complex*>(data))) == 0;
+            }
+            static FFTWComplex* allocate(const size_t n) {
+                return static_cast<FFTWComplex*>(fftwf_malloc(sizeof(FFTWComplex) * n));
+            }
+            static void free(void *buf) { fftwf_free(buf); }
+            static void destroy(Plan &p) { fftwf_destroy_plan(p); }
+            static std::map<PlanKey, Plan>& cache() {
+                static std::map<PlanKey, Plan> theCache;
+                return theCache;
+            }
+        };
+
+        /**
+         * Obtain a plan from the cache, creating it if necessary. The plan is
+         * created on a scratch buffer, so the data being transformed are never
+         * touched by the planner.
+         */
+        template<typename T>
+        static typename FFTWTraits<T>::Plan getPlan(const int nx, const int ny, const bool forward,
+                                                    const bool aligned)
+        {
+            typedef FFTWTraits<T> Traits;
+            boost::unique_lock<boost::mutex> lock(fftWrapperMutex);
+            const PlanKey key(nx, ny, forward, aligned);
+            typename std::map<PlanKey, typename Traits::Plan>::const_iterator ci = Traits::cache().find(key);
+            if (ci != Traits::cache().end()) {
+                return ci->second;
+            }
+            const size_t nElements = size_t(nx) * size_t(ny > 0 ? ny : 1);
+            typename Traits::FFTWComplex* buf = Traits::allocate(nElements);
+            ASKAPCHECK(buf, "Unable to allocate buffer of "<<nElements<<" elements to make FFTW plan");
+            typename Traits::Plan p = Traits::plan(key, buf);
+            Traits::free(buf);
+            ASKAPCHECK(p, "Unable to make FFTW plan for "<<nx<<" x "<<ny<<" transform");
+            Traits::cache()[key] = p;
+            return p;
+        }
 
         /**
          * Scale the array by 1/N were N is the total number of elements in
@@ -67,229 +225,210 @@ namespace askap {
             }
         }
 
-        /*
-         * Execute a Double-precision FFT plan.
+        /**
+         * 1-D transform of contiguous data with the origin at n/2 (casa convention)
          */
-        static inline void fftExec(casa::Vector<casa::DComplex>& vec, const bool forward,
-                            fftw_plan& p, fftw_complex* buf, size_t bufsz)
+        template<typename T>
+        static void fft1dImpl(T* dataPtr, const size_t nElements, const bool forward)
         {
-            const size_t nElements = vec.nelements();
-            ASKAPDEBUGASSERT(nElements == bufsz);
-
-            Bool deleteIt;
-            DComplex *dataPtr = vec.getStorage(deleteIt);
-
-            // rotate input because the origin for FFTW is at 0, not n/2 (casa fft).
-            std::rotate_copy(dataPtr, dataPtr + (nElements / 2), dataPtr + nElements,
-                             reinterpret_cast<casa::DComplex*>(buf));
-
-            fftw_execute(p);
+            typedef FFTWTraits<T> Traits;
+            // rotate input because the origin for FFTW is at 0, not n/2 (casa fft)
+            std::rotate(dataPtr, dataPtr + (nElements / 2), dataPtr + nElements);
 
-            // rotate output and copy back to the vectors storage
-            std::rotate_copy(reinterpret_cast<casa::DComplex*>(buf),
-                             reinterpret_cast<casa::DComplex*>(buf) + (nElements / 2),
-                             reinterpret_cast<casa::DComplex*>(buf) + nElements,
-                             dataPtr);
+            const typename Traits::Plan p = getPlan<T>(int(nElements), 0, forward, Traits::isAligned(dataPtr));
+            Traits::execute(p, dataPtr);
 
             if (!forward) {
                 scaleResult(dataPtr, nElements);
             }
 
-            vec.putStorage(dataPtr, deleteIt);
+            // rotate output
+            std::rotate(dataPtr, dataPtr + (nElements / 2), dataPtr + nElements);
         }
 
         /**
-         * Execute a Single-precision FFT plan.
+         * Circular shift of a 2-D plane, out[i,j] = in[(i+nx/2)%nx, (j+ny/2)%ny].
+         * This is the 2-D equivalent of the rotation done for 1-D transforms.
          */
-        static inline void fftExec(casa::Vector<casa::Complex>& vec, const bool forward,
-                            fftwf_plan& p, fftwf_complex* buf, size_t bufsz)
+        template<typename T>
+        static void shiftPlane(const T* in, T* out, const size_t nx, const size_t ny)
         {
-            const size_t nElements = vec.nelements();
-            ASKAPDEBUGASSERT(nElements == bufsz);
+            for (size_t j = 0; j < ny; ++j) {
+                const T* inRow = in + ((j + ny / 2) % ny) * nx;
+                std::rotate_copy(inRow, inRow + nx / 2, inRow + nx, out + j * nx);
+            }
+        }
 
-            Bool deleteIt;
-            Complex *dataPtr = vec.getStorage(deleteIt);
+        /**
+         * 2-D transform of a contiguous plane with the origin at (nx/2, ny/2).
+         * For even sizes the shift of the origin is folded into the transform as
+         * a multiplication by (-1)^(i+j) before and after the transform (with
+         * an additional sign if nx/2+ny/2 is odd), so the data are transformed
+         * in place without any copy. Odd sizes are shifted explicitly via a
+         * scratch buffer.
+         */
+        template<typename T>
+        static void fft2dImpl(T* dataPtr, const size_t nx, const size_t ny, const bool forward)
+        {
+            typedef FFTWTraits<T> Traits;
+            typedef typename T::value_type Real;
+            const size_t nElements = nx * ny;
+
+            if ((nx % 2 == 0) && (ny % 2 == 0)) {
+                for (size_t j = 0; j < ny; ++j) {
+                    // negate elements with odd i+j
+                    T* row = dataPtr + j * nx + ((j + 1) % 2);
+                    for (size_t i = (j + 1) % 2; i < nx; i += 2, row += 2) {
+                        *row = -(*row);
+                    }
+                }
+                const typename Traits::Plan p = getPlan<T>(int(nx), int(ny), forward, Traits::isAligned(dataPtr));
+                Traits::execute(p, dataPtr);
+                const Real scale = forward ? Real(1) : Real(1) / Real(nElements);
+                const Real sign = ((nx / 2 + ny / 2) % 2 == 0) ? Real(1) : Real(-1);
+                for (size_t j = 0; j < ny; ++j) {
+                    T* row = dataPtr + j * nx;
+                    for (size_t i = 0; i < nx; ++i) {
+                        row[i] *= ((i + j) % 2 == 0) ? sign * scale : -sign * scale;
+                    }
+                }
+            } else {
+                T* buf = reinterpret_cast<T*>(Traits::allocate(nElements));
+                ASKAPCHECK(buf, "Unable to allocate buffer of "<<nElements<<" elements for FFT");
+                shiftPlane(dataPtr, buf, nx, ny);
+                const typename Traits::Plan p = getPlan<T>(int(nx), int(ny), forward, true);
+                Traits::execute(p, buf);
+                shiftPlane(buf, dataPtr, nx, ny);
+                Traits::free(buf);
+                if (!forward) {
+                    scaleResult(dataPtr, nElements);
+                }
+            }
+        }
 
-            // rotate input because the origin for FFTW is at 0, not n/2 (casa fft)
-            std::rotate_copy(dataPtr, dataPtr + (nElements / 2), dataPtr + nElements,
-                    reinterpret_cast<casa::Complex*>(buf));
+        /**
+         * 2-D transform of the first two axes of an array, plane by plane
+         */
+        template<typename T>
+        static void fft2dArray(casa::Array<T>& arr, const bool forward)
+        {
+            // 1: Make an iterator that returns plane by plane
+            casa::ArrayIterator<T> it(arr, 2);
 
-            fftwf_execute(p);
+            while (!it.pastEnd()) {
+                casa::Matrix<T> mat(it.array());
+                ASKAPDEBUGASSERT(mat.ncolumn() > 0 && mat.nrow() > 0);
 
-            // rotate output
-            std::rotate_copy(reinterpret_cast<casa::Complex*>(buf),
-                             reinterpret_cast<casa::Complex*>(buf) + (nElements / 2),
-                             reinterpret_cast<casa::Complex*>(buf) + nElements,
-                             dataPtr);
+                // 2: Get contiguous storage (a copy is made only if the plane is not contiguous)
+                Bool deleteIt;
+                T *dataPtr = mat.getStorage(deleteIt);
 
-            if (!forward) {
-                scaleResult(dataPtr, nElements);
-            }
+                // 3: transform the plane in one go
+                fft2dImpl(dataPtr, mat.nrow(), mat.ncolumn(), forward);
 
-            vec.putStorage(dataPtr, deleteIt);
+                mat.putStorage(dataPtr, deleteIt);
+                it.next();
+            }
         }
 
         void fft(casa::Vector<casa::DComplex>& vec, const bool forward)
         {
             ASKAPTRACE("fft<casa::DComplex>");
-#ifdef _OPENMP
-            boost::unique_lock<boost::mutex> lock(fftWrapperMutex);
-#endif
 
             Bool deleteIt;
             DComplex *dataPtr = vec.getStorage(deleteIt);
-            const size_t nElements = vec.nelements();
-
-            // rotate input because the origin for FFTW is at 0, not n/2 (casa fft)
-            std::rotate(dataPtr, dataPtr + (nElements / 2), dataPtr + nElements);
-
-            fftw_plan p = fftw_plan_dft_1d(nElements, reinterpret_cast<fftw_complex*>(dataPtr),
-                                           reinterpret_cast<fftw_complex*>(dataPtr),
-                                           (forward) ? FFTW_FORWARD : FFTW_BACKWARD, FFTW_ESTIMATE);
-
-            fftw_execute(p);
-
-            if (!forward) {
-                scaleResult(dataPtr, nElements);
-            }
-
-            // rotate output
-            std::rotate(dataPtr, dataPtr + (nElements / 2), dataPtr + nElements);
-
+            fft1dImpl(dataPtr, vec.nelements(), forward);
             vec.putStorage(dataPtr, deleteIt);
-            fftw_destroy_plan(p);
         }
 
         void fft(casa::Vector<casa::Complex>& vec, const bool forward)
         {
             ASKAPTRACE("fft<casa::Complex>");
-#ifdef _OPENMP
-            boost::unique_lock<boost::mutex> lock(fftWrapperMutex);
-#endif
 
             Bool deleteIt;
             Complex *dataPtr = vec.getStorage(deleteIt);
-            const size_t nElements = vec.nelements();
-
-            // rotate input because the origin for FFTW is at 0, not n/2 (casa fft)
-            std::rotate(dataPtr, dataPtr + (nElements / 2), dataPtr + nElements);
-
-            fftwf_plan p = fftwf_plan_dft_1d(nElements, reinterpret_cast<fftwf_complex*>(dataPtr),
-                                             reinterpret_cast<fftwf_complex*>(dataPtr),
-                                             (forward) ? FFTW_FORWARD : FFTW_BACKWARD, FFTW_ESTIMATE);
-            fftwf_execute(p);
-
-            if (!forward) {
-                scaleResult(dataPtr, nElements);
-            }
-
-            // rotate output
-            std::rotate(dataPtr, dataPtr + (nElements / 2), dataPtr + nElements);
-
+            fft1dImpl(dataPtr, vec.nelements(), forward);
             vec.putStorage(dataPtr, deleteIt);
-            fftwf_destroy_plan(p);
         }
 
         void fft2d(casa::Array<casa::Complex>& arr, const bool forward)
         {
             ASKAPTRACE("fft2d<casa::Complex>");
-#ifdef _OPENMP
-            boost::unique_lock<boost::mutex> lock(fftWrapperMutex);
-#endif
-
-            // 1: Make an iterator that returns plane by plane
-            casa::ArrayIterator<casa::Complex> it(arr, 2);
-
-            while (!it.pastEnd()) {
-                casa::Matrix<casa::Complex> mat(it.array());
-                ASKAPDEBUGASSERT(mat.ncolumn() > 0 && mat.nrow() > 0);
-
-                // 2: Setup a buffer and fft plan based on the size of the first column
-                size_t bufsz = mat.nrow();
-                fftwf_complex* buf = (fftwf_complex*) fftw_malloc(sizeof(fftwf_complex) * bufsz);
-                fftwf_plan p = fftwf_plan_dft_1d(bufsz, buf, buf,
-                                                 (forward) ? FFTW_FORWARD : FFTW_BACKWARD, FFTW_ESTIMATE);
-
-                // 3: FFT each column
-                for (uInt col = 0; col < mat.ncolumn(); col++) {
-                    casa::Vector<casa::Complex> vec(mat.column(col));
-                    fftExec(vec, forward, p, buf, bufsz);
-                }
-
-                // 4: If the row are of different length to the rows then
-                // re-allocate buffer and regen the plan
-                if (mat.ncolumn() != mat.nrow()) {
-                    fftwf_destroy_plan(p);
-                    fftwf_free(buf);
-                    bufsz = mat.ncolumn();
-                    fftwf_complex* buf = (fftwf_complex*) fftwf_malloc(sizeof(fftwf_complex) * bufsz);
-                    p = fftwf_plan_dft_1d(bufsz, buf, buf,
-                                          (forward) ? FFTW_FORWARD : FFTW_BACKWARD, FFTW_MEASURE);
-                }
-
-                // 5: FFT each row
-                for (uInt row = 0; row < mat.nrow(); row++) {
-                    casa::Vector<casa::Complex> vec(mat.row(row));
-                    fftExec(vec, forward, p, buf, bufsz);
-                }
-
-                // 6: Delete the plan and temporary buffer
-                fftwf_destroy_plan(p);
-                fftwf_free(buf);
-
-                it.next();
-            }
+            fft2dArray(arr, forward);
         }
 
         void fft2d(casa::Array<casa::DComplex>& arr, const bool forward)
         {
             ASKAPTRACE("fft2d<casa::DComplex>");
-#ifdef _OPENMP
-            boost::unique_lock<boost::mutex> lock(fftWrapperMutex);
-#endif
-
-            /// 1: Make an iterator that returns plane by plane
-            casa::ArrayIterator<casa::DComplex> it(arr, 2);
-
-            while (!it.pastEnd()) {
-                casa::Matrix<casa::DComplex> mat(it.array());
-                ASKAPDEBUGASSERT(mat.ncolumn() > 0 && mat.nrow() > 0);
+            fft2dArray(arr, forward);
+        }
 
-                // 2: Setup a buffer and fft plan based on the size of the first column
-                size_t bufsz = mat.nrow();
-                fftw_complex* buf = (fftw_complex*) fftw_malloc(sizeof(fftw_complex) * bufsz);
-                fftw_plan p = fftw_plan_dft_1d(bufsz, buf, buf,
-                                               (forward) ? FFTW_FORWARD : FFTW_BACKWARD, FFTW_ESTIMATE);
+        void fftSetNumberOfThreads(const int nThreads)
+        {
+            ASKAPCHECK(nThreads > 0, "Number of FFT threads should be positive, you have "<<nThreads);
+            boost::unique_lock<boost::mutex> lock(fftWrapperMutex);
+            if (!fftThreadsInitialised && (nThreads > 1)) {
+                ASKAPCHECK(fftw_init_threads() != 0, "Unable to initialise FFTW threads");
+                ASKAPCHECK(fftwf_init_threads() != 0, "Unable to initialise FFTW threads (single precision)");
+                fftThreadsInitialised = true;
+            }
+            // plans made with a different number of threads stay in the cache, but will not be used
+            fftNumberOfThreads = nThreads;
+        }
 
-                // 3: FFT each column
-                for (uInt col = 0; col < mat.ncolumn(); col++) {
-                    casa::Vector<casa::DComplex> vec(mat.column(col));
-                    fftExec(vec, forward, p, buf, bufsz);
-                }
+        int fftNumberOfThreadsInUse()
+        {
+            boost::unique_lock<boost::mutex> lock(fftWrapperMutex);
+            return fftNumberOfThreads;
+        }
 
-                // 4: If the rows are of different length to the columns then
-                // re-allocate buffer and regen the plan
-                if (mat.ncolumn() != mat.nrow()) {
-                    fftw_destroy_plan(p);
-                    fftw_free(buf);
-                    bufsz = mat.ncolumn();
-                    fftw_complex* buf = (fftw_complex*) fftw_malloc(sizeof(fftw_complex) * bufsz);
-                    p = fftw_plan_dft_1d(bufsz, buf, buf,
-                                         (forward) ? FFTW_FORWARD : FFTW_BACKWARD, FFTW_MEASURE);
-                }
+        bool fftImportWisdom(const std::string &fileName)
+        {
+            boost::unique_lock<boost::mutex> lock(fftWrapperMutex);
+            const bool dpResult = fftw_import_wisdom_from_filename((fileName + ".dp").c_str()) != 0;
+            const bool spResult = fftwf_import_wisdom_from_filename((fileName + ".sp").c_str()) != 0;
+            return dpResult && spResult;
+        }
 
-                // 5: FFT each row
-                for (uInt row = 0; row < mat.nrow(); row++) {
-                    casa::Vector<casa::DComplex> vec(mat.row(row));
-                    fftExec(vec, forward, p, buf, bufsz);
-                }
+        void fftSetPlannerRigour(const std::string &rigour)
+        {
+            unsigned flags = FFTW_ESTIMATE;
+            if (rigour == "measure") {
+                flags = FFTW_MEASURE;
+            } else if (rigour == "patient") {
+                flags = FFTW_PATIENT;
+            } else {
+                ASKAPCHECK(rigour == "estimate", "Unknown FFTW planner rigour "<<rigour<<
+                           ", use estimate, measure or patient");
+            }
+            boost::unique_lock<boost::mutex> lock(fftWrapperMutex);
+            fftPlannerFlags = flags;
+        }
 
-                // 6: Delete the plan and temporary buffer
-                fftw_destroy_plan(p);
-                fftw_free(buf);
+        void fftExportWisdom(const std::string &fileName)
+        {
+            boost::unique_lock<boost::mutex> lock(fftWrapperMutex);
+            ASKAPCHECK(fftw_export_wisdom_to_filename((fileName + ".dp").c_str()) != 0,
+                       "Unable to export FFTW wisdom to "<<fileName<<".dp");
+            ASKAPCHECK(fftwf_export_wisdom_to_filename((fileName + ".sp").c_str()) != 0,
+                       "Unable to export FFTW wisdom to "<<fileName<<".sp");
+        }
 
-                it.next();
+        void fftClearPlanCache()
+        {
+            boost::unique_lock<boost::mutex> lock(fftWrapperMutex);
+            typedef std::map<PlanKey, fftw_plan>::iterator DPIterator;
+            for (DPIterator it = FFTWTraits<casa::DComplex>::cache().begin();
+                 it != FFTWTraits<casa::DComplex>::cache().end(); ++it) {
+                 fftw_destroy_plan(it->second);
+            }
+            FFTWTraits<casa::DComplex>::cache().clear();
+            typedef std::map<PlanKey, fftwf_plan>::iterator SPIterator;
+            for (SPIterator it = FFTWTraits<casa::Complex>::cache().begin();
+                 it != FFTWTraits<casa::Complex>::cache().end(); ++it) {
+                 fftwf_destroy_plan(it->second);
             }
+            FFTWTraits<casa::Complex>::cache().clear();
         }
     }
 }
@@ -35,6 +35,9 @@
 #include <casa/Arrays/Vector.h>
 #include <casa/Arrays/Array.h>
 
+// std includes
+#include <string>
+
 namespace askap
 {
     namespace scimath
@@ -62,6 +65,54 @@ namespace askap
         /// @param forward Forward transform?
         /// @ingroup fft
         void fft2d(casa::Array<casa::DComplex>& arr, const bool forward);
+
+        /// @brief set the number of threads used by each transform
+        /// @details FFTW plans are cached (per shape, precision, direction and
+        /// data alignment) and are executed outside of any lock, so concurrent
+        /// calls to the functions above run in parallel. In addition, each
+        /// transform can be spread over a number of threads. Plans created from now
+        /// on will use the given number of threads. The default is 1.
+        /// @param nThreads number of threads
+        /// @ingroup fft
+        void fftSetNumberOfThreads(const int nThreads);
+
+        /// @brief obtain the number of threads used by each transform
+        /// @return number of threads
+        /// @ingroup fft
+        int fftNumberOfThreadsInUse();
+
+        /// @brief import FFTW wisdom
+        /// @details Wisdom is stored in two files (for single and double precision)
+        /// with ".sp" and ".dp" suffixes added to the given name. The wisdom only
+        /// speeds up planning if it was made with the planner rigour in use (see
+        /// fftSetPlannerRigour).
+        /// @param fileName base file name
+        /// @return true if the wisdom was read successfully for both precisions
+        /// @ingroup fft
+        bool fftImportWisdom(const std::string &fileName);
+
+        /// @brief set the rigour of the FFTW planner
+        /// @details "estimate" (the default) makes plans quickly without running
+        /// any transform. "measure" and "patient" time a number of algorithms,
+        /// which gives faster transforms but can take minutes per plan for large
+        /// images (and blocks other threads from making plans). Set it before any
+        /// plan is made, and use the same rigour in the run exporting the wisdom
+        /// and the runs importing it, so the plans are found in the wisdom.
+        /// An exception is thrown for any other value.
+        /// @param rigour "estimate", "measure" or "patient"
+        /// @ingroup fft
+        void fftSetPlannerRigour(const std::string &rigour);
+
+        /// @brief export FFTW wisdom accumulated so far
+        /// @details An exception is thrown if the wisdom cannot be written.
+        /// @param fileName base file name (see fftImportWisdom)
+        /// @ingroup fft
+        void fftExportWisdom(const std::string &fileName);
+
+        /// @brief destroy all cached FFTW plans
+        /// @details Must not be called while any transform is in progress.
+        /// @ingroup fft
+        void fftClearPlanCache();
     }
 }
 #endif
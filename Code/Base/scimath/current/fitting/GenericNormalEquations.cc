@@ -198,9 +198,12 @@ void GenericNormalEquations::mergeParameter(const std::string &par,
 /// corresponds to a cross- or parallel term in the normal equations. Data
 /// vector is given simply as a casa::Vector, rather than the map of vectors,
 /// because only one parameter is concerned here. If a parameter with the given
-/// name doesn't exist, the method adds it to both normal matrix and data vector,
-/// populating correctly all required cross-terms with 0-matrices of an 
-/// appropriate shape.
+/// name doesn't exist, the method adds it to both normal matrix and data vector.
+/// Only the row of the normal matrix corresponding to the given parameter is
+/// updated: elements present in the input are added up and missing ones are
+/// inserted. Zero cross-terms are not stored, so the caller has to supply all
+/// rows involved to keep the matrix symmetric (design matrices and merging
+/// always do).
 /// @param[in] par name of the parameter to work with
 /// @param[in] inNM input normal matrix
 /// @param[in] inDV input data vector 
@@ -214,27 +217,35 @@ void GenericNormalEquations::addParameter(const std::string &par,
   if (nmRowIt != itsNormalMatrix.end()) {
       // this parameter is already present in the normal matrix held by this class
       ASKAPDEBUGASSERT(nmRowIt->second.find(par) != nmRowIt->second.end());
+      
+      // first, check the data vector, so a shape mismatch leaves the
+      // normal matrix intact
+      MapOfVectors::const_iterator dvIt = itsDataVector.find(par);
+      ASKAPDEBUGASSERT(dvIt != itsDataVector.end());
+      ASKAPCHECK(inDV.shape() == dvIt->second.shape(),
+               "shape mismatch for data vector, parameter: "<<dvIt->first);
        
-      // first, process normal matrix 
-      for (MapOfMatrices::iterator nmColIt = nmRowIt->second.begin();
-                          nmColIt != nmRowIt->second.end(); ++nmColIt) {
-            
-           // search for an appropriate parameter in the input matrix 
-           MapOfMatrices::const_iterator inNMIt = inNM.find(nmColIt->first);           
-           // work with cross-terms if the input matrix have them
-           if (inNMIt != inNM.end()) {
+      // process normal matrix, iterating over the (usually few) elements
+      // of the input row
+      MapOfMatrices &nmRow = nmRowIt->second;
+      for (MapOfMatrices::const_iterator inNMIt = inNM.begin(); 
+                          inNMIt != inNM.end(); ++inNMIt) {
+           const MapOfMatrices::iterator nmColIt = nmRow.lower_bound(inNMIt->first);
+           if (nmColIt != nmRow.end() && nmColIt->first == inNMIt->first) {
                ASKAPCHECK(inNMIt->second.shape() == nmColIt->second.shape(),
                         "shape mismatch for normal matrix, parameters ("<<
                         nmRowIt->first<<" , "<<nmColIt->first<<")");
-                nmColIt->second += inNMIt->second; // add up a matrix         
-           }            
+               nmColIt->second += inNMIt->second; // add up a matrix         
+           } else {
+               // new non-zero cross-term
+               ASKAPCHECK(inNMIt->second.nrow() == inDV.nelements(),
+                        "shape mismatch for normal matrix, parameters ("<<
+                        nmRowIt->first<<" , "<<inNMIt->first<<")");
+               nmRow.insert(nmColIt, std::make_pair(inNMIt->first, inNMIt->second.copy()));
+           }
       }
       
-      // now process the data vector
-      MapOfVectors::const_iterator dvIt = itsDataVector.find(par);
-      ASKAPDEBUGASSERT(dvIt != itsDataVector.end());
-      ASKAPCHECK(inDV.shape() == dvIt->second.shape(),
-               "shape mismatch for data vector, parameter: "<<dvIt->first);
+      // now add the data vector
       // we have to instantiate explicitly a casa::Vector object because
       // otherwise, for some reason, the compiler can't figure out the type 
       // properly at the += operator. Exploit reference semantics - no copying!
@@ -242,46 +253,23 @@ void GenericNormalEquations::addParameter(const std::string &par,
       destVec += inDV; // add up a vector  
   } else {
      // this is a brand new parameter
-     // obtain iterator, which points to this parameter in inNM map.
+     ASKAPCHECK(inNM.find(par) != inNM.end(), 
+                "Diagonal term is missing for the new parameter "<<par);
+     ASKAPCHECK(parameterDimension(inNM) == inDV.nelements(),
+                "shape mismatch for data vector, parameter: "<<par);
      nmRowIt = itsNormalMatrix.insert(std::make_pair(par,MapOfMatrices())).first;
-     const casa::uInt newParDimension = parameterDimension(inNM); 
-       
-     // process normal matrix - add cross terms for all parameters, names are
-     // gathered from rows (it uses the fact the normal matrix is always square)
-     for (std::map<std::string, MapOfMatrices>::iterator nmOldRowIt = 
-          itsNormalMatrix.begin(); nmOldRowIt != itsNormalMatrix.end(); 
-          ++nmOldRowIt) {
-            
-          // search for an appropriate parameter in the source 
-          MapOfMatrices::const_iterator inNMIt = inNM.find(nmOldRowIt->first);           
-          if (inNMIt != inNM.end()) {
-              // insert terms only if the input matrix have them
-              nmRowIt->second.insert(*inNMIt); // assign a matrix
-              if (par != nmOldRowIt->first) {
-                  // fill in a symmetric term
-                  nmOldRowIt->second.insert(std::make_pair(par,
-                                transpose(inNMIt->second)));
-              }         
-          } else {
-              // insert zero matrix, as the parameter referred by nameIt and
-              // the new parameter are independent and, therefore, have zero 
-              // cross-terms.
-              const casa::uInt thisParDimension = 
-                               parameterDimension(nmOldRowIt->second); 
-              nmRowIt->second.insert(std::make_pair(nmOldRowIt->first,
-                  casa::Matrix<double>(newParDimension, thisParDimension,0.)));
-              if (par != nmOldRowIt->first) {
-                  // fill in a symmetric term
-                  nmOldRowIt->second.insert(std::make_pair(par,
-                      casa::Matrix<double>(thisParDimension, newParDimension,0.)));    
-              }
-          }            
-     }
      
+     // process normal matrix - only the non-zero terms are stored. Copy them
+     // as the input may be shared with other normal equations (i.e. merge)
+     for (MapOfMatrices::const_iterator inNMIt = inNM.begin(); 
+          inNMIt != inNM.end(); ++inNMIt) {
+          nmRowIt->second.insert(nmRowIt->second.end(), 
+                std::make_pair(inNMIt->first, inNMIt->second.copy()));
+     }
        
      // process data vector
      ASKAPDEBUGASSERT(itsDataVector.find(par) == itsDataVector.end());
-     itsDataVector.insert(std::make_pair(par, inDV));
+     itsDataVector.insert(std::make_pair(par, inDV.copy()));
   }                       
 }           
 
@@ -590,8 +578,35 @@ const casa::Matrix<double>& GenericNormalEquations::normalMatrix(const std::stri
   ASKAPCHECK(cIt1 != itsNormalMatrix.end(), "Missing first parameter "<<par1<<" is requested from the normal matrix");
   std::map<string, casa::Matrix<double> >::const_iterator cIt2 = 
                                    cIt1->second.find(par2);
-  ASKAPCHECK(cIt2 != cIt1->second.end(), "Missing second parameter "<<par2<<" is requested from the normal matrix");
-  return cIt2->second;                             
+  if (cIt2 != cIt1->second.end()) {
+      return cIt2->second;
+  }
+  // the cross-term is not stored, it is zero if both parameters are known
+  const MapOfVectors::const_iterator dvIt2 = itsDataVector.find(par2);
+  ASKAPCHECK(dvIt2 != itsDataVector.end(), "Missing second parameter "<<par2<<" is requested from the normal matrix");
+  const std::pair<casa::uInt, casa::uInt> shape(parameterDimension(cIt1->second), 
+                                                 dvIt2->second.nelements());
+  std::map<std::pair<casa::uInt, casa::uInt>, casa::Matrix<double> >::iterator zeroIt = 
+                                   itsZeroMatrices.find(shape);
+  if (zeroIt == itsZeroMatrices.end()) {
+      zeroIt = itsZeroMatrices.insert(std::make_pair(shape, 
+                     casa::Matrix<double>(shape.first, shape.second, 0.))).first;
+  }
+  return zeroIt->second;                             
+}
+
+/// @brief stored elements of one row of the normal matrix
+/// @details This method gives access to all non-zero elements of the
+/// normal matrix in the row corresponding to the given parameter. 
+/// @param[in] par the name of the parameter of interest
+/// @return map of column parameter names to the elements of the normal matrix
+const GenericNormalEquations::MapOfMatrices& 
+GenericNormalEquations::normalMatrixRow(const std::string &par) const
+{
+  const std::map<std::string, MapOfMatrices>::const_iterator cIt = 
+                                   itsNormalMatrix.find(par);
+  ASKAPCHECK(cIt != itsNormalMatrix.end(), "Parameter "<<par<<" is not found in the normal equations");
+  return cIt->second;
 }
 
 /// @brief data vector for a given parameter
@@ -615,8 +630,9 @@ const casa::Vector<double>& GenericNormalEquations::dataVector(const std::string
 void GenericNormalEquations::writeToBlob(LOFAR::BlobOStream& os) const
 { 
   // increment version number on the next line and in the next method
-  // if any new data members are added  
-  os.putStart("GenericNormalEquations",2);
+  // if any new data members are added. Version 3 stores the normal matrix
+  // as a sparse matrix (zero cross-terms are omitted)
+  os.putStart("GenericNormalEquations",3);
   os<<itsNormalMatrix<<itsDataVector<<itsMetadata;
   os.putEnd();
 }
@@ -627,9 +643,10 @@ void GenericNormalEquations::writeToBlob(LOFAR::BlobOStream& os) const
 void GenericNormalEquations::readFromBlob(LOFAR::BlobIStream& is)
 { 
   const int version = is.getStart("GenericNormalEquations");
-  ASKAPCHECK(version == 2, 
+  // version 2 has the same layout with all zero cross-terms present
+  ASKAPCHECK((version == 2) || (version == 3), 
               "Attempting to read from a blob stream an object of the wrong "
-              "version: expect version 2, found version "<<version);
+              "version: expect version 2 or 3, found version "<<version);
   is>>itsNormalMatrix>>itsDataVector>>itsMetadata;
   is.getEnd();
 }
@@ -50,6 +50,7 @@
 // std includes
 #include <map>
 #include <string>
+#include <utility>
 
 namespace askap {
 
@@ -66,8 +67,21 @@ class DesignMatrix;
 /// is approximated by a sum of diagonal and shift invariant matrices. This
 /// class represents the generic case, where no approximation to the normal
 /// matrix is done.
+///
+/// The normal matrix is stored as a sparse matrix of blocks: only the
+/// cross-terms between parameters which have been constrained together
+/// (i.e. appeared in the same design matrix or ComplexDiffMatrix) are kept.
+/// All other cross-terms are zero. This keeps memory and the cost of adding
+/// and merging proportional to the number of non-zero blocks, which matters
+/// for calibration problems with many antennas, beams and channels where the
+/// normal matrix is mostly block-diagonal.
 /// @ingroup fitting
 struct GenericNormalEquations : public INormalEquations {
+
+  /// @brief map of matrices (data element of each row map)
+  typedef std::map<std::string, casa::Matrix<double> > MapOfMatrices;
+  /// @brief map of vectors (data vectors for all parameters)
+  typedef std::map<std::string, casa::Vector<double> > MapOfVectors;
       
   /// @brief a default constructor
   /// @details It creates an empty normal equations class
@@ -155,8 +169,19 @@ struct GenericNormalEquations : public INormalEquations {
   /// @param[in] par1 the name of the first parameter
   /// @param[in] par2 the name of the second parameter
   /// @return one element of the sparse normal matrix (a dense matrix)
+  /// @note Zero cross-terms are not stored, a shared zero matrix of the
+  /// appropriate shape is returned for them. It must not be modified.
   virtual const casa::Matrix<double>& normalMatrix(const std::string &par1, 
                         const std::string &par2) const;
+
+  /// @brief stored elements of one row of the normal matrix
+  /// @details This method gives access to all non-zero elements of the
+  /// normal matrix in the row corresponding to the given parameter (the
+  /// diagonal element is always present). It allows solvers to work out the
+  /// structure of the normal equations without querying every pair of parameters.
+  /// @param[in] par the name of the parameter of interest
+  /// @return map of column parameter names to the elements of the normal matrix
+  const MapOfMatrices& normalMatrixRow(const std::string &par) const;
   
   /// @brief data vector for a given parameter
   /// @details In the current framework, parameters are essentially 
@@ -205,11 +230,6 @@ struct GenericNormalEquations : public INormalEquations {
   inline const Params& metadata() const { return itsMetadata;}
     
 protected:
-  /// @brief map of matrices (data element of each row map)
-  typedef std::map<std::string, casa::Matrix<double> > MapOfMatrices;
-  /// @brief map of vectors (data vectors for all parameters)
-  typedef std::map<std::string, casa::Vector<double> > MapOfVectors;
-
   /// @brief Add one parameter from another normal equations class
   /// @details This helper method is used in merging of two normal equations.
   /// It processes just one parameter.
@@ -232,9 +252,10 @@ protected:
   /// corresponds to a cross- or parallel term in the normal equations. Data
   /// vector is given simply as a casa::Vector, rather than the map of vectors,
   /// because only one parameter is concerned here. If a parameter with the given
-  /// name doesn't exist, the method adds it to both normal matrix and data vector,
-  /// populating correctly all required cross-terms with 0-matrices of an 
-  /// appropriate shape.
+  /// name doesn't exist, the method adds it to both normal matrix and data vector.
+  /// Only the given row is updated, cross-terms missing in this row are
+  /// inserted. The caller is responsible for passing all rows concerned, so the
+  /// matrix stays symmetric (this is the case for all public methods).
   /// @param[in] par name of the parameter to work with
   /// @param[in] inNM input normal matrix
   /// @param[in] inDV input data vector 
@@ -294,8 +315,13 @@ private:
   
   /// @brief normal matrix
   /// @details Normal matrices stored as a map or maps of Matrixes - 
-  /// it's really just a big matrix.
+  /// it's really just a big sparse matrix. Zero cross-terms are not stored.
   std::map<string, MapOfMatrices> itsNormalMatrix;
+
+  /// @brief zero matrices returned for the cross-terms which are not stored
+  /// @details The key is the shape (number of rows and columns). This is just
+  /// a cache, it is not copied or serialised.
+  mutable std::map<std::pair<casa::uInt, casa::uInt>, casa::Matrix<double> > itsZeroMatrices;
   
   /// @brief the data vectors
   /// @details This parameter may eventually go a level up in the class
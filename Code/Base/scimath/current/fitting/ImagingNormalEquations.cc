@@ -169,43 +169,15 @@ namespace askap
         if (other.itsDataVector.find(*iterCol) == other.itsDataVector.end()) {
             continue;
         }
-        ASKAPDEBUGASSERT(other.itsDataVector.find(*iterCol) != other.itsDataVector.end()); 
-        if(itsDataVector[*iterCol].size()!=other.itsDataVector.find(*iterCol)->second.size())
-        {
-          itsDataVector[*iterCol].assign(other.itsDataVector.find(*iterCol)->second);
-        }
-        else
-        {
-          itsDataVector[*iterCol]+=other.itsDataVector.find(*iterCol)->second;
-        }
-            
-        itsShape[*iterCol].resize(0);
         ASKAPDEBUGASSERT(other.itsShape.find(*iterCol) != other.itsShape.end());
-        itsShape[*iterCol]=other.itsShape.find(*iterCol)->second;
-        
-        itsReference[*iterCol].resize(0);
         ASKAPDEBUGASSERT(other.itsReference.find(*iterCol) != other.itsReference.end());
-        itsReference[*iterCol] = other.itsReference.find(*iterCol)->second;
-        
         ASKAPDEBUGASSERT(other.itsNormalMatrixSlice.find(*iterCol) != other.itsNormalMatrixSlice.end());
-        if(itsNormalMatrixSlice[*iterCol].shape()!=other.itsNormalMatrixSlice.find(*iterCol)->second.shape())
-        {
-          itsNormalMatrixSlice[*iterCol].assign(other.itsNormalMatrixSlice.find(*iterCol)->second);
-        }
-        else
-        {
-          itsNormalMatrixSlice[*iterCol]+=other.itsNormalMatrixSlice.find(*iterCol)->second;
-        }
- 
         ASKAPDEBUGASSERT(other.itsNormalMatrixDiagonal.find(*iterCol) != other.itsNormalMatrixDiagonal.end());
-        if(itsNormalMatrixDiagonal[*iterCol].shape()!=other.itsNormalMatrixDiagonal.find(*iterCol)->second.shape())
-        {
-          itsNormalMatrixDiagonal[*iterCol].assign(other.itsNormalMatrixDiagonal.find(*iterCol)->second);
-        }
-        else
-        {
-          itsNormalMatrixDiagonal[*iterCol]+=other.itsNormalMatrixDiagonal.find(*iterCol)->second;
-        }       
+        mergeParameter(*iterCol, other.itsNormalMatrixSlice.find(*iterCol)->second,
+                       other.itsNormalMatrixDiagonal.find(*iterCol)->second,
+                       other.itsDataVector.find(*iterCol)->second,
+                       other.itsShape.find(*iterCol)->second,
+                       other.itsReference.find(*iterCol)->second);
       }     
     }
     catch (const std::bad_cast &bc) {
@@ -214,6 +186,49 @@ namespace askap
     }
   }
 
+  /// @brief merge in a single parameter
+  /// @details This method does the same for one parameter as merge does for all
+  /// parameters of the input normal equations, i.e. the vectors are added if they
+  /// conform and replaced otherwise. It allows normal equations to be merged
+  /// parameter by parameter without assembling the whole input object first.
+  /// @param[in] name parameter name
+  /// @param[in] normalmatrixslice slice of the normal matrix for this parameter
+  /// @param[in] normalmatrixdiagonal diagonal of the normal matrix for this parameter
+  /// @param[in] datavector data vector for this parameter
+  /// @param[in] shape shape of this parameter
+  /// @param[in] reference reference point for the slice
+  void ImagingNormalEquations::mergeParameter(const std::string &name,
+                    const casa::Vector<double>& normalmatrixslice,
+                    const casa::Vector<double>& normalmatrixdiagonal,
+                    const casa::Vector<double>& datavector,
+                    const casa::IPosition& shape,
+                    const casa::IPosition& reference)
+  {
+    if (itsDataVector[name].size() != datavector.size()) {
+        itsDataVector[name].assign(datavector);
+    } else {
+        itsDataVector[name] += datavector;
+    }
+
+    itsShape[name].resize(0);
+    itsShape[name] = shape;
+
+    itsReference[name].resize(0);
+    itsReference[name] = reference;
+
+    if (itsNormalMatrixSlice[name].shape() != normalmatrixslice.shape()) {
+        itsNormalMatrixSlice[name].assign(normalmatrixslice);
+    } else {
+        itsNormalMatrixSlice[name] += normalmatrixslice;
+    }
+
+    if (itsNormalMatrixDiagonal[name].shape() != normalmatrixdiagonal.shape()) {
+        itsNormalMatrixDiagonal[name].assign(normalmatrixdiagonal);
+    } else {
+        itsNormalMatrixDiagonal[name] += normalmatrixdiagonal;
+    }
+  }
+
     const std::map<string, casa::Vector<double> >& ImagingNormalEquations::normalMatrixDiagonal() const
     {
       return itsNormalMatrixDiagonal;
@@ -160,6 +160,25 @@ namespace askap
       /// This means that we just add
       /// @param[in] src an object to get the normal equations from
       virtual void merge(const INormalEquations& src);
+
+      /// @brief merge in a single parameter
+      /// @details This method does the same for one parameter as merge does for all
+      /// parameters of the input normal equations, i.e. the vectors are added if they
+      /// conform and replaced otherwise. It allows normal equations to be merged
+      /// parameter by parameter as they are received, without assembling the
+      /// whole input object first.
+      /// @param[in] name parameter name
+      /// @param[in] normalmatrixslice slice of the normal matrix for this parameter
+      /// @param[in] normalmatrixdiagonal diagonal of the normal matrix for this parameter
+      /// @param[in] datavector data vector for this parameter
+      /// @param[in] shape shape of this parameter
+      /// @param[in] reference reference point for the slice
+      void mergeParameter(const std::string &name,
+                          const casa::Vector<double>& normalmatrixslice,
+                          const casa::Vector<double>& normalmatrixdiagonal,
+                          const casa::Vector<double>& datavector,
+                          const casa::IPosition& shape,
+                          const casa::IPosition& reference);
       
       
        /// @brief normal equations for given parameters
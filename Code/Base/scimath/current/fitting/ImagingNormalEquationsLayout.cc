@@ -0,0 +1,205 @@
+/// @file
+/// @brief Flat layout of imaging normal equations
+/// @details Imaging normal equations keep a separate vector for the normal matrix
+/// slice, diagonal and data vector of each parameter. This class describes how all
+/// these vectors can be packed into a single contiguous buffer of doubles. If two
+/// normal equations have the same layout, merging them is just an element-wise sum
+/// of their flat buffers, which can be done directly by MPI reduction operations
+/// without any serialisation.
+///
+/// @copyright (c) 2007 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+
+#include <fitting/ImagingNormalEquationsLayout.h>
+
+#include <askap/AskapError.h>
+
+#include <casa/Arrays/Vector.h>
+
+#include <Blob/BlobArray.h>
+
+#include <algorithm>
+#include <map>
+
+namespace askap {
+
+namespace scimath {
+
+/// @brief empty layout
+ImagingNormalEquationsLayout::ImagingNormalEquationsLayout() : itsSize(0) {}
+
+/// @brief build the layout of the given normal equations
+/// @param[in] ne normal equations
+ImagingNormalEquationsLayout::ImagingNormalEquationsLayout(const ImagingNormalEquations &ne) : itsSize(0)
+{
+  const std::vector<std::string> names = ne.unknowns();
+  itsParameters.resize(names.size());
+  for (size_t par = 0; par < names.size(); ++par) {
+       Parameter &param = itsParameters[par];
+       param.itsName = names[par];
+       const std::map<std::string, casa::IPosition>::const_iterator shapeIt = ne.shape().find(names[par]);
+       ASKAPDEBUGASSERT(shapeIt != ne.shape().end());
+       param.itsShape = shapeIt->second;
+       const std::map<std::string, casa::IPosition>::const_iterator refIt = ne.reference().find(names[par]);
+       ASKAPDEBUGASSERT(refIt != ne.reference().end());
+       param.itsReference = refIt->second;
+       ASKAPDEBUGASSERT(ne.normalMatrixDiagonal().find(names[par]) != ne.normalMatrixDiagonal().end());
+       ASKAPDEBUGASSERT(ne.dataVector().find(names[par]) != ne.dataVector().end());
+       param.itsSize[0] = ne.normalMatrixSlice().find(names[par])->second.nelements();
+       param.itsSize[1] = ne.normalMatrixDiagonal().find(names[par])->second.nelements();
+       param.itsSize[2] = ne.dataVector().find(names[par])->second.nelements();
+       param.itsOffset = itsSize;
+       itsSize += param.itsSize[0] + param.itsSize[1] + param.itsSize[2];
+  }
+}
+
+/// @brief name of the given parameter
+/// @param[in] par parameter index
+/// @return name of the parameter
+const std::string& ImagingNormalEquationsLayout::name(size_t par) const
+{
+  ASKAPDEBUGASSERT(par < itsParameters.size());
+  return itsParameters[par].itsName;
+}
+
+/// @brief offset of the given parameter
+/// @param[in] par parameter index
+/// @return offset of the first element of the normal matrix slice of this parameter
+size_t ImagingNormalEquationsLayout::offset(size_t par) const
+{
+  ASKAPDEBUGASSERT(par < itsParameters.size());
+  return itsParameters[par].itsOffset;
+}
+
+/// @brief compare two layouts
+/// @details Layouts are equal if they have the same parameters with the same
+/// shapes, reference points and vector sizes. Flat buffers of the same layout can
+/// be added element by element.
+/// @param[in] other layout to compare with
+/// @return true if the layouts are equal
+bool ImagingNormalEquationsLayout::operator==(const ImagingNormalEquationsLayout &other) const
+{
+  if (itsSize != other.itsSize || itsParameters.size() != other.itsParameters.size()) {
+      return false;
+  }
+  for (size_t par = 0; par < itsParameters.size(); ++par) {
+       const Parameter &param = itsParameters[par];
+       const Parameter &otherParam = other.itsParameters[par];
+       if (param.itsName != otherParam.itsName || param.itsOffset != otherParam.itsOffset ||
+           !std::equal(param.itsSize, param.itsSize + 3, otherParam.itsSize) ||
+           !param.itsShape.isEqual(otherParam.itsShape) ||
+           !param.itsReference.isEqual(otherParam.itsReference)) {
+           return false;
+       }
+  }
+  return true;
+}
+
+/// @brief pack normal equations into a flat buffer
+/// @param[in] ne normal equations, they must have this layout
+/// @param[out] buf buffer of at least size() elements
+void ImagingNormalEquationsLayout::pack(const ImagingNormalEquations &ne, double *buf) const
+{
+  ASKAPDEBUGASSERT(buf != 0 || itsSize == 0);
+  for (std::vector<Parameter>::const_iterator ci = itsParameters.begin(); ci != itsParameters.end(); ++ci) {
+       const casa::Vector<double>* vectors[3] = {0, 0, 0};
+       const std::map<std::string, casa::Vector<double> >::const_iterator sliceIt =
+             ne.normalMatrixSlice().find(ci->itsName);
+       const std::map<std::string, casa::Vector<double> >::const_iterator diagIt =
+             ne.normalMatrixDiagonal().find(ci->itsName);
+       const std::map<std::string, casa::Vector<double> >::const_iterator dvIt =
+             ne.dataVector().find(ci->itsName);
+       ASKAPCHECK(sliceIt != ne.normalMatrixSlice().end() && diagIt != ne.normalMatrixDiagonal().end() &&
+                  dvIt != ne.dataVector().end(), "Parameter "<<ci->itsName<<
+                  " is missing in the normal equations being packed");
+       vectors[0] = &(sliceIt->second);
+       vectors[1] = &(diagIt->second);
+       vectors[2] = &(dvIt->second);
+       double *dest = buf + ci->itsOffset;
+       for (size_t i = 0; i < 3; ++i) {
+            ASKAPCHECK(vectors[i]->nelements() == ci->itsSize[i], "Normal equations for "<<ci->itsName<<
+                       " do not conform to the layout");
+            std::copy(vectors[i]->begin(), vectors[i]->end(), dest);
+            dest += ci->itsSize[i];
+       }
+  }
+}
+
+/// @brief unpack normal equations from a flat buffer
+/// @details The normal equations are reset and then filled with the content
+/// of the flat buffer, i.e. the old values are replaced rather than merged.
+/// @param[in] buf buffer of at least size() elements
+/// @param[in,out] ne normal equations to fill
+void ImagingNormalEquationsLayout::unpack(const double *buf, ImagingNormalEquations &ne) const
+{
+  ASKAPDEBUGASSERT(buf != 0 || itsSize == 0);
+  ne.reset();
+  for (std::vector<Parameter>::const_iterator ci = itsParameters.begin(); ci != itsParameters.end(); ++ci) {
+       // vectors referencing the flat buffer, mergeParameter copies the data
+       // because the normal equations have been reset
+       double *src = const_cast<double*>(buf) + ci->itsOffset;
+       const casa::Vector<double> slice(casa::IPosition(1, ci->itsSize[0]), src, casa::SHARE);
+       src += ci->itsSize[0];
+       const casa::Vector<double> diag(casa::IPosition(1, ci->itsSize[1]), src, casa::SHARE);
+       src += ci->itsSize[1];
+       const casa::Vector<double> dv(casa::IPosition(1, ci->itsSize[2]), src, casa::SHARE);
+       ne.mergeParameter(ci->itsName, slice, diag, dv, ci->itsShape, ci->itsReference);
+  }
+}
+
+/// @brief write the object to a blob stream
+/// @param[in] os the output stream
+void ImagingNormalEquationsLayout::writeToBlob(LOFAR::BlobOStream& os) const
+{
+  os << static_cast<LOFAR::uint64>(itsParameters.size());
+  for (std::vector<Parameter>::const_iterator ci = itsParameters.begin(); ci != itsParameters.end(); ++ci) {
+       os << ci->itsName << ci->itsShape << ci->itsReference;
+       for (size_t i = 0; i < 3; ++i) {
+            os << static_cast<LOFAR::uint64>(ci->itsSize[i]);
+       }
+  }
+}
+
+/// @brief read the object from a blob stream
+/// @param[in] is the input stream
+void ImagingNormalEquationsLayout::readFromBlob(LOFAR::BlobIStream& is)
+{
+  LOFAR::uint64 nParams = 0;
+  is >> nParams;
+  itsParameters.resize(nParams);
+  itsSize = 0;
+  for (std::vector<Parameter>::iterator it = itsParameters.begin(); it != itsParameters.end(); ++it) {
+       is >> it->itsName >> it->itsShape >> it->itsReference;
+       for (size_t i = 0; i < 3; ++i) {
+            LOFAR::uint64 size = 0;
+            is >> size;
+            it->itsSize[i] = size;
+       }
+       it->itsOffset = itsSize;
+       itsSize += it->itsSize[0] + it->itsSize[1] + it->itsSize[2];
+  }
+}
+
+} // namespace scimath
+
+} // namespace askap
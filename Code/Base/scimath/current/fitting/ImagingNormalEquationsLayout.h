@@ -0,0 +1,142 @@
+/// @file
+/// @brief Flat layout of imaging normal equations
+/// @details Imaging normal equations keep a separate vector for the normal matrix
+/// slice, diagonal and data vector of each parameter. This class describes how all
+/// these vectors can be packed into a single contiguous buffer of doubles. If two
+/// normal equations have the same layout, merging them is just an element-wise sum
+/// of their flat buffers, which can be done directly by MPI reduction operations
+/// without any serialisation.
+///
+/// @copyright (c) 2007 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+
+#ifndef IMAGING_NORMAL_EQUATIONS_LAYOUT_H
+#define IMAGING_NORMAL_EQUATIONS_LAYOUT_H
+
+#include <fitting/ISerializable.h>
+#include <fitting/ImagingNormalEquations.h>
+
+#include <casa/Arrays/IPosition.h>
+
+#include <string>
+#include <vector>
+
+namespace askap {
+
+namespace scimath {
+
+/// @brief Flat layout of imaging normal equations
+/// @details This class holds an offset table describing where the normal matrix
+/// slice, diagonal and data vector of each parameter are located in a single
+/// contiguous buffer of doubles. For every parameter (in the alphabetical order
+/// of names), the slice is followed by the diagonal and then by the data vector.
+/// The layout also keeps shapes and reference points, so the normal equations can
+/// be fully reconstructed from the flat buffer.
+/// @ingroup fitting
+class ImagingNormalEquationsLayout : public ISerializable {
+public:
+   /// @brief empty layout
+   ImagingNormalEquationsLayout();
+
+   /// @brief build the layout of the given normal equations
+   /// @param[in] ne normal equations
+   explicit ImagingNormalEquationsLayout(const ImagingNormalEquations &ne);
+
+   /// @brief total size of the flat buffer
+   /// @return number of elements (doubles) in the flat buffer
+   inline size_t size() const { return itsSize; }
+
+   /// @brief number of parameters
+   /// @return number of parameters described by this layout
+   inline size_t nParameters() const { return itsParameters.size(); }
+
+   /// @brief name of the given parameter
+   /// @param[in] par parameter index
+   /// @return name of the parameter
+   const std::string& name(size_t par) const;
+
+   /// @brief offset of the given parameter
+   /// @param[in] par parameter index
+   /// @return offset of the first element of the normal matrix slice of this parameter
+   size_t offset(size_t par) const;
+
+   /// @brief compare two layouts
+   /// @details Layouts are equal if they have the same parameters with the same
+   /// shapes, reference points and vector sizes. Flat buffers of the same layout can
+   /// be added element by element.
+   /// @param[in] other layout to compare with
+   /// @return true if the layouts are equal
+   bool operator==(const ImagingNormalEquationsLayout &other) const;
+
+   /// @brief compare two layouts
+   /// @param[in] other layout to compare with
+   /// @return true if the layouts are not equal
+   inline bool operator!=(const ImagingNormalEquationsLayout &other) const { return !operator==(other); }
+
+   /// @brief pack normal equations into a flat buffer
+   /// @param[in] ne normal equations, they must have this layout
+   /// @param[out] buf buffer of at least size() elements
+   void pack(const ImagingNormalEquations &ne, double *buf) const;
+
+   /// @brief unpack normal equations from a flat buffer
+   /// @details The normal equations are reset and then filled with the content
+   /// of the flat buffer, i.e. the old values are replaced rather than merged.
+   /// @param[in] buf buffer of at least size() elements
+   /// @param[in,out] ne normal equations to fill
+   void unpack(const double *buf, ImagingNormalEquations &ne) const;
+
+   /// @brief write the object to a blob stream
+   /// @param[in] os the output stream
+   virtual void writeToBlob(LOFAR::BlobOStream& os) const;
+
+   /// @brief read the object from a blob stream
+   /// @param[in] is the input stream
+   virtual void readFromBlob(LOFAR::BlobIStream& is);
+
+private:
+   /// @brief description of one parameter
+   struct Parameter {
+      /// @brief parameter name
+      std::string itsName;
+      /// @brief shape of the parameter
+      casa::IPosition itsShape;
+      /// @brief reference point for the slice
+      casa::IPosition itsReference;
+      /// @brief offset of the normal matrix slice in the flat buffer
+      size_t itsOffset;
+      /// @brief number of elements in the slice, diagonal and data vector
+      size_t itsSize[3];
+   };
+
+   /// @brief descriptions of all parameters
+   std::vector<Parameter> itsParameters;
+
+   /// @brief total number of elements
+   size_t itsSize;
+};
+
+} // namespace scimath
+
+} // namespace askap
+
+#endif // #ifndef IMAGING_NORMAL_EQUATIONS_LAYOUT_H
@@ -27,6 +27,7 @@
 /// @author Tim Cornwell <tim.cornwell@csiro.au>
 ///
 #include <fitting/LinearSolver.h>
+#include <fitting/GenericNormalEquations.h>
 
 #include <askap/AskapError.h>
 #include <profile/AskapProfiler.h>
@@ -41,6 +42,7 @@
 #include <gsl/gsl_linalg.h>
 
 #include <iostream>
+#include <algorithm>
 
 #include <string>
 #include <map>
@@ -127,6 +129,91 @@ std::vector<std::string> LinearSolver::getIndependentSubset(std::vector<std::str
 }
     
     
+/// @brief split parameters into independent blocks
+/// @details This method partitions the given parameters into groups which are
+/// not linked by any non-zero element of the normal matrix (directly or via other
+/// parameters of the same group). For GenericNormalEquations only the stored
+/// elements of each row are examined and the groups are merged with a union-find
+/// structure, so the cost is proportional to the number of non-zero elements rather
+/// than to the square of the number of parameters. For other types of normal equations
+/// getIndependentSubset is called repeatedly.
+/// @param[in] names names for parameters to split
+/// @param[in] tolerance tolerance on the matrix elements to decide whether they can be considered independent
+/// @return names of parameters for each block (in the order of the first appearance in names)
+std::vector<std::vector<std::string> > LinearSolver::getIndependentBlocks(const std::vector<std::string> &names, 
+                                                                          const double tolerance) const
+{
+   ASKAPTRACE("LinearSolver::getIndependentBlocks");
+   std::vector<std::vector<std::string> > result;
+   const GenericNormalEquations *gne = dynamic_cast<const GenericNormalEquations*>(&normalEquations());
+   if (gne == NULL) {
+       std::vector<std::string> remainingNames(names);
+       while (remainingNames.size() > 0) {
+          const std::vector<std::string> subsetNames = getIndependentSubset(remainingNames,tolerance);
+          result.push_back(subsetNames);
+          std::vector<std::string> buf;
+          buf.reserve(remainingNames.size() - subsetNames.size());
+          for (std::vector<std::string>::const_iterator ci = remainingNames.begin(); ci != remainingNames.end(); ++ci) {
+               if (find(subsetNames.begin(),subsetNames.end(),*ci) == subsetNames.end()) {
+                   buf.push_back(*ci);
+               }
+          }
+          remainingNames.swap(buf);
+       }
+       return result;
+   }
+   
+   std::map<std::string, size_t> indices;
+   for (size_t index = 0; index < names.size(); ++index) {
+        indices.insert(std::make_pair(names[index], index));
+   }
+   
+   // union-find structure, each parameter points towards the representative of its block
+   std::vector<size_t> parent(names.size());
+   for (size_t index = 0; index < parent.size(); ++index) {
+        parent[index] = index;
+   }
+   for (size_t index = 0; index < names.size(); ++index) {
+        const GenericNormalEquations::MapOfMatrices &row = gne->normalMatrixRow(names[index]);
+        for (GenericNormalEquations::MapOfMatrices::const_iterator ci = row.begin(); ci != row.end(); ++ci) {
+             const std::map<std::string, size_t>::const_iterator indexIt = indices.find(ci->first);
+             if ((indexIt == indices.end()) || (indexIt->second == index) || 
+                 allMatrixElementsAreZeros(ci->second, tolerance)) {
+                 continue;
+             }
+             size_t root1 = index;
+             while (parent[root1] != root1) {
+                    root1 = parent[root1] = parent[parent[root1]];
+             }
+             size_t root2 = indexIt->second;
+             while (parent[root2] != root2) {
+                    root2 = parent[root2] = parent[parent[root2]];
+             }
+             // the smaller index is kept as the representative to preserve the order
+             if (root1 < root2) {
+                 parent[root2] = root1;
+             } else {
+                 parent[root1] = root2;
+             }
+        }
+   }
+   
+   // form the blocks, the representative is the first parameter of the block in names
+   std::vector<size_t> blockIndex(names.size(), names.size());
+   for (size_t index = 0; index < names.size(); ++index) {
+        size_t root = index;
+        while (parent[root] != root) {
+               root = parent[root];
+        }
+        if (blockIndex[root] == names.size()) {
+            blockIndex[root] = result.size();
+            result.push_back(std::vector<std::string>());
+        }
+        result[blockIndex[root]].push_back(names[index]);
+   }
+   return result;
+}
+    
 /// @brief solve for a subset of parameters
 /// @details This method is used in solveNormalEquations
 /// @param[in] params parameters to be updated           
@@ -341,28 +428,10 @@ std::pair<double,double>  LinearSolver::solveSubsetOfNormalEquations(Params &par
           // no need to extract independent blocks if number of unknowns is small
           solveSubsetOfNormalEquations(params,quality,names);
       } else {
-          while (names.size() > 0) {
-              const std::vector<std::string> subsetNames = getIndependentSubset(names,1e-6);
-              if (subsetNames.size() == names.size()) {
-                  names.resize(0);
-              } else {
-                  // remove the elements corresponding to the current subset from the list of names prepared for the
-                  // following integration
-                  std::vector<size_t> indicesToRemove(subsetNames.size(),subsetNames.size());                                   
-                  for (size_t index = 0,indexToRemove = 0; index < names.size(); ++index) {
-                       if (find(subsetNames.begin(),subsetNames.end(),names[index]) != subsetNames.end()) {
-                           ASKAPDEBUGASSERT(indexToRemove < indicesToRemove.size());
-                           indicesToRemove[indexToRemove++] = index;
-                       }
-                  }
-                  
-                  // the following could be done more elegantly/faster, but leave the optimisation to later time                  
-                  for (std::vector<size_t>::const_reverse_iterator ci = indicesToRemove.rbegin(); ci!=indicesToRemove.rend(); ++ci) {
-                       ASKAPDEBUGASSERT(*ci < names.size());
-                       names.erase(names.begin() + *ci);
-                  }
-              }
-              solveSubsetOfNormalEquations(params,quality, subsetNames);
+          const std::vector<std::vector<std::string> > blocks = getIndependentBlocks(names,1e-6);
+          for (std::vector<std::vector<std::string> >::const_iterator ci = blocks.begin(); 
+               ci != blocks.end(); ++ci) {
+               solveSubsetOfNormalEquations(params,quality, *ci);
           } 
       }
         
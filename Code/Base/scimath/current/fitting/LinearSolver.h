@@ -98,6 +98,19 @@ namespace askap
         /// @param[in] tolerance tolerance on the matrix elements to decide whether they can be considered independent
         /// @return names of parameters in this subset
         std::vector<std::string> getIndependentSubset(std::vector<std::string> &names, const double tolerance) const;
+
+        /// @brief split parameters into independent blocks
+        /// @details This method partitions the given parameters into groups which are
+        /// not linked by any non-zero element of the normal matrix (directly or via other
+        /// parameters of the same group), i.e. the connected components of the normal matrix
+        /// structure. Each group can be solved for separately. For GenericNormalEquations
+        /// only the stored (non-zero) elements are examined, otherwise getIndependentSubset
+        /// is used repeatedly.
+        /// @param[in] names names for parameters to split
+        /// @param[in] tolerance tolerance on the matrix elements to decide whether they can be considered independent
+        /// @return names of parameters for each block (in the order of the first appearance in names)
+        std::vector<std::vector<std::string> > getIndependentBlocks(const std::vector<std::string> &names, 
+                                                                    const double tolerance) const;
          
         /// @brief test that all matrix elements are below tolerance by absolute value
         /// @details This is a helper method to test all matrix elements
@@ -150,6 +150,10 @@ namespace askap
       CPPUNIT_TEST_SUITE(FFTTest);
       CPPUNIT_TEST(testForwardBackwardSinglePrecision);
       CPPUNIT_TEST(testForwardBackwardDoublePrecision);      
+      CPPUNIT_TEST(test2DAgainst1D);
+      CPPUNIT_TEST(testThreads);
+      CPPUNIT_TEST(testPlannerRigour);
+      CPPUNIT_TEST_EXCEPTION(testUnknownPlannerRigour, askap::AskapError);
       CPPUNIT_TEST_SUITE_END();
 
       private:
@@ -194,6 +198,88 @@ namespace askap
                 CPPUNIT_ASSERT(forward_backward_test(N, dp_mat, NRMSE, dp_precision) == true);
             }
         }
+
+        void test2DAgainst1D()
+        {
+            // fft2d folds the shift of the origin into the transform for even sizes and
+            // shifts explicitly for odd sizes, the result should match 1-D transforms
+            // done along each axis in turn
+            const int shapes[][2] = {{8, 8}, {16, 6}, {6, 10}, {7, 7}, {9, 4}, {2, 2}};
+            for (size_t i = 0; i < sizeof(shapes) / sizeof(shapes[0]); ++i) {
+                 for (int dir = 0; dir < 2; ++dir) {
+                      const bool forward = (dir == 0);
+                      casa::Matrix<casa::DComplex> mat(shapes[i][0], shapes[i][1]);
+                      for (uInt row = 0; row < mat.nrow(); ++row) {
+                           for (uInt col = 0; col < mat.ncolumn(); ++col) {
+                                mat(row, col) = casa::DComplex(myRand(-0.5,0.5), myRand(-0.5,0.5));
+                           }
+                      }
+                      casa::Matrix<casa::DComplex> expected = mat.copy();
+                      for (uInt col = 0; col < expected.ncolumn(); ++col) {
+                           casa::Vector<casa::DComplex> y = expected.column(col);
+                           askap::scimath::fft(y, forward);
+                      }
+                      for (uInt row = 0; row < expected.nrow(); ++row) {
+                           casa::Vector<casa::DComplex> y = expected.row(row);
+                           askap::scimath::fft(y, forward);
+                      }
+                      casa::Array<casa::DComplex> arr(mat);
+                      askap::scimath::fft2d(arr, forward);
+                      for (uInt row = 0; row < mat.nrow(); ++row) {
+                           for (uInt col = 0; col < mat.ncolumn(); ++col) {
+                                CPPUNIT_ASSERT_DOUBLES_EQUAL(0., abs(mat(row, col) - expected(row, col)), 1e-10);
+                           }
+                      }
+                 }
+            }
+        }
+
+        void testThreads()
+        {
+            askap::scimath::fftSetNumberOfThreads(2);
+            CPPUNIT_ASSERT_EQUAL(2, askap::scimath::fftNumberOfThreadsInUse());
+            casa::Matrix<casa::Complex> mat(64, 64);
+            for (uInt row = 0; row < mat.nrow(); ++row) {
+                 for (uInt col = 0; col < mat.ncolumn(); ++col) {
+                      mat(row, col) = casa::Complex(myRand(-0.5,0.5), myRand(-0.5,0.5));
+                 }
+            }
+            const casa::Matrix<casa::Complex> original = mat.copy();
+            casa::Array<casa::Complex> arr(mat);
+            askap::scimath::fft2d(arr, FFT);
+            askap::scimath::fft2d(arr, IFFT);
+            double diff = 0.;
+            CPPUNIT_ASSERT(test_for_equality(mat, original, NRMSE, sp_precision, diff));
+            askap::scimath::fftSetNumberOfThreads(1);
+            askap::scimath::fftClearPlanCache();
+        }
+
+        void testPlannerRigour()
+        {
+            // measured plans must give the same transforms as estimated ones
+            askap::scimath::fftClearPlanCache();
+            askap::scimath::fftSetPlannerRigour("measure");
+            casa::Matrix<casa::Complex> mat(32, 16);
+            for (uInt row = 0; row < mat.nrow(); ++row) {
+                 for (uInt col = 0; col < mat.ncolumn(); ++col) {
+                      mat(row, col) = casa::Complex(myRand(-0.5,0.5), myRand(-0.5,0.5));
+                 }
+            }
+            const casa::Matrix<casa::Complex> original = mat.copy();
+            casa::Array<casa::Complex> arr(mat);
+            askap::scimath::fft2d(arr, FFT);
+            askap::scimath::fftSetPlannerRigour("estimate");
+            askap::scimath::fftClearPlanCache();
+            askap::scimath::fft2d(arr, IFFT);
+            double diff = 0.;
+            CPPUNIT_ASSERT(test_for_equality(mat, original, NRMSE, sp_precision, diff));
+            askap::scimath::fftClearPlanCache();
+        }
+
+        void testUnknownPlannerRigour()
+        {
+            askap::scimath::fftSetPlannerRigour("exhaustive-ish");
+        }
         
     };
     
@@ -40,6 +40,9 @@
 #include <fitting/DesignMatrix.h>
 #include <fitting/ComplexDiffMatrix.h>
 #include <fitting/PolXProducts.h>
+#include <fitting/LinearSolver.h>
+#include <fitting/Params.h>
+#include <fitting/Quality.h>
 
 
 #include <cppunit/extensions/HelperMacros.h>
@@ -54,6 +57,7 @@
 #include <askap/AskapError.h>
 
 #include <boost/shared_ptr.hpp>
+#include <boost/lexical_cast.hpp>
 #include <algorithm>
 
 namespace askap
@@ -74,6 +78,7 @@ namespace askap
       CPPUNIT_TEST(testBlobStream);
       CPPUNIT_TEST(testAddProduct);
       CPPUNIT_TEST(testMetadata);
+      CPPUNIT_TEST(testSparseBlocks);
       CPPUNIT_TEST_SUITE_END();
 
       private:
@@ -411,6 +416,53 @@ namespace askap
           CPPUNIT_ASSERT_DOUBLES_EQUAL(-1.1e-2, itsNE->metadata().scalarValue("mdata_keyword2"),1e-6);
         }
                         
+        // many independent pairs of parameters, only non-zero elements
+        // are stored and the solver has to find the blocks
+        void testSparseBlocks() {
+          const size_t nBlocks = 60;
+          Params params;
+          for (size_t block = 0; block < nBlocks; ++block) {
+               const std::string suffix = boost::lexical_cast<std::string>(block);
+               // a + b = 3 + block, a + 2*b = 4 + block
+               DesignMatrix dm;
+               casa::Matrix<casa::Double> derivB(2, 1, 1.0);
+               derivB(1,0) = 2.;
+               dm.addDerivative("a"+suffix, casa::Matrix<casa::Double>(2, 1, 1.0));
+               dm.addDerivative("b"+suffix, derivB);
+               casa::Vector<casa::Double> residual(2, 3. + block);
+               residual[1] += 1.;
+               dm.addResidual(residual, casa::Vector<double>(2, 1.0));
+               itsNE->add(dm);
+               params.add("a"+suffix, 0.);
+               params.add("b"+suffix, 0.);
+          }
+          CPPUNIT_ASSERT_EQUAL(size_t(2 * nBlocks), itsNE->unknowns().size());
+          CPPUNIT_ASSERT_EQUAL(size_t(2), itsNE->normalMatrixRow("a0").size());
+          CPPUNIT_ASSERT_EQUAL(size_t(2), itsNE->normalMatrixRow("b10").size());
+          const casa::Matrix<double>& crossTerm = itsNE->normalMatrix("a0","b1");
+          CPPUNIT_ASSERT_EQUAL(1u, crossTerm.nrow());
+          CPPUNIT_ASSERT_EQUAL(1u, crossTerm.ncolumn());
+          CPPUNIT_ASSERT(norm1(crossTerm)<1e-7);
+          CPPUNIT_ASSERT_DOUBLES_EQUAL(2., itsNE->normalMatrix("a1","a1")(0,0), 1e-7);
+          CPPUNIT_ASSERT_DOUBLES_EQUAL(3., itsNE->normalMatrix("a1","b1")(0,0), 1e-7);
+          
+          // merging keeps the structure
+          GenericNormalEquations gne(*itsNE);
+          itsNE->merge(gne);
+          CPPUNIT_ASSERT_EQUAL(size_t(2), itsNE->normalMatrixRow("a5").size());
+          CPPUNIT_ASSERT_DOUBLES_EQUAL(4., itsNE->normalMatrix("a5","a5")(0,0), 1e-7);
+          
+          LinearSolver solver;
+          solver.addNormalEquations(*itsNE);
+          Quality q;
+          solver.solveNormalEquations(params, q);
+          for (size_t block = 0; block < nBlocks; ++block) {
+               const std::string suffix = boost::lexical_cast<std::string>(block);
+               CPPUNIT_ASSERT_DOUBLES_EQUAL(2. + block, params.scalarValue("a"+suffix), 1e-7);
+               CPPUNIT_ASSERT_DOUBLES_EQUAL(1., params.scalarValue("b"+suffix), 1e-7);
+          }
+        }
+
         // testing addition of normal equations based on a product of
         // complex diff matrix and a vector presented by cross-products
         void testAddProduct() {
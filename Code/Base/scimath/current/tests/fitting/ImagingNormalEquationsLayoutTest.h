@@ -0,0 +1,226 @@
+/// @file
+///
+/// @brief Tests of ImagingNormalEquationsLayout, the flat layout of imaging normal equations
+/// @details See ImagingNormalEquationsLayout for description of what this class
+/// is supposed to do. This file contains appropriate unit tests.
+///
+/// @copyright (c) 2007 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+
+#ifndef IMAGING_NORMAL_EQUATIONS_LAYOUT_TEST_H
+#define IMAGING_NORMAL_EQUATIONS_LAYOUT_TEST_H
+
+#include <fitting/ImagingNormalEquationsLayout.h>
+#include <fitting/ImagingNormalEquations.h>
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <Blob/BlobString.h>
+#include <Blob/BlobOBufString.h>
+#include <Blob/BlobIBufString.h>
+#include <Blob/BlobOStream.h>
+#include <Blob/BlobIStream.h>
+
+#include <askap/AskapError.h>
+
+#include <vector>
+#include <cmath>
+
+namespace askap
+{
+  namespace scimath
+  {
+
+    class ImagingNormalEquationsLayoutTest : public CppUnit::TestFixture
+    {
+      CPPUNIT_TEST_SUITE(ImagingNormalEquationsLayoutTest);
+      CPPUNIT_TEST(testLayout);
+      CPPUNIT_TEST(testPackUnpack);
+      CPPUNIT_TEST(testSum);
+      CPPUNIT_TEST(testComparison);
+      CPPUNIT_TEST(testBlobStream);
+      CPPUNIT_TEST_EXCEPTION(testPackWrongShape, askap::AskapError);
+      CPPUNIT_TEST_SUITE_END();
+
+      public:
+
+        void testLayout()
+        {
+          ImagingNormalEquations ne;
+          fill(ne, 1.);
+          const ImagingNormalEquationsLayout layout(ne);
+          CPPUNIT_ASSERT_EQUAL(size_t(2), layout.nParameters());
+          // parameters are in the alphabetical order
+          CPPUNIT_ASSERT_EQUAL(std::string("Image1"), layout.name(0));
+          CPPUNIT_ASSERT_EQUAL(std::string("Image2"), layout.name(1));
+          CPPUNIT_ASSERT_EQUAL(size_t(0), layout.offset(0));
+          CPPUNIT_ASSERT_EQUAL(size_t(15), layout.offset(1));
+          CPPUNIT_ASSERT_EQUAL(size_t(21), layout.size());
+
+          const ImagingNormalEquationsLayout emptyLayout;
+          CPPUNIT_ASSERT_EQUAL(size_t(0), emptyLayout.size());
+          CPPUNIT_ASSERT_EQUAL(size_t(0), emptyLayout.nParameters());
+        }
+
+        void testPackUnpack()
+        {
+          ImagingNormalEquations ne;
+          fill(ne, 2.);
+          const ImagingNormalEquationsLayout layout(ne);
+          std::vector<double> buf(layout.size(), -1.);
+          layout.pack(ne, &buf[0]);
+          CPPUNIT_ASSERT_DOUBLES_EQUAL(0.2, buf[0], 1e-6);
+          CPPUNIT_ASSERT_DOUBLES_EQUAL(2., buf[5], 1e-6);
+          CPPUNIT_ASSERT_DOUBLES_EQUAL(-80., buf[10], 1e-6);
+          CPPUNIT_ASSERT_DOUBLES_EQUAL(2., buf[15], 1e-6);
+          CPPUNIT_ASSERT_DOUBLES_EQUAL(20., buf[18], 1e-6);
+
+          ImagingNormalEquations result;
+          layout.unpack(&buf[0], result);
+          checkValues(result, 2.);
+          CPPUNIT_ASSERT(ImagingNormalEquationsLayout(result) == layout);
+
+          // the buffer must have been copied
+          buf.assign(buf.size(), 0.);
+          checkValues(result, 2.);
+        }
+
+        void testSum()
+        {
+          // the sum of flat buffers must be equivalent to merge
+          ImagingNormalEquations ne1;
+          fill(ne1, 1.);
+          ImagingNormalEquations ne2;
+          fill(ne2, 3.);
+          const ImagingNormalEquationsLayout layout(ne1);
+          std::vector<double> buf1(layout.size());
+          std::vector<double> buf2(layout.size());
+          layout.pack(ne1, &buf1[0]);
+          layout.pack(ne2, &buf2[0]);
+          for (size_t i = 0; i < buf1.size(); ++i) {
+               buf1[i] += buf2[i];
+          }
+          // unpack replaces the old content
+          layout.unpack(&buf1[0], ne2);
+          checkValues(ne2, 4.);
+          ne1.merge(ne2);
+          checkValues(ne1, 5.);
+        }
+
+        void testComparison()
+        {
+          ImagingNormalEquations ne1;
+          fill(ne1, 1.);
+          ImagingNormalEquations ne2;
+          fill(ne2, 10.);
+          CPPUNIT_ASSERT(ImagingNormalEquationsLayout(ne1) == ImagingNormalEquationsLayout(ne2));
+          ne2.addSlice("Image3", casa::Vector<double>(2, 1.), casa::Vector<double>(2, 1.),
+                       casa::Vector<double>(2, 1.), casa::IPosition(1,0));
+          CPPUNIT_ASSERT(ImagingNormalEquationsLayout(ne1) != ImagingNormalEquationsLayout(ne2));
+          ImagingNormalEquations ne3;
+          fill(ne3, 1., casa::IPosition(1,1));
+          CPPUNIT_ASSERT(ImagingNormalEquationsLayout(ne1) != ImagingNormalEquationsLayout(ne3));
+          CPPUNIT_ASSERT(ImagingNormalEquationsLayout(ne1) != ImagingNormalEquationsLayout());
+        }
+
+        void testBlobStream()
+        {
+          ImagingNormalEquations ne;
+          fill(ne, 1.);
+          const ImagingNormalEquationsLayout layout(ne);
+          LOFAR::BlobString b1(false);
+          LOFAR::BlobOBufString bob(b1);
+          LOFAR::BlobOStream bos(bob);
+          bos << layout;
+          LOFAR::BlobIBufString bib(b1);
+          LOFAR::BlobIStream bis(bib);
+          ImagingNormalEquationsLayout layout2;
+          bis >> layout2;
+          CPPUNIT_ASSERT(layout == layout2);
+          CPPUNIT_ASSERT_EQUAL(layout.size(), layout2.size());
+          CPPUNIT_ASSERT_EQUAL(layout.offset(1), layout2.offset(1));
+        }
+
+        void testPackWrongShape()
+        {
+          ImagingNormalEquations ne1;
+          fill(ne1, 1.);
+          const ImagingNormalEquationsLayout layout(ne1);
+          ImagingNormalEquations ne2;
+          ne2.addSlice("Image1", casa::Vector<double>(3, 1.), casa::Vector<double>(3, 1.),
+                       casa::Vector<double>(3, 1.), casa::IPosition(1,0));
+          std::vector<double> buf(layout.size());
+          // should throw an exception
+          layout.pack(ne2, &buf[0]);
+        }
+
+      protected:
+        /// @brief fill normal equations with test values
+        /// @details Two parameters are set up, one with a slice of 5 elements and
+        /// one with the diagonal of 3 elements and an empty slice. All values are
+        /// proportional to the scale.
+        /// @param[in] ne normal equations to fill
+        /// @param[in] scale scaling factor for all values
+        /// @param[in] reference reference point for the slice
+        static void fill(ImagingNormalEquations &ne, double scale,
+                         const casa::IPosition &reference = casa::IPosition(1,0))
+        {
+          ne.addSlice("Image1", casa::Vector<double>(5, 0.1 * scale),
+                      casa::Vector<double>(5, scale), casa::Vector<double>(5, -40. * scale),
+                      reference);
+          // addDiagonal doesn't create an (empty) slice, so the parameter would be ignored
+          ne.mergeParameter("Image2", casa::Vector<double>(0), casa::Vector<double>(3, scale),
+                      casa::Vector<double>(3, 10. * scale), casa::IPosition(1, 3), casa::IPosition());
+        }
+
+        /// @brief check values set up by fill
+        /// @param[in] ne normal equations to check
+        /// @param[in] scale expected scaling factor
+        static void checkValues(const ImagingNormalEquations &ne, double scale)
+        {
+          testAllElements(ne.normalMatrixSlice().find("Image1")->second, 5, 0.1 * scale);
+          testAllElements(ne.normalMatrixDiagonal().find("Image1")->second, 5, scale);
+          testAllElements(ne.dataVector("Image1"), 5, -40. * scale);
+          testAllElements(ne.normalMatrixSlice().find("Image2")->second, 0, 0.);
+          testAllElements(ne.normalMatrixDiagonal().find("Image2")->second, 3, scale);
+          testAllElements(ne.dataVector("Image2"), 3, 10. * scale);
+        }
+
+        /// @brief test values stored in a vector
+        /// @param[in] vec input vector (passed by const reference)
+        /// @param[in] expectedSize expected size of the vector
+        /// @param[in] expectedValue expected value of all elements
+        static void testAllElements(const casa::Vector<double> &vec,
+                casa::uInt expectedSize, double expectedValue)
+        {
+          CPPUNIT_ASSERT_EQUAL(expectedSize, vec.nelements());
+          for (casa::uInt i=0; i<expectedSize; ++i) {
+               CPPUNIT_ASSERT_DOUBLES_EQUAL(expectedValue, vec[i], 1e-6);
+          }
+        }
+    };
+
+  } // namespace scimath
+} // namespace askap
+
+#endif // #ifndef IMAGING_NORMAL_EQUATIONS_LAYOUT_TEST_H
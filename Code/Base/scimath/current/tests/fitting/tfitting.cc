@@ -28,6 +28,7 @@
 #include <ParamsTableTest.h>
 #include <DesignMatrixTest.h>
 #include <ImagingNormalEquationsTest.h>
+#include <ImagingNormalEquationsLayoutTest.h>
 #include <GenericNormalEquationsTest.h>
 #include <NormalEquationsStubTest.h>
 #include <PolynomialEquationTest.h>
@@ -47,6 +48,7 @@ int main(int argc, char *argv[])
     runner.addTest(askap::scimath::DesignMatrixTest::suite());
     runner.addTest(askap::scimath::GenericNormalEquationsTest::suite());
     runner.addTest(askap::scimath::ImagingNormalEquationsTest::suite());
+    runner.addTest(askap::scimath::ImagingNormalEquationsLayoutTest::suite());
     runner.addTest(askap::scimath::NormalEquationsStubTest::suite());
     runner.addTest(askap::scimath::PolynomialEquationTest::suite());
     runner.addTest(askap::scimath::GeneralFittingTest::suite());
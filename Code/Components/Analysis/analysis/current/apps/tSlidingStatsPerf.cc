@@ -0,0 +1,151 @@
+/// @file : timing of the sliding-box median and MADFM used by the variable thresholder
+///
+/// Compares SlidingRobustStats with casacore's slidingArrayMath, for a
+/// channel map (spatial search) and for a number of spectra (spectral
+/// search).
+///
+/// Usage: tSlidingStatsPerf [imageSize [boxSize [numChannels [numThreads]]]]
+///
+/// @copyright (c) 2015 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+#include <askap_analysis.h>
+
+#include <preprocessing/SlidingRobustStats.h>
+
+#include <casa/aipstype.h>
+#include <casa/Arrays/Array.h>
+#include <casa/Arrays/ArrayMath.h>
+#include <casa/Arrays/ArrayPartMath.h>
+#include <casa/Arrays/MaskedArray.h>
+#include <casa/Arrays/MaskArrMath.h>
+#include <casa/Arrays/IPosition.h>
+#include <casa/OS/Timer.h>
+
+#include <askap/AskapLogging.h>
+#include <askap/AskapError.h>
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+using namespace askap;
+using namespace askap::analysis;
+
+ASKAP_LOGGER(logger, "tSlidingStatsPerf.log");
+
+/// Noise-like values, with one pixel in fifty masked
+casa::MaskedArray<casa::Float> makeInput(const casa::IPosition &shape)
+{
+    casa::Array<casa::Float> values(shape);
+    casa::LogicalArray mask(shape);
+    casa::Array<casa::Float>::iterator iterValue(values.begin());
+    casa::LogicalArray::iterator iterMask(mask.begin());
+    for (; iterValue != values.end(); iterValue++, iterMask++) {
+        *iterValue = casa::Float(rand()) / RAND_MAX + casa::Float(rand()) / RAND_MAX +
+                     casa::Float(rand()) / RAND_MAX - 1.5;
+        *iterMask = (rand() % 50 != 0);
+    }
+    return casa::MaskedArray<casa::Float>(values, mask);
+}
+
+/// Time both methods for a number of chunks of the given shape
+void compare(const std::string &mode, const casa::IPosition &shape,
+             const casa::IPosition &box, size_t nChunks, unsigned int nThreads)
+{
+    std::vector< casa::MaskedArray<casa::Float> > chunks;
+    for (size_t i = 0; i < nChunks; i++) {
+        chunks.push_back(makeInput(shape));
+    }
+
+    casa::Timer timer;
+    std::vector< casa::Array<casa::Float> > casaMedian(nChunks), casaMadfm(nChunks);
+    timer.mark();
+    for (size_t i = 0; i < nChunks; i++) {
+        casaMedian[i].resize(shape);
+        casaMadfm[i].resize(shape);
+        casaMedian[i] = slidingArrayMath(chunks[i], box, casa::MaskedMedianFunc<casa::Float>());
+        casaMadfm[i] = slidingArrayMath(chunks[i], box, casa::MaskedMadfmFunc<casa::Float>());
+    }
+    const double casaTime = timer.real();
+
+    const SlidingRobustStats stats(box, nThreads);
+    casa::Array<casa::Float> median(shape), madfm(shape);
+    double maxDiff = 0.;
+    timer.mark();
+    for (size_t i = 0; i < nChunks; i++) {
+        stats.calculate(chunks[i], median, madfm);
+        maxDiff = std::max(maxDiff, double(max(abs(median - casaMedian[i]))));
+        maxDiff = std::max(maxDiff, double(max(abs(madfm - casaMadfm[i]))));
+    }
+    const double engineTime = timer.real();
+
+    ASKAPLOG_INFO_STR(logger, mode << ": " << nChunks << " chunk(s) of shape " << shape <<
+                      ", box half-widths " << box);
+    ASKAPLOG_INFO_STR(logger, "   slidingArrayMath:   " << casaTime << " s");
+    ASKAPLOG_INFO_STR(logger, "   SlidingRobustStats: " << engineTime << " s with " <<
+                      nThreads << " thread(s), speed-up " << casaTime / engineTime);
+    ASKAPLOG_INFO_STR(logger, "   largest difference: " << maxDiff);
+}
+
+int main(int argc, const char *argv[])
+{
+    std::ifstream config("askap.log_cfg", std::ifstream::in);
+
+    if (config) {
+        ASKAPLOG_INIT("askap.log_cfg");
+    } else {
+        std::ostringstream ss;
+        ss << argv[0] << ".log_cfg";
+        ASKAPLOG_INIT(ss.str().c_str());
+    }
+
+    try {
+        const int imageSize = argc > 1 ? atoi(argv[1]) : 512;
+        const int boxSize = argc > 2 ? atoi(argv[2]) : 50;
+        const int numChannels = argc > 3 ? atoi(argv[3]) : 2048;
+        const unsigned int numThreads = argc > 4 ? atoi(argv[4]) : 1;
+        ASKAPCHECK(imageSize > 0 && boxSize >= 0 && numChannels > 0,
+                   "Usage: " << argv[0] << " [imageSize [boxSize [numChannels [numThreads]]]]");
+
+        // spatial search: one channel map at a time, 2D box
+        compare("Spatial", casa::IPosition(4, imageSize, imageSize, 1, 1),
+                casa::IPosition(2, boxSize, boxSize), 1, numThreads);
+
+        // spectral search: one spectrum at a time, 1D box along the spectral axis
+        compare("Spectral", casa::IPosition(4, 1, 1, numChannels, 1),
+                casa::IPosition(4, 0, 0, boxSize, 0), 100, numThreads);
+
+    } catch (const askap::AskapError& x) {
+        ASKAPLOG_FATAL_STR(logger, "Askap error in " << argv[0] << ": " << x.what());
+        std::cerr << "Askap error in " << argv[0] << ": " << x.what() << std::endl;
+        exit(1);
+    } catch (const std::exception& x) {
+        ASKAPLOG_FATAL_STR(logger, "Unexpected exception in " << argv[0] << ": " << x.what());
+        std::cerr << "Unexpected exception in " << argv[0] << ": " << x.what() << std::endl;
+        exit(1);
+    }
+
+    return 0;
+}
@@ -60,6 +60,9 @@ using namespace LOFAR::TYPES;
 
 // boost includes
 #include <boost/shared_ptr.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/bind.hpp>
 
 #include <askap_analysis.h>
 
@@ -161,7 +164,7 @@ bool DuchampParallel::is2D()
 
 
 DuchampParallel::DuchampParallel(askap::askapparallel::AskapParallel& comms)
-    : itsComms(comms)
+    : itsComms(comms), itsNumFitThreads(1)
 {
     itsFitParams = sourcefitting::FittingParameters(LOFAR::ParameterSet());
 }
@@ -226,6 +229,11 @@ DuchampParallel::DuchampParallel(askap::askapparallel::AskapParallel& comms,
     LOFAR::ParameterSet fitParset = itsParset.makeSubset("Fitter.");
     itsFitParams = sourcefitting::FittingParameters(fitParset);
     itsFlagDistribFit = itsParset.getBool("distribFit", true);
+    itsNumFitThreads = itsParset.getUint("numFitThreads", 1);
+    if (itsNumFitThreads == 0) {
+        ASKAPLOG_WARN_STR(logger, "numFitThreads=0 is not valid. Using a single thread for fitting.");
+        itsNumFitThreads = 1;
+    }
 
     itsFlagFindSpectralTerms = itsParset.getBoolVector("findSpectralTerms",
                                std::vector<bool>(2, itsFitParams.doFit()));
@@ -899,6 +907,8 @@ void DuchampParallel::fitSources()
             ASKAPLOG_INFO_STR(logger, "Fitting source profiles.");
         }
 
+        // indices of the sources in itsSourceList to be fitted
+        std::vector<size_t> toFit;
         for (size_t i = 0; i < itsCube.getNumObj(); i++) {
             if (itsFitParams.doFit()) {
                 ASKAPLOG_INFO_STR(logger, "Setting up source #" << i + 1 <<
@@ -928,11 +938,122 @@ void DuchampParallel::fitSources()
             }
 
             if (!src.isAtEdge() && itsFitParams.doFit()) {
-                this->fitSource(src);
+                toFit.push_back(itsSourceList.size());
             }
 
             itsSourceList.push_back(src);
         }
+
+        this->fitSourceList(itsSourceList, toFit);
+    }
+}
+
+//**************************************************************//
+
+namespace {
+
+/// @brief Fits sources taken from a queue shared by several threads
+/// @details Each thread takes the next source from the queue until
+/// it is empty. If a fit throws an exception, the message is kept and
+/// the remaining sources are skipped.
+class FitQueue {
+    public:
+        FitQueue(std::vector<sourcefitting::RadioSource> &srclist,
+                 const std::vector<size_t> &order,
+                 duchamp::Cube &cube)
+            : itsSourceList(srclist), itsOrder(order), itsCube(cube), itsNext(0)
+        {
+        }
+
+        /// @brief Entry point of the threads
+        void run()
+        {
+            size_t index;
+            while (next(index)) {
+                try {
+                    itsSourceList[index].fitGauss(itsCube);
+                } catch (const std::exception &err) {
+                    boost::mutex::scoped_lock lock(itsMutex);
+                    if (itsError.empty()) {
+                        itsError = err.what();
+                    }
+                    itsNext = itsOrder.size();
+                }
+            }
+        }
+
+        /// @brief The message of the first exception thrown by a fit, if any
+        const std::string &error() const {return itsError;};
+
+    private:
+        /// @brief Take the index of the next source to fit
+        /// @return false if the queue is empty
+        bool next(size_t &index)
+        {
+            boost::mutex::scoped_lock lock(itsMutex);
+            if (itsNext >= itsOrder.size()) {
+                return false;
+            }
+            index = itsOrder[itsNext++];
+            return true;
+        }
+
+        std::vector<sourcefitting::RadioSource> &itsSourceList;
+        const std::vector<size_t> &itsOrder;
+        duchamp::Cube &itsCube;
+        size_t itsNext;
+        std::string itsError;
+        boost::mutex itsMutex;
+};
+
+/// @brief Orders source indices by decreasing fitting cost
+class CostOrder {
+    public:
+        CostOrder(const std::vector<double> &cost) : itsCost(cost) {}
+        bool operator()(size_t a, size_t b) const {return itsCost[a] > itsCost[b];};
+    private:
+        const std::vector<double> &itsCost;
+};
+
+}
+
+void DuchampParallel::fitSourceList(std::vector<sourcefitting::RadioSource> &srclist,
+                                    const std::vector<size_t> &toFit)
+{
+    const size_t numThreads = std::min(size_t(itsNumFitThreads), toFit.size());
+
+    if (numThreads > 1) {
+        // Most expensive fits first, so they don't finish last
+        std::vector<double> cost(srclist.size(), 0.);
+        for (size_t i = 0; i < toFit.size(); i++) {
+            cost[toFit[i]] = srclist[toFit[i]].fitCost();
+        }
+        std::vector<size_t> order(toFit);
+        std::stable_sort(order.begin(), order.end(), CostOrder(cost));
+
+        ASKAPLOG_INFO_STR(logger, "Fitting " << order.size() << " sources with " <<
+                          numThreads << " threads");
+        FitQueue queue(srclist, order, itsCube);
+        boost::thread_group threads;
+        for (size_t t = 0; t < numThreads; t++) {
+            threads.create_thread(boost::bind(&FitQueue::run, &queue));
+        }
+        threads.join_all();
+        if (!queue.error().empty()) {
+            ASKAPTHROW(AskapError, "Source fitting failed: " << queue.error());
+        }
+    } else {
+        for (size_t i = 0; i < toFit.size(); i++) {
+            srclist[toFit[i]].fitGauss(itsCube);
+        }
+    }
+
+    // The spectral terms are read from images, which is not thread-safe
+    for (size_t i = 0; i < toFit.size(); i++) {
+        for (int t = 1; t <= 2; t++) {
+            srclist[toFit[i]].findSpectralTerm(itsSpectralTermImages[t - 1], t,
+                                               itsFlagFindSpectralTerms[t - 1]);
+        }
     }
 }
 
@@ -241,6 +241,9 @@ class DuchampParallel {
         /// the master to do after they have been combined with objects
         /// from other subimages.
         ///
+        /// The fits are done by fitSourceList, which can use several
+        /// threads (set by the numFitThreads parameter).
+        ///
         /// @todo Make the boundary determination smart enough to know
         /// which side is adjacent to another subimage.
         void fitSources();
@@ -248,6 +251,19 @@ class DuchampParallel {
         /// @brief Fit a single source
         void fitSource(sourcefitting::RadioSource &src);
 
+        /// @brief Fit a set of sources, possibly concurrently
+        /// @details The sources given by the indices are fitted to
+        /// the cube with itsNumFitThreads threads. The threads take
+        /// the sources from a shared queue, ordered by decreasing
+        /// fitting cost (RadioSource::fitCost), so that a few slow
+        /// fits started late don't leave the other threads idle. The
+        /// spectral terms are found afterwards in a single thread, as
+        /// the image access is not thread-safe.
+        /// @param srclist The list of sources
+        /// @param toFit Indices (into srclist) of the sources to fit
+        void fitSourceList(std::vector<sourcefitting::RadioSource> &srclist,
+                           const std::vector<size_t> &toFit);
+
         /// @brief Run any preprocessing on the workers
         /// @details Runs any requested pre-processing. This includes
         /// inverting the cube, smoothing or multi-resolution wavelet
@@ -412,6 +428,9 @@ class DuchampParallel {
         /// Shall the fitting be delegated to the workers?
         bool itsFlagDistribFit;
 
+        /// The number of threads used by each process for fitting
+        unsigned int itsNumFitThreads;
+
         /// Shall we find spectral index/curvature information?
         std::vector<bool> itsFlagFindSpectralTerms;
         /// Where shall we find spectral index/curvature information?
@@ -43,6 +43,10 @@
 #include <Blob/BlobOBufString.h>
 #include <Blob/BlobIStream.h>
 #include <Blob/BlobOStream.h>
+
+#include <vector>
+#include <utility>
+#include <algorithm>
 using namespace LOFAR::TYPES;
 
 ///@brief Where the log messages go.
@@ -96,8 +100,9 @@ void ObjectParameteriser::distribute()
     if (itsComms->isParallel()) {
 
         if (itsComms->isMaster()) {
-            // send objects in itsInputList to workers in round-robin fashion
-            // broadcast 'finished' signal
+            // Hand out the objects in itsInputList to the workers as
+            // they become free, most expensive first, then tell each
+            // worker that we're finished.
 
             // First send total number of sources to all workers
             LOFAR::BlobString bs;
@@ -106,7 +111,7 @@ void ObjectParameteriser::distribute()
             bs.resize(0);
             bob = LOFAR::BlobOBufString(bs);
             out = LOFAR::BlobOStream(bob);
-            ASKAPLOG_DEBUG_STR(logger, "Broadcasting 'finished' signal to all workers");
+            ASKAPLOG_DEBUG_STR(logger, "Broadcasting number of sources to all workers");
             out.putStart("OP", 1);
             out << itsTotalListSize;
             out.putEnd();
@@ -115,39 +120,37 @@ void ObjectParameteriser::distribute()
             }
 
             if (itsTotalListSize > 0) {
-                for (size_t i = 0; i < itsInputList.size(); i++) {
-                    unsigned int rank = i % (itsComms->nProcs() - 1);
-                    ASKAPLOG_DEBUG_STR(logger, "Sending source #" << i + 1 <<
-                                       ", ID=" << itsInputList[i].getID() <<
-                                       " to worker " << rank + 1 <<
-                                       " for parameterisation");
+                const std::vector<size_t> order = costOrder();
+                size_t next = 0;
+                int numFinished = 0;
+                while (numFinished < itsComms->nProcs() - 1) {
+                    // wait for any worker to ask for an object
+                    const int rank = itsComms->waitForNotification().first;
                     bs.resize(0);
                     LOFAR::BlobOBufString bob(bs);
                     LOFAR::BlobOStream out(bob);
                     out.putStart("OP", 1);
-                    out << true << itsInputList[i];
+                    if (next < order.size()) {
+                        const size_t i = order[next++];
+                        ASKAPLOG_DEBUG_STR(logger, "Sending source #" << i + 1 <<
+                                           ", ID=" << itsInputList[i].getID() <<
+                                           " to worker " << rank <<
+                                           " for parameterisation");
+                        out << true << itsInputList[i];
+                    } else {
+                        // no more objects, so notify this worker that we're finished.
+                        ASKAPLOG_DEBUG_STR(logger, "Sending 'finished' signal to worker " << rank);
+                        out << false;
+                        numFinished++;
+                    }
                     out.putEnd();
-                    itsComms->sendBlob(bs, rank + 1);
-                }
-
-                // now notify all workers that we're finished.
-                LOFAR::BlobOBufString bob(bs);
-                LOFAR::BlobOStream out(bob);
-                bs.resize(0);
-                bob = LOFAR::BlobOBufString(bs);
-                out = LOFAR::BlobOStream(bob);
-                ASKAPLOG_DEBUG_STR(logger, "Broadcasting 'finished' signal to all workers");
-                out.putStart("OP", 1);
-                out << false;
-                out.putEnd();
-                //itsComms->broadcastBlob(bs,0);
-                for (int i = 1; i < itsComms->nProcs(); ++i) {
-                    itsComms->sendBlob(bs, i);
+                    itsComms->sendBlob(bs, rank);
                 }
             }
 
         } else {
-            // receive objects and put in itsInputList until receive 'finished' signal
+            // receive the number of objects. The objects themselves
+            // are requested one at a time in parameterise()
             LOFAR::BlobString bs;
 
             itsComms->receiveBlob(bs, 0);
@@ -157,12 +160,43 @@ void ObjectParameteriser::distribute()
             ASKAPASSERT(version == 1);
             in >> itsTotalListSize;
             in.getEnd();
+            itsInputList.clear();
+        }
+    }
+}
+
+std::vector<size_t> ObjectParameteriser::costOrder()
+{
+    std::vector<std::pair<double, size_t> > cost(itsInputList.size());
+    for (size_t i = 0; i < itsInputList.size(); i++) {
+        // negative, so the most expensive object comes first
+        cost[i] = std::pair<double, size_t>(-itsInputList[i].fitCost(), i);
+    }
+    std::sort(cost.begin(), cost.end());
+
+    std::vector<size_t> order(cost.size());
+    for (size_t i = 0; i < cost.size(); i++) {
+        order[i] = cost[i].second;
+    }
+    return order;
+}
+
+void ObjectParameteriser::parameterise()
+{
+    if (itsComms->isWorker()) {
+        // For each object, get the bounding subsection for that object
+        // Define a DuchampParallel and use it to do the parameterisation
+        // put parameterised objects into itsOutputList
+
+        if (itsComms->isParallel()) {
 
             if (itsTotalListSize > 0) {
-                // now read individual sources
+                // ask the master for objects until we receive the
+                // 'finished' signal
+                LOFAR::BlobString bs;
                 bool isOK = true;
-                itsInputList.clear();
                 while (isOK) {
+                    itsComms->notifyMaster();
                     sourcefitting::RadioSource src;
                     itsComms->receiveBlob(bs, 0);
                     LOFAR::BlobIBufString bib(bs);
@@ -179,109 +213,110 @@ void ObjectParameteriser::distribute()
                                            itsInputList.back().getID());
                     }
                     in.getEnd();
+
+                    if (isOK) {
+                        ASKAPLOG_DEBUG_STR(logger, "Parameterising object #" <<
+                                           itsInputList.size() << " on worker " <<
+                                           itsComms->rank());
+                        itsOutputList.push_back(parameteriseObject(itsInputList.back()));
+                    }
                 }
                 ASKAPLOG_DEBUG_STR(logger, "Worker " << itsComms->rank() <<
-                                   " received " << itsInputList.size() <<
-                                   " objects to parameterise.");
+                                   " parameterised " << itsInputList.size() <<
+                                   " objects.");
             }
 
-        }
-    }
-}
-
-void ObjectParameteriser::parameterise()
-{
-    if (itsComms->isWorker()) {
-        // For each object, get the bounding subsection for that object
-        // Define a DuchampParallel and use it to do the parameterisation
-        // put parameterised objects into itsOutputList
-
-        if (itsInputList.size() > 0) {
-
-            std::string image = itsReferenceParams.getImageFile();
-            std::vector<size_t> dim = analysisutilities::getCASAdimensions(image);
-            itsReferenceParset.replace("flagsubsection", "true");
+        } else {
 
             for (size_t i = 0; i < itsInputList.size(); i++) {
 
                 ASKAPLOG_DEBUG_STR(logger, "Parameterising object #" << i + 1 <<
                                    " out of " << itsInputList.size());
 
-                // get bounding subsection & transform into a Subsection string
-                itsInputList[i].setHeader(itsHeader);
+                itsOutputList.push_back(parameteriseObject(itsInputList[i]));
+            }
 
-                // add the offsets, so that we are in global-pixel-coordinates
-                itsInputList[i].addOffsets();
-                std::string subsection = itsInputList[i].boundingSubsection(dim, true);
+        }
 
-                itsReferenceParset.replace("subsection", subsection);
-                // turn off the subimaging, so we read the whole lot.
-                itsReferenceParset.replace("nsubx", "1");
-                itsReferenceParset.replace("nsuby", "1");
-                itsReferenceParset.replace("nsubz", "1");
+        ASKAPASSERT(itsOutputList.size() == itsInputList.size());
 
-                // define a duchamp Cube using the filename from the
-                // itsReferenceParams
+    }
 
-                // set the subsection
-                DuchampParallel tempDP(*itsComms, itsReferenceParset);
-                // set this to false to stop anything trying to access
-                // the recon array
-                tempDP.cube().setReconFlag(false);
+}
 
-                // open the image
-                tempDP.readData();
+sourcefitting::RadioSource
+ObjectParameteriser::parameteriseObject(sourcefitting::RadioSource &object)
+{
+    std::string image = itsReferenceParams.getImageFile();
+    std::vector<size_t> dim = analysisutilities::getCASAdimensions(image);
+    itsReferenceParset.replace("flagsubsection", "true");
 
-                // set the offsets to those from the local subsection
-                itsInputList[i].setOffsets(tempDP.cube().pars());
-                // remove those offsets, so we are in
-                // local-pixel-coordinates (as if we just did the
-                // searching)
-                itsInputList[i].removeOffsets();
-                itsInputList[i].setFlagText("");
+    // get bounding subsection & transform into a Subsection string
+    object.setHeader(itsHeader);
 
-                // store the current object to the cube
-                tempDP.cube().addObject(itsInputList[i]);
+    // add the offsets, so that we are in global-pixel-coordinates
+    object.addOffsets();
+    std::string subsection = object.boundingSubsection(dim, true);
 
-                // parameterise
-                tempDP.cube().calcObjectWCSparams();
+    itsReferenceParset.replace("subsection", subsection);
+    // turn off the subimaging, so we read the whole lot.
+    itsReferenceParset.replace("nsubx", "1");
+    itsReferenceParset.replace("nsuby", "1");
+    itsReferenceParset.replace("nsubz", "1");
 
-                sourcefitting::RadioSource src(tempDP.cube().getObject(0));
+    // define a duchamp Cube using the filename from the
+    // itsReferenceParams
 
-                if (tempDP.fitParams().doFit()) {
+    // set the subsection
+    DuchampParallel tempDP(*itsComms, itsReferenceParset);
+    // set this to false to stop anything trying to access
+    // the recon array
+    tempDP.cube().setReconFlag(false);
 
-                    src.setFitParams(tempDP.fitParams());
-                    src.defineBox(tempDP.cube().pars().section(),
-                                  tempDP.cube().header().getWCS()->spec);
-                    src.setDetectionThreshold(tempDP.cube(),
-                                              tempDP.getFlagVariableThreshold(),
-                                              tempDP.varThresher()->snrImage());
+    // open the image
+    tempDP.readData();
 
-                    src.prepareForFit(tempDP.cube(), true);
-                    src.setAtEdge(false);
+    // set the offsets to those from the local subsection
+    object.setOffsets(tempDP.cube().pars());
+    // remove those offsets, so we are in
+    // local-pixel-coordinates (as if we just did the
+    // searching)
+    object.removeOffsets();
+    object.setFlagText("");
 
-                    tempDP.fitSource(src);
+    // store the current object to the cube
+    tempDP.cube().addObject(object);
 
-                }
+    // parameterise
+    tempDP.cube().calcObjectWCSparams();
 
-                // put back onto the global grid
-                src.addOffsets();
+    sourcefitting::RadioSource src(tempDP.cube().getObject(0));
 
-                // set the offsets to those from the base subsection
-                src.setOffsets(itsReferenceParams);
-                // and remove them, so that we're in subsection coordinates
-                src.removeOffsets();
+    if (tempDP.fitParams().doFit()) {
 
-                // get the parameterised object and store to itsOutputList
-                itsOutputList.push_back(src);
-            }
+        src.setFitParams(tempDP.fitParams());
+        src.defineBox(tempDP.cube().pars().section(),
+                      tempDP.cube().header().getWCS()->spec);
+        src.setDetectionThreshold(tempDP.cube(),
+                                  tempDP.getFlagVariableThreshold(),
+                                  tempDP.varThresher()->snrImage());
 
-            ASKAPASSERT(itsOutputList.size() == itsInputList.size());
+        src.prepareForFit(tempDP.cube(), true);
+        src.setAtEdge(false);
 
-        }
+        tempDP.fitSource(src);
 
     }
 
+    // put back onto the global grid
+    src.addOffsets();
+
+    // set the offsets to those from the base subsection
+    src.setOffsets(itsReferenceParams);
+    // and remove them, so that we're in subsection coordinates
+    src.removeOffsets();
+
+    return src;
 }
 
 void ObjectParameteriser::gather()
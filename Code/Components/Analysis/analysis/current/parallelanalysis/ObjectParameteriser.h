@@ -45,12 +45,22 @@ class ObjectParameteriser {
         /// @brief Initialise members - parameters, header and input object list.
         void initialise(DuchampParallel *dp);
 
-        /// @brief Master sends list to workers, who fill out
-        /// itsInputList
+        /// @brief Master sends objects to the workers as they ask
+        /// for them
+        /// @details The master first sends the total number of
+        /// objects to all workers. It then hands out the objects one
+        /// at a time, in order of decreasing fitting cost, to
+        /// whichever worker asks for one, until all are gone, and
+        /// then tells each worker that it has finished. This way,
+        /// a worker that gets a few slow fits doesn't hold up the
+        /// rest. Workers only receive the number of objects here.
         void distribute();
 
         /// @brief Each object on a worker is parameterised, and
         /// fitted (if requested).
+        /// @details In the parallel case, the workers request the
+        /// objects from the master (see distribute()) and fill out
+        /// itsInputList as they go.
         void parameterise();
 
         /// @brief The workers' objects are returned to the master
@@ -61,6 +71,14 @@ class ObjectParameteriser {
 
     protected:
 
+        /// @brief Indices of itsInputList in order of decreasing
+        /// fitting cost
+        std::vector<size_t> costOrder();
+
+        /// @brief Parameterise (and fit, if requested) a single
+        /// object, reading the part of the image around it
+        sourcefitting::RadioSource parameteriseObject(sourcefitting::RadioSource &object);
+
         /// The communication class
         askap::askapparallel::AskapParallel *itsComms;
 
@@ -36,6 +36,7 @@
 #include <patternmatching/Point.h>
 #include <patternmatching/PointCatalogue.h>
 #include <patternmatching/MatchingUtilities.h>
+#include <patternmatching/PointIndex.h>
 #include <casainterface/CasaInterface.h>
 
 #include <Common/ParameterSet.h>
@@ -50,6 +51,9 @@
 #include <casa/Quanta.h>
 
 #include <vector>
+#include <map>
+#include <set>
+#include <string>
 
 ASKAP_LOGGER(logger, ".cataloguematching");
 
@@ -208,11 +212,18 @@ void CatalogueMatcher::zeroOffsetMatch()
 
     std::sort(itsSrcCatalogue.pointList().begin(), itsSrcCatalogue.pointList().end());
     std::sort(itsRefCatalogue.pointList().begin(), itsRefCatalogue.pointList().end());
+    PointIndex refIndex(itsRefCatalogue.pointList());
 
     for (size_t s = 0; s < itsSrcCatalogue.pointList().size(); s++) {
 
-        for (size_t r = 0; r < itsRefCatalogue.pointList().size() && !srcMatched[s]; r++) {
+        // Only reference points within itsEpsilon in x and y can match
+        std::vector<size_t> near = refIndex.inSquare(itsSrcCatalogue.pointList()[s].x(),
+                                   itsSrcCatalogue.pointList()[s].y(),
+                                   itsEpsilon);
 
+        for (size_t n = 0; n < near.size() && !srcMatched[s]; n++) {
+
+            size_t r = near[n];
             if (!refMatched[r]) {
                 if (itsSrcCatalogue.pointList()[s].sep(itsRefCatalogue.pointList()[r]) <
                         itsEpsilon) {
@@ -285,24 +296,31 @@ void CatalogueMatcher::addNewMatches()
         std::vector<Point>::iterator src, ref;
         std::vector<std::pair<Point, Point> >::iterator match;
 
+        std::set<std::string> matchedIDs;
+        for (match = itsMatchingPixList.begin(); match < itsMatchingPixList.end(); match++) {
+            matchedIDs.insert(match->first.ID());
+        }
+
+        // The search square is slightly larger than the match radius,
+        // so that rounding of the offsets can't lose any candidates
+        PointIndex refIndex(itsRefCatalogue.fullPointList());
+        const double searchRadius = 1.001 * matchRadius * itsEpsilon;
+
         for (src = itsSrcCatalogue.fullPointList().begin();
                 src < itsSrcCatalogue.fullPointList().end();
                 src++) {
 
-            bool isMatch = false;
-            match = itsMatchingPixList.begin();
-
-            for (; match < itsMatchingPixList.end() && !isMatch; match++) {
-                isMatch = (src->ID() == match->first.ID());
-            }
+            bool isMatch = (matchedIDs.count(src->ID()) > 0);
 
             if (!isMatch) {
                 float minOffset = 0.;
                 int minRef = -1;
 
-                for (ref = itsRefCatalogue.fullPointList().begin();
-                        ref < itsRefCatalogue.fullPointList().end();
-                        ref++) {
+                std::vector<size_t> near = refIndex.inSquare(src->x() - itsMeanDx,
+                                           src->y() - itsMeanDy,
+                                           searchRadius);
+                for (size_t n = 0; n < near.size(); n++) {
+                    ref = itsRefCatalogue.fullPointList().begin() + near[n];
 
                     float offset = hypot(src->x() - ref->x() - itsMeanDx,
                                          src->y() - ref->y() - itsMeanDy);
@@ -319,6 +337,7 @@ void CatalogueMatcher::addNewMatches()
                     ref = itsRefCatalogue.fullPointList().begin() + minRef;
                     std::pair<Point, Point> newMatch(*src, *ref);
                     itsMatchingPixList.push_back(newMatch);
+                    matchedIDs.insert(src->ID());
                 }
             }
         }
@@ -336,33 +355,34 @@ void CatalogueMatcher::rejectMultipleMatches()
 
     if (itsMatchingPixList.size() < 2) return;
 
-    std::vector<std::pair<Point, Point> >::iterator alice, bob;
-    alice = itsMatchingPixList.begin();
-
-    while (alice < itsMatchingPixList.end() - 1) {
-        bool aliceGone = false;
-        bob = alice + 1;
-
-        while (bob < itsMatchingPixList.end() && !aliceGone) {
-            bool bobGone = false;
-            if (alice->second.ID() == bob->second.ID()) {
-                // alice & bob have the same reference source
-                double df_alice = alice->first.flux() - alice->second.flux();
-                double df_bob   = bob->first.flux() - bob->second.flux();
-
-                if (fabs(df_alice) < fabs(df_bob)) {
-                    itsMatchingPixList.erase(bob);
-                    bobGone = true;
-                } else {
-                    itsMatchingPixList.erase(alice);
-                    aliceGone = true;
-                }
+    // For each reference source, keep only the match with the
+    // smallest flux difference (the later one, if two are equal),
+    // leaving the order of the list unchanged.
+    std::map<std::string, size_t> best;
+    std::map<std::string, size_t>::iterator bestMatch;
+    for (size_t i = 0; i < itsMatchingPixList.size(); i++) {
+        std::string refID = itsMatchingPixList[i].second.ID();
+        bestMatch = best.find(refID);
+        if (bestMatch == best.end()) {
+            best[refID] = i;
+        } else {
+            std::pair<Point, Point> &prev = itsMatchingPixList[bestMatch->second];
+            double df_prev = prev.first.flux() - prev.second.flux();
+            double df_this = itsMatchingPixList[i].first.flux() -
+                             itsMatchingPixList[i].second.flux();
+            if (!(fabs(df_prev) < fabs(df_this))) {
+                bestMatch->second = i;
             }
-            if (!bobGone) bob++;
         }
+    }
 
-        if (!aliceGone) alice++;
+    std::vector<std::pair<Point, Point> > keptList;
+    for (size_t i = 0; i < itsMatchingPixList.size(); i++) {
+        if (best[itsMatchingPixList[i].second.ID()] == i) {
+            keptList.push_back(itsMatchingPixList[i]);
+        }
     }
+    itsMatchingPixList = keptList;
 }
 
 //**************************************************************//
@@ -420,6 +440,14 @@ void CatalogueMatcher::outputMisses()
         std::vector<Point>::iterator pt;
         std::vector<std::pair<Point, Point> >::iterator match;
 
+        std::set<std::string> srcMatched, refMatched;
+        for (match = itsMatchingPixList.begin();
+                match < itsMatchingPixList.end();
+                match++) {
+            srcMatched.insert(match->first.ID());
+            refMatched.insert(match->second.ID());
+        }
+
         size_t width = 0;
         for (pt = itsRefCatalogue.fullPointList().begin();
                 pt < itsRefCatalogue.fullPointList().end();
@@ -431,13 +459,7 @@ void CatalogueMatcher::outputMisses()
                 pt < itsRefCatalogue.fullPointList().end();
                 pt++) {
 
-            bool isMatch = false;
-
-            for (match = itsMatchingPixList.begin();
-                    match < itsMatchingPixList.end() && !isMatch;
-                    match++) {
-                isMatch = (pt->ID() == match->second.ID());
-            }
+            bool isMatch = (refMatched.count(pt->ID()) > 0);
 
             if (!isMatch) {
                 fout << "R "
@@ -459,13 +481,7 @@ void CatalogueMatcher::outputMisses()
                 pt < itsSrcCatalogue.fullPointList().end();
                 pt++) {
 
-            bool isMatch = false;
-
-            for (match = itsMatchingPixList.begin();
-                    match < itsMatchingPixList.end() && !isMatch;
-                    match++) {
-                isMatch = (pt->ID() == match->first.ID());
-            }
+            bool isMatch = (srcMatched.count(pt->ID()) > 0);
 
             if (!isMatch) {
                 fout << "S "
@@ -501,14 +517,17 @@ void CatalogueMatcher::outputSummary(PointCatalogue &cat, std::string filename)
     size_t width = 0;
     std::string matchID;
     std::vector<Point>::iterator pt;
-    std::vector<std::pair<Point, Point> >::iterator mpair;
     std::vector<std::pair<Point, Point> >::iterator match;
 
+    // The first match of each reference ID
+    std::map<std::string, std::string> matchedTo;
     for (match = itsMatchingPixList.begin();
             match < itsMatchingPixList.end();
             match++) {
         width = std::max(width, match->first.ID().size());
         width = std::max(width, match->second.ID().size());
+        matchedTo.insert(std::pair<std::string, std::string>(match->second.ID(),
+                         match->first.ID()));
     }
 
     std::ofstream fout(filename.c_str());
@@ -517,12 +536,9 @@ void CatalogueMatcher::outputSummary(PointCatalogue &cat, std::string filename)
                 pt < cat.fullPointList().end();
                 pt++) {
 
-            bool isMatch = false;
-            for (mpair = itsMatchingPixList.begin();
-                    mpair < itsMatchingPixList.end() && !isMatch;
-                    mpair++) {
-                isMatch = (pt->ID() == mpair->second.ID());
-                matchID = isMatch ? mpair->first.ID() : "---";
+            if (itsMatchingPixList.size() > 0) {
+                std::map<std::string, std::string>::iterator id = matchedTo.find(pt->ID());
+                matchID = (id != matchedTo.end()) ? id->second : "---";
             }
             fout << std::setw(width) << pt->ID() << " "
                  << std::setw(width) << matchID << " "
@@ -35,6 +35,7 @@
 #include <patternmatching/Triangle.h>
 #include <patternmatching/Point.h>
 #include <patternmatching/MatchingUtilities.h>
+#include <patternmatching/PointIndex.h>
 
 #include <Common/ParameterSet.h>
 
@@ -44,6 +45,8 @@
 #include <iomanip>
 #include <fstream>
 #include <vector>
+#include <map>
+#include <set>
 #include <utility>
 #include <string>
 #include <math.h>
@@ -345,19 +348,28 @@ void Matcher::addNewMatches()
         std::vector<Point>::iterator src, ref;
         std::vector<std::pair<Point, Point> >::iterator match;
 
-        for (src = itsSrcPixList.begin(); src < itsSrcPixList.end(); src++) {
-            bool isMatch = false;
-            match = itsMatchingPixList.begin();
+        std::set<std::string> matchedIDs;
+        for (match = itsMatchingPixList.begin(); match < itsMatchingPixList.end(); match++) {
+            matchedIDs.insert(match->first.ID());
+        }
 
-            for (; match < itsMatchingPixList.end() && !isMatch; match++) {
-                isMatch = (src->ID() == match->first.ID());
-            }
+        // The search square is slightly larger than the match radius,
+        // so that rounding of the offsets can't lose any candidates
+        PointIndex refIndex(itsRefPixList);
+        const double searchRadius = 1.001 * matchRadius * itsEpsilon;
+
+        for (src = itsSrcPixList.begin(); src < itsSrcPixList.end(); src++) {
+            bool isMatch = (matchedIDs.count(src->ID()) > 0);
 
             if (!isMatch) {
                 float minOffset = 0.;
                 int minRef = -1;
 
-                for (ref = itsRefPixList.begin(); ref < itsRefPixList.end(); ref++) {
+                std::vector<size_t> near = refIndex.inSquare(src->x() - itsMeanDx,
+                                           src->y() - itsMeanDy,
+                                           searchRadius);
+                for (size_t n = 0; n < near.size(); n++) {
+                    ref = itsRefPixList.begin() + near[n];
                     float offset = hypot(src->x() - ref->x() - itsMeanDx,
                                          src->y() - ref->y() - itsMeanDy);
 
@@ -373,6 +385,7 @@ void Matcher::addNewMatches()
                     ref = itsRefPixList.begin() + minRef;
                     std::pair<Point, Point> newMatch(*src, *ref);
                     itsMatchingPixList.push_back(newMatch);
+                    matchedIDs.insert(src->ID());
                 }
             }
         }
@@ -388,44 +401,34 @@ void Matcher::rejectMultipleMatches()
 {
     if (itsMatchingPixList.size() < 2) return;
 
-    std::vector<std::pair<Point, Point> >::iterator alice, bob;
-    alice = itsMatchingPixList.begin();
-
-    while (alice < itsMatchingPixList.end() - 1) {
-        bool bobGone = false;
-        bool aliceGone = false;
-        bob = alice + 1;
-
-        while (bob < itsMatchingPixList.end() && !aliceGone) {
-            if (alice->second.ID() == bob->second.ID()) {
-                // alice & bob have the same reference source
-                float df_alice, df_bob;
-
-                // if (itsFluxMethod == "integrated") {
-                //     df_alice = alice->first.stuff().flux() - alice->second.flux();
-                //     df_bob   = bob->first.stuff().flux() - bob->second.flux();
-                // } else {
-                df_alice = alice->first.flux() - alice->second.flux();
-                df_bob   = bob->first.flux() - bob->second.flux();
-                // }
-
-                if (fabs(df_alice) < fabs(df_bob)) {
-                    // delete bob
-                    itsMatchingPixList.erase(bob);
-                    bobGone = true;
-                } else {
-                    // delete alice
-                    itsMatchingPixList.erase(alice);
-                    aliceGone = true;
-                }
+    // For each reference source, keep only the match with the
+    // smallest flux difference (the later one, if two are equal),
+    // leaving the order of the list unchanged.
+    std::map<std::string, size_t> best;
+    std::map<std::string, size_t>::iterator bestMatch;
+    for (size_t i = 0; i < itsMatchingPixList.size(); i++) {
+        std::string refID = itsMatchingPixList[i].second.ID();
+        bestMatch = best.find(refID);
+        if (bestMatch == best.end()) {
+            best[refID] = i;
+        } else {
+            std::pair<Point, Point> &prev = itsMatchingPixList[bestMatch->second];
+            float df_prev = prev.first.flux() - prev.second.flux();
+            float df_this = itsMatchingPixList[i].first.flux() -
+                            itsMatchingPixList[i].second.flux();
+            if (!(fabs(df_prev) < fabs(df_this))) {
+                bestMatch->second = i;
             }
-
-            if (!bobGone) bob++;
-            else bobGone = false;
         }
+    }
 
-        if (!aliceGone) alice++;
+    std::vector<std::pair<Point, Point> > keptList;
+    for (size_t i = 0; i < itsMatchingPixList.size(); i++) {
+        if (best[itsMatchingPixList[i].second.ID()] == i) {
+            keptList.push_back(itsMatchingPixList[i]);
+        }
     }
+    itsMatchingPixList = keptList;
 }
 
 
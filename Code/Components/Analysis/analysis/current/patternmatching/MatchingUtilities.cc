@@ -35,6 +35,7 @@
 #include <patternmatching/Triangle.h>
 #include <patternmatching/Point.h>
 #include <patternmatching/Matcher.h>
+#include <patternmatching/PointIndex.h>
 
 #include <coordutils/PositionUtilities.h>
 
@@ -46,6 +47,8 @@
 #include <fstream>
 #include <sstream>
 #include <vector>
+#include <map>
+#include <set>
 #include <algorithm>
 #include <string>
 #include <math.h>
@@ -337,11 +340,7 @@ trimList(std::vector<matching::Point> &inputList, const unsigned int maxSize)
     std::reverse(outList.begin(), outList.end());
 
     if (outList.size() > maxSize) {
-        std::vector<matching::Point>::iterator pt = outList.begin() + maxSize;
-
-        while (pt != outList.end()) {
-            outList.erase(pt);
-        }
+        outList.resize(maxSize);
     }
 
     return outList;
@@ -353,12 +352,16 @@ crudeMatchList(std::vector<matching::Point> &reflist,
                std::vector<matching::Point> &srclist,
                float maxOffset)
 {
-    std::vector<matching::Point>::iterator ref, src;
+    std::vector<matching::Point>::iterator src;
     std::vector<matching::Point> newreflist;
+    PointIndex refIndex(reflist);
     for (src = srclist.begin(); src < srclist.end(); src++) {
 
-        for (ref = reflist.begin(); ref < reflist.end(); ref++) {
-            if (src->sep(*ref) < maxOffset) newreflist.push_back(*ref);
+        // only those reference points in the surrounding square need
+        // their separation checked
+        std::vector<size_t> near = refIndex.inSquare(src->x(), src->y(), maxOffset);
+        for (size_t i = 0; i < near.size(); i++) {
+            if (src->sep(reflist[near[i]]) < maxOffset) newreflist.push_back(reflist[near[i]]);
         }
 
     }
@@ -386,6 +389,44 @@ std::vector<Triangle> getTriList(std::vector<Point> &pixlist)
     return triList;
 }
 
+std::vector<Triangle> getLocalTriList(std::vector<Point> &pixlist,
+                                      unsigned int numNeighbours,
+                                      double ratioLimit)
+{
+    std::vector<Triangle> triList;
+    const size_t npix = pixlist.size();
+    PointIndex index(pixlist);
+    std::set<std::vector<size_t> > done;
+
+    for (size_t i = 0; i < npix; i++) {
+        // the first of the nearest points is the point itself
+        std::vector<size_t> near = index.nearest(pixlist[i].x(), pixlist[i].y(),
+                                   numNeighbours + 1);
+        for (size_t j = 0; j < near.size(); j++) {
+            for (size_t k = j + 1; k < near.size(); k++) {
+                if (near[j] == i || near[k] == i) {
+                    continue;
+                }
+                std::vector<size_t> vertices(3);
+                vertices[0] = i;
+                vertices[1] = near[j];
+                vertices[2] = near[k];
+                std::sort(vertices.begin(), vertices.end());
+                if (done.insert(vertices).second) {
+                    Triangle tri(pixlist[vertices[0]], pixlist[vertices[1]],
+                                 pixlist[vertices[2]]);
+                    if (tri.ratio() < ratioLimit) triList.push_back(tri);
+                }
+            }
+        }
+    }
+
+    ASKAPLOG_INFO_STR(logger, "Generated a list of " << triList.size() <<
+                      " triangles from the " << numNeighbours <<
+                      " nearest neighbours of each point");
+    return triList;
+}
+
 //**************************************************************//
 
 std::vector<std::pair<Triangle, Triangle> >
@@ -423,9 +464,23 @@ matchLists(std::vector<Triangle> &list1, std::vector<Triangle> &list2, double ep
         double maxRatioB = list1[i].ratio() + sqrt(maxTol1 + maxTol2);
         double minRatioB = list1[i].ratio() - sqrt(maxTol1 + maxTol2);
 
-        std::vector<Triangle> matches;
-        for (size_t j = 0; j < size2 && list2[j].ratio() < maxRatioB; j++) {
-            if (list2[j].ratio() > minRatioB && list1[i].isMatch(list2[j], epsilon)) {
+        // list2 is sorted by ratio, so find the first triangle above
+        // the acceptable range by bisection, rather than by
+        // stepping through from the start of the list
+        size_t lo = 0, hi = size2;
+        while (lo < hi) {
+            size_t mid = lo + (hi - lo) / 2;
+            if (list2[mid].ratio() > minRatioB) hi = mid;
+            else lo = mid + 1;
+        }
+
+        for (size_t j = lo; j < size2 && list2[j].ratio() < maxRatioB; j++) {
+            // Same test as Triangle::isMatch, using the tolerances
+            // already defined above
+            double ratioSep = list1[i].ratio() - list2[j].ratio();
+            double angleSep = list1[i].angle() - list2[j].angle();
+            if ((ratioSep * ratioSep < list1[i].ratioTol() + list2[j].ratioTol()) &&
+                    (angleSep * angleSep < list1[i].angleTol() + list2[j].angleTol())) {
                 nmatch++;
                 std::pair<Triangle, Triangle> match(list1[i], list2[j]);
                 matchList.push_back(match);
@@ -520,26 +575,21 @@ std::vector<std::pair<Point, Point> > vote(std::vector<std::pair<Triangle, Trian
     std::vector<int> votes;
     std::multimap<int, std::pair<Point, Point> >::iterator vote;
     std::multimap<int, std::pair<Point, Point> >::reverse_iterator rvote;
+    // location in pts of each pair of IDs voted for so far
+    std::map<std::pair<std::string, std::string>, size_t> ptLocation;
+    std::map<std::pair<std::string, std::string>, size_t>::iterator loc;
 
     for (unsigned int i = 0; i < trilist.size(); i++) {
         std::vector<Point> ptlist1 = trilist[i].first.getPtList();
         std::vector<Point> ptlist2 = trilist[i].second.getPtList();
 
         for (int p = 0; p < 3; p++) { // for each of the three points:
-            bool foundMatch = false;
-            if (votes.size() > 0) {
-
-                for (size_t i = 0; i < votes.size() && !foundMatch; i++) {
-                    if ((pts[i].first.ID() == ptlist1[p].ID()) &&
-                            (pts[i].second.ID() == ptlist2[p].ID())) {
-                        votes[i]++;
-                        foundMatch = true;
-                    }
-                }
-
-            }
-
-            if (!foundMatch) {
+            std::pair<std::string, std::string> ids(ptlist1[p].ID(), ptlist2[p].ID());
+            loc = ptLocation.find(ids);
+            if (loc != ptLocation.end()) {
+                votes[loc->second]++;
+            } else {
+                ptLocation[ids] = votes.size();
                 votes.push_back(1);
                 pts.push_back(std::pair<Point, Point>(ptlist1[p], ptlist2[p]));
             }
@@ -560,12 +610,11 @@ std::vector<std::pair<Point, Point> > vote(std::vector<std::pair<Triangle, Trian
 
     bool stop = false;
     int prevVote = voteList.rbegin()->first;
+    std::set<std::string> accepted;
 
     for (rvote = voteList.rbegin(); rvote != voteList.rend() && !stop; rvote++) {
 
-        for (unsigned int i = 0; i < outlist.size() && !stop; i++) {
-            stop = ((rvote->second.first.ID() == outlist[i].first.ID()));
-        }
+        stop = (accepted.count(rvote->second.first.ID()) > 0);
 
         if (rvote != voteList.rbegin()) {
             stop = stop || (rvote->first < 0.5 * prevVote);
@@ -573,6 +622,7 @@ std::vector<std::pair<Point, Point> > vote(std::vector<std::pair<Triangle, Trian
 
         if (!stop) {
             outlist.push_back(rvote->second);
+            accepted.insert(rvote->second.first.ID());
         }
 
         prevVote = rvote->first;
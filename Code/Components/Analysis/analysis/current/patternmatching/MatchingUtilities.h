@@ -161,6 +161,10 @@ getPixList(std::ifstream &fin, std::string raBaseStr, std::string decBaseStr,
 std::vector<matching::Point>
 trimList(std::vector<matching::Point> &inputList, const unsigned int maxSize);
 
+/// @brief Find the reference points near to any of the source points
+/// @details Returns, for each source point in turn, the reference
+/// points lying closer than maxOffset to it. A reference point may
+/// therefore appear more than once.
 std::vector<matching::Point>
 crudeMatchList(std::vector<matching::Point> &reflist,
                std::vector<matching::Point> &srclist,
@@ -169,6 +173,20 @@ crudeMatchList(std::vector<matching::Point> &reflist,
 /// @brief Create a list of triangles from a list of points
 std::vector<Triangle> getTriList(std::vector<Point> &pixlist);
 
+/// @brief Create a list of triangles from the neighbours of each point
+/// @details Rather than every combination of three points, only
+/// triangles formed by a point and two of its numNeighbours nearest
+/// neighbours are used. Each triangle appears only once. The number
+/// of triangles then grows linearly, rather than as the cube of the
+/// number of points.
+/// @param pixlist The list of points
+/// @param numNeighbours The number of neighbours of each point to use
+/// @param ratioLimit Triangles with a ratio of longest to shortest
+/// side of this or more are not used
+std::vector<Triangle> getLocalTriList(std::vector<Point> &pixlist,
+                                      unsigned int numNeighbours,
+                                      double ratioLimit = 10.);
+
 /// @brief Match two lists of triangles
 /// @details Finds a list of matching triangles from two
 /// lists. The lists are both sorted in order of increasing
@@ -30,6 +30,8 @@
 #include <patternmatching/PointCatalogue.h>
 #include <patternmatching/Point.h>
 #include <patternmatching/Triangle.h>
+#include <patternmatching/PointIndex.h>
+#include <patternmatching/MatchingUtilities.h>
 #include <modelcomponents/ModelFactory.h>
 #include <modelcomponents/Spectrum.h>
 #include <coordutils/PositionUtilities.h>
@@ -59,6 +61,7 @@ namespace matching {
 PointCatalogue::PointCatalogue():
     itsFilename(""),
     itsTrimSize(0),
+    itsTriangleNeighbours(0),
     itsRatioLimit(defaultRatioLimit),
     itsFlagOffsetPositions(false),
     itsRAref(0.),
@@ -84,6 +87,7 @@ PointCatalogue::PointCatalogue(LOFAR::ParameterSet &parset)
         ASKAPLOG_WARN_STR(logger, "Since trimsize<=2, the entire point list " <<
                           "will be used to generate triangles.");
     }
+    itsTriangleNeighbours = parset.getUint32("triangleNeighbours", 0);
     itsRatioLimit = parset.getFloat("ratioLimit", defaultRatioLimit);
     itsFullPointList = std::vector<Point>(0);
     itsWorkingPointList = std::vector<Point>(0);
@@ -178,6 +182,13 @@ void PointCatalogue::makeTriangleList()
     ASKAPLOG_DEBUG_STR(logger, "Second of list has flux " << itsWorkingPointList[1].flux());
 
     itsTriangleList = std::vector<Triangle>(0);
+    if (itsTriangleNeighbours > 0) {
+        std::vector<Point> triPoints(itsWorkingPointList.begin(),
+                                     itsWorkingPointList.begin() + maxPoint);
+        itsTriangleList = getLocalTriList(triPoints, itsTriangleNeighbours, itsRatioLimit);
+        return;
+    }
+
     for (size_t i = 0; i < maxPoint - 2; i++) {
         for (size_t j = i + 1; j < maxPoint - 1; j++) {
             for (size_t k = j + 1; k < maxPoint; k++) {
@@ -199,9 +210,12 @@ bool PointCatalogue::crudeMatch(std::vector<Point> &other, double maxSep)
     ASKAPLOG_DEBUG_STR(logger, "Performing crude match with maximum separation = " << maxSep);
     std::vector<Point>::iterator mine, theirs;
     itsWorkingPointList = std::vector<Point>(0);
+    PointIndex otherIndex(other);
     for (mine = itsFullPointList.begin(); mine < itsFullPointList.end(); mine++) {
         bool stop = false;
-        for (theirs = other.begin(); theirs < other.end() && !stop; theirs++) {
+        std::vector<size_t> near = otherIndex.inSquare(mine->x(), mine->y(), maxSep);
+        for (size_t i = 0; i < near.size() && !stop; i++) {
+            theirs = other.begin() + near[i];
 
             if (theirs->sep(*mine) < maxSep) {
                 itsWorkingPointList.push_back(*mine);
@@ -71,6 +71,7 @@ class PointCatalogue {
         std::string itsFilename;
         analysisutilities::ModelFactory itsFactory;
         size_t itsTrimSize; // only use the first itsTrimSize points to make the triangle list
+        size_t itsTriangleNeighbours; // if >0, make triangles only from this many nearest neighbours of each point
         double itsRatioLimit;
         bool   itsFlagOffsetPositions;
         double itsRAref;
@@ -0,0 +1,194 @@
+/// @file
+///
+/// Spatial index of a list of points, for fast neighbour searches
+///
+/// @copyright (c) 2015 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+#include <askap_analysis.h>
+
+#include <patternmatching/PointIndex.h>
+#include <patternmatching/Point.h>
+
+#include <algorithm>
+#include <math.h>
+#include <vector>
+#include <utility>
+
+namespace askap {
+
+namespace analysis {
+
+namespace matching {
+
+namespace {
+
+/// Ranges of this many points or fewer are searched linearly
+const size_t LeafSize = 8;
+
+/// Orders indices by the x or y value of the points they refer to
+class CoordLess {
+    public:
+        CoordLess(const std::vector<double> &coord) : itsCoord(coord) {};
+        bool operator()(size_t a, size_t b) const {return itsCoord[a] < itsCoord[b];};
+    private:
+        const std::vector<double> &itsCoord;
+};
+
+}
+
+PointIndex::PointIndex(std::vector<Point> &pointList)
+{
+    const size_t size = pointList.size();
+    std::vector<double> x(size), y(size);
+    itsIndex.resize(size);
+    for (size_t i = 0; i < size; i++) {
+        x[i] = pointList[i].x();
+        y[i] = pointList[i].y();
+        itsIndex[i] = i;
+    }
+
+    // Arrange the indices into tree order, then copy the positions
+    // into the same order so that searches walk through memory
+    // sequentially.
+    itsX.swap(x);
+    itsY.swap(y);
+    this->build(0, size, true);
+    x.resize(size);
+    y.resize(size);
+    for (size_t i = 0; i < size; i++) {
+        x[i] = itsX[itsIndex[i]];
+        y[i] = itsY[itsIndex[i]];
+    }
+    itsX.swap(x);
+    itsY.swap(y);
+}
+
+void PointIndex::build(size_t start, size_t end, bool splitX)
+{
+    // The point at the middle of each range is the one it is split
+    // on: those before it are not greater along the split axis, and
+    // those after it are not less.
+    if (end - start <= LeafSize) {
+        return;
+    }
+    const size_t mid = start + (end - start) / 2;
+    std::nth_element(itsIndex.begin() + start, itsIndex.begin() + mid,
+                     itsIndex.begin() + end, CoordLess(splitX ? itsX : itsY));
+    this->build(start, mid, !splitX);
+    this->build(mid + 1, end, !splitX);
+}
+
+std::vector<size_t> PointIndex::inSquare(double x0, double y0, double halfWidth) const
+{
+    std::vector<size_t> result;
+    this->searchSquare(0, itsIndex.size(), true, x0, y0, halfWidth, result);
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+void PointIndex::searchSquare(size_t start, size_t end, bool splitX,
+                              double x0, double y0, double halfWidth,
+                              std::vector<size_t> &result) const
+{
+    if (end - start <= LeafSize) {
+        for (size_t i = start; i < end; i++) {
+            if (fabs(itsX[i] - x0) <= halfWidth && fabs(itsY[i] - y0) <= halfWidth) {
+                result.push_back(itsIndex[i]);
+            }
+        }
+        return;
+    }
+
+    const size_t mid = start + (end - start) / 2;
+    if (fabs(itsX[mid] - x0) <= halfWidth && fabs(itsY[mid] - y0) <= halfWidth) {
+        result.push_back(itsIndex[mid]);
+    }
+    const double split = splitX ? itsX[mid] : itsY[mid];
+    const double pos = splitX ? x0 : y0;
+    if (pos - halfWidth <= split) {
+        this->searchSquare(start, mid, !splitX, x0, y0, halfWidth, result);
+    }
+    if (pos + halfWidth >= split) {
+        this->searchSquare(mid + 1, end, !splitX, x0, y0, halfWidth, result);
+    }
+}
+
+std::vector<size_t> PointIndex::nearest(double x0, double y0, size_t k) const
+{
+    // A max-heap of (squared distance, index) holding the k closest
+    // points found so far
+    std::vector< std::pair<double, size_t> > heap;
+    if (k > 0) {
+        heap.reserve(k + 1);
+        this->searchNearest(0, itsIndex.size(), true, x0, y0, k, heap);
+    }
+    std::sort_heap(heap.begin(), heap.end());
+    std::vector<size_t> result(heap.size());
+    for (size_t i = 0; i < heap.size(); i++) {
+        result[i] = heap[i].second;
+    }
+    return result;
+}
+
+void PointIndex::searchNearest(size_t start, size_t end, bool splitX,
+                               double x0, double y0, size_t k,
+                               std::vector< std::pair<double, size_t> > &heap) const
+{
+    const size_t mid = start + (end - start) / 2;
+    const bool leaf = (end - start <= LeafSize);
+    for (size_t i = (leaf ? start : mid); i < (leaf ? end : mid + 1); i++) {
+        const double dx = itsX[i] - x0;
+        const double dy = itsY[i] - y0;
+        const std::pair<double, size_t> item(dx * dx + dy * dy, itsIndex[i]);
+        if (heap.size() < k) {
+            heap.push_back(item);
+            std::push_heap(heap.begin(), heap.end());
+        } else if (item < heap.front()) {
+            std::pop_heap(heap.begin(), heap.end());
+            heap.back() = item;
+            std::push_heap(heap.begin(), heap.end());
+        }
+    }
+    if (leaf) {
+        return;
+    }
+
+    // Search the side containing the position first, and the other
+    // side only if it could hold anything closer than the furthest
+    // point kept so far.
+    const double offset = (splitX ? x0 - itsX[mid] : y0 - itsY[mid]);
+    const size_t nearStart = (offset < 0) ? start : mid + 1;
+    const size_t nearEnd = (offset < 0) ? mid : end;
+    const size_t farStart = (offset < 0) ? mid + 1 : start;
+    const size_t farEnd = (offset < 0) ? end : mid;
+    this->searchNearest(nearStart, nearEnd, !splitX, x0, y0, k, heap);
+    if (heap.size() < k || offset * offset < heap.front().first) {
+        this->searchNearest(farStart, farEnd, !splitX, x0, y0, k, heap);
+    }
+}
+
+}
+
+}
+
+}
@@ -0,0 +1,92 @@
+/// @file
+///
+/// Spatial index of a list of points, for fast neighbour searches
+///
+/// @copyright (c) 2015 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+#ifndef ASKAP_ANALYSIS_POINTINDEX_H_
+#define ASKAP_ANALYSIS_POINTINDEX_H_
+
+#include <patternmatching/Point.h>
+
+#include <vector>
+#include <utility>
+
+namespace askap {
+
+namespace analysis {
+
+namespace matching {
+
+/// @brief A k-d tree of the positions of a list of Points
+/// @details The tree is built once from a list of points, and
+/// answers neighbour queries in O(log n) time rather than by
+/// looking at every point of the list. Points are referred to by
+/// their index in the list used to build the tree, so the list
+/// should not be reordered while the index is in use.
+class PointIndex {
+    public:
+        /// @brief Build the tree from a list of points
+        PointIndex(std::vector<Point> &pointList);
+
+        /// @brief Number of points in the tree
+        size_t size() const {return itsIndex.size();};
+
+        /// @brief Points in a square around a position
+        /// @details Returns the indices (in increasing order) of all
+        /// points with |x-x0|<=halfWidth and |y-y0|<=halfWidth. This
+        /// includes all points closer than halfWidth, so callers
+        /// finding points within a given separation should apply
+        /// their own distance test to the points returned.
+        std::vector<size_t> inSquare(double x0, double y0, double halfWidth) const;
+
+        /// @brief The nearest points to a position
+        /// @details Returns the indices of the k points closest to
+        /// (x0,y0), nearest first. Fewer are returned if the tree
+        /// has fewer than k points.
+        std::vector<size_t> nearest(double x0, double y0, size_t k) const;
+
+    protected:
+        void build(size_t start, size_t end, bool splitX);
+        void searchSquare(size_t start, size_t end, bool splitX,
+                          double x0, double y0, double halfWidth,
+                          std::vector<size_t> &result) const;
+        void searchNearest(size_t start, size_t end, bool splitX,
+                           double x0, double y0, size_t k,
+                           std::vector< std::pair<double, size_t> > &heap) const;
+
+        /// @brief x coordinates, in tree order
+        std::vector<double> itsX;
+        /// @brief y coordinates, in tree order
+        std::vector<double> itsY;
+        /// @brief Index in the original list, in tree order
+        std::vector<size_t> itsIndex;
+};
+
+}
+
+}
+
+}
+
+#endif
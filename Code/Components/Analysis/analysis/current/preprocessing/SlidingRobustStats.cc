@@ -0,0 +1,487 @@
+/// @file SlidingRobustStats.cc
+///
+/// @copyright (c) 2015 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+
+#include <preprocessing/SlidingRobustStats.h>
+
+#include <casa/aipstype.h>
+#include <casa/Arrays/Array.h>
+#include <casa/Arrays/MaskedArray.h>
+#include <casa/Arrays/IPosition.h>
+
+#include <askap/AskapLogging.h>
+#include <askap/AskapError.h>
+
+#include <boost/thread/thread.hpp>
+#include <boost/bind.hpp>
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+#include <cmath>
+
+///@brief Where the log messages go.
+ASKAP_LOGGER(logger, ".slidingrobuststats");
+
+namespace askap {
+
+namespace analysis {
+
+namespace {
+
+/// Minimum number of output rows in a band. Each band ranks its own
+/// pixels, so bands much shorter than the box would rank most pixels
+/// several times.
+const size_t MinBandRows = 16;
+
+/// Layout of the planes the box slides over: the box axes (x and y, y
+/// being absent for a 1D box) and the start of every plane
+struct PlaneLayout {
+    size_t nx, ny;
+    size_t hx, hy;
+    size_t sx, sy;
+    std::vector<size_t> planeStarts;
+};
+
+/// A band of output rows of one plane
+struct Band {
+    size_t planeStart;
+    size_t yStart, yEnd;
+};
+
+/// @brief Number of pixels of each rank in the box
+/// @details This is a Fenwick (binary indexed) tree, so adding or
+/// removing a pixel and finding the k-th smallest value take
+/// O(log N) time.
+class RankCounter {
+    public:
+        RankCounter() : itsTopBit(0), itsCount(0) {};
+
+        void reset(size_t nRanks)
+        {
+            itsTree.assign(nRanks + 1, 0);
+            itsTopBit = 1;
+            while (itsTopBit * 2 <= nRanks) {
+                itsTopBit *= 2;
+            }
+            itsCount = 0;
+        };
+
+        void add(size_t rank)
+        {
+            for (size_t i = rank + 1; i < itsTree.size(); i += i & (~i + 1)) {
+                ++itsTree[i];
+            }
+            ++itsCount;
+        };
+
+        void remove(size_t rank)
+        {
+            for (size_t i = rank + 1; i < itsTree.size(); i += i & (~i + 1)) {
+                --itsTree[i];
+            }
+            --itsCount;
+        };
+
+        size_t count() const {return itsCount;};
+
+        /// Rank of the k-th smallest (from zero) pixel in the box
+        size_t select(size_t k) const
+        {
+            size_t pos = 0;
+            for (size_t step = itsTopBit; step > 0; step >>= 1) {
+                if (pos + step < itsTree.size() && itsTree[pos + step] <= k) {
+                    pos += step;
+                    k -= itsTree[pos];
+                }
+            }
+            return pos;
+        };
+
+    private:
+        std::vector<unsigned int> itsTree;
+        size_t itsTopBit;
+        size_t itsCount;
+};
+
+/// @brief Sliding median and MADFM over bands of rows
+/// @details One worker per thread, the scratch space is reused
+/// from band to band.
+class BandWorker {
+    public:
+        BandWorker(const PlaneLayout &layout, const casa::Float *data, const casa::Bool *mask,
+                   casa::Float *median, casa::Float *madfm) :
+            itsLayout(layout), itsData(data), itsMask(mask),
+            itsMedian(median), itsMadfm(madfm), itsYLow(0) {};
+
+        void process(const Band &band);
+
+    private:
+        /// Rank the good pixels of the rows needed by the band
+        void rank(const Band &band);
+
+        void add(size_t x, size_t y)
+        {
+            const size_t r = itsRanks[(y - itsYLow) * itsLayout.nx + x];
+            if (r != NotRanked) {
+                itsCounter.add(r);
+            }
+        };
+
+        void remove(size_t x, size_t y)
+        {
+            const size_t r = itsRanks[(y - itsYLow) * itsLayout.nx + x];
+            if (r != NotRanked) {
+                itsCounter.remove(r);
+            }
+        };
+
+        /// k-th smallest value in the box
+        casa::Float value(size_t k) const {return itsValues[itsCounter.select(k)];};
+
+        /// @brief k-th smallest absolute deviation from the median
+        /// @details The box values up to the median (nLeft of them) and
+        /// those above it give two sorted lists of deviations, this is a
+        /// binary search for the number taken from the first list.
+        casa::Float deviation(size_t k, casa::Float med, size_t nLeft) const;
+
+        /// Median and MADFM of the box around the given pixel
+        void evaluate(size_t offset);
+
+        static const size_t NotRanked = static_cast<size_t>(-1);
+
+        const PlaneLayout &itsLayout;
+        const casa::Float *itsData;
+        const casa::Bool *itsMask;
+        casa::Float *itsMedian;
+        casa::Float *itsMadfm;
+
+        /// First row ranked
+        size_t itsYLow;
+        /// Rank of each pixel of the ranked rows
+        std::vector<size_t> itsRanks;
+        /// Value of each rank
+        std::vector<casa::Float> itsValues;
+        std::vector< std::pair<casa::Float, size_t> > itsSorted;
+        RankCounter itsCounter;
+};
+
+void BandWorker::rank(const Band &band)
+{
+    const PlaneLayout &l = itsLayout;
+    itsYLow = band.yStart - l.hy;
+    const size_t yHigh = band.yEnd + l.hy;
+    itsSorted.clear();
+    for (size_t y = itsYLow; y < yHigh; y++) {
+        for (size_t x = 0; x < l.nx; x++) {
+            const size_t offset = band.planeStart + x * l.sx + y * l.sy;
+            const casa::Float val = itsData[offset];
+            if ((itsMask == 0 || itsMask[offset]) && !std::isnan(val)) {
+                itsSorted.push_back(std::make_pair(val, (y - itsYLow) * l.nx + x));
+            }
+        }
+    }
+    std::sort(itsSorted.begin(), itsSorted.end());
+    itsRanks.assign((yHigh - itsYLow) * l.nx, NotRanked);
+    itsValues.resize(itsSorted.size());
+    for (size_t i = 0; i < itsSorted.size(); i++) {
+        itsValues[i] = itsSorted[i].first;
+        itsRanks[itsSorted[i].second] = i;
+    }
+    itsCounter.reset(itsSorted.size());
+}
+
+void BandWorker::process(const Band &band)
+{
+    const PlaneLayout &l = itsLayout;
+    rank(band);
+
+    // Snake through the band: along the first row, back along the
+    // second, and so on, so the box always moves by a single pixel.
+    const size_t xFirst = l.hx;
+    const size_t xLast = l.nx - l.hx - 1;
+    size_t x = xFirst;
+    for (size_t dy = 0; dy <= 2 * l.hy; dy++) {
+        for (size_t dx = 0; dx <= 2 * l.hx; dx++) {
+            add(dx, band.yStart - l.hy + dy);
+        }
+    }
+
+    bool forward = true;
+    for (size_t y = band.yStart; y < band.yEnd; y++) {
+        if (y > band.yStart) {
+            for (size_t xx = x - l.hx; xx <= x + l.hx; xx++) {
+                remove(xx, y - l.hy - 1);
+                add(xx, y + l.hy);
+            }
+        }
+        while (true) {
+            evaluate(band.planeStart + x * l.sx + y * l.sy);
+            if (forward ? (x == xLast) : (x == xFirst)) {
+                break;
+            }
+            const size_t xOut = forward ? x - l.hx : x + l.hx;
+            const size_t xIn = forward ? x + l.hx + 1 : x - l.hx - 1;
+            for (size_t yy = y - l.hy; yy <= y + l.hy; yy++) {
+                remove(xOut, yy);
+                add(xIn, yy);
+            }
+            x = forward ? x + 1 : x - 1;
+        }
+        forward = !forward;
+    }
+}
+
+casa::Float BandWorker::deviation(size_t k, casa::Float med, size_t nLeft) const
+{
+    // left(j) = med - (j-th value below the median, counting down)
+    // right(j) = (j-th value above the median) - med
+    const size_t n = itsCounter.count();
+    const size_t nRight = n - nLeft;
+    size_t lo = (k + 1 > nRight) ? k + 1 - nRight : 0;
+    size_t hi = std::min(k + 1, nLeft);
+    while (lo < hi) {
+        const size_t i = (lo + hi) / 2;
+        if (med - value(nLeft - 1 - i) < value(nLeft + k - i) - med) {
+            lo = i + 1;
+        } else {
+            hi = i;
+        }
+    }
+    // lo values from the left list and k+1-lo from the right list
+    if (lo == 0) {
+        return value(nLeft + k) - med;
+    }
+    if (lo == k + 1) {
+        return med - value(nLeft - 1 - k);
+    }
+    return std::max(med - value(nLeft - lo), value(nLeft + k - lo) - med);
+}
+
+void BandWorker::evaluate(size_t offset)
+{
+    const size_t n = itsCounter.count();
+    if (n == 0) {
+        itsMedian[offset] = 0.;
+        itsMadfm[offset] = 0.;
+        return;
+    }
+    const size_t half = n / 2;
+    casa::Float med;
+    size_t nLeft;
+    if (n % 2 == 1) {
+        med = value(half);
+        nLeft = half + 1;
+    } else {
+        med = 0.5 * (value(half - 1) + value(half));
+        nLeft = half;
+    }
+    itsMedian[offset] = med;
+    if (n % 2 == 1) {
+        itsMadfm[offset] = deviation(half, med, nLeft);
+    } else {
+        itsMadfm[offset] = 0.5 * (deviation(half - 1, med, nLeft) +
+                                  deviation(half, med, nLeft));
+    }
+}
+
+/// Process every nThreads-th band, starting from the given one
+void processBands(const PlaneLayout &layout, const std::vector<Band> &bands,
+                  size_t first, size_t step,
+                  const casa::Float *data, const casa::Bool *mask, casa::Float *median, casa::Float *madfm)
+{
+    BandWorker worker(layout, data, mask, median, madfm);
+    for (size_t i = first; i < bands.size(); i += step) {
+        worker.process(bands[i]);
+    }
+}
+
+}
+
+SlidingRobustStats::SlidingRobustStats(const casa::IPosition &halfBox,
+                                       unsigned int nThreads):
+    itsHalfBox(halfBox),
+    itsNumThreads(std::max(nThreads, 1U))
+{
+}
+
+bool SlidingRobustStats::canHandle(const casa::IPosition &shape) const
+{
+    if (itsHalfBox.size() > shape.size()) {
+        return false;
+    }
+    size_t nBoxAxes = 0;
+    for (size_t i = 0; i < itsHalfBox.size(); i++) {
+        if (itsHalfBox(i) < 0) {
+            return false;
+        }
+        if (itsHalfBox(i) > 0) {
+            nBoxAxes++;
+        }
+    }
+    return nBoxAxes <= 2;
+}
+
+void SlidingRobustStats::calculate(const casa::Array<casa::Float> &input,
+                                   casa::Array<casa::Float> &median,
+                                   casa::Array<casa::Float> &madfm) const
+{
+    ASKAPCHECK(input.shape() == median.shape() && input.shape() == madfm.shape(),
+               "SlidingRobustStats: output arrays should have the shape of the input");
+    casa::Bool deleteData, deleteMedian, deleteMadfm;
+    const casa::Float *data = input.getStorage(deleteData);
+    casa::Float *medianData = median.getStorage(deleteMedian);
+    casa::Float *madfmData = madfm.getStorage(deleteMadfm);
+    calculate(data, 0, input.shape(), medianData, madfmData);
+    input.freeStorage(data, deleteData);
+    median.putStorage(medianData, deleteMedian);
+    madfm.putStorage(madfmData, deleteMadfm);
+}
+
+void SlidingRobustStats::calculate(const casa::MaskedArray<casa::Float> &input,
+                                   casa::Array<casa::Float> &median,
+                                   casa::Array<casa::Float> &madfm) const
+{
+    ASKAPCHECK(input.shape() == median.shape() && input.shape() == madfm.shape(),
+               "SlidingRobustStats: output arrays should have the shape of the input");
+    const casa::Array<casa::Float> &arr = input.getArray();
+    const casa::LogicalArray &mask = input.getMask();
+    casa::Bool deleteData, deleteMask, deleteMedian, deleteMadfm;
+    const casa::Float *data = arr.getStorage(deleteData);
+    const casa::Bool *maskData = mask.getStorage(deleteMask);
+    casa::Float *medianData = median.getStorage(deleteMedian);
+    casa::Float *madfmData = madfm.getStorage(deleteMadfm);
+    calculate(data, maskData, arr.shape(), medianData, madfmData);
+    arr.freeStorage(data, deleteData);
+    mask.freeStorage(maskData, deleteMask);
+    median.putStorage(medianData, deleteMedian);
+    madfm.putStorage(madfmData, deleteMadfm);
+}
+
+void SlidingRobustStats::calculate(const casa::Float *data, const casa::Bool *mask,
+                                   const casa::IPosition &shape,
+                                   casa::Float *median, casa::Float *madfm) const
+{
+    ASKAPCHECK(canHandle(shape), "SlidingRobustStats: can't use a box with half-widths " <<
+               itsHalfBox << " for an array of shape " << shape);
+
+    const size_t ndim = shape.size();
+    size_t npix = 1;
+    std::vector<size_t> strides(ndim);
+    for (size_t i = 0; i < ndim; i++) {
+        strides[i] = npix;
+        npix *= shape(i);
+    }
+    if (npix == 0) {
+        return;
+    }
+    std::fill(median, median + npix, casa::Float(0.));
+    std::fill(madfm, madfm + npix, casa::Float(0.));
+
+    // The box axes become x and y of the planes, a 1D box (or no box
+    // at all) has a single row per plane.
+    std::vector<size_t> boxAxes;
+    for (size_t i = 0; i < itsHalfBox.size(); i++) {
+        if (itsHalfBox(i) > 0) {
+            boxAxes.push_back(i);
+        }
+    }
+    if (boxAxes.empty()) {
+        boxAxes.push_back(0);
+    }
+    PlaneLayout layout;
+    layout.nx = shape(boxAxes[0]);
+    layout.hx = (boxAxes[0] < itsHalfBox.size()) ? itsHalfBox(boxAxes[0]) : 0;
+    layout.sx = strides[boxAxes[0]];
+    if (boxAxes.size() > 1) {
+        layout.ny = shape(boxAxes[1]);
+        layout.hy = itsHalfBox(boxAxes[1]);
+        layout.sy = strides[boxAxes[1]];
+    } else {
+        layout.ny = 1;
+        layout.hy = 0;
+        layout.sy = 0;
+    }
+    if (layout.nx < 2 * layout.hx + 1 || layout.ny < 2 * layout.hy + 1) {
+        // The box doesn't fit anywhere, all pixels are edge pixels
+        return;
+    }
+
+    // Start of every plane: loop over all positions along the other axes
+    std::vector<bool> isBoxAxis(ndim, false);
+    for (size_t i = 0; i < boxAxes.size(); i++) {
+        isBoxAxis[boxAxes[i]] = true;
+    }
+    std::vector<size_t> counter(ndim, 0);
+    while (true) {
+        size_t start = 0;
+        for (size_t i = 0; i < ndim; i++) {
+            start += counter[i] * strides[i];
+        }
+        layout.planeStarts.push_back(start);
+        size_t axis = 0;
+        while (axis < ndim) {
+            if (!isBoxAxis[axis]) {
+                if (++counter[axis] < size_t(shape(axis))) {
+                    break;
+                }
+                counter[axis] = 0;
+            }
+            axis++;
+        }
+        if (axis == ndim) {
+            break;
+        }
+    }
+
+    const size_t bandRows = std::max(2 * layout.hy + 1, MinBandRows);
+    std::vector<Band> bands;
+    for (size_t p = 0; p < layout.planeStarts.size(); p++) {
+        for (size_t y = layout.hy; y < layout.ny - layout.hy; y += bandRows) {
+            Band band;
+            band.planeStart = layout.planeStarts[p];
+            band.yStart = y;
+            band.yEnd = std::min(y + bandRows, layout.ny - layout.hy);
+            bands.push_back(band);
+        }
+    }
+
+    const size_t nThreads = std::min(size_t(itsNumThreads), bands.size());
+    if (nThreads <= 1) {
+        processBands(layout, bands, 0, 1, data, mask, median, madfm);
+    } else {
+        ASKAPLOG_DEBUG_STR(logger, "Sliding box statistics of " << bands.size() <<
+                           " bands with " << nThreads << " threads");
+        boost::thread_group threads;
+        for (size_t t = 0; t < nThreads; t++) {
+            threads.create_thread(boost::bind(&processBands, boost::cref(layout),
+                                              boost::cref(bands), t, nThreads,
+                                              data, mask, median, madfm));
+        }
+        threads.join_all();
+    }
+}
+
+}
+
+}
@@ -0,0 +1,112 @@
+/// @file SlidingRobustStats.h
+///
+/// @copyright (c) 2015 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+
+#ifndef ASKAP_ANALYSIS_SLIDING_ROBUST_STATS_H_
+#define ASKAP_ANALYSIS_SLIDING_ROBUST_STATS_H_
+
+#include <casa/aipstype.h>
+#include <casa/Arrays/Array.h>
+#include <casa/Arrays/MaskedArray.h>
+#include <casa/Arrays/IPosition.h>
+
+namespace askap {
+
+namespace analysis {
+
+/// @brief Sliding-box median and MADFM of an array
+/// @details This gives the same results as casacore's slidingArrayMath
+/// with (Masked)MedianFunc and (Masked)MadfmFunc, but without sorting
+/// the box from scratch at every pixel. The values are ranked once per
+/// band of rows, and the box keeps a count of the ranks it contains
+/// (a Fenwick tree). Moving the box by one pixel only adds and removes
+/// the pixels of one row or column, and the median and the MADFM are
+/// found by searching the counts in O(log N) and O(log^2 N) time.
+///
+/// As with slidingArrayMath, the box is given by its half-width along
+/// each axis, pixels closer to the edge than the half-width are set
+/// to zero, as are those where the box has no unmasked pixels. The
+/// mean of the two middle values is taken for an even number of
+/// values. NaN values are ignored in the same way as masked pixels.
+///
+/// At most two axes may have a non-zero half-width, which covers both
+/// the spatial (2D box) and spectral (1D box) cases. The array is
+/// split into independent bands of rows (and planes or spectra, when
+/// the box doesn't cover all axes), which are shared out between
+/// threads.
+class SlidingRobustStats {
+    public:
+        /// @brief Constructor
+        /// @param[in] halfBox half-width of the box along each axis
+        /// (missing axes have zero half-width)
+        /// @param[in] nThreads number of threads to use
+        SlidingRobustStats(const casa::IPosition &halfBox,
+                           unsigned int nThreads = 1);
+
+        /// @brief Can the box be used for an array of the given shape?
+        /// @details False if more than two axes have a non-zero
+        /// half-width, or the box has more axes than the array.
+        bool canHandle(const casa::IPosition &shape) const;
+
+        /// @brief Sliding median and MADFM of all pixels
+        /// @param[in] input input array
+        /// @param[out] median median in the box around each pixel
+        /// @param[out] madfm median absolute deviation from the median
+        /// (not scaled to the standard deviation)
+        void calculate(const casa::Array<casa::Float> &input,
+                       casa::Array<casa::Float> &median,
+                       casa::Array<casa::Float> &madfm) const;
+
+        /// @brief Sliding median and MADFM of the unmasked pixels
+        /// @param[in] input input array and mask
+        /// @param[out] median median in the box around each pixel
+        /// @param[out] madfm median absolute deviation from the median
+        /// (not scaled to the standard deviation)
+        void calculate(const casa::MaskedArray<casa::Float> &input,
+                       casa::Array<casa::Float> &median,
+                       casa::Array<casa::Float> &madfm) const;
+
+        /// @brief Sliding median and MADFM of contiguous storage
+        /// @param[in] data input values, in casacore (Fortran) order
+        /// @param[in] mask mask values (true for good pixels), or
+        /// zero if all pixels are good
+        /// @param[in] shape shape of the array
+        /// @param[out] median median in the box around each pixel
+        /// @param[out] madfm median absolute deviation from the median
+        void calculate(const casa::Float *data, const casa::Bool *mask,
+                       const casa::IPosition &shape,
+                       casa::Float *median, casa::Float *madfm) const;
+
+    private:
+        /// Half-width of the box along each axis
+        casa::IPosition itsHalfBox;
+
+        /// Number of threads
+        unsigned int itsNumThreads;
+};
+
+}
+
+}
+
+#endif
@@ -67,6 +67,7 @@ VariableThresholder::VariableThresholder(askap::askapparallel::AskapParallel& co
     itsParset(parset)
 {
     itsBoxSize = parset.getInt16("boxSize", 50);
+    itsNumThreads = parset.getUint("numThreads", 1);
     itsSNRimageName = parset.getString("SNRimageName", "");
     itsThresholdImageName = parset.getString("ThresholdImageName", "");
     itsNoiseImageName = parset.getString("NoiseImageName", "");
@@ -218,7 +219,9 @@ void VariableThresholder::calculate()
         } else {
             if (lngAxis >= 0) chunkshape(lngAxis) = 1;
             if (latAxis >= 0) chunkshape(latAxis) = 1;
-            box = casa::IPosition(1, itsBoxSize);
+            // The box runs along the spectral axis of the chunk
+            box = casa::IPosition(chunkshape.size(), 0);
+            if (specAxis >= 0) box(specAxis) = itsBoxSize;
             maxCtr = spatsize;
         }
 
@@ -263,7 +266,7 @@ void VariableThresholder::calculate()
                 this->defineChunk(inputChunk, inputMaskedChunk, ctr);
                 //slidingBoxStats(inputChunk, middle, spread, box, itsFlagRobustStats);
                 slidingBoxMaskedStats(inputMaskedChunk, middle, spread, box,
-                                      itsFlagRobustStats);
+                                      itsFlagRobustStats, itsNumThreads);
                 // snr = calcSNR(inputChunk,middle,spread);
                 snr = calcMaskedSNR(inputMaskedChunk, middle, spread);
                 if (itsBoxSumImageName != "") {
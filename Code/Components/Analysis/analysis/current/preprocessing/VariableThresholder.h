@@ -160,6 +160,8 @@ class VariableThresholder {
         std::string itsSearchType;
         /// The half-box-width used for the sliding-box calculations
         unsigned int itsBoxSize;
+        /// Number of threads used for the sliding box statistics
+        unsigned int itsNumThreads;
 
         std::string itsInputImage;
 
@@ -23,6 +23,7 @@
 /// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
 
 #include <preprocessing/VariableThresholdingHelpers.h>
+#include <preprocessing/SlidingRobustStats.h>
 
 #include <casa/aipstype.h>
 #include <casa/Arrays/Array.h>
@@ -47,12 +48,17 @@ void slidingBoxStats(casa::Array<Float> &input,
                      casa::Array<Float> &middle,
                      casa::Array<Float> &spread,
                      casa::IPosition &box,
-                     bool useRobust)
+                     bool useRobust,
+                     unsigned int nThreads)
 {
     ASKAPASSERT(input.shape() == middle.shape());
     ASKAPASSERT(input.shape() == spread.shape());
 
-    if (useRobust) {
+    SlidingRobustStats robustStats(box, nThreads);
+    if (useRobust && robustStats.canHandle(input.shape())) {
+        robustStats.calculate(input, middle, spread);
+        spread /= Float(Statistics::correctionFactor);
+    } else if (useRobust) {
         middle = slidingArrayMath(input, box, MedianFunc<Float>());
         spread = slidingArrayMath(input, box, MadfmFunc<Float>()) /
                  Statistics::correctionFactor;
@@ -87,12 +93,17 @@ void slidingBoxMaskedStats(casa::MaskedArray<Float> &input,
                            casa::Array<Float> &middle,
                            casa::Array<Float> &spread,
                            casa::IPosition &box,
-                           bool useRobust)
+                           bool useRobust,
+                           unsigned int nThreads)
 {
     ASKAPASSERT(input.shape() == middle.shape());
     ASKAPASSERT(input.shape() == spread.shape());
 
-    if (useRobust) {
+    SlidingRobustStats robustStats(box, nThreads);
+    if (useRobust && robustStats.canHandle(input.shape())) {
+        robustStats.calculate(input, middle, spread);
+        spread /= Float(Statistics::correctionFactor);
+    } else if (useRobust) {
         middle = slidingArrayMath(input, box, MaskedMedianFunc<Float>());
         spread = slidingArrayMath(input, box, MaskedMadfmFunc<Float>()) /
                  Statistics::correctionFactor;
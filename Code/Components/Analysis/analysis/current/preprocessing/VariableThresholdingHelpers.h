@@ -28,27 +28,38 @@
 #include <casa/aipstype.h>
 #include <casa/Arrays/Array.h>
 #include <casa/Arrays/IPosition.h>
+#include <casa/Arrays/MaskedArray.h>
 #include <casa/namespace.h>
 
 namespace askap {
 
 namespace analysis {
 
+/// @brief Sliding box statistics of an array
+/// @details The box is given by its half-width along each axis. The
+/// robust statistics (median and MADFM scaled to a standard deviation)
+/// are found with SlidingRobustStats when it can handle the box, and
+/// with casacore's slidingArrayMath otherwise.
+/// @param[in] nThreads number of threads used for the robust statistics
 void slidingBoxStats(casa::Array<Float> &input,
                      casa::Array<Float> &middle,
                      casa::Array<Float> &spread,
                      casa::IPosition &box,
-                     bool useRobust);
+                     bool useRobust,
+                     unsigned int nThreads = 1);
 
 casa::Array<Float> calcSNR(casa::Array<Float> &input,
                            casa::Array<Float> &middle,
                            casa::Array<Float> &spread);
 
+/// @brief Sliding box statistics of the unmasked pixels of an array
+/// @details As for slidingBoxStats.
 void slidingBoxMaskedStats(casa::MaskedArray<Float> &input,
                            casa::Array<Float> &middle,
                            casa::Array<Float> &spread,
                            casa::IPosition &box,
-                           bool useRobust);
+                           bool useRobust,
+                           unsigned int nThreads = 1);
 
 casa::Array<Float> calcMaskedSNR(casa::MaskedArray<Float> &input,
                                  casa::Array<Float> &middle,
@@ -836,19 +836,38 @@ void RadioSource::prepareForFit(duchamp::Cube & cube, bool useArray)
 
 //**************************************************************//
 
-bool RadioSource::fitGauss(duchamp::Cube &cube)
+double RadioSource::fitCost()
 {
-    std::vector<float> array(cube.getArray(),
-                             cube.getArray() + cube.getSize());
-    std::vector<size_t> dim(cube.getDimArray(),
-                            cube.getDimArray() + cube.getNumDim());
+    const double numPix = itsFitParams.fitJustDetection() ?
+                          double(this->getSize()) : double(this->boxSize());
+
+    // The fits are done for 1 up to maxNumGauss Gaussians, and the
+    // cost of each grows with the number of Gaussians
+    const double maxGauss = std::min(double(itsFitParams.maxNumGauss()), numPix);
+    int numTypes = 0;
+    std::vector<std::string>::const_iterator type;
+    for (type = availableFitTypes.begin(); type < availableFitTypes.end(); type++) {
+        if (itsFitParams.hasType(*type)) {
+            numTypes++;
+        }
+    }
+
+    return numPix * maxGauss * (maxGauss + 1.) / 2. * std::max(numTypes, 1);
+}
+
+//**************************************************************//
 
+bool RadioSource::fitGauss(duchamp::Cube &cube)
+{
+    // Use the arrays of the cube directly - copying the whole image
+    // for every source is expensive
     if (itsFitParams.fitJustDetection()) {
         ASKAPLOG_DEBUG_STR(logger, "Fitting to detected pixels");
-        std::vector<PixelInfo::Voxel> voxlist = this->getPixelSet(array.data(), dim.data());
+        std::vector<PixelInfo::Voxel> voxlist =
+            this->getPixelSet(cube.getArray(), cube.getDimArray());
         return fitGauss(voxlist);
     } else {
-        return fitGauss(array, dim);
+        return fitGauss(cube.getArray(), cube.getDimArray());
     }
 
 }
@@ -897,6 +916,13 @@ bool RadioSource::fitGauss(std::vector<PixelInfo::Voxel> &voxelList)
 
 bool RadioSource::fitGauss(std::vector<float> &fluxArray,
                            std::vector<size_t> &dimArray)
+{
+    return fitGauss(fluxArray.data(), dimArray.data());
+}
+
+//**************************************************************//
+
+bool RadioSource::fitGauss(const float *fluxArray, const size_t *dimArray)
 {
 
     if (this->getZcentre() != this->getZmin() || this->getZcentre() != this->getZmax()) {
@@ -195,13 +195,14 @@ class RadioSource : public duchamp::Detection {
 
         /// @details The principle interface to the Gaussian
         /// fitting. Depending on the choice in the FittingParameters,
-        /// this either extracts the flux and dimension arrays from
-        /// the cube and passes them to fitGauss(std::vector<float>,
-        /// std::vector<size_t>), or extracts the set of voxels that
+        /// this either passes the flux and dimension arrays of
+        /// the cube to fitGauss(const float *, const size_t *),
+        /// or extracts the set of voxels that
         /// make up the object and pass them to
         /// fitGauss(std::vector<PixelInfo::Voxel> &). The
         /// FittingParameters need to have been set prior to calling
-        /// (via setFitParams).
+        /// (via setFitParams). The cube is not modified, so several
+        /// sources can be fitted to the same cube concurrently.
         bool fitGauss(duchamp::Cube &cube);
 
         /// @details First defines the pixel array with the
@@ -226,6 +227,11 @@ class RadioSource : public duchamp::Detection {
         bool fitGauss(std::vector<float> &fluxArray,
                       std::vector<size_t> &dimArray);
 
+        /// @details As for fitGauss(std::vector<float> &,
+        /// std::vector<size_t> &), but reads the flux values
+        /// directly from the given array, which is not copied.
+        bool fitGauss(const float *fluxArray, const size_t *dimArray);
+
         /// @details This function drives the fitting of the Gaussian
         /// functions. It first sets up the fitting parameters, then
         /// finds the sub-components present in the box. The main loop
@@ -471,6 +477,15 @@ class RadioSource : public duchamp::Detection {
         /// Number of pixels in box
         size_t boxSize() {return boxXsize() * boxYsize();};
 
+        /// @brief Estimate of the relative cost of fitting this source
+        /// @details This is used to schedule the fits, so that the
+        /// most expensive ones are started first. The cost is taken
+        /// to be proportional to the number of pixels used in the
+        /// fit and to the total number of Gaussians fitted over all
+        /// trials and fit types. The box needs to have been defined
+        /// (via defineBox).
+        double fitCost();
+
         /// Return the full box description
         casa::Slicer box() {return itsBox;};
         /// Define the box in one shot
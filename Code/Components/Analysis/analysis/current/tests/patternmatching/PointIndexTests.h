@@ -0,0 +1,153 @@
+/// @file
+///
+/// Tests of the spatial index used for cross-matching point lists
+///
+/// @copyright (c) 2015 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+#include <patternmatching/PointIndex.h>
+#include <patternmatching/Point.h>
+#include <patternmatching/MatchingUtilities.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <vector>
+#include <algorithm>
+#include <math.h>
+
+namespace askap {
+namespace analysis {
+
+namespace matching {
+
+class PointIndexTest : public CppUnit::TestFixture {
+        CPPUNIT_TEST_SUITE(PointIndexTest);
+        CPPUNIT_TEST(testInSquare);
+        CPPUNIT_TEST(testNearest);
+        CPPUNIT_TEST(testCrudeMatch);
+        CPPUNIT_TEST(testLocalTriangles);
+        CPPUNIT_TEST_SUITE_END();
+
+    private:
+        std::vector<Point> itsPoints;
+
+    public:
+
+        void setUp()
+        {
+            // A pseudo-random scatter of points, with some repeated positions
+            itsPoints.clear();
+            unsigned int seed = 4321;
+            for (int i = 0; i < 500; i++) {
+                seed = seed * 1103515245 + 12345;
+                double x = double((seed >> 8) % 10000) / 100.;
+                seed = seed * 1103515245 + 12345;
+                double y = double((seed >> 8) % 10000) / 100.;
+                if (i % 50 == 49) {
+                    x = itsPoints[i - 1].x();
+                    y = itsPoints[i - 1].y();
+                }
+                itsPoints.push_back(Point(x, y, 1.));
+            }
+        }
+
+        void testInSquare()
+        {
+            PointIndex index(itsPoints);
+            CPPUNIT_ASSERT_EQUAL(itsPoints.size(), index.size());
+            for (int i = 0; i < 20; i++) {
+                double x0 = 5. * i, y0 = 100. - 4. * i, width = 0.5 * i;
+                std::vector<size_t> expected;
+                for (size_t p = 0; p < itsPoints.size(); p++) {
+                    if (fabs(itsPoints[p].x() - x0) <= width &&
+                            fabs(itsPoints[p].y() - y0) <= width) {
+                        expected.push_back(p);
+                    }
+                }
+                std::vector<size_t> found = index.inSquare(x0, y0, width);
+                CPPUNIT_ASSERT(found == expected);
+            }
+        }
+
+        void testNearest()
+        {
+            PointIndex index(itsPoints);
+            for (int i = 0; i < 20; i++) {
+                double x0 = 3. * i, y0 = 2. * i;
+                std::vector<double> dist;
+                for (size_t p = 0; p < itsPoints.size(); p++) {
+                    dist.push_back(hypot(itsPoints[p].x() - x0, itsPoints[p].y() - y0));
+                }
+                std::vector<double> sorted = dist;
+                std::sort(sorted.begin(), sorted.end());
+
+                std::vector<size_t> found = index.nearest(x0, y0, 7);
+                CPPUNIT_ASSERT_EQUAL(size_t(7), found.size());
+                for (size_t k = 0; k < found.size(); k++) {
+                    CPPUNIT_ASSERT_DOUBLES_EQUAL(sorted[k], dist[found[k]], 1.e-9);
+                }
+            }
+            CPPUNIT_ASSERT_EQUAL(itsPoints.size(), index.nearest(0., 0., 1000).size());
+        }
+
+        void testCrudeMatch()
+        {
+            std::vector<Point> src;
+            src.push_back(Point(10., 10., 1.));
+            src.push_back(Point(50., 70., 1.));
+            src.push_back(Point(95., 5., 1.));
+            const float maxOffset = 4.;
+
+            std::vector<Point> expected;
+            for (size_t s = 0; s < src.size(); s++) {
+                for (size_t p = 0; p < itsPoints.size(); p++) {
+                    if (src[s].sep(itsPoints[p]) < maxOffset) expected.push_back(itsPoints[p]);
+                }
+            }
+
+            std::vector<Point> found = crudeMatchList(itsPoints, src, maxOffset);
+            CPPUNIT_ASSERT_EQUAL(expected.size(), found.size());
+            for (size_t i = 0; i < found.size(); i++) {
+                CPPUNIT_ASSERT_EQUAL(expected[i].x(), found[i].x());
+                CPPUNIT_ASSERT_EQUAL(expected[i].y(), found[i].y());
+            }
+        }
+
+        void testLocalTriangles()
+        {
+            // With every other point as a neighbour, all triangles are made
+            std::vector<Point> pts(itsPoints.begin(), itsPoints.begin() + 12);
+            std::vector<Triangle> all = getTriList(pts);
+            std::vector<Triangle> local = getLocalTriList(pts, pts.size() - 1);
+            CPPUNIT_ASSERT_EQUAL(all.size(), local.size());
+
+            // Fewer neighbours give fewer triangles
+            local = getLocalTriList(pts, 3);
+            CPPUNIT_ASSERT(local.size() < all.size());
+            CPPUNIT_ASSERT(local.size() > 0);
+        }
+
+};
+
+}
+
+}
+}
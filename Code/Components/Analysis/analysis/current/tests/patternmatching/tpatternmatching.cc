@@ -32,11 +32,13 @@
 
 // Test includes
 #include <TriangleTests.h>
+#include <PointIndexTests.h>
 
 int main(int argc, char *argv[])
 {
     askapdev::testutils::AskapTestRunner runner(argv[0]);
     runner.addTest(askap::analysis::matching::TriangleTest::suite());
+    runner.addTest(askap::analysis::matching::PointIndexTest::suite());
     bool wasSuccessful = runner.run();
 
     return wasSuccessful ? 0 : 1;
@@ -0,0 +1,119 @@
+/// @file
+///
+/// Tests of the incremental sliding-box median and MADFM
+///
+/// @copyright (c) 2015 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+#include <preprocessing/SlidingRobustStats.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include <askap/AskapLogging.h>
+#include <askap/AskapError.h>
+#include <casa/Arrays/ArrayPartMath.h>
+#include <casa/Arrays/MaskArrMath.h>
+
+namespace askap {
+namespace analysis {
+
+class SlidingRobustStatsTest : public CppUnit::TestFixture {
+        CPPUNIT_TEST_SUITE(SlidingRobustStatsTest);
+        CPPUNIT_TEST(testSpatial);
+        CPPUNIT_TEST(testSpectral);
+        CPPUNIT_TEST(testThreads);
+        CPPUNIT_TEST(testBoxTooBig);
+        CPPUNIT_TEST_SUITE_END();
+
+    public:
+
+        /// Fill with noise-like values, some of them repeated and some masked
+        void fill(casa::MaskedArray<casa::Float> &arr, const casa::IPosition &shape)
+        {
+            casa::Array<casa::Float> values(shape);
+            casa::LogicalArray mask(shape);
+            casa::Array<casa::Float>::iterator iterValue(values.begin());
+            casa::LogicalArray::iterator iterMask(mask.begin());
+            unsigned int seed = 12345;
+            for (; iterValue != values.end(); iterValue++, iterMask++) {
+                seed = seed * 1103515245 + 12345;
+                *iterValue = (seed % 4 == 0) ? casa::Float((seed >> 8) % 5) :
+                             casa::Float((seed >> 8) % 100000) / 1000.;
+                *iterMask = ((seed >> 4) % 7 != 0);
+            }
+            arr.setData(values, mask);
+        }
+
+        /// Compare with casacore's slidingArrayMath
+        void compare(const casa::IPosition &shape, const casa::IPosition &box,
+                     unsigned int nThreads)
+        {
+            casa::MaskedArray<casa::Float> input;
+            fill(input, shape);
+            casa::Array<casa::Float> median(shape, 0.), madfm(shape, 0.);
+            SlidingRobustStats stats(box, nThreads);
+            CPPUNIT_ASSERT(stats.canHandle(shape));
+            stats.calculate(input, median, madfm);
+
+            casa::Array<casa::Float> expMedian(shape, 0.), expMadfm(shape, 0.);
+            expMedian = slidingArrayMath(input, box, casa::MaskedMedianFunc<casa::Float>());
+            expMadfm = slidingArrayMath(input, box, casa::MaskedMadfmFunc<casa::Float>());
+            casa::Array<casa::Float>::const_iterator iterMedian(median.begin());
+            casa::Array<casa::Float>::const_iterator iterMadfm(madfm.begin());
+            casa::Array<casa::Float>::const_iterator iterExpMedian(expMedian.begin());
+            casa::Array<casa::Float>::const_iterator iterExpMadfm(expMadfm.begin());
+            for (; iterMedian != median.end(); iterMedian++, iterMadfm++,
+                    iterExpMedian++, iterExpMadfm++) {
+                CPPUNIT_ASSERT_DOUBLES_EQUAL(*iterExpMedian, *iterMedian, 1.e-5);
+                CPPUNIT_ASSERT_DOUBLES_EQUAL(*iterExpMadfm, *iterMadfm, 1.e-5);
+            }
+        }
+
+        void testSpatial()
+        {
+            compare(casa::IPosition(2, 30, 25), casa::IPosition(2, 3, 2), 1);
+        }
+
+        void testSpectral()
+        {
+            // One box per spectrum, as in a spectral search
+            compare(casa::IPosition(4, 3, 2, 60, 1), casa::IPosition(4, 0, 0, 5, 0), 1);
+        }
+
+        void testThreads()
+        {
+            compare(casa::IPosition(2, 30, 70), casa::IPosition(2, 2, 2), 3);
+            compare(casa::IPosition(4, 3, 2, 60, 1), casa::IPosition(4, 0, 0, 5, 0), 4);
+        }
+
+        void testBoxTooBig()
+        {
+            // All pixels are edge pixels
+            compare(casa::IPosition(2, 6, 6), casa::IPosition(2, 3, 3), 1);
+            // Only two axes can have a box
+            SlidingRobustStats stats(casa::IPosition(3, 1, 1, 1));
+            CPPUNIT_ASSERT(!stats.canHandle(casa::IPosition(3, 5, 5, 5)));
+            CPPUNIT_ASSERT(!stats.canHandle(casa::IPosition(2, 5, 5)));
+        }
+
+};
+
+}
+}
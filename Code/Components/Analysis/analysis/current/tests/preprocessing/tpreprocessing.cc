@@ -33,6 +33,7 @@
 // Test includes
 #include <SlidingMathTests.h>
 #include <MaskedSlidingMathTests.h>
+#include <SlidingRobustStatsTests.h>
 
 int main(int argc, char *argv[])
 {
@@ -49,6 +50,7 @@ int main(int argc, char *argv[])
         askapdev::testutils::AskapTestRunner runner(argv[0]);
         runner.addTest(askap::analysis::SlidingMathTest::suite());
         runner.addTest(askap::analysis::MaskedSlidingMathTest::suite());
+        runner.addTest(askap::analysis::SlidingRobustStatsTest::suite());
         bool wasSuccessful = runner.run();
 
         return wasSuccessful ? 0 : 1;
@@ -87,6 +87,7 @@ class RadioSourceTest : public CppUnit::TestFixture {
         CPPUNIT_TEST_SUITE(RadioSourceTest);
         CPPUNIT_TEST(findSource);
         CPPUNIT_TEST(sourceBox);
+        CPPUNIT_TEST(fitCost);
         CPPUNIT_TEST(findGaussSource);
         CPPUNIT_TEST(testShapeGaussSource);
         CPPUNIT_TEST(subthreshold);
@@ -220,6 +221,29 @@ class RadioSourceTest : public CppUnit::TestFixture {
 
         }
 
+        /*****************************************/
+        void fitCost()
+        {
+            // one fit type, one Gaussian, fitting to the detected pixels
+            const double size = itsSource.getSize();
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(size, itsSource.fitCost(), 1.e-6);
+
+            // 1+2+3 Gaussians, for each of two fit types
+            std::vector<std::string> types(1, "full");
+            types.push_back("psf");
+            itsFitparams.setFitTypes(types);
+            itsFitparams.setMaxNumGauss(3);
+            itsSource.setFitParams(itsFitparams);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(12. * size, itsSource.fitCost(), 1.e-6);
+
+            // fitting to the whole box
+            itsFitparams.setFlagFitJustDetection(false);
+            itsSource.setFitParams(itsFitparams);
+            itsSource.defineBox(itsSection, 2);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(12. * itsSource.boxSize(), itsSource.fitCost(), 1.e-6);
+            CPPUNIT_ASSERT(itsSource.boxSize() > size_t(size));
+        }
+
         /*****************************************/
         void findGaussSource()
         {
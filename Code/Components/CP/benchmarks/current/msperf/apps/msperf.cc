@@ -31,15 +31,19 @@
 #include <iostream>
 #include <string>
 #include <sstream>
+#include <vector>
 #include <mpi.h>
 
 // ASKAPsoft includes
+#include "boost/scoped_ptr.hpp"
 #include "CommandLineParser.h"
 #include "Common/ParameterSet.h"
 #include "casa/OS/Timer.h"
+#include "casa/BasicSL/Complex.h"
 
 // Local includes
 #include "writers/DataSet.h"
+#include "writers/AsyncWriter.h"
 
 // Using
 using LOFAR::ParameterSet;
@@ -91,26 +95,63 @@ int main(int argc, char *argv[])
     int intTime = subset.getInt32("integrationTime");
     int integrations = subset.getInt32("nIntegrations");
 
+    const bool async = subset.getBool("asyncwrite", false);
+    const unsigned int flushCadence = subset.getUint32("flushCadence", 0);
+
     DataSet data(filename, subset);
 
+    // In the asynchronous mode the integrations are handed off to a writer
+    // thread, as done by the ingest pipeline MSSink. The hand-off copies a
+    // buffer the size of one integration.
+    boost::scoped_ptr<AsyncWriter> writer;
+    std::vector<casa::Complex> vis;
+    if (async) {
+        const int nAnt = subset.getInt32("nAntenna");
+        const size_t nVis = static_cast<size_t>(subset.getInt32("nFeeds")) *
+            (nAnt * (nAnt + 1) / 2) * subset.getInt32("nChan") * subset.getInt32("nPol");
+        const unsigned int nBuffers = subset.getUint32("asyncBuffers", 2);
+        vis.resize(nVis);
+        writer.reset(new AsyncWriter(data, nBuffers, nVis, flushCadence));
+        if (rank == 0) {
+            std::cout << "Writing asynchronously with " << nBuffers
+                << " buffer(s) of " << nVis << " visibilities" << std::endl;
+        }
+    }
+
     casa::Timer timer;
     casa::Timer total;
     total.mark();
     for (int i = 0; i < integrations; ++i) {
         timer.mark();
-        data.add();
+        if (writer) {
+            writer->add(vis);
+        } else {
+            data.add();
+            if (flushCadence > 0 && (i + 1) % flushCadence == 0) {
+                data.flush();
+            }
+        }
         MPI_Barrier(MPI_COMM_WORLD);
 
         // Report progress
         if (rank == 0) {
             const float realtime = timer.real();
             const float perf = static_cast<float>(intTime) / realtime;
-            std::cout << "Wrote integration " << i <<
-            " in " << realtime << " seconds"
+            std::cout << (writer ? "Handed off integration " : "Wrote integration ")
+            << i << " in " << realtime << " seconds"
             << " (" << perf << "x requirement)" << std::endl;
         }
     }
 
+    // Wait for the writer thread to catch up, so the total is the
+    // sustained rate
+    if (writer) {
+        writer->finish();
+    } else {
+        data.flush();
+    }
+    MPI_Barrier(MPI_COMM_WORLD);
+
     // Report totals
     if (rank == 0) {
         const float realtime = total.real();
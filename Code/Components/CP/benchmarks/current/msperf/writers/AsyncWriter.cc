@@ -0,0 +1,115 @@
+/// @file AsyncWriter.cc
+///
+/// @copyright (c) 2015 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+
+// Include own header file first
+#include "AsyncWriter.h"
+
+// System includes
+#include <algorithm>
+#include <vector>
+
+// ASKAPsoft includes
+#include "boost/bind.hpp"
+
+AsyncWriter::AsyncWriter(DataSet& data, unsigned int nBuffers, size_t bufferSize,
+        unsigned int flushCadence)
+    : itsData(data), itsFlushCadence(flushCadence),
+    itsBuffers(std::max(nBuffers, 1u), std::vector<casa::Complex>(bufferSize)),
+    itsFinished(false),
+    itsThread(boost::bind(&AsyncWriter::run, this))
+{
+    // The thread only waits on itsFull, so it is safe to fill the free list
+    // after it has started
+    boost::mutex::scoped_lock lock(itsMutex);
+    for (size_t i = 0; i < itsBuffers.size(); ++i) {
+        itsFree.push_back(i);
+    }
+}
+
+AsyncWriter::~AsyncWriter()
+{
+    finish();
+}
+
+void AsyncWriter::add(const std::vector<casa::Complex>& vis)
+{
+    boost::mutex::scoped_lock lock(itsMutex);
+    while (itsFree.empty()) {
+        itsCondVar.wait(lock);
+    }
+    const size_t buf = itsFree.front();
+    itsFree.pop_front();
+
+    // Nobody else touches a buffer which is in neither list
+    lock.unlock();
+    std::copy(vis.begin(), vis.end(), itsBuffers[buf].begin());
+    lock.lock();
+
+    itsFull.push_back(buf);
+    lock.unlock();
+    itsCondVar.notify_all();
+}
+
+void AsyncWriter::finish(void)
+{
+    {
+        boost::mutex::scoped_lock lock(itsMutex);
+        itsFinished = true;
+    }
+    itsCondVar.notify_all();
+    if (itsThread.joinable()) {
+        itsThread.join();
+    }
+}
+
+void AsyncWriter::run(void)
+{
+    unsigned int unflushed = 0;
+    while (true) {
+        boost::mutex::scoped_lock lock(itsMutex);
+        while (itsFull.empty() && !itsFinished) {
+            itsCondVar.wait(lock);
+        }
+        if (itsFull.empty()) {
+            break;
+        }
+        const size_t buf = itsFull.front();
+        itsFull.pop_front();
+        lock.unlock();
+
+        itsData.add();
+        ++unflushed;
+        if (itsFlushCadence > 0 && unflushed >= itsFlushCadence) {
+            itsData.flush();
+            unflushed = 0;
+        }
+
+        lock.lock();
+        itsFree.push_back(buf);
+        lock.unlock();
+        itsCondVar.notify_all();
+    }
+    itsData.flush();
+}
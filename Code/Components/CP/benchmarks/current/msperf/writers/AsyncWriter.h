@@ -0,0 +1,88 @@
+/// @file AsyncWriter.h
+///
+/// @copyright (c) 2015 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+
+#ifndef ASYNCWRITER_H
+#define ASYNCWRITER_H
+
+// System includes
+#include <deque>
+#include <vector>
+
+// ASKAPsoft includes
+#include "boost/thread/thread.hpp"
+#include "boost/thread/mutex.hpp"
+#include "boost/thread/condition.hpp"
+#include "casa/aips.h"
+#include "casa/BasicSL/Complex.h"
+
+// Local includes
+#include "DataSet.h"
+
+/// Mimics the asynchronous mode of the ingest pipeline MSSink: add() copies
+/// an integration into one of a fixed number of buffers and returns, while
+/// a writer thread writes the buffered integrations to the DataSet. add()
+/// only blocks when all buffers are waiting to be written.
+/// The DataSet still writes its own synthetic visibilities, the copy into
+/// the buffer is there to account for the cost of the hand-off.
+class AsyncWriter
+{
+    public:
+        /// @param[in] data         the dataset to write to
+        /// @param[in] nBuffers     number of integrations that can be buffered
+        /// @param[in] bufferSize   number of visibilities in an integration
+        /// @param[in] flushCadence flush the dataset every this many
+        ///                         integrations (zero for never)
+        AsyncWriter(DataSet& data, unsigned int nBuffers, size_t bufferSize,
+                unsigned int flushCadence);
+
+        /// Waits for the buffered integrations to be written
+        ~AsyncWriter();
+
+        /// Hand off an integration to the writer thread
+        void add(const std::vector<casa::Complex>& vis);
+
+        /// Wait for the buffered integrations to be written
+        void finish(void);
+
+    private:
+        void run(void);
+
+        DataSet& itsData;
+        const unsigned int itsFlushCadence;
+
+        std::vector< std::vector<casa::Complex> > itsBuffers;
+
+        // Indices of the buffers which are free, and of those waiting to be
+        // written (in order)
+        std::deque<size_t> itsFree;
+        std::deque<size_t> itsFull;
+        bool itsFinished;
+
+        boost::mutex itsMutex;
+        boost::condition itsCondVar;
+        boost::thread itsThread;
+};
+
+#endif
@@ -147,6 +147,11 @@ void DataSet::add(void)
     pointingc.targetMeasCol().put(pointingRow, direction);
 }
 
+void DataSet::flush(void)
+{
+    itsMs->flush();
+}
+
 void DataSet::create(const std::string& filename)
 {
     int bucketSize = itsParset.getInt32("stman.bucketsize");
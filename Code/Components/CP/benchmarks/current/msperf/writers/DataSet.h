@@ -42,6 +42,8 @@ class DataSet
 
         void add(void);
 
+        void flush(void);
+
     private:
         void create(const std::string& filename);
         void initAnt(void);
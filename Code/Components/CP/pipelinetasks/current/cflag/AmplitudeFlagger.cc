@@ -111,12 +111,18 @@ casa::Vector<casa::Int> AmplitudeFlagger::getStokesType(
     return polc.corrType()(descPolId);
 }
 
-void AmplitudeFlagger::processRow(casa::MSColumns& msc, const casa::uInt pass,
-                                  const casa::uInt row, const bool dryRun)
+casa::Bool AmplitudeFlagger::dataRequired(const casa::uInt pass)
 {
-    const Matrix<casa::Complex> data = msc.data()(row);
-    Matrix<casa::Bool> flags = msc.flag()(row);
+    // The second pass only applies the flags derived from the integrations
+    return (pass==0);
+}
 
+casa::Bool AmplitudeFlagger::processRow(casa::MSColumns& msc, const casa::uInt pass,
+                                        const casa::uInt row,
+                                        const casa::Matrix<casa::Complex>& data,
+                                        casa::Matrix<casa::Bool>& flags,
+                                        casa::Bool& rowFlag)
+{
     // Only need to write out the flag matrix if it was updated
     bool wasUpdated = false;
     // Only set flagRow if all corr are flagged
@@ -133,7 +139,7 @@ void AmplitudeFlagger::processRow(casa::MSColumns& msc, const casa::uInt pass,
     }
 
     // Iterate over rows (one row is one correlation product)
-    for (size_t corr = 0; corr < data.nrow(); ++corr) {
+    for (size_t corr = 0; corr < flags.nrow(); ++corr) {
 
         // If this row doesn't contain a product we are meant to be flagging,
         // then ignore it
@@ -156,17 +162,13 @@ void AmplitudeFlagger::processRow(casa::MSColumns& msc, const casa::uInt pass,
         // if this is the first instance of this key, initialise storage vectors
         if ( itsIntegrateSpectra && (pass==0) &&
                (itsAveSpectra.find(key) == itsAveSpectra.end()) ) {
-            initSpectrumVectors(key, data.row(0).shape());
+            initSpectrumVectors(key, flags.row(0).shape());
         }
 
         // need temporary indicators that can be updated if necessary
         bool hasLowLimit = itsHasLowLimit;
         bool hasHighLimit = itsHasHighLimit;
 
-        // get the spectrum
-        casa::Vector<casa::Float>
-            spectrumAmplitudes = casa::amplitude(data.row(corr));
-
         // set a mask (only needed when averaging, so move this if need be)
         casa::Vector<casa::Bool>
             unflaggedMask = (flags.row(corr)==casa::False);
@@ -175,7 +177,7 @@ void AmplitudeFlagger::processRow(casa::MSColumns& msc, const casa::uInt pass,
             // check that there is something to flag and continue if there isn't
             if (std::find(unflaggedMask.begin(),
                      unflaggedMask.end(), casa::True) == unflaggedMask.end()) {
-                itsStats.visAlreadyFlagged += data.ncolumn();
+                itsStats.visAlreadyFlagged += flags.ncolumn();
                 if ( itsIntegrateTimes ) {
                    itsMaskTimes[key][itsCountTimes[key]] = casa::False;
                 }
@@ -187,6 +189,10 @@ void AmplitudeFlagger::processRow(casa::MSColumns& msc, const casa::uInt pass,
         // could change this
         if ( pass==0 ) {
 
+            // get the spectrum
+            const casa::Vector<casa::Float>
+                spectrumAmplitudes = casa::amplitude(data.row(corr));
+
             if ( itsAutoThresholds ) {
          
                 // combine amplitudes with mask and get the median-based statistics
@@ -224,7 +230,7 @@ void AmplitudeFlagger::processRow(casa::MSColumns& msc, const casa::uInt pass,
             casa::uInt countTime = 0;
 
             // look for individual peaks and do any integrations
-            for (size_t chan = 0; chan < data.ncolumn(); ++chan) {
+            for (size_t chan = 0; chan < flags.ncolumn(); ++chan) {
                 if (flags(corr, chan)) {
                     itsStats.visAlreadyFlagged++;
                     continue;
@@ -274,7 +280,7 @@ void AmplitudeFlagger::processRow(casa::MSColumns& msc, const casa::uInt pass,
                 // apply itsMaskTimes flags. Could just use flagRow,
                 // but not sure that all applications support flagRow
                 if ( !itsMaskTimes[key][itsCountTimes[key]] ) {
-                    for (size_t chan = 0; chan < data.ncolumn(); ++chan) {
+                    for (size_t chan = 0; chan < flags.ncolumn(); ++chan) {
                         if (flags(corr, chan)) continue;
                             flags(corr, chan) = true;
                             wasUpdated = true;
@@ -288,7 +294,7 @@ void AmplitudeFlagger::processRow(casa::MSColumns& msc, const casa::uInt pass,
             }
             // apply itsIntegrateSpectra flags
             if ( itsIntegrateSpectra ) {
-                for (size_t chan = 0; chan < data.ncolumn(); ++chan) {
+                for (size_t chan = 0; chan < flags.ncolumn(); ++chan) {
                     if ( !flags(corr, chan) && !itsMaskSpectra[key][chan] ) {
                         flags(corr, chan) = true;
                         wasUpdated = true;
@@ -302,13 +308,9 @@ void AmplitudeFlagger::processRow(casa::MSColumns& msc, const casa::uInt pass,
 
     if (wasUpdated && itsIntegrateTimes && !leaveRowFlag && (pass==1)) {
         itsStats.rowsFlagged++;
-        if (!dryRun) {
-            msc.flagRow().put(row, true);
-        }
-    }
-    if (wasUpdated && !dryRun) {
-        msc.flag().put(row, flags);
+        rowFlag = true;
     }
+    return wasUpdated;
 }
 
 
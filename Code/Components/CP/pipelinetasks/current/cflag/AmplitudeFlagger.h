@@ -41,6 +41,7 @@
 #include "ms/MeasurementSets/MSColumns.h"
 #include "measures/Measures/Stokes.h"
 #include "casa/Arrays/Vector.h"
+#include "casa/Arrays/Matrix.h"
 
 // Local package includes
 #include "cflag/IFlagger.h"
@@ -71,8 +72,11 @@ class AmplitudeFlagger : public IFlagger {
         AmplitudeFlagger(const LOFAR::ParameterSet& parset);
 
         /// @see IFlagger::processRow()
-        virtual void processRow(casa::MSColumns& msc, const casa::uInt pass,
-                                const casa::uInt row, const bool dryRun);
+        virtual casa::Bool processRow(casa::MSColumns& msc, const casa::uInt pass,
+                                      const casa::uInt row,
+                                      const casa::Matrix<casa::Complex>& data,
+                                      casa::Matrix<casa::Bool>& flags,
+                                      casa::Bool& rowFlag);
 
         /// @see IFlagger::stats()
         virtual FlaggingStats stats(void) const;
@@ -80,6 +84,9 @@ class AmplitudeFlagger : public IFlagger {
         /// @see IFlagger::stats()
         virtual casa::Bool processingRequired(const casa::uInt pass);
 
+        /// @see IFlagger::dataRequired()
+        virtual casa::Bool dataRequired(const casa::uInt pass);
+
     private:
         // load and log relevant parset parameters
         void loadParset(const LOFAR::ParameterSet& parset);
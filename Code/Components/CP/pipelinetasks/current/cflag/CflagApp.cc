@@ -33,6 +33,7 @@
 // System includes
 #include <string>
 #include <iomanip>
+#include <algorithm>
 
 // ASKAPsoft includes
 #include "askap/AskapLogging.h"
@@ -41,6 +42,11 @@
 #include "Common/ParameterSet.h"
 #include "askap/StatReporter.h"
 #include "casa/aipstype.h"
+#include "casa/Arrays/Cube.h"
+#include "casa/Arrays/Matrix.h"
+#include "casa/Arrays/Vector.h"
+#include "casa/Arrays/Slicer.h"
+#include "casa/Containers/Record.h"
 #include "ms/MeasurementSets/MeasurementSet.h"
 #include "ms/MeasurementSets/MSColumns.h"
 
@@ -87,28 +93,35 @@ int CflagApp::run(int argc, char* argv[])
         ASKAPLOG_INFO_STR(logger, "!!!!! DRY RUN ONLY - MeasurementSet will not be updated !!!!!");
     }
 
-    // Iterate over each row in the main table
+    // Iterate over the main table in blocks of rows
     const casa::uInt nRows = msc.nrow();
+    const casa::uInt maxRows = rowsPerBlock(subset, ms, msc);
+    ASKAPLOG_INFO_STR(logger, "Reading up to " << maxRows << " rows at a time");
+    const casa::uInt cacheSize = 64 * 1024 * 1024;
+    msc.data().setMaximumCacheSize(cacheSize);
+    msc.flag().setMaximumCacheSize(cacheSize);
+
     std::vector< boost::shared_ptr<IFlagger> >::iterator it;
     unsigned long rowsAlreadyFlagged = 0;
     casa::Bool passRequired = casa::True;
     casa::uInt pass = 0;
     while (passRequired) {
-        for (casa::uInt i = 0; i < nRows; ++i) {
-            if (!msc.flagRow()(i)) {
-                // Invoke each flagger for this row, but only while the row isn't flagged
-                for (it = flaggers.begin(); it != flaggers.end(); ++it) {
-                    if (msc.flagRow()(i)) {
-                        break;
-                    }
-                    if ((*it)->processingRequired(pass)) {
-                        (*it)->processRow(msc, pass, i, dryRun);
-                    }
-                }
-            } else {
-                rowsAlreadyFlagged++;
+        // Only read the visibilities if a flagger needs them in this pass
+        bool readData = false;
+        for (it = flaggers.begin(); it != flaggers.end(); ++it) {
+            if ((*it)->processingRequired(pass) && (*it)->dataRequired(pass)) {
+                readData = true;
             }
         }
+        ASKAPLOG_INFO_STR(logger, "Starting pass " << pass + 1
+                << (readData ? "" : " (flags only)"));
+
+        casa::uInt row = 0;
+        while (row < nRows) {
+            row += processBlock(msc, flaggers, pass, row,
+                    std::min(maxRows, nRows - row), readData, dryRun,
+                    rowsAlreadyFlagged);
+        }
         pass++;
         passRequired = casa::False;
         for (it = flaggers.begin(); it != flaggers.end(); ++it) {
@@ -136,3 +149,114 @@ int CflagApp::run(int argc, char* argv[])
     stats.logSummary();
     return 0;
 }
+
+casa::uInt CflagApp::processBlock(casa::MSColumns& msc,
+                                  std::vector< boost::shared_ptr<IFlagger> >& flaggers,
+                                  const casa::uInt pass,
+                                  const casa::uInt startRow,
+                                  const casa::uInt maxRows,
+                                  const bool readData,
+                                  const bool dryRun,
+                                  unsigned long& rowsAlreadyFlagged)
+{
+    ASKAPDEBUGASSERT(maxRows > 0);
+
+    // Limit the block to rows with the same data description, so the
+    // arrays can be read as a single cube
+    const casa::Vector<casa::Int> dataDescId = msc.dataDescId().getColumnRange(
+            Slicer(IPosition(1, startRow), IPosition(1, maxRows), Slicer::endIsLength));
+    casa::uInt nRows = 1;
+    while (nRows < maxRows && dataDescId(nRows) == dataDescId(0)) {
+        ++nRows;
+    }
+    const Slicer rowSlicer(IPosition(1, startRow), IPosition(1, nRows),
+            Slicer::endIsLength);
+
+    // Read the block
+    casa::Vector<casa::Bool> rowFlags = msc.flagRow().getColumnRange(rowSlicer);
+    casa::Cube<casa::Bool> flags = msc.flag().getColumnRange(rowSlicer);
+    casa::Cube<casa::Complex> data;
+    if (readData) {
+        data = msc.data().getColumnRange(rowSlicer);
+    }
+
+    // Apply all the flaggers to each row
+    std::vector< boost::shared_ptr<IFlagger> >::iterator it;
+    bool wasUpdated = false;
+    const casa::Matrix<casa::Complex> noData;
+    for (casa::uInt i = 0; i < nRows; ++i) {
+        if (rowFlags(i)) {
+            rowsAlreadyFlagged++;
+            continue;
+        }
+        casa::Matrix<casa::Bool> rowFlag = flags.xyPlane(i);
+        const casa::Matrix<casa::Complex> rowData = readData ? data.xyPlane(i) : noData;
+
+        // Invoke each flagger for this row, but only while the row isn't flagged
+        for (it = flaggers.begin(); it != flaggers.end(); ++it) {
+            if (rowFlags(i)) {
+                break;
+            }
+            if ((*it)->processingRequired(pass)) {
+                if ((*it)->processRow(msc, pass, startRow + i, rowData, rowFlag, rowFlags(i))) {
+                    wasUpdated = true;
+                }
+            }
+        }
+    }
+
+    // Write the flags back
+    if (wasUpdated && !dryRun) {
+        msc.flag().putColumnRange(rowSlicer, flags);
+        msc.flagRow().putColumnRange(rowSlicer, rowFlags);
+    }
+    return nRows;
+}
+
+casa::uInt CflagApp::rowsPerBlock(const LOFAR::ParameterSet& parset,
+                                  const casa::MeasurementSet& ms,
+                                  casa::MSColumns& msc)
+{
+    if (parset.isDefined("rowsPerBlock")) {
+        return std::max(1u, parset.getUint32("rowsPerBlock"));
+    }
+    if (msc.nrow() == 0) {
+        return 1;
+    }
+
+    // Fit the visibilities and flags into a 32MB buffer
+    const casa::IPosition shape = msc.data().shape(0);
+    const size_t bytesPerRow = shape.product() * (sizeof(casa::Complex) + sizeof(casa::Bool));
+    casa::uInt nRows = std::max(size_t(1), (32 * 1024 * 1024) / std::max(size_t(1), bytesPerRow));
+
+    // Read whole tiles if possible
+    const casa::uInt tileRows = dataTileRows(ms);
+    if (tileRows > 0 && nRows > tileRows) {
+        nRows -= nRows % tileRows;
+    }
+    return nRows;
+}
+
+casa::uInt CflagApp::dataTileRows(const casa::MeasurementSet& ms)
+{
+    const casa::Record dminfo = ms.dataManagerInfo();
+    for (casa::uInt i = 0; i < dminfo.nfields(); ++i) {
+        const casa::Record dm = dminfo.subRecord(i);
+        if (!dm.isDefined("COLUMNS") || !dm.isDefined("SPEC")) {
+            continue;
+        }
+        const casa::Vector<casa::String> columns = dm.asArrayString("COLUMNS");
+        if (std::find(columns.begin(), columns.end(), "DATA") == columns.end()) {
+            continue;
+        }
+        const casa::Record spec = dm.subRecord("SPEC");
+        if (spec.isDefined("DEFAULTTILESHAPE") &&
+                spec.dataType("DEFAULTTILESHAPE") == casa::TpArrayInt) {
+            const casa::Vector<casa::Int> tileShape = spec.asArrayInt("DEFAULTTILESHAPE");
+            if (tileShape.size() > 0 && tileShape(tileShape.size() - 1) > 0) {
+                return tileShape(tileShape.size() - 1);
+            }
+        }
+    }
+    return 0;
+}
@@ -27,20 +27,70 @@
 #ifndef ASKAP_CP_PIPELINETASKS_CFLAGAPP_H
 #define ASKAP_CP_PIPELINETASKS_CFLAGAPP_H
 
+// System includes
+#include <vector>
+
 // ASKAPsoft includes
 #include "askap/Application.h"
+#include "boost/shared_ptr.hpp"
+#include "Common/ParameterSet.h"
+#include "casa/aipstype.h"
+#include "ms/MeasurementSets/MeasurementSet.h"
+#include "ms/MeasurementSets/MSColumns.h"
 
 // Local package includes
+#include "cflag/IFlagger.h"
 
 namespace askap {
 namespace cp {
 namespace pipelinetasks {
 
 /// @brief Implementation of the Cflag application
+/// @details The main table is processed in blocks of rows. The visibilities
+/// and flags of a block are read with a single access per column, all
+/// flaggers are applied to the rows held in memory, then the flags are
+/// written back in bulk. The visibilities are only read in the passes where
+/// at least one flagger needs them.
 class CflagApp : public askap::Application {
     public:
         /// Run the application
         virtual int run(int argc, char* argv[]);
+
+    private:
+        /// Process a block of rows with all the flaggers requiring this pass.
+        /// The block is shortened if needed, so that all its rows have the same
+        /// data description (and therefore the same shape).
+        ///
+        /// @param[in,out] msc  the measurement set columns
+        /// @param[in] flaggers the flaggers to apply
+        /// @param[in] pass     number of passes over the data already performed
+        /// @param[in] startRow the first row of the block
+        /// @param[in] maxRows  the maximum number of rows in the block
+        /// @param[in] readData true if the visibilities have to be read
+        /// @param[in] dryRun   if true the measurement set is not modified
+        /// @param[in,out] rowsAlreadyFlagged   incremented by the number of rows
+        ///                                     flagged before this pass
+        /// @return the number of rows processed
+        static casa::uInt processBlock(casa::MSColumns& msc,
+                                       std::vector< boost::shared_ptr<IFlagger> >& flaggers,
+                                       const casa::uInt pass,
+                                       const casa::uInt startRow,
+                                       const casa::uInt maxRows,
+                                       const bool readData,
+                                       const bool dryRun,
+                                       unsigned long& rowsAlreadyFlagged);
+
+        /// Returns the number of rows to read at once. This is either given
+        /// by the "rowsPerBlock" parameter, or chosen to fit the visibilities
+        /// and flags into a 32MB buffer. If the data column is tiled, the
+        /// number of rows is a multiple of the number of rows per tile.
+        static casa::uInt rowsPerBlock(const LOFAR::ParameterSet& parset,
+                                       const casa::MeasurementSet& ms,
+                                       casa::MSColumns& msc);
+
+        /// Returns the number of rows per tile of the data column, or zero if
+        /// it is not stored with a tiled storage manager.
+        static casa::uInt dataTileRows(const casa::MeasurementSet& ms);
 };
 
 }
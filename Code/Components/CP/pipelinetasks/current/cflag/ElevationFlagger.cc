@@ -86,6 +86,11 @@ casa::Bool ElevationFlagger::processingRequired(const casa::uInt pass)
     return (pass==0);
 }
 
+casa::Bool ElevationFlagger::dataRequired(const casa::uInt)
+{
+    return casa::False;
+}
+
 void ElevationFlagger::updateElevations(casa::MSColumns& msc,
                                          const casa::uInt row)
 {
@@ -117,8 +122,11 @@ void ElevationFlagger::updateElevations(casa::MSColumns& msc,
     itsTimeElevCalculated = msc.time()(row);
 }
 
-void ElevationFlagger::processRow(casa::MSColumns& msc, const casa::uInt pass,
-                                  const casa::uInt row, const bool dryRun)
+casa::Bool ElevationFlagger::processRow(casa::MSColumns& msc, const casa::uInt pass,
+                                        const casa::uInt row,
+                                        const casa::Matrix<casa::Complex>& /*data*/,
+                                        casa::Matrix<casa::Bool>& flags,
+                                        casa::Bool& rowFlag)
 {
     // 1: If new timestamp then update the antenna elevations
     const casa::Double epsilon = std::numeric_limits<casa::Double>::epsilon();
@@ -134,20 +142,17 @@ void ElevationFlagger::processRow(casa::MSColumns& msc, const casa::uInt pass,
             itsAntennaElevations(ant1) > itsHighLimit ||
             itsAntennaElevations(ant2) > itsHighLimit)
     {
-        flagRow(msc, row, dryRun);
+        flagRow(flags, rowFlag);
+        return casa::True;
     }
+    return casa::False;
 }
 
-void ElevationFlagger::flagRow(casa::MSColumns& msc, const casa::uInt row, const bool dryRun)
+void ElevationFlagger::flagRow(casa::Matrix<casa::Bool>& flags, casa::Bool& rowFlag)
 {
-    Matrix<casa::Bool> flags = msc.flag()(row);
     flags = true;
+    rowFlag = true;
 
     itsStats.visFlagged += flags.size();
     itsStats.rowsFlagged++;
-
-    if (!dryRun) {
-        msc.flagRow().put(row, true);
-        msc.flag().put(row, flags);
-    }
 }
@@ -63,8 +63,11 @@ class ElevationFlagger : public IFlagger {
         ElevationFlagger(const LOFAR::ParameterSet& parset);
 
         /// @see IFlagger::processRow()
-        virtual void processRow(casa::MSColumns& msc, const casa::uInt pass,
-                                const casa::uInt row, const bool dryRun);
+        virtual casa::Bool processRow(casa::MSColumns& msc, const casa::uInt pass,
+                                      const casa::uInt row,
+                                      const casa::Matrix<casa::Complex>& data,
+                                      casa::Matrix<casa::Bool>& flags,
+                                      casa::Bool& rowFlag);
 
         /// @see IFlagger::stats()
         virtual FlaggingStats stats(void) const;
@@ -72,6 +75,9 @@ class ElevationFlagger : public IFlagger {
         /// @see IFlagger::stats()
         virtual casa::Bool processingRequired(const casa::uInt pass);
 
+        /// @see IFlagger::dataRequired()
+        virtual casa::Bool dataRequired(const casa::uInt pass);
+
     private:
 
         // Elevations are cached in "itsAntennaElevations" for a given timestamp
@@ -80,7 +86,7 @@ class ElevationFlagger : public IFlagger {
 
         // Utility method to flag the current row. Both the ROWFLAG and FLAG
         // data are set.
-        void flagRow(casa::MSColumns& msc, const casa::uInt row, const bool dryRun);
+        void flagRow(casa::Matrix<casa::Bool>& flags, casa::Bool& rowFlag);
 
         // Flagging statistics
         FlaggingStats itsStats;
@@ -30,6 +30,8 @@
 // ASKAPsoft includes
 #include "ms/MeasurementSets/MSColumns.h"
 #include "casa/aipstype.h"
+#include "casa/BasicSL/Complex.h"
+#include "casa/Arrays/Matrix.h"
 #include "boost/tuple/tuple.hpp"
 #include "boost/tuple/tuple_comparison.hpp"
 
@@ -51,16 +53,27 @@ class IFlagger {
         virtual ~IFlagger();
 
         /// Perform flagging (if necessary) for the row with index "row".
+        /// The visibilities and flags are not read from or written to the
+        /// measurement set by the flagger. The caller reads them in blocks
+        /// of rows, and writes the flags back once all flaggers have
+        /// processed the block.
         ///
-        /// @param[in,out] msc  the masurement set columns that contain the data
-        ///                     and flagging arrays
+        /// @param[in] msc      the masurement set columns, used to access
+        ///                     the other (i.e. metadata) columns of the row
+        /// @param[in] pass     number of passes over the data already performed
         /// @param[in] row      the (zero-based) index number for the row in
         ///                     msc to be processed.
-        /// @param[in] dryRun   if true the measurement set will not be modified,
-        ///                     however statistics will be calculated indicating
-        ///                     what flagging would have been done.
-        virtual void processRow(casa::MSColumns& msc, const casa::uInt pass,
-                                const casa::uInt row, const bool dryRun) = 0;
+        /// @param[in] data     the visibilities (nCorr x nChan) of this row. This
+        ///                     is empty if dataRequired(pass) is false.
+        /// @param[in,out] flags    the flags (nCorr x nChan) of this row, these
+        ///                         are updated in place
+        /// @param[in,out] rowFlag  the row flag, this is updated in place
+        /// @return true if the flags or the row flag have been modified
+        virtual casa::Bool processRow(casa::MSColumns& msc, const casa::uInt pass,
+                                      const casa::uInt row,
+                                      const casa::Matrix<casa::Complex>& data,
+                                      casa::Matrix<casa::Bool>& flags,
+                                      casa::Bool& rowFlag) = 0;
 
         /// Returns flagging statistics
         virtual FlaggingStats stats(void) const = 0;
@@ -69,6 +82,12 @@ class IFlagger {
         /// @param[in] pass     number of passes over the data already performed
         virtual casa::Bool processingRequired(const casa::uInt pass) = 0;
 
+        /// Indicates whether the visibilities are needed by processRow(). If
+        /// no flagger needs them for a given pass, the (large) data column is
+        /// not read at all during that pass.
+        /// @param[in] pass     number of passes over the data already performed
+        virtual casa::Bool dataRequired(const casa::uInt pass) = 0;
+
 };
 
 }
@@ -150,23 +150,34 @@ casa::Bool SelectionFlagger::processingRequired(const casa::uInt pass)
     return (pass==0);
 }
 
-void SelectionFlagger::processRow(casa::MSColumns& msc, const casa::uInt pass,
-                                  const casa::uInt row, const bool dryRun)
+casa::Bool SelectionFlagger::dataRequired(const casa::uInt)
+{
+    return casa::False;
+}
+
+casa::Bool SelectionFlagger::processRow(casa::MSColumns& msc, const casa::uInt pass,
+                                        const casa::uInt row,
+                                        const casa::Matrix<casa::Complex>& /*data*/,
+                                        casa::Matrix<casa::Bool>& flags,
+                                        casa::Bool& rowFlag)
 {
     const bool rowCriteriaMatches = dispatch(itsRowCriteria, msc, row);
+    bool wasUpdated = false;
 
     // 1: Handle the case where all row criteria match and no detailed criteria
     // exists
     if (rowCriteriaMatches && !itsDetailedCriteriaExists) {
-        flagRow(msc, row, dryRun);
+        flagRow(flags, rowFlag);
+        wasUpdated = true;
     }
 
     // 2: Handle the case where there is no row criteria, but there is detailed
     // criteria. Or, where the row criteria exists and match.
     if ((itsRowCriteria.empty() && itsDetailedCriteriaExists)
             || (rowCriteriaMatches && itsDetailedCriteriaExists)) {
-        checkDetailed(msc, row, dryRun);
+        wasUpdated = checkDetailed(msc, row, flags) || wasUpdated;
     }
+    return wasUpdated;
 }
 
 bool SelectionFlagger::checkBaseline(casa::MSColumns& msc, const casa::uInt row)
@@ -284,15 +295,16 @@ bool SelectionFlagger::dispatch(const std::vector<SelectionCriteria>& v,
     return true;
 }
 
-void SelectionFlagger::checkDetailed(casa::MSColumns& msc, const casa::uInt row, const bool dryRun)
+bool SelectionFlagger::checkDetailed(casa::MSColumns& msc, const casa::uInt row,
+                                     casa::Matrix<casa::Bool>& flags)
 {
     const Matrix<casa::Int> chanList = itsSelection.getChanList();
     if (chanList.empty()) {
         ASKAPLOG_DEBUG_STR(logger, "Channel flagging list is EMPTY");
-        return;
+        return false;
     }
     ASKAPCHECK(chanList.ncolumn() == 4, "Expected four columns");
-    Matrix<casa::Bool> flags = msc.flag()(row);
+    bool wasUpdated = false;
 
     const casa::ROMSDataDescColumns& ddc = msc.dataDescription();
 
@@ -318,24 +330,17 @@ void SelectionFlagger::checkDetailed(casa::MSColumns& msc, const casa::uInt row,
                 flags(pol, chan) = true;
                 itsStats.visFlagged++;
             }
+            wasUpdated = true;
         }
     }
-
-    if (!dryRun) {
-        msc.flag().put(row, flags);
-    }
+    return wasUpdated;
 }
 
-void SelectionFlagger::flagRow(casa::MSColumns& msc, const casa::uInt row, const bool dryRun)
+void SelectionFlagger::flagRow(casa::Matrix<casa::Bool>& flags, casa::Bool& rowFlag)
 {
-    Matrix<casa::Bool> flags = msc.flag()(row);
     flags = true;
+    rowFlag = true;
 
     itsStats.visFlagged += flags.size();
     itsStats.rowsFlagged++;
-
-    if (!dryRun) {
-        msc.flagRow().put(row, true);
-        msc.flag().put(row, flags);
-    }
 }
@@ -77,8 +77,11 @@ class SelectionFlagger : public IFlagger {
                           const casa::MeasurementSet& ms);
 
         /// @see IFlagger::processRow()
-        virtual void processRow(casa::MSColumns& msc, const casa::uInt pass,
-                                const casa::uInt row, const bool dryRun);
+        virtual casa::Bool processRow(casa::MSColumns& msc, const casa::uInt pass,
+                                      const casa::uInt row,
+                                      const casa::Matrix<casa::Complex>& data,
+                                      casa::Matrix<casa::Bool>& flags,
+                                      casa::Bool& rowFlag);
 
         /// @see IFlagger::stats()
         virtual FlaggingStats stats(void) const;
@@ -86,6 +89,9 @@ class SelectionFlagger : public IFlagger {
         /// @see IFlagger::stats()
         virtual casa::Bool processingRequired(const casa::uInt pass);
 
+        /// @see IFlagger::dataRequired()
+        virtual casa::Bool dataRequired(const casa::uInt pass);
+
     private:
         enum SelectionCriteria {
             BASELINE,
@@ -106,11 +112,12 @@ class SelectionFlagger : public IFlagger {
         bool dispatch(const std::vector<SelectionCriteria>& v,
                       casa::MSColumns& msc, const casa::uInt row);
 
-        void checkDetailed(casa::MSColumns& msc, const casa::uInt row,
-                           const bool dryRun);
+        // Returns true if any flags were set
+        bool checkDetailed(casa::MSColumns& msc, const casa::uInt row,
+                           casa::Matrix<casa::Bool>& flags);
 
         // Sets the row flag to true, and also sets the flag true for each visibility
-        void flagRow(casa::MSColumns& msc, const casa::uInt row, const bool dryRun);
+        void flagRow(casa::Matrix<casa::Bool>& flags, casa::Bool& rowFlag);
 
         // Flagging statistics
         FlaggingStats itsStats;
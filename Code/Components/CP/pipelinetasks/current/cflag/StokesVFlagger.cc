@@ -142,33 +142,18 @@ casa::StokesConverter& StokesVFlagger::getStokesConverter(
     return itsConverterCache[polId];
 }
 
-void StokesVFlagger::processRow(casa::MSColumns& msc, const casa::uInt pass,
-                                const casa::uInt row, const bool dryRun)
+casa::Bool StokesVFlagger::dataRequired(const casa::uInt pass)
 {
-    // Get a description of what correlation products are in the data table.
-    const casa::ROMSDataDescColumns& ddc = msc.dataDescription();
-    const casa::Int dataDescId = msc.dataDescId()(row);
-    const casa::Int polId = ddc.polarizationId()(dataDescId);
-
-    // Get the (potentially cached) stokes converter
-    const StokesConverter& stokesconv = getStokesConverter(msc.polarization(), polId);
-
-    // Convert data to Stokes V (imag(data(2,i))-imag(data(3,i)))
-    const Matrix<casa::Complex> data = msc.data()(row);
-    casa::Matrix<casa::Complex> vmatrix(1, data.ncolumn());
-    stokesconv.convert(vmatrix, data);
-    casa::Vector<casa::Complex> vdata = vmatrix.row(0);
-
-    // Build a vector with the amplitudes
-    Matrix<casa::Bool> flags = msc.flag()(row);
-    std::vector<casa::Float> tmpamps;
-    for (size_t i = 0; i < vdata.size(); ++i) {
-        bool anyFlagged = anyEQ(flags.column(i), true);
-        if (!anyFlagged) {
-            tmpamps.push_back(abs(vdata(i)));
-        }
-    }
+    // The second pass only applies the flags derived from the integrations
+    return (pass==0);
+}
 
+casa::Bool StokesVFlagger::processRow(casa::MSColumns& msc, const casa::uInt pass,
+                                      const casa::uInt row,
+                                      const casa::Matrix<casa::Complex>& data,
+                                      casa::Matrix<casa::Bool>& flags,
+                                      casa::Bool& rowFlag)
+{
     // normalise averages and search them for peaks to flag
     if ( !itsAverageFlagsAreReady && (pass==1) ) {
         ASKAPLOG_INFO_STR(logger, "Finalising averages at the start of pass "
@@ -188,16 +173,38 @@ void StokesVFlagger::processRow(casa::MSColumns& msc, const casa::uInt pass,
     // if this is the first instance of this key, initialise storage vectors
     if ( itsIntegrateSpectra && (pass==0) &&
            (itsAveSpectra.find(key) == itsAveSpectra.end()) ) {
-        initSpectrumVectors(key, data.row(0).shape());
+        initSpectrumVectors(key, casa::IPosition(1, flags.ncolumn()));
     }
 
-    // If all visibilities are flagged, nothing to do
-    if (tmpamps.empty()) return;
-
     bool wasUpdated = false;
 
     if ( pass==0 ) {
 
+        // Get a description of what correlation products are in the data table.
+        const casa::ROMSDataDescColumns& ddc = msc.dataDescription();
+        const casa::Int dataDescId = msc.dataDescId()(row);
+        const casa::Int polId = ddc.polarizationId()(dataDescId);
+
+        // Get the (potentially cached) stokes converter
+        const StokesConverter& stokesconv = getStokesConverter(msc.polarization(), polId);
+
+        // Convert data to Stokes V (imag(data(2,i))-imag(data(3,i)))
+        casa::Matrix<casa::Complex> vmatrix(1, data.ncolumn());
+        stokesconv.convert(vmatrix, data);
+        casa::Vector<casa::Complex> vdata = vmatrix.row(0);
+
+        // Build a vector with the amplitudes
+        std::vector<casa::Float> tmpamps;
+        for (size_t i = 0; i < vdata.size(); ++i) {
+            bool anyFlagged = anyEQ(flags.column(i), true);
+            if (!anyFlagged) {
+                tmpamps.push_back(abs(vdata(i)));
+            }
+        }
+
+        // If all visibilities are flagged, nothing to do
+        if (tmpamps.empty()) return false;
+
         // Convert to a casa::Vector so we can use ArrayMath functions
         // to determine the mean and stddev
         casa::Vector<casa::Float> amps(tmpamps);
@@ -214,7 +221,7 @@ void StokesVFlagger::processRow(casa::MSColumns& msc, const casa::uInt pass,
             if ((statsVector[2] >= (avg - (sigma * itsThreshold))) &&
                 (statsVector[3] <= (avg + (sigma * itsThreshold))) &&
                 !itsIntegrateSpectra && !itsIntegrateTimes) {
-                return;
+                return false;
             }
         }
         else {
@@ -226,7 +233,7 @@ void StokesVFlagger::processRow(casa::MSColumns& msc, const casa::uInt pass,
         // then vdata will contain all zeros. In this case, no flagging can be done.
         const casa::Float epsilon = std::numeric_limits<casa::Float>::epsilon();
         if (near(sigma, 0.0, epsilon) && near(avg, 0.0, epsilon)) {
-            return;
+            return false;
         }
  
         // Apply threshold based flagging and accumulate any averages
@@ -277,6 +284,16 @@ void StokesVFlagger::processRow(casa::MSColumns& msc, const casa::uInt pass,
 
     }
     else if ( (pass==1) &&  ( itsIntegrateSpectra || itsIntegrateTimes ) ) {
+        // If all visibilities are flagged, nothing to do
+        bool anyUnflagged = false;
+        for (size_t i = 0; i < flags.ncolumn(); ++i) {
+            if (!anyEQ(flags.column(i), true)) {
+                anyUnflagged = true;
+                break;
+            }
+        }
+        if (!anyUnflagged) return false;
+
         // only flag unflagged data, so that new flags can be counted.
         // "flags" is true for flags, "mask*" are false for flags
         bool rowFlagged = false;
@@ -286,7 +303,7 @@ void StokesVFlagger::processRow(casa::MSColumns& msc, const casa::uInt pass,
             if ( !itsMaskTimes[key][itsCountTimes[key]] ) {
                 rowFlagged = true;
                 itsStats.rowsFlagged++;
-                for (size_t i = 0; i < vdata.size(); ++i) {
+                for (size_t i = 0; i < flags.ncolumn(); ++i) {
                     for (casa::uInt pol = 0; pol < flags.nrow(); ++pol) {
                         if (flags(pol, i)) continue;
                         flags(pol, i) = true;
@@ -299,7 +316,7 @@ void StokesVFlagger::processRow(casa::MSColumns& msc, const casa::uInt pass,
         }
         // apply itsIntegrateSpectra flags
         if ( itsIntegrateSpectra && !rowFlagged ) {
-            for (size_t i = 0; i < vdata.size(); ++i) {
+            for (size_t i = 0; i < flags.ncolumn(); ++i) {
                 if ( !itsMaskSpectra[key][i] ) {
                     for (casa::uInt pol = 0; pol < flags.nrow(); ++pol) {
                         if ( flags(pol, i) ) continue;
@@ -312,12 +329,10 @@ void StokesVFlagger::processRow(casa::MSColumns& msc, const casa::uInt pass,
         }
     }
 
-    if (wasUpdated && !dryRun) {
-        if (itsIntegrateTimes && !itsMaskTimes[key][itsCountTimes[key]] && (pass==1)) {
-            msc.flagRow().put(row, true);
-        }
-        msc.flag().put(row, flags);
+    if (wasUpdated && itsIntegrateTimes && !itsMaskTimes[key][itsCountTimes[key]] && (pass==1)) {
+        rowFlag = true;
     }
+    return wasUpdated;
 }
 
 
@@ -75,8 +75,11 @@ class StokesVFlagger : public IFlagger {
                        bool integrateTimes, float timesThreshold);
 
         /// @see IFlagger::processRow()
-        virtual void processRow(casa::MSColumns& msc, const casa::uInt pass,
-                                const casa::uInt row, const bool dryRun);
+        virtual casa::Bool processRow(casa::MSColumns& msc, const casa::uInt pass,
+                                      const casa::uInt row,
+                                      const casa::Matrix<casa::Complex>& data,
+                                      casa::Matrix<casa::Bool>& flags,
+                                      casa::Bool& rowFlag);
 
         /// @see IFlagger::stats()
         virtual FlaggingStats stats(void) const;
@@ -84,6 +87,9 @@ class StokesVFlagger : public IFlagger {
         /// @see IFlagger::stats()
         virtual casa::Bool processingRequired(const casa::uInt pass);
 
+        /// @see IFlagger::dataRequired()
+        virtual casa::Bool dataRequired(const casa::uInt pass);
+
     private:
 
         /// Returns an instance of a stokes converter that will convert to Stokes-V.
@@ -52,9 +52,13 @@
 #include "casa/Arrays/IPosition.h"
 #include "casa/Arrays/Slicer.h"
 #include "casa/Arrays/Array.h"
+#include "casa/Arrays/ArrayMath.h"
 #include "casa/Arrays/Vector.h"
 #include "casa/Arrays/Cube.h"
+#include "casa/Arrays/Matrix.h"
+#include "casa/Arrays/Slice.h"
 #include "casa/Quanta/MVTime.h"
+#include "tables/Tables/RefRows.h"
 #include "tables/Tables/TableDesc.h"
 #include "tables/Tables/SetupNewTab.h"
 #include "tables/Tables/IncrementalStMan.h"
@@ -129,8 +133,7 @@ boost::shared_ptr<casa::MeasurementSet> MsSplitApp::create(
     // These columns contain the bulk of the data so save them in a tiled way
     {
         // Get nr of rows in a tile.
-        const int bytesPerRow = sizeof(std::complex<float>) * tileNcorr * tileNchan;
-        const int nrowTile = std::max(1u, bucketSize / bytesPerRow);
+        const int nrowTile = tileNrow(bucketSize, tileNcorr, tileNchan);
         TiledShapeStMan dataMan("TiledData",
                                 IPosition(3, tileNcorr, tileNchan, nrowTile));
         newMS.bindColumn(MeasurementSet::columnName(MeasurementSet::DATA),
@@ -168,6 +171,20 @@ boost::shared_ptr<casa::MeasurementSet> MsSplitApp::create(
     return ms;
 }
 
+casa::uInt MsSplitApp::tileNrow(casa::uInt bucketSize, casa::uInt tileNcorr,
+                                casa::uInt tileNchan)
+{
+    // Same limits as applied by create()
+    if (bucketSize < 8192) bucketSize = 8192;
+
+    if (tileNcorr < 1) tileNcorr = 1;
+
+    if (tileNchan < 1) tileNchan = 1;
+
+    const casa::uInt bytesPerRow = sizeof(std::complex<float>) * tileNcorr * tileNchan;
+    return std::max(1u, bucketSize / bytesPerRow);
+}
+
 void MsSplitApp::copyAntenna(const casa::MeasurementSet& source, casa::MeasurementSet& dest)
 {
     const ROMSColumns srcMsc(source);
@@ -451,329 +468,412 @@ bool MsSplitApp::rowIsFiltered(uint32_t scanid, uint32_t fieldid,
     return false;
 }
 
+casa::Vector<casa::uInt> MsSplitApp::selectRows(const ROMSColumns& sc) const
+{
+    const casa::uInt nRows = sc.nrow();
+    if (!rowFiltersExist()) {
+        casa::Vector<casa::uInt> rows(nRows);
+        indgen(rows);
+        return rows;
+    }
+
+    // Read the columns the filters depend on in large blocks, rather than a
+    // cell at a time
+    std::vector<casa::uInt> selected;
+    const casa::uInt blockSize = 1024 * 1024;
+    for (uInt row = 0; row < nRows; row += blockSize) {
+        const uInt n = min(blockSize, nRows - row);
+        const Slicer rowslicer(IPosition(1, row), IPosition(1, n), Slicer::endIsLength);
+        const casa::Vector<casa::Int> scanNumber = sc.scanNumber().getColumnRange(rowslicer);
+        const casa::Vector<casa::Int> fieldId = sc.fieldId().getColumnRange(rowslicer);
+        const casa::Vector<casa::Int> feed1 = sc.feed1().getColumnRange(rowslicer);
+        const casa::Vector<casa::Int> feed2 = sc.feed2().getColumnRange(rowslicer);
+        const casa::Vector<casa::Double> time = sc.time().getColumnRange(rowslicer);
+        for (uInt i = 0; i < n; ++i) {
+            if (!rowIsFiltered(scanNumber(i), fieldId(i), feed1(i), feed2(i), time(i))) {
+                selected.push_back(row + i);
+            }
+        }
+    }
+    return casa::Vector<casa::uInt>(selected);
+}
+
+void MsSplitApp::writeChannels(casa::MSColumns& dc,
+                               const OutputSpec& output,
+                               const casa::Slicer& dstrowslicer,
+                               const uint32_t firstChan,
+                               const casa::Cube<casa::Complex>& indata,
+                               const casa::Cube<casa::Bool>& inflag,
+                               const casa::Cube<casa::Float>& insigma,
+                               const casa::Matrix<casa::Float>& sigma)
+{
+    // Pre-conditions
+    ASKAPDEBUGASSERT(output.startChan >= firstChan);
+    ASKAPDEBUGASSERT(output.endChan - firstChan < indata.shape()(1));
+
+    const uInt nPol = indata.shape()(0);
+    const uInt nRows = indata.shape()(2);
+    const uInt width = output.width;
+    const uInt nChanOut = (output.endChan - output.startChan + 1) / width;
+    const uInt offset = output.startChan - firstChan;
+    const casa::Bool haveInSigmaSpec = !insigma.empty();
+    const casa::Bool haveOutSigmaSpec = output.ms->isColumn(MS::SIGMA_SPECTRUM);
+
+    const Slicer destarrslicer(IPosition(2, 0, 0),
+                               IPosition(2, nPol, nChanOut), Slicer::endIsLength);
+
+    if (width == 1) {
+        // No averaging, just write this output's part of the input cubes
+        const Slicer chanslicer(IPosition(3, 0, offset, 0),
+                                IPosition(3, nPol, nChanOut, nRows), Slicer::endIsLength);
+        dc.data().putColumnRange(dstrowslicer, destarrslicer, indata(chanslicer));
+        dc.flag().putColumnRange(dstrowslicer, destarrslicer, inflag(chanslicer));
+        if (haveInSigmaSpec && haveOutSigmaSpec) {
+            dc.sigmaSpectrum().putColumnRange(dstrowslicer, destarrslicer,
+                                              insigma(chanslicer));
+        }
+        return;
+    }
+
+    // Create the output data/flag/sigma. Fully flagged channels are left zero.
+    // The sigma spectrum is only needed if generating sigmaSpectra, but that
+    // should be the case with width>1, and this avoids testing in the tight
+    // loops below
+    casa::Cube<casa::Complex> outdata(nPol, nChanOut, nRows);
+    casa::Cube<casa::Bool> outflag(nPol, nChanOut, nRows);
+    casa::Cube<casa::Float> outsigma(nPol, nChanOut, nRows);
+    outdata = casa::Complex(0.0, 0.0);
+    outsigma = 0.0;
+
+    // Average data and combine flag information. Each row is independent, so
+    // the rows are shared between the threads. Polarisation is the innermost
+    // loop as it is the fastest varying axis of the cubes.
+    const int nRowsInt = static_cast<int>(nRows);
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(static)
+#endif
+    for (int r = 0; r < nRowsInt; ++r) {
+        for (uInt destChan = 0; destChan < nChanOut; ++destChan) {
+            for (uInt pol = 0; pol < nPol; ++pol) {
+                casa::Complex sum(0.0, 0.0);
+                casa::Float varsum = 0.0;
+                casa::uInt sumcount = 0;
+
+                // Starting at the appropriate offset into the source data, average "width"
+                // channels together. Without a sigma spectrum there's only 1 sigma per
+                // pol & row, so it applies to all channels
+                const uInt first = offset + destChan * width;
+                for (uInt i = first; i < first + width; ++i) {
+                    if (inflag(pol, i, r)) continue;
+                    sum += indata(pol, i, r);
+                    const casa::Float s = haveInSigmaSpec ? insigma(pol, i, r) : sigma(pol, r);
+                    varsum += s * s;
+                    sumcount++;
+                }
+
+                // Now the input channels have been averaged, write the data to
+                // the output cubes
+                if (sumcount > 0) {
+                    outdata(pol, destChan, r) = casa::Complex(sum.real() / sumcount,
+                                                              sum.imag() / sumcount);
+                    outflag(pol, destChan, r) = false;
+                    outsigma(pol, destChan, r) = sqrt(varsum) / sumcount;
+                } else {
+                    outflag(pol, destChan, r) = true;
+                }
+            }
+        }
+    }
+
+    // Put (write) the output data/flag
+    dc.data().putColumnRange(dstrowslicer, destarrslicer, outdata);
+    dc.flag().putColumnRange(dstrowslicer, destarrslicer, outflag);
+    if (haveOutSigmaSpec) {
+        dc.sigmaSpectrum().putColumnRange(dstrowslicer, destarrslicer, outsigma);
+    }
+}
+
 void MsSplitApp::splitMainTable(const casa::MeasurementSet& source,
-                                casa::MeasurementSet& dest,
-                                const uint32_t startChan,
-                                const uint32_t endChan,
-                                const uint32_t width)
+                                std::vector<OutputSpec>& outputs,
+                                const casa::uInt nRowsPerTile)
 {
     // Pre-conditions
-    ASKAPDEBUGASSERT(endChan >= startChan);
-    ASKAPDEBUGASSERT((endChan - startChan + 1) % width == 0);
+    ASKAPDEBUGASSERT(!outputs.empty());
+    ASKAPDEBUGASSERT(nRowsPerTile > 0);
 
     const ROMSColumns sc(source);
-    MSColumns dc(dest);
-
-    // Add rows upfront if no row based filters exist
-    const casa::uInt nRows = sc.nrow();
-    if (!rowFiltersExist()) dest.addRow(nRows);
 
-    // Work out how many channels are to be actual input and which output
-    // and how many polarisations are involved.
-    const uInt nChanIn = endChan - startChan + 1;
-    const uInt nChanOut = nChanIn / width;
-    const uInt nPol = sc.data()(0).shape()(0);
+    // Build the index of selected rows once, so the copy below only touches
+    // the rows which are actually needed
+    const casa::Vector<casa::uInt> rows = selectRows(sc);
+    const casa::uInt nRows = rows.nelements();
+    ASKAPLOG_INFO_STR(logger, "Selected " << nRows << " of " << sc.nrow() << " rows");
+    if (nRows == 0) return;
+
+    // The input is read once for all outputs, so work out the union of the
+    // channel ranges and how many polarisations are involved.
+    uint32_t firstChan = outputs[0].startChan;
+    uint32_t lastChan = outputs[0].endChan;
+    for (size_t i = 1; i < outputs.size(); ++i) {
+        firstChan = min(firstChan, outputs[i].startChan);
+        lastChan = max(lastChan, outputs[i].endChan);
+    }
+    const uInt nChanIn = lastChan - firstChan + 1;
+    const uInt nPol = sc.data()(rows(0)).shape()(0);
     ASKAPDEBUGASSERT(nPol > 0);
 
     // Test to see whether SIGMA_SPECTRUM has been added
-    casa::Bool haveInSigmaSpec = source.isColumn(MS::SIGMA_SPECTRUM);
-    casa::Bool haveOutSigmaSpec = dest.isColumn(MS::SIGMA_SPECTRUM);
+    const casa::Bool haveInSigmaSpec = source.isColumn(MS::SIGMA_SPECTRUM);
     if (haveInSigmaSpec) {
         ASKAPLOG_INFO_STR(logger, "Reading and using the spectra of sigma values");
     }
-    if (haveOutSigmaSpec) {
-        ASKAPLOG_INFO_STR(logger, "Calculating and storing spectra of sigma values");
-    }
-
-    // Decide how many rows to process simultaneously. This needs to fit within
-    // a reasonable amount of memory, because all visibilities will be read
-    // in for possible averaging. Assumes 32MB working space.
-    std::size_t inDataSize = sizeof(casa::Complex) + sizeof(casa::Bool);
-    std::size_t outDataSize = inDataSize;
-    if (haveInSigmaSpec) {
-        inDataSize += sizeof(casa::Float);
-    }
-    if (haveOutSigmaSpec) {
-        outDataSize += sizeof(casa::Float);
-    }
-    uInt maxSimultaneousRows = (32 * 1024 * 1024) / nPol /
-            (nChanIn * inDataSize) / (nChanOut * outDataSize);
-    if (maxSimultaneousRows<1) maxSimultaneousRows = 1;
-
-    // However, if there is row-based filtering only one row can be copied
-    // at a time.
-    if (rowFiltersExist()) maxSimultaneousRows = 1;
 
     // Set a 64MB maximum cache size for the large columns
     const casa::uInt cacheSize = 64 * 1024 * 1024;
     sc.data().setMaximumCacheSize(cacheSize);
-    dc.data().setMaximumCacheSize(cacheSize);
     sc.flag().setMaximumCacheSize(cacheSize);
-    dc.flag().setMaximumCacheSize(cacheSize);
     if (haveInSigmaSpec) {
         sc.sigmaSpectrum().setMaximumCacheSize(cacheSize);
     }
-    if (haveOutSigmaSpec) {
-        dc.sigmaSpectrum().setMaximumCacheSize(cacheSize);
+
+    // The memory needed per row, for the input and all the outputs
+    std::size_t bytesPerRow = nPol * nChanIn * (sizeof(casa::Complex) + sizeof(casa::Bool));
+    if (haveInSigmaSpec) {
+        bytesPerRow += nPol * nChanIn * sizeof(casa::Float);
     }
 
+    // Add all the rows to the outputs upfront, the selected rows are written
+    // contiguously
+    std::vector< boost::shared_ptr<MSColumns> > dcs;
+    for (size_t i = 0; i < outputs.size(); ++i) {
+        MeasurementSet& dest = *outputs[i].ms;
+        dest.addRow(nRows);
+        boost::shared_ptr<MSColumns> dc(new MSColumns(dest));
+        dc->data().setMaximumCacheSize(cacheSize);
+        dc->flag().setMaximumCacheSize(cacheSize);
+
+        const uInt nChanOut = (outputs[i].endChan - outputs[i].startChan + 1) / outputs[i].width;
+        bytesPerRow += nPol * nChanOut * (sizeof(casa::Complex) + sizeof(casa::Bool));
+        if (dest.isColumn(MS::SIGMA_SPECTRUM)) {
+            ASKAPLOG_INFO_STR(logger, "Calculating and storing spectra of sigma values in "
+                    << outputs[i].outvis);
+            dc->sigmaSpectrum().setMaximumCacheSize(cacheSize);
+            bytesPerRow += nPol * nChanOut * sizeof(casa::Float);
+        }
+        dcs.push_back(dc);
+    }
+
+    // Decide how many rows to process simultaneously. This needs to fit within
+    // a reasonable amount of memory, because all visibilities will be read
+    // in for possible averaging. Assumes 32MB working space. The block is
+    // a whole number of output tiles, so each tile is written in one go.
+    uInt maxSimultaneousRows = (32 * 1024 * 1024) / bytesPerRow;
+    if (maxSimultaneousRows >= nRowsPerTile) {
+        maxSimultaneousRows -= maxSimultaneousRows % nRowsPerTile;
+    }
+    if (maxSimultaneousRows < 1) maxSimultaneousRows = 1;
+    ASKAPLOG_INFO_STR(logger, "Processing up to " << maxSimultaneousRows
+            << " rows per iteration");
+
     uInt progressCounter = 0; // Used for progress reporting
     const uInt PROGRESS_INTERVAL_IN_ROWS = nRows / 100;
 
-    // Row in destination table may differ from source table if row based
+    // Row in destination tables may differ from source table if row based
     // filtering is used
-    uInt dstRow = 0;
     uInt row = 0;
     while (row < nRows) {
         // Number of rows to process for this iteration of the loop; either
         // maxSimultaneousRows or the remaining rows.
         const uInt nRowsThisIteration = min(maxSimultaneousRows, nRows - row);
-        const Slicer srcrowslicer(IPosition(1, row), IPosition(1, nRowsThisIteration),
+        const Slicer dstrowslicer(IPosition(1, row), IPosition(1, nRowsThisIteration),
                 Slicer::endIsLength);
-        Slicer dstrowslicer = srcrowslicer;
+
+        // The source rows of this iteration, which are not contiguous if
+        // rows have been filtered out
+        const RefRows srcrows(rows(Slice(row, nRowsThisIteration)), False, True);
 
         // Report progress at intervals and on completion
         progressCounter += nRowsThisIteration;
         if (progressCounter >= PROGRESS_INTERVAL_IN_ROWS ||
-                (row >= nRows - 1)) {
-            ASKAPLOG_INFO_STR(logger,  "Processed row " << row + 1 << " of " << nRows);
+                (row + nRowsThisIteration >= nRows)) {
+            ASKAPLOG_INFO_STR(logger,  "Processed row " << row + nRowsThisIteration
+                    << " of " << nRows);
             progressCounter = 0;
         }
-        
-        // Debugging for chunk copying only
-        if (nRowsThisIteration > 1) {
-            ASKAPLOG_DEBUG_STR(logger,  "Processing " << nRowsThisIteration
-                    << " rows this iteration");
-        }
-
-        // Skip this row if it is filtered out
-        if (rowIsFiltered(sc.scanNumber()(row),
-                    sc.fieldId()(row),
-                    sc.feed1()(row),
-                    sc.feed2()(row),
-                    sc.time()(row))) {
-            row += nRowsThisIteration;
-            continue;
-        }
 
-        // Rows have been pre-added if no row based filtering is done 
-        if (rowFiltersExist()) {
-            dest.addRow();
-            dstrowslicer = Slicer(IPosition(1, dstRow), IPosition(1, nRowsThisIteration),
-                    Slicer::endIsLength);
-        }
-
-        // Copy over the simple cells (i.e. those not needing averaging/merging)
-        dc.scanNumber().putColumnRange(dstrowslicer, sc.scanNumber().getColumnRange(srcrowslicer));
-        dc.fieldId().putColumnRange(dstrowslicer, sc.fieldId().getColumnRange(srcrowslicer));
-        dc.dataDescId().putColumnRange(dstrowslicer, sc.dataDescId().getColumnRange(srcrowslicer));
-        dc.time().putColumnRange(dstrowslicer, sc.time().getColumnRange(srcrowslicer));
-        dc.timeCentroid().putColumnRange(dstrowslicer, sc.timeCentroid().getColumnRange(srcrowslicer));
-        dc.arrayId().putColumnRange(dstrowslicer, sc.arrayId().getColumnRange(srcrowslicer));
-        dc.processorId().putColumnRange(dstrowslicer, sc.processorId().getColumnRange(srcrowslicer));
-        dc.exposure().putColumnRange(dstrowslicer, sc.exposure().getColumnRange(srcrowslicer));
-        dc.interval().putColumnRange(dstrowslicer, sc.interval().getColumnRange(srcrowslicer));
-        dc.observationId().putColumnRange(dstrowslicer, sc.observationId().getColumnRange(srcrowslicer));
-        dc.antenna1().putColumnRange(dstrowslicer, sc.antenna1().getColumnRange(srcrowslicer));
-        dc.antenna2().putColumnRange(dstrowslicer, sc.antenna2().getColumnRange(srcrowslicer));
-        dc.feed1().putColumnRange(dstrowslicer, sc.feed1().getColumnRange(srcrowslicer));
-        dc.feed2().putColumnRange(dstrowslicer, sc.feed2().getColumnRange(srcrowslicer));
-        dc.uvw().putColumnRange(dstrowslicer, sc.uvw().getColumnRange(srcrowslicer));
-        dc.flagRow().putColumnRange(dstrowslicer, sc.flagRow().getColumnRange(srcrowslicer));
-        dc.weight().putColumnRange(dstrowslicer, sc.weight().getColumnRange(srcrowslicer));
-        dc.sigma().putColumnRange(dstrowslicer, sc.sigma().getColumnRange(srcrowslicer)/sqrt(width));
-
-        // Set the shape of the destination arrays
-        for (uInt i = dstRow; i < dstRow + nRowsThisIteration; ++i) {
-            dc.data().setShape(i, IPosition(2, nPol, nChanOut));
-            dc.flag().setShape(i, IPosition(2, nPol, nChanOut));
-            if (haveOutSigmaSpec) {
-                dc.sigmaSpectrum().setShape(i, IPosition(2, nPol, nChanOut));
-            }
-        }
-
-        //  Average (if applicable) then write data into the output MS
-        const Slicer srcarrslicer(IPosition(2, 0, startChan - 1),
+        // Read the simple cells (i.e. those not needing averaging/merging) once
+        const casa::Vector<casa::Int> scanNumber = sc.scanNumber().getColumnCells(srcrows);
+        const casa::Vector<casa::Int> fieldId = sc.fieldId().getColumnCells(srcrows);
+        const casa::Vector<casa::Int> dataDescId = sc.dataDescId().getColumnCells(srcrows);
+        const casa::Vector<casa::Double> time = sc.time().getColumnCells(srcrows);
+        const casa::Vector<casa::Double> timeCentroid = sc.timeCentroid().getColumnCells(srcrows);
+        const casa::Vector<casa::Int> arrayId = sc.arrayId().getColumnCells(srcrows);
+        const casa::Vector<casa::Int> processorId = sc.processorId().getColumnCells(srcrows);
+        const casa::Vector<casa::Double> exposure = sc.exposure().getColumnCells(srcrows);
+        const casa::Vector<casa::Double> interval = sc.interval().getColumnCells(srcrows);
+        const casa::Vector<casa::Int> observationId = sc.observationId().getColumnCells(srcrows);
+        const casa::Vector<casa::Int> antenna1 = sc.antenna1().getColumnCells(srcrows);
+        const casa::Vector<casa::Int> antenna2 = sc.antenna2().getColumnCells(srcrows);
+        const casa::Vector<casa::Int> feed1 = sc.feed1().getColumnCells(srcrows);
+        const casa::Vector<casa::Int> feed2 = sc.feed2().getColumnCells(srcrows);
+        const casa::Vector<casa::Bool> flagRow = sc.flagRow().getColumnCells(srcrows);
+        const casa::Matrix<casa::Double> uvw = sc.uvw().getColumnCells(srcrows);
+        const casa::Matrix<casa::Float> weight = sc.weight().getColumnCells(srcrows);
+        const casa::Matrix<casa::Float> sigma = sc.sigma().getColumnCells(srcrows);
+
+        // Get (read) the input data/flag/sigma for the channels of all outputs
+        const Slicer srcarrslicer(IPosition(2, 0, firstChan - 1),
                                   IPosition(2, nPol, nChanIn), Slicer::endIsLength);
-        const Slicer destarrslicer(IPosition(2, 0, 0),
-                                   IPosition(2, nPol, nChanOut), Slicer::endIsLength);
-
-        if (width == 1) {
-            dc.data().putColumnRange(dstrowslicer, destarrslicer,
-                sc.data().getColumnRange(srcrowslicer, srcarrslicer));
-            dc.flag().putColumnRange(dstrowslicer, destarrslicer,
-                sc.flag().getColumnRange(srcrowslicer, srcarrslicer));
-            if (haveInSigmaSpec && haveOutSigmaSpec) {
-                dc.sigmaSpectrum().putColumnRange(dstrowslicer, destarrslicer,
-                    sc.sigmaSpectrum().getColumnRange(srcrowslicer, srcarrslicer));
-            }
-        } else {
-            // Get (read) the input data/flag/sigma
-            const casa::Cube<casa::Complex> indata = sc.data().getColumnRange(srcrowslicer, srcarrslicer);
-            const casa::Cube<casa::Bool> inflag = sc.flag().getColumnRange(srcrowslicer, srcarrslicer);
-            // This is only needed if generating sigmaSpectra, but that should be the
-            // case with width>1, and this avoids testing in the tight loops below
-            casa::Cube<casa::Float> insigma;
-            if (haveInSigmaSpec) {
-                insigma = sc.sigmaSpectrum().getColumnRange(srcrowslicer, srcarrslicer);
-            } else {
-                // There's only 1 sigma per pol & row, so spread over channels
-                insigma = casa::Cube<casa::Float>(indata.shape());
-                casa::IPosition arrayShape(3, nPol,1,nRowsThisIteration);
-                casa::Array<casa::Float> sigmaArray =
-                    sc.sigma().getColumnRange(srcrowslicer).reform(arrayShape);
-                for (uInt i = 0; i < nChanIn; ++i) {
-                    const Slicer blockSlicer(IPosition(3, 0,i,0),
-                                             arrayShape, Slicer::endIsLength);
-                    insigma(blockSlicer) = sigmaArray;
-                }
-            }
-
-            // Create the output data/flag/sigma
-            casa::Cube<casa::Complex> outdata(nPol, nChanOut, nRowsThisIteration);
-            casa::Cube<casa::Bool> outflag(nPol, nChanOut, nRowsThisIteration);
-            // This is only needed if generating sigmaSpectra, but that should be the
-            // case with width>1, and this avoids testing in the tight loops below
-            casa::Cube<casa::Float> outsigma(nPol, nChanOut, nRowsThisIteration); 
+        const casa::Cube<casa::Complex> indata = sc.data().getColumnCells(srcrows, srcarrslicer);
+        const casa::Cube<casa::Bool> inflag = sc.flag().getColumnCells(srcrows, srcarrslicer);
+        casa::Cube<casa::Float> insigma;
+        if (haveInSigmaSpec) {
+            insigma.reference(sc.sigmaSpectrum().getColumnCells(srcrows, srcarrslicer));
+        }
 
-            // Average data and combine flag information
-            for (uInt pol = 0; pol < nPol; ++pol) {
-                for (uInt destChan = 0; destChan < nChanOut; ++destChan) {
-                    for (uInt r = 0; r < nRowsThisIteration; ++r) {
-                        casa::Complex sum(0.0, 0.0);
-                        casa::Float varsum = 0.0; 
-                        casa::uInt sumcount = 0; 
-
-                        // Starting at the appropriate offset into the source data, average "width"
-                        // channels together
-                        for (uInt i = (destChan * width); i < (destChan * width) + width; ++i) {
-                            ASKAPDEBUGASSERT(i < nChanIn);
-                            if (inflag(pol, i, r)) continue;
-                            sum += indata(pol, i, r);
-                            varsum += insigma(pol, i, r) * insigma(pol, i, r);
-                            sumcount++;
-                        }
-
-                        // Now the input channels have been averaged, write the data to
-                        // the output cubes
-                        if (sumcount > 0) { 
-                            outdata(pol, destChan, r) = casa::Complex(sum.real() / sumcount,
-                                                                      sum.imag() / sumcount);
-                            outflag(pol, destChan, r) = false;
-                            outsigma(pol, destChan, r) = sqrt(varsum) / sumcount;
-                        } else {
-                            outflag(pol, destChan, r) = true;
-                        }
-
-                    }
+        for (size_t i = 0; i < outputs.size(); ++i) {
+            MSColumns& dc = *dcs[i];
+            const OutputSpec& output = outputs[i];
+
+            dc.scanNumber().putColumnRange(dstrowslicer, scanNumber);
+            dc.fieldId().putColumnRange(dstrowslicer, fieldId);
+            dc.dataDescId().putColumnRange(dstrowslicer, dataDescId);
+            dc.time().putColumnRange(dstrowslicer, time);
+            dc.timeCentroid().putColumnRange(dstrowslicer, timeCentroid);
+            dc.arrayId().putColumnRange(dstrowslicer, arrayId);
+            dc.processorId().putColumnRange(dstrowslicer, processorId);
+            dc.exposure().putColumnRange(dstrowslicer, exposure);
+            dc.interval().putColumnRange(dstrowslicer, interval);
+            dc.observationId().putColumnRange(dstrowslicer, observationId);
+            dc.antenna1().putColumnRange(dstrowslicer, antenna1);
+            dc.antenna2().putColumnRange(dstrowslicer, antenna2);
+            dc.feed1().putColumnRange(dstrowslicer, feed1);
+            dc.feed2().putColumnRange(dstrowslicer, feed2);
+            dc.uvw().putColumnRange(dstrowslicer, uvw);
+            dc.flagRow().putColumnRange(dstrowslicer, flagRow);
+            dc.weight().putColumnRange(dstrowslicer, weight);
+            dc.sigma().putColumnRange(dstrowslicer,
+                    sigma / casa::Float(sqrt(casa::Float(output.width))));
+
+            // Set the shape of the destination arrays
+            const uInt nChanOut = (output.endChan - output.startChan + 1) / output.width;
+            const casa::Bool haveOutSigmaSpec = output.ms->isColumn(MS::SIGMA_SPECTRUM);
+            for (uInt r = row; r < row + nRowsThisIteration; ++r) {
+                dc.data().setShape(r, IPosition(2, nPol, nChanOut));
+                dc.flag().setShape(r, IPosition(2, nPol, nChanOut));
+                if (haveOutSigmaSpec) {
+                    dc.sigmaSpectrum().setShape(r, IPosition(2, nPol, nChanOut));
                 }
             }
 
-            // Put (write) the output data/flag
-            dc.data().putColumnRange(dstrowslicer, destarrslicer, outdata);
-            dc.flag().putColumnRange(dstrowslicer, destarrslicer, outflag);
-            if (haveOutSigmaSpec) {
-                dc.sigmaSpectrum().putColumnRange(dstrowslicer, destarrslicer, outsigma);
-            }
+            //  Average (if applicable) then write data into the output MS
+            writeChannels(dc, output, dstrowslicer, firstChan, indata, inflag, insigma, sigma);
         }
 
         row += nRowsThisIteration;
-        dstRow += nRowsThisIteration;
     }
 }
 
-int MsSplitApp::split(const std::string& invis, const std::string& outvis,
-                      const uint32_t startChan,
-                      const uint32_t endChan,
-                      const uint32_t width,
+int MsSplitApp::split(const std::string& invis, std::vector<OutputSpec>& outputs,
                       const LOFAR::ParameterSet& parset)
 {
-    ASKAPLOG_INFO_STR(logger,  "Splitting out channel range " << startChan << " to "
-                          << endChan << " (inclusive)");
-
-    if (width > 1) {
-        ASKAPLOG_INFO_STR(logger,  "Averaging " << width << " channels to form 1");
-    } else {
-        ASKAPLOG_INFO_STR(logger,  "No averaging");
-    }
-
-    // Verify split parameters
-    const uInt nChanIn = endChan - startChan + 1;
-
-    if ((width < 1) || (nChanIn % width != 0)) {
-        ASKAPLOG_ERROR_STR(logger, "Width must equally divide the channel range");
-        return 1;
-    }
-
     // Open the input measurement set
     const casa::MeasurementSet in(invis);
-
-    // Verify split parameters that require input MS info
     const casa::uInt totChanIn = ROScalarColumn<casa::Int>(in.spectralWindow(),"NUM_CHAN")(0);
-    if ((startChan<1) || (endChan > totChanIn)) {
-        ASKAPLOG_ERROR_STR(logger,
-            "Input channel range is inconsistent with input spectra: ["<<
-            startChan<<","<<endChan<<"] is outside [1,"<<totChanIn<<"]");
-        return 1;
-    }
 
-    // Create the output measurement set
-    if (casa::File(outvis).exists()) {
-        ASKAPLOG_ERROR_STR(logger, "File or table " << outvis << " already exists!");
-        return 1;
-    }
+    // Verify the split parameters of all outputs before any is created
+    std::set<std::string> names;
+    for (size_t i = 0; i < outputs.size(); ++i) {
+        const OutputSpec& output = outputs[i];
+        ASKAPLOG_INFO_STR(logger,  "Splitting out channel range " << output.startChan
+                << " to " << output.endChan << " (inclusive) to " << output.outvis);
 
-    // Add a sigma spectrum to the output measurement set?
-    casa::Bool addSigmaSpec = false;
-    if ((width > 1) || in.isColumn(MS::SIGMA_SPECTRUM)) {
-        addSigmaSpec = true;
+        if (output.width > 1) {
+            ASKAPLOG_INFO_STR(logger,  "Averaging " << output.width << " channels to form 1");
+        } else {
+            ASKAPLOG_INFO_STR(logger,  "No averaging");
+        }
+
+        if (output.endChan < output.startChan) {
+            ASKAPLOG_ERROR_STR(logger, "Invalid channel range for " << output.outvis);
+            return 1;
+        }
+        const uInt nChanIn = output.endChan - output.startChan + 1;
+        if ((output.width < 1) || (nChanIn % output.width != 0)) {
+            ASKAPLOG_ERROR_STR(logger, "Width must equally divide the channel range");
+            return 1;
+        }
+
+        // Verify split parameters that require input MS info
+        if ((output.startChan < 1) || (output.endChan > totChanIn)) {
+            ASKAPLOG_ERROR_STR(logger,
+                "Input channel range is inconsistent with input spectra: ["<<
+                output.startChan<<","<<output.endChan<<"] is outside [1,"<<totChanIn<<"]");
+            return 1;
+        }
+
+        if (casa::File(output.outvis).exists() || !names.insert(output.outvis).second) {
+            ASKAPLOG_ERROR_STR(logger, "File or table " << output.outvis << " already exists!");
+            return 1;
+        }
     }
 
     const casa::uInt bucketSize = parset.getUint32("stman.bucketsize", 64 * 1024);
     const casa::uInt tileNcorr = parset.getUint32("stman.tilencorr", 4);
     const casa::uInt tileNchan = parset.getUint32("stman.tilenchan", 1);
 
-    boost::shared_ptr<casa::MeasurementSet>
-        out(create(outvis, addSigmaSpec, bucketSize, tileNcorr, tileNchan));
+    // Get the spectral window id (must be common for all main table rows)
+    const casa::Int spwId = findSpectralWindowId(in);
 
-    // Copy ANTENNA
-    ASKAPLOG_INFO_STR(logger,  "Copying ANTENNA table");
-    copyAntenna(in, *out);
+    for (size_t i = 0; i < outputs.size(); ++i) {
+        OutputSpec& output = outputs[i];
 
-    // Copy DATA_DESCRIPTION
-    ASKAPLOG_INFO_STR(logger,  "Copying DATA_DESCRIPTION table");
-    copyDataDescription(in, *out);
+        // Add a sigma spectrum to the output measurement set?
+        casa::Bool addSigmaSpec = false;
+        if ((output.width > 1) || in.isColumn(MS::SIGMA_SPECTRUM)) {
+            addSigmaSpec = true;
+        }
 
-    // Copy FEED
-    ASKAPLOG_INFO_STR(logger,  "Copying FEED table");
-    copyFeed(in, *out);
+        // Create the output measurement set
+        output.ms = create(output.outvis, addSigmaSpec, bucketSize, tileNcorr, tileNchan);
+        MeasurementSet& out = *output.ms;
 
-    // Copy FIELD
-    ASKAPLOG_INFO_STR(logger,  "Copying FIELD table");
-    copyField(in, *out);
+        // Copy ANTENNA
+        ASKAPLOG_INFO_STR(logger,  "Copying ANTENNA table");
+        copyAntenna(in, out);
 
-    // Copy OBSERVATION
-    ASKAPLOG_INFO_STR(logger,  "Copying OBSERVATION table");
-    copyObservation(in, *out);
+        // Copy DATA_DESCRIPTION
+        ASKAPLOG_INFO_STR(logger,  "Copying DATA_DESCRIPTION table");
+        copyDataDescription(in, out);
 
-    // Copy POINTING
-    ASKAPLOG_INFO_STR(logger,  "Copying POINTING table");
-    copyPointing(in, *out);
+        // Copy FEED
+        ASKAPLOG_INFO_STR(logger,  "Copying FEED table");
+        copyFeed(in, out);
 
-    // Copy POLARIZATION
-    ASKAPLOG_INFO_STR(logger,  "Copying POLARIZATION table");
-    copyPolarization(in, *out);
+        // Copy FIELD
+        ASKAPLOG_INFO_STR(logger,  "Copying FIELD table");
+        copyField(in, out);
 
-    // Get the spectral window id (must be common for all main table rows)
-    const casa::Int spwId = findSpectralWindowId(in);
+        // Copy OBSERVATION
+        ASKAPLOG_INFO_STR(logger,  "Copying OBSERVATION table");
+        copyObservation(in, out);
 
-    // Split SPECTRAL_WINDOW
-    ASKAPLOG_INFO_STR(logger,  "Splitting SPECTRAL_WINDOW table");
-    splitSpectralWindow(in, *out, startChan, endChan, width, spwId);
+        // Copy POINTING
+        ASKAPLOG_INFO_STR(logger,  "Copying POINTING table");
+        copyPointing(in, out);
+
+        // Copy POLARIZATION
+        ASKAPLOG_INFO_STR(logger,  "Copying POLARIZATION table");
+        copyPolarization(in, out);
+
+        // Split SPECTRAL_WINDOW
+        ASKAPLOG_INFO_STR(logger,  "Splitting SPECTRAL_WINDOW table");
+        splitSpectralWindow(in, out, output.startChan, output.endChan, output.width, spwId);
+    }
 
     // Split main table
     ASKAPLOG_INFO_STR(logger,  "Splitting main table");
-    splitMainTable(in, *out, startChan, endChan, width);
+    splitMainTable(in, outputs, tileNrow(bucketSize, tileNcorr, tileNchan));
 
     return 0;
 }
@@ -834,11 +934,34 @@ int MsSplitApp::run(int argc, char* argv[])
 
     // Get the required parameters to split
     const string invis = config().getString("vis");
-    const string outvis = config().getString("outputvis");
 
-    // Read channel selection parameters
-    const pair<uint32_t, uint32_t> range = ParsetUtils::parseIntRange(config(), "channel");
+    // Read the outputs and their channel selection parameters. Either a
+    // single output, or a list of named outputs which are all written from
+    // one pass over the input
+    std::vector<OutputSpec> outputs;
     const uint32_t width = config().getUint32("width", 1);
+    if (config().isDefined("outputs")) {
+        const vector<string> names = config().getStringVector("outputs", true);
+        ASKAPCHECK(!names.empty(), "The outputs parameter must name at least one output");
+        for (size_t i = 0; i < names.size(); ++i) {
+            const LOFAR::ParameterSet subset = config().makeSubset(names[i] + ".");
+            const pair<uint32_t, uint32_t> range = ParsetUtils::parseIntRange(subset, "channel");
+            OutputSpec output;
+            output.outvis = subset.getString("outputvis");
+            output.startChan = range.first;
+            output.endChan = range.second;
+            output.width = subset.getUint32("width", width);
+            outputs.push_back(output);
+        }
+    } else {
+        const pair<uint32_t, uint32_t> range = ParsetUtils::parseIntRange(config(), "channel");
+        OutputSpec output;
+        output.outvis = config().getString("outputvis");
+        output.startChan = range.first;
+        output.endChan = range.second;
+        output.width = width;
+        outputs.push_back(output);
+    }
 
     // Read beam selection parameters
     if (config().isDefined("beams")) {
@@ -867,7 +990,7 @@ int MsSplitApp::run(int argc, char* argv[])
     configureTimeFilter("timebegin", "Excluding rows with time less than: ", itsTimeBegin);
     configureTimeFilter("timeend", "Excluding rows with time greater than: ", itsTimeEnd);
 
-    const int error = split(invis, outvis, range.first, range.second, width, config());
+    const int error = split(invis, outputs, config());
     stats.logSummary();
     return error;
 }
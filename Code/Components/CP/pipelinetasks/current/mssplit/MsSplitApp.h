@@ -34,6 +34,7 @@
 #include <string>
 #include <set>
 #include <utility>
+#include <vector>
 #include <stdint.h>
 
 // ASKAPsoft includes
@@ -45,7 +46,12 @@
 #include "boost/optional.hpp"
 #include "Common/ParameterSet.h"
 #include "casa/aips.h"
+#include "casa/Arrays/Cube.h"
+#include "casa/Arrays/Matrix.h"
+#include "casa/Arrays/Slicer.h"
+#include "casa/Arrays/Vector.h"
 #include "ms/MeasurementSets/MeasurementSet.h"
+#include "ms/MeasurementSets/MSColumns.h"
 
 namespace askap {
 namespace cp {
@@ -61,10 +67,30 @@ class MsSplitApp : public askap::Application {
 
     private:
 
+        /// Description of one output measurement set. Several outputs with
+        /// different channel ranges can be written from one pass over the input.
+        struct OutputSpec {
+            /// Name of the output measurement set
+            std::string outvis;
+            /// First channel (one-based, inclusive)
+            uint32_t startChan;
+            /// Last channel (one-based, inclusive)
+            uint32_t endChan;
+            /// Number of input channels averaged to form one output channel
+            uint32_t width;
+            /// The output measurement set, once created
+            boost::shared_ptr<casa::MeasurementSet> ms;
+        };
+
         static boost::shared_ptr<casa::MeasurementSet> create(
             const std::string& filename, const casa::Bool addSigmaSpec,
             casa::uInt bucketSize, casa::uInt tileNcorr, casa::uInt tileNchan);
 
+        /// Returns the number of rows in a tile of the DATA/FLAG columns
+        /// created by create() for the given storage manager parameters
+        static casa::uInt tileNrow(casa::uInt bucketSize, casa::uInt tileNcorr,
+                                   casa::uInt tileNchan);
+
         static void copyAntenna(const casa::MeasurementSet& source, casa::MeasurementSet& dest);
 
         static void copyDataDescription(const casa::MeasurementSet& source, casa::MeasurementSet& dest);
@@ -94,18 +120,37 @@ class MsSplitApp : public askap::Application {
                                  const uint32_t width,
                                  const casa::Int spwId);
 
+        /// Copies the selected rows of the main table to all the outputs. The
+        /// union of the channel ranges of the outputs is read once, in blocks of
+        /// rows which are a multiple of the output tile size, and the channels
+        /// are averaged by a team of threads.
+        /// @param[in] nRowsPerTile number of rows in a tile of the output
         void splitMainTable(const casa::MeasurementSet& source,
-                            casa::MeasurementSet& dest,
-                            const uint32_t startChan,
-                            const uint32_t endChan,
-                            const uint32_t width);
-
-        int split(const std::string& invis, const std::string& outvis,
-                  const uint32_t startChan,
-                  const uint32_t endChan,
-                  const uint32_t width,
+                            std::vector<OutputSpec>& outputs,
+                            const casa::uInt nRowsPerTile);
+
+        /// Writes one block of the DATA, FLAG and (if present) SIGMA_SPECTRUM
+        /// columns of an output, averaging the channels if required.
+        /// @param[in] firstChan    the first channel of the input cubes
+        ///                         (one-based)
+        /// @param[in] sigma        the SIGMA column of the block, used when
+        ///                         the input has no SIGMA_SPECTRUM column
+        static void writeChannels(casa::MSColumns& dc,
+                                  const OutputSpec& output,
+                                  const casa::Slicer& dstrowslicer,
+                                  const uint32_t firstChan,
+                                  const casa::Cube<casa::Complex>& indata,
+                                  const casa::Cube<casa::Bool>& inflag,
+                                  const casa::Cube<casa::Float>& insigma,
+                                  const casa::Matrix<casa::Float>& sigma);
+
+        int split(const std::string& invis, std::vector<OutputSpec>& outputs,
                   const LOFAR::ParameterSet& parset);
 
+        // Returns the (increasing) indices of the rows of the main table which
+        // pass the row filters
+        casa::Vector<casa::uInt> selectRows(const casa::ROMSColumns& sc) const;
+
         // Returns true if row filtering is enabled, otherwise false.
         bool rowFiltersExist() const;
 
@@ -44,6 +44,27 @@
 // Using
 using namespace askap::cp::common;
 
+namespace {
+
+/// Makes a cube refer to the first newShape.product() elements of its
+/// own (contiguous) storage, reinterpreted with the new shape.
+template <typename T>
+void shrinkCube(casa::Cube<T>& cube, const casa::IPosition& newShape)
+{
+    ASKAPCHECK(cube.contiguousStorage(),
+            "Cannot shrink a cube without contiguous storage in place");
+    const casa::Int64 newSize = newShape.product();
+    if (newSize == 0) {
+        cube.resize(newShape);
+        return;
+    }
+    const casa::Array<T> flat = cube.reform(casa::IPosition(1, cube.nelements()));
+    const casa::Array<T> prefix = flat(casa::IPosition(1, 0), casa::IPosition(1, newSize - 1));
+    cube.reference(prefix.reform(newShape));
+}
+
+}
+
 VisChunk::VisChunk(const casa::uInt nRow,
                    const casa::uInt nChannel,
                    const casa::uInt nPol,
@@ -344,3 +365,23 @@ void VisChunk::resize(const casa::Cube<casa::Complex>& visibility,
 
     itsNumberOfChannels = newNChan;
 }
+
+void VisChunk::shrinkChannels(const casa::uInt nChan)
+{
+    ASKAPCHECK(nChan <= itsNumberOfChannels,
+            "Cannot shrink " << itsNumberOfChannels << " channels to " << nChan);
+    if (nChan == itsNumberOfChannels) {
+        return;
+    }
+
+    const casa::IPosition newShape(3, itsNumberOfRows, nChan, itsNumberOfPolarisations);
+    shrinkCube(itsVisibility, newShape);
+    shrinkCube(itsFlag, newShape);
+    if (nChan == 0) {
+        itsFrequency.resize(0);
+    } else {
+        itsFrequency.reference(itsFrequency(casa::Slice(0, nChan)));
+    }
+
+    itsNumberOfChannels = nChan;
+}
@@ -307,6 +307,25 @@ class VisChunk {
                     const casa::Cube<casa::Bool>& flag,
                     const casa::Vector<casa::Double>& frequency);
 
+        /// Reduces the number of channels without reallocating the
+        /// visibility, flag and frequency containers.
+        /// The new (smaller) visibility and flag cubes take the first
+        /// nRow * nChan * nPol elements of the existing storage, in the
+        /// usual (row fastest, then channel, then polarisation) order,
+        /// and the new frequency vector takes the first nChan elements
+        /// of the existing one. The caller is expected to have packed
+        /// the data into this order first.
+        ///
+        /// @note This exists to support the channel averaging and
+        /// selection tasks, which reduce the channels in place.
+        ///
+        /// @throw AskapError If nChan is larger than the current number
+        ///     of channels, or the visibility or flag cube does not have
+        ///     contiguous storage.
+        ///
+        /// @param[in] nChan the new number of channels.
+        void shrinkChannels(const casa::uInt nChan);
+
         /// @brief Shared pointer typedef
         typedef boost::shared_ptr<VisChunk> ShPtr;
 
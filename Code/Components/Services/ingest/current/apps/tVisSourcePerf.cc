@@ -0,0 +1,164 @@
+/// @file tVisSourcePerf.cc
+///
+/// @copyright (c) 2015 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @brief Loopback load generator for VisSource.
+///
+/// Sends VisDatagrams to a VisSource over the loopback interface as fast as
+/// possible (or at a given rate) and reports the sustained packet rate and
+/// the number of datagrams lost.
+///
+/// Usage: tVisSourcePerf [count] [rate] [bufsize] [port]
+///   count   - number of datagrams to send (default 1000000)
+///   rate    - datagrams per second, zero for no limit (default 0)
+///   bufsize - VisSource buffer size in datagrams (default 100000)
+///   port    - UDP port (default 3000)
+
+// System includes
+#include <iostream>
+#include <string>
+#include <cstring>
+#include <cstdlib>
+#include <cerrno>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+// ASKAPsoft includes
+#include "askap/AskapLogging.h"
+#include "askap/AskapError.h"
+#include "boost/shared_ptr.hpp"
+#include "boost/thread.hpp"
+#include "boost/bind.hpp"
+#include "casa/OS/Timer.h"
+#include "cpcommon/VisDatagram.h"
+
+// Local package includes
+#include "ingestpipeline/sourcetask/VisSource.h"
+
+// Using
+using namespace askap;
+using namespace askap::cp;
+using namespace askap::cp::ingest;
+
+ASKAP_LOGGER(logger, ".tVisSourcePerf");
+
+/// Sends the datagrams, the timestamp field holds the sequence number
+static void generate(unsigned int port, unsigned long count, unsigned long rate)
+{
+    const int fd = socket(PF_INET, SOCK_DGRAM, 0);
+    ASKAPCHECK(fd != -1, "Could not create socket. Errno: " << errno);
+    const int sndsz = 8 * 1024 * 1024;
+    setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &sndsz, sizeof(sndsz));
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(struct sockaddr_in));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    ASKAPCHECK(connect(fd, reinterpret_cast<const struct sockaddr *>(&addr), sizeof(addr)) == 0,
+            "Could not connect socket. Errno: " << errno);
+
+    VisDatagram vis;
+    memset(&vis, 0, sizeof(VisDatagram));
+    vis.version = VISPAYLOAD_VERSION;
+
+    casa::Timer timer;
+    timer.mark();
+    for (unsigned long i = 0; i < count; ++i) {
+        vis.timestamp = i;
+        if (send(fd, &vis, sizeof(VisDatagram), 0) == -1) {
+            ASKAPLOG_WARN_STR(logger, "UDP send failed. Errno: " << errno);
+        }
+        if (rate > 0) {
+            // Pace by the elapsed time rather than sleeping a fixed interval
+            const double ahead = static_cast<double>(i + 1) / rate - timer.real();
+            if (ahead > 0.001) {
+                usleep(static_cast<useconds_t>(ahead * 1e6));
+            }
+        }
+    }
+    const double elapsed = timer.real();
+    ASKAPLOG_INFO_STR(logger, "Sent " << count << " datagrams in " << elapsed
+            << "s (" << count / elapsed << " datagrams/s)");
+    close(fd);
+}
+
+int main(int argc, char *argv[])
+{
+    ASKAPLOG_INIT("tVisSourcePerf.log_cfg");
+
+    const unsigned long count = argc > 1 ? strtoul(argv[1], 0, 10) : 1000000;
+    const unsigned long rate = argc > 2 ? strtoul(argv[2], 0, 10) : 0;
+    const unsigned int bufSize = argc > 3 ? strtoul(argv[3], 0, 10) : 100000;
+    const unsigned int port = argc > 4 ? strtoul(argv[4], 0, 10) : 3000;
+
+    VisSource source(port, bufSize);
+    boost::thread sender(boost::bind(&generate, port, count, rate));
+
+    // Receive until everything has arrived or nothing arrives for a second
+    // after the sender has finished
+    const long timeout = 1000000;
+    unsigned long received = 0;
+    unsigned long outOfOrder = 0;
+    unsigned long expected = 0;
+    casa::Timer timer;
+    double firstTime = -1.0;
+    double lastTime = 0.0;
+    timer.mark();
+    while (received < count) {
+        boost::shared_ptr<VisDatagram> vis = source.next(timeout);
+        if (!vis) {
+            if (sender.timed_join(boost::posix_time::seconds(0))) {
+                break;
+            }
+            continue;
+        }
+        lastTime = timer.real();
+        if (firstTime < 0) {
+            firstTime = lastTime;
+        }
+        if (vis->timestamp < expected) {
+            ++outOfOrder;
+        } else {
+            expected = vis->timestamp + 1;
+        }
+        ++received;
+    }
+    sender.join();
+
+    const double elapsed = lastTime - firstTime;
+    const unsigned long lost = count - received;
+    std::cout << "Sent:         " << count << " datagrams" << std::endl;
+    std::cout << "Received:     " << received << " datagrams" << std::endl;
+    std::cout << "Lost:         " << lost << " ("
+        << (count > 0 ? 100.0 * lost / count : 0.0) << "%)" << std::endl;
+    std::cout << "Out of order: " << outOfOrder << std::endl;
+    if (elapsed > 0) {
+        std::cout << "Rate:         " << received / elapsed << " datagrams/s, "
+            << received * sizeof(VisDatagram) / elapsed / 1e6 << " MB/s" << std::endl;
+    }
+    return 0;
+}
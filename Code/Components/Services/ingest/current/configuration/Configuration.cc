@@ -149,6 +149,16 @@ MonitoringProviderConfig Configuration::monitoringConfig(void) const
     }
 }
 
+bool Configuration::threadedPipeline(void) const
+{
+    return itsParset.getBool("tasks.threaded", false);
+}
+
+casa::uInt Configuration::stageQueueSize(void) const
+{
+    return itsParset.getUint32("tasks.queuesize", 2);
+}
+
 TopicConfig Configuration::metadataTopic(void) const
 {
     const string registryHost = itsParset.getString("metadata_source.ice.locator_host");
@@ -168,7 +178,8 @@ void Configuration::buildTasks(void)
         const string typeStr = itsParset.getString(keyBase + ".type");
         const TaskDesc::Type type = TaskDesc::toType(typeStr);
         const LOFAR::ParameterSet params = itsParset.makeSubset(keyBase + ".params.");
-        itsTasks.push_back(TaskDesc(*it, type, params));
+        const string stage = itsParset.getString(keyBase + ".stage", *it);
+        itsTasks.push_back(TaskDesc(*it, type, params, stage));
     }
 }
 
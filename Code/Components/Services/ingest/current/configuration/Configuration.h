@@ -103,6 +103,14 @@ class Configuration {
         /// @brief Ice configuration for the monitoring provider interface
         MonitoringProviderConfig monitoringConfig(void) const;
 
+        /// @brief Returns true if the pipeline tasks should run in separate
+        /// threads (stages), false if all tasks run on the thread of the source.
+        bool threadedPipeline(void) const;
+
+        /// @brief The maximum number of VisChunks queued between two stages
+        /// of the threaded pipeline.
+        casa::uInt stageQueueSize(void) const;
+
     private:
 
         void buildTasks(void);
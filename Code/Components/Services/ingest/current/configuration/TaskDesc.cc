@@ -43,8 +43,10 @@ using namespace askap::cp::ingest;
 
 TaskDesc::TaskDesc(const std::string& name,
                    const TaskDesc::Type type,
-                   const LOFAR::ParameterSet& params)
-        : itsName(name), itsType(type), itsParams(params)
+                   const LOFAR::ParameterSet& params,
+                   const std::string& stage)
+        : itsName(name), itsType(type), itsParams(params),
+        itsStage(stage.empty() ? name : stage)
 {
 }
 
@@ -63,6 +65,11 @@ LOFAR::ParameterSet TaskDesc::params(void) const
     return itsParams;
 }
 
+std::string TaskDesc::stage(void) const
+{
+    return itsStage;
+}
+
 TaskDesc::Type TaskDesc::toType(const std::string& type)
 {
     if (type == "MergedSource") {
@@ -64,9 +64,16 @@ class TaskDesc {
         };
 
         /// @brief Constructor
+        /// @param[in] name     a generic name for the task.
+        /// @param[in] type     the type of task.
+        /// @param[in] params   a parameter subset for this specific task.
+        /// @param[in] stage    the stage of the threaded pipeline this task
+        ///                     runs in. Defaults to the name of the task
+        ///                     (i.e. each task has its own stage).
         TaskDesc(const std::string& name,
                  const TaskDesc::Type type,
-                 const LOFAR::ParameterSet& params);
+                 const LOFAR::ParameterSet& params,
+                 const std::string& stage = "");
 
         /// @brief A generic name for the task. This can be anything, is just a label.
         std::string name(void) const;
@@ -77,6 +84,10 @@ class TaskDesc {
         /// @brief A parameter subset for this specific task.
         LOFAR::ParameterSet params(void) const;
 
+        /// @brief The stage of the threaded pipeline this task runs in.
+        /// Consecutive tasks with the same stage share a thread.
+        std::string stage(void) const;
+
         /// @brief Maps string representations of the task type to one of the types
         /// in the "Type" enumeration.
         /// @throw AskapError   If the string could not be mapped to a known "Type".
@@ -87,6 +98,7 @@ class TaskDesc {
         std::string itsName;
         TaskDesc::Type itsType;
         LOFAR::ParameterSet itsParams;
+        std::string itsStage;
 };
 
 }
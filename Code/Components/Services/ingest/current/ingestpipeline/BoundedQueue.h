@@ -0,0 +1,163 @@
+/// @file BoundedQueue.h
+///
+/// @copyright (c) 2015 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+
+#ifndef ASKAP_CP_INGEST_BOUNDEDQUEUE_H
+#define ASKAP_CP_INGEST_BOUNDEDQUEUE_H
+
+// ASKAPsoft includes
+#include "boost/shared_ptr.hpp"
+#include "boost/thread/mutex.hpp"
+#include "boost/thread/condition.hpp"
+#include "boost/circular_buffer.hpp"
+
+namespace askap {
+namespace cp {
+namespace ingest {
+
+/// @brief A thread safe bounded queue connecting two threads.
+/// Unlike CircularBuffer, which overwrites the oldest element when full,
+/// this queue blocks the producer until the consumer makes room. This
+/// provides back pressure between the stages of the pipeline without
+/// losing any data. The queue can be closed, which unblocks both the
+/// producer and the consumer (e.g. if one of the stages has failed).
+template<class T>
+class BoundedQueue {
+    public:
+
+        /// @brief Constructor.
+        /// @param[in] bufSize  the maximum number of elements (of type T)
+        ///                     that the queue can contain.
+        BoundedQueue(const unsigned int bufSize) : itsClosed(false) {
+            if (bufSize > 0) {
+                itsBuffer.set_capacity(bufSize);
+            } else {
+                itsBuffer.set_capacity(1);
+            }
+        };
+
+        /// @brief Add an element to the back of the queue.
+        /// This call blocks while the queue is full.
+        /// @param[in]  obj a pointer to be added to the queue. A null
+        ///                 pointer is a valid element.
+        /// @return true if the element has been added, false if the queue
+        ///         has been closed.
+        bool push(const boost::shared_ptr<T> obj) {
+            boost::mutex::scoped_lock lock(itsMutex);
+            while (itsBuffer.full() && !itsClosed) {
+                itsCondVar.wait(lock);
+            }
+            if (itsClosed) {
+                return false;
+            }
+            itsBuffer.push_back(obj);
+
+            // Notify the consumer
+            lock.unlock();
+            itsCondVar.notify_all();
+            return true;
+        };
+
+        /// @brief Get the next object from the front of the queue.
+        /// This call blocks while the queue is empty.
+        /// @return the element from the front of the queue, or a null pointer
+        ///         if the queue has been closed and is empty.
+        boost::shared_ptr<T> pop(void) {
+            boost::mutex::scoped_lock lock(itsMutex);
+            while (itsBuffer.empty() && !itsClosed) {
+                itsCondVar.wait(lock);
+            }
+            if (itsBuffer.empty()) {
+                return boost::shared_ptr<T>(); // Null pointer
+            }
+            boost::shared_ptr<T> obj(itsBuffer.front());
+            itsBuffer.pop_front();
+
+            // Notify the producer
+            lock.unlock();
+            itsCondVar.notify_all();
+            return obj;
+        };
+
+        /// @brief Get the next object from the front of the queue, without
+        /// waiting.
+        /// @return the element from the front of the queue, or a null pointer
+        ///         if the queue is empty.
+        boost::shared_ptr<T> tryPop(void) {
+            boost::mutex::scoped_lock lock(itsMutex);
+            if (itsBuffer.empty()) {
+                return boost::shared_ptr<T>(); // Null pointer
+            }
+            boost::shared_ptr<T> obj(itsBuffer.front());
+            itsBuffer.pop_front();
+
+            // Notify the producer
+            lock.unlock();
+            itsCondVar.notify_all();
+            return obj;
+        };
+
+        /// @brief Close the queue.
+        /// Any blocked or subsequent push fails, pop returns the remaining
+        /// elements and then null pointers.
+        void close(void) {
+            boost::mutex::scoped_lock lock(itsMutex);
+            itsClosed = true;
+            lock.unlock();
+            itsCondVar.notify_all();
+        };
+
+        /// @brief Returns the number of items in the queue
+        size_t size(void) const {
+            boost::mutex::scoped_lock lock(itsMutex);
+            return itsBuffer.size();
+        };
+
+        /// @brief Returns the maximum number of items in the queue
+        size_t capacity(void) const {
+            boost::mutex::scoped_lock lock(itsMutex);
+            return itsBuffer.capacity();
+        };
+
+    private:
+        /// The circular buffer holding the elements
+        boost::circular_buffer< boost::shared_ptr<T> > itsBuffer;
+
+        /// True if the queue has been closed
+        bool itsClosed;
+
+        // Mutex used for synchronisation between threads
+        // This is mutable so the "size() const" method can use it
+        mutable boost::mutex itsMutex;
+
+        // Condition variable used for synchronisation between threads.
+        // Both the producer and the consumer wait on it.
+        boost::condition itsCondVar;
+};
+
+}
+}
+}
+
+#endif
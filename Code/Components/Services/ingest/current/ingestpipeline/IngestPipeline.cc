@@ -110,21 +110,27 @@ void IngestPipeline::ingest(void)
         itsTasks.push_back(task);
     }
 
-    // 6) Process correlator integrations, one at a time
-    casa::Timer timer;
-    while (itsRunning)  {
-        try {
-            timer.mark();
-            bool endOfStream = ingestOne();
-            ASKAPLOG_DEBUG_STR(logger, "Total cycle execution time "
-                    << timer.real() << "s");
-            itsRunning = !endOfStream;
-        } catch (InterruptedException&) {
-            break;
+    // 6) Process correlator integrations, either one at a time on this
+    // thread or with the tasks running in separate pipeline stages
+    if (itsConfig.threadedPipeline() && !itsTasks.empty()) {
+        ingestThreaded();
+    } else {
+        casa::Timer timer;
+        while (itsRunning)  {
+            try {
+                timer.mark();
+                bool endOfStream = ingestOne();
+                ASKAPLOG_DEBUG_STR(logger, "Total cycle execution time "
+                        << timer.real() << "s");
+                itsRunning = !endOfStream;
+            } catch (InterruptedException&) {
+                break;
+            }
         }
     }
 
     // 7) Clean up
+    itsStages.clear();
     itsSource.reset();
     // Destroying this is safe even if the object was not initialised
     MonitoringSingleton::destroy();
@@ -153,3 +159,70 @@ bool IngestPipeline::ingestOne(void)
 
     return false; // Not finished
 }
+
+void IngestPipeline::buildStages(void)
+{
+    // The first task description is the source
+    const std::vector<TaskDesc>& tasks = itsConfig.tasks();
+    ASKAPDEBUGASSERT(tasks.size() == itsTasks.size() + 1);
+
+    std::vector<ITask::ShPtr> stageTasks;
+    for (size_t i = 0; i < itsTasks.size(); ++i) {
+        stageTasks.push_back(itsTasks[i]);
+        const std::string& stage = tasks[i + 1].stage();
+        if (i + 1 == itsTasks.size() || tasks[i + 2].stage() != stage) {
+            TaskStage::ShPtr newStage(new TaskStage(stage, stageTasks,
+                        itsConfig.stageQueueSize()));
+            if (!itsStages.empty()) {
+                itsStages.back()->setNext(newStage);
+            }
+            itsStages.push_back(newStage);
+            stageTasks.clear();
+        }
+    }
+}
+
+void IngestPipeline::ingestThreaded(void)
+{
+    buildStages();
+    ASKAPDEBUGASSERT(!itsStages.empty());
+    ASKAPLOG_INFO_STR(logger, "Running " << itsStages.size() << " pipeline stage(s) in "
+            "separate threads, up to " << itsConfig.stageQueueSize() << " chunk(s) queued per stage");
+    for (size_t i = 0; i < itsStages.size(); ++i) {
+        itsStages[i]->start();
+    }
+
+    // The source runs on this thread, so it is never stalled by a slow task
+    // unless the queue of the first stage is full
+    casa::Timer timer;
+    while (itsRunning) {
+        try {
+            ASKAPLOG_DEBUG_STR(logger, "Waiting for data");
+            timer.mark();
+            VisChunk::ShPtr chunk(itsSource->next());
+            ASKAPLOG_DEBUG_STR(logger, "Source task execution time " << timer.real() << "s");
+            if (chunk.get() == 0) {
+                break; // Finished
+            }
+            ASKAPLOG_INFO_STR(logger, "Received one VisChunk. Timestamp: " << chunk->time());
+            if (!itsStages.front()->push(chunk)) {
+                break; // One of the stages has failed
+            }
+        } catch (InterruptedException&) {
+            break;
+        }
+    }
+
+    // Signal the end of the stream and wait for the queued data to be processed
+    itsStages.front()->push(VisChunk::ShPtr());
+    for (size_t i = 0; i < itsStages.size(); ++i) {
+        itsStages[i]->join();
+    }
+
+    for (size_t i = 0; i < itsStages.size(); ++i) {
+        if (itsStages[i]->failed()) {
+            ASKAPTHROW(AskapError, "Pipeline stage " << itsStages[i]->name()
+                    << " failed: " << itsStages[i]->error());
+        }
+    }
+}
@@ -37,6 +37,7 @@
 // Local package includes
 #include "ingestpipeline/sourcetask/ISource.h"
 #include "ingestpipeline/ITask.h"
+#include "ingestpipeline/TaskStage.h"
 #include "configuration/Configuration.h" // Includes all configuration attributes too
 
 namespace askap {
@@ -72,6 +73,13 @@ class IngestPipeline {
 
         bool ingestOne(void);
 
+        // Process correlator integrations with each pipeline stage
+        // running on its own thread
+        void ingestThreaded(void);
+
+        // Group consecutive tasks with the same stage into pipeline stages
+        void buildStages(void);
+
         const Configuration itsConfig;
 
         bool itsRunning;
@@ -80,6 +88,9 @@ class IngestPipeline {
 
         std::vector<ITask::ShPtr> itsTasks;
 
+        // Stages of the threaded pipeline (empty if not used)
+        std::vector<TaskStage::ShPtr> itsStages;
+
         // No support for assignment
         IngestPipeline& operator=(const IngestPipeline& rhs);
 
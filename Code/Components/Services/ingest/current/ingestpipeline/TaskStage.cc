@@ -0,0 +1,171 @@
+/// @file TaskStage.cc
+///
+/// @copyright (c) 2015 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+
+// Include own header file first
+#include "ingestpipeline/TaskStage.h"
+
+// Include package level header file
+#include "askap_cpingest.h"
+
+// System includes
+#include <string>
+#include <vector>
+#include <exception>
+
+// ASKAPsoft includes
+#include "askap/AskapLogging.h"
+#include "askap/AskapError.h"
+#include "boost/bind.hpp"
+#include "casa/OS/Timer.h"
+#include "cpcommon/VisChunk.h"
+
+// Local package includes
+#include "monitoring/MonitoringSingleton.h"
+
+ASKAP_LOGGER(logger, ".TaskStage");
+
+using namespace askap;
+using namespace askap::cp::common;
+using namespace askap::cp::ingest;
+
+TaskStage::TaskStage(const std::string& name,
+                     const std::vector<ITask::ShPtr>& tasks,
+                     unsigned int queueSize)
+    : itsName(name), itsTasks(tasks), itsQueue(queueSize)
+{
+    ASKAPCHECK(!itsTasks.empty(), "Pipeline stage " << itsName << " has no tasks");
+}
+
+TaskStage::~TaskStage()
+{
+    if (itsThread) {
+        abort();
+        itsThread->join();
+    }
+}
+
+void TaskStage::setNext(boost::shared_ptr<TaskStage> next)
+{
+    ASKAPCHECK(!itsThread, "Pipeline stage " << itsName << " is already running");
+    itsNext = next;
+}
+
+void TaskStage::start(void)
+{
+    ASKAPCHECK(!itsThread, "Pipeline stage " << itsName << " is already running");
+    itsThread.reset(new boost::thread(boost::bind(&TaskStage::run, this)));
+}
+
+bool TaskStage::push(VisChunk::ShPtr chunk)
+{
+    return itsQueue.push(chunk);
+}
+
+void TaskStage::join(void)
+{
+    if (itsThread) {
+        itsThread->join();
+    }
+}
+
+void TaskStage::abort(void)
+{
+    itsQueue.close();
+}
+
+bool TaskStage::failed(void) const
+{
+    boost::mutex::scoped_lock lock(itsMutex);
+    return !itsError.empty();
+}
+
+std::string TaskStage::error(void) const
+{
+    boost::mutex::scoped_lock lock(itsMutex);
+    return itsError;
+}
+
+std::string TaskStage::name(void) const
+{
+    return itsName;
+}
+
+void TaskStage::run(void)
+{
+    ASKAPLOG_DEBUG_STR(logger, "Pipeline stage " << itsName << " started");
+    while (true) {
+        VisChunk::ShPtr chunk(itsQueue.pop());
+        if (chunk.get() == 0) {
+            break; // End of stream
+        }
+
+        try {
+            processOne(chunk);
+        } catch (const std::exception& e) {
+            ASKAPLOG_ERROR_STR(logger, "Pipeline stage " << itsName << " failed: " << e.what());
+            {
+                boost::mutex::scoped_lock lock(itsMutex);
+                itsError = e.what();
+            }
+            // Stop accepting data, this makes the upstream stages stop too
+            itsQueue.close();
+            break;
+        }
+
+        if (itsNext && !itsNext->push(chunk)) {
+            // The downstream stage has failed
+            itsQueue.close();
+            break;
+        }
+    }
+
+    // Signal the end of the stream to the next stage
+    if (itsNext) {
+        itsNext->push(VisChunk::ShPtr());
+    }
+    ASKAPLOG_DEBUG_STR(logger, "Pipeline stage " << itsName << " finished");
+}
+
+void TaskStage::processOne(VisChunk::ShPtr chunk)
+{
+    casa::Timer stageTimer;
+    casa::Timer timer;
+    stageTimer.mark();
+    for (unsigned int i = 0; i < itsTasks.size(); ++i) {
+        timer.mark();
+        itsTasks[i]->process(chunk);
+        ASKAPLOG_DEBUG_STR(logger, itsTasks[i]->getName() << " execution time "
+                << timer.real() << "s");
+    }
+
+    const double processingTime = stageTimer.real();
+    const int queueDepth = static_cast<int>(itsQueue.size());
+    ASKAPLOG_DEBUG_STR(logger, "Pipeline stage " << itsName << " execution time "
+            << processingTime << "s, " << queueDepth << " chunk(s) queued");
+    MonitoringSingleton::update("stage." + itsName + ".ProcessingTime", processingTime,
+            MonitorPointStatus::OK, "s");
+    MonitoringSingleton::update("stage." + itsName + ".QueueDepth", queueDepth,
+            MonitorPointStatus::OK);
+}
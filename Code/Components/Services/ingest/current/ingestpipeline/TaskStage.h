@@ -0,0 +1,152 @@
+/// @file TaskStage.h
+///
+/// @copyright (c) 2015 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+
+#ifndef ASKAP_CP_INGEST_TASKSTAGE_H
+#define ASKAP_CP_INGEST_TASKSTAGE_H
+
+// System includes
+#include <string>
+#include <vector>
+
+// ASKAPsoft includes
+#include "boost/shared_ptr.hpp"
+#include "boost/thread/thread.hpp"
+#include "boost/thread/mutex.hpp"
+#include "cpcommon/VisChunk.h"
+
+// Local package includes
+#include "ingestpipeline/ITask.h"
+#include "ingestpipeline/BoundedQueue.h"
+
+namespace askap {
+namespace cp {
+namespace ingest {
+
+/// @brief A stage of the threaded ingest pipeline.
+///
+/// A stage owns one or more consecutive tasks of the pipeline and runs
+/// them on its own thread. VisChunks are passed to the stage via a bounded
+/// input queue. Once all tasks of this stage have processed a VisChunk, it
+/// is passed to the input queue of the next stage (if any). A null pointer
+/// marks the end of the stream, it is passed down the pipeline before the
+/// thread exits.
+///
+/// The following monitoring points are published for each processed VisChunk
+/// (with the stage name in place of <name>):
+/// - stage.<name>.ProcessingTime - time spent in the tasks of this stage (seconds)
+/// - stage.<name>.QueueDepth - number of VisChunks waiting in the input queue
+class TaskStage {
+    public:
+        /// @brief Constructor.
+        /// @param[in] name     the name of this stage, used for logging
+        ///                     and monitoring.
+        /// @param[in] tasks    the tasks to run, in order.
+        /// @param[in] queueSize the maximum number of VisChunks waiting
+        ///                     in the input queue.
+        TaskStage(const std::string& name,
+                  const std::vector<ITask::ShPtr>& tasks,
+                  unsigned int queueSize);
+
+        /// @brief Destructor.
+        /// Aborts and joins the thread if it is still running.
+        ~TaskStage();
+
+        /// @brief Set the stage which receives the output of this stage.
+        /// Must be called before start().
+        /// @param[in] next the next stage of the pipeline
+        void setNext(boost::shared_ptr<TaskStage> next);
+
+        /// @brief Start the thread of this stage.
+        void start(void);
+
+        /// @brief Pass a VisChunk to this stage.
+        /// This call blocks while the input queue is full.
+        /// @param[in] chunk the VisChunk to process, a null pointer signals
+        ///                  the end of the stream.
+        /// @return false if this stage or one of the following stages has
+        ///         failed and no longer accepts data, true otherwise.
+        bool push(askap::cp::common::VisChunk::ShPtr chunk);
+
+        /// @brief Wait for the thread of this stage to finish.
+        void join(void);
+
+        /// @brief Stop accepting data.
+        /// The VisChunks already queued are still processed.
+        void abort(void);
+
+        /// @brief Returns true if one of the tasks of this stage has thrown
+        /// an exception.
+        bool failed(void) const;
+
+        /// @brief Returns the message of the exception thrown by one of the
+        /// tasks, an empty string if none.
+        std::string error(void) const;
+
+        /// @brief Returns the name of this stage.
+        std::string name(void) const;
+
+        /// Shared pointer definition
+        typedef boost::shared_ptr<TaskStage> ShPtr;
+
+    private:
+        /// Main loop of the thread
+        void run(void);
+
+        /// Process one VisChunk with all tasks of this stage
+        void processOne(askap::cp::common::VisChunk::ShPtr chunk);
+
+        /// The name of this stage
+        const std::string itsName;
+
+        /// The tasks of this stage
+        const std::vector<ITask::ShPtr> itsTasks;
+
+        /// Input queue
+        BoundedQueue<askap::cp::common::VisChunk> itsQueue;
+
+        /// Next stage of the pipeline, if any
+        boost::shared_ptr<TaskStage> itsNext;
+
+        /// The thread of this stage
+        boost::shared_ptr<boost::thread> itsThread;
+
+        /// Error message of the failed task (empty if none)
+        std::string itsError;
+
+        /// Mutex protecting itsError
+        mutable boost::mutex itsMutex;
+
+        // No support for assignment
+        TaskStage& operator=(const TaskStage& rhs);
+
+        // No support for copy constructor
+        TaskStage(const TaskStage& src);
+};
+
+}
+}
+}
+
+#endif
@@ -40,6 +40,7 @@
 #include "Common/ParameterSet.h"
 #include "casa/Arrays/Matrix.h"
 #include "casa/Arrays/MatrixMath.h"
+#include "casa/Arrays/ArrayLogical.h"
 #include "measures/Measures.h"
 #include "measures/Measures/MeasConvert.h"
 #include "measures/Measures/MCEpoch.h"
@@ -69,6 +70,10 @@ CalcUVWTask::CalcUVWTask(const LOFAR::ParameterSet& parset,
 
     createPositionMatrix(config);
     setupBeamOffsets(config);
+
+    itsAntUVW.resize(nBeams());
+    itsCachedPointing.resize(nBeams());
+    itsCacheValid.resize(nBeams(), false);
 }
 
 CalcUVWTask::~CalcUVWTask()
@@ -78,8 +83,16 @@ CalcUVWTask::~CalcUVWTask()
 
 void CalcUVWTask::process(VisChunk::ShPtr chunk)
 {
+    // Determine Greenwich Apparent Sidereal Time and the frame once for
+    // the whole integration
+    const double gast = calcGAST(chunk->time());
+    const casa::MeasFrame frame(casa::MEpoch(chunk->time(), casa::MEpoch::UTC));
+
+    // Antenna UVWs from the previous integration are stale
+    itsCacheValid.assign(itsCacheValid.size(), false);
+
     for (casa::uInt row = 0; row < chunk->nRow(); ++row) {
-        calcForRow(chunk, row);
+        calcForRow(chunk, row, gast, frame);
     }
 }
 
@@ -115,28 +128,45 @@ double CalcUVWTask::calcGAST(const casa::MVEpoch &epoch)
     return (gast - Int(gast)) * C::_2pi; // Into Radians
 }
 
-void CalcUVWTask::calcForRow(VisChunk::ShPtr chunk, const casa::uInt row)
+void CalcUVWTask::calcForRow(VisChunk::ShPtr chunk, const casa::uInt row,
+                             const double gast, const casa::MeasFrame& frame)
 {
     const casa::uInt ant1 = chunk->antenna1()(row);
     const casa::uInt ant2 = chunk->antenna2()(row);
+    const casa::uInt beam = chunk->beam1()(row);
 
     const casa::uInt nAnt = nAntennas();
 
     ASKAPCHECK(ant1 < nAnt, "Antenna index (" << ant1 << ") is invalid");
     ASKAPCHECK(ant2 < nAnt, "Antenna index (" << ant2 << ") is invalid");
+    ASKAPCHECK(beam < nBeams(), "Beam index (" << beam << ") is invalid");
+
+    // All rows of a beam normally share the dish pointing, recalculate
+    // antenna UVWs only if this row has a different one
+    const casa::MVDirection& dishPointing = chunk->phaseCentre1()(row);
+    if (!itsCacheValid[beam] ||
+            !casa::allEQ(itsCachedPointing[beam].getValue(), dishPointing.getValue())) {
+        calcForBeam(beam, dishPointing, gast, frame);
+    }
 
-    // Determine Greenwich Mean Sidereal Time
-    const double gast = calcGAST(chunk->time()); 
-    casa::MeasFrame frame(casa::MEpoch(chunk->time(), casa::MEpoch::UTC));
+    // Finally set the baseline uvw in the VisChunk
+    const casa::Matrix<double>& antUVW = itsAntUVW[beam];
+    casa::RigidVector<casa::Double, 3>& uvw = chunk->uvw()(row);
+    for (casa::uInt i = 0; i < 3; ++i) {
+        uvw(i) = antUVW(i, ant2) - antUVW(i, ant1);
+    }
+}
 
+void CalcUVWTask::calcForBeam(const casa::uInt beam, const casa::MVDirection& dishPointing,
+                              const double gast, const casa::MeasFrame& frame)
+{
     // phase center for a given beam
-    //const casa::MDirection fpc = phaseCentre(chunk->phaseCentre1()(row),chunk->beam1()(row));
-    const casa::MDirection fpc = casa::MDirection::Convert(phaseCentre(chunk->phaseCentre1()(row),chunk->beam1()(row)),
+    const casa::MDirection fpc = casa::MDirection::Convert(phaseCentre(dishPointing, beam),
                                     casa::MDirection::Ref(casa::MDirection::TOPO, frame))();
     const double ra = fpc.getAngle().getValue()(0);
     const double dec = fpc.getAngle().getValue()(1);
 
-    // Transformation from antenna position difference (ant2-ant1) to uvw
+    // Transformation from antenna position to uvw
     const double H0 = gast - ra;
     const double sH0 = sin(H0);
     const double cH0 = cos(H0);
@@ -147,40 +177,21 @@ void CalcUVWTask::calcForRow(VisChunk::ShPtr chunk, const casa::uInt row)
     trans(1, 0) = sd * cH0; trans(1, 1) = -sd * sH0; trans(1, 2) = -cd;
     trans(2, 0) = -cd * cH0; trans(2, 1) = cd * sH0; trans(2, 2) = -sd;
 
-    // Rotate antennas to correct frame
-
-    /*
-    // there is no need to calculate uvw per antenna here as we recalculate it per row
-    // caching it per row and beam would be the optimal approach in terms of the number of
-    // operations, but we leave such implementation for some time in the future
-
-    Matrix<double> antUVW(3, nAnt);
-    
-    for (uInt i = 0; i < nAnt; ++i) {
-        antUVW.column(i) = casa::product(trans, antXYZ(i));
+    // Rotate antennas to correct frame, the conversion to J2000 is a rotation
+    // too, so one machine serves all antennas of this beam
+    const casa::UVWMachine uvm(casa::MDirection::Ref(casa::MDirection::J2000), fpc);
+    const casa::uInt nAnt = nAntennas();
+    casa::Matrix<double>& antUVW = itsAntUVW[beam];
+    antUVW.resize(3, nAnt);
+    for (casa::uInt ant = 0; ant < nAnt; ++ant) {
+        Vector<double> uvwvec = casa::product(trans, antXYZ(ant));
+        ASKAPDEBUGASSERT(uvwvec.nelements() == 3);
+        uvm.convertUVW(uvwvec);
+        antUVW.column(ant) = uvwvec;
     }
 
-    double x1 = antUVW(0, ant1), y1 = antUVW(1, ant1), z1 = antUVW(2, ant1);
-    double x2 = antUVW(0, ant2), y2 = antUVW(1, ant2), z2 = antUVW(2, ant2);
-    Vector<double> uvwvec(3);
-    uvwvec(0) = x2 - x1;
-    uvwvec(1) = y2 - y1;
-    uvwvec(2) = z2 - z1;
-    */
-
-    const Vector<double> baseline = antXYZ(ant2) - antXYZ(ant1);
-    ASKAPDEBUGASSERT(baseline.nelements() == 3);
-    Vector<double> uvwvec = casa::product(trans,baseline);
-    ASKAPDEBUGASSERT(uvwvec.nelements() == 3);
-    // do the conversion to J2000 in a quick and dirty way for now
-    // some optimisation and caching of rotation matrix are definitely possible here
-    // but cache class in accessors needs to be adapted first.
-    casa::UVWMachine uvm(casa::MDirection::Ref(casa::MDirection::J2000), fpc);
-    uvm.convertUVW(uvwvec);
-    ASKAPDEBUGASSERT(uvwvec.nelements() == 3);
-
-    // Finally set the uvwvec in the VisChunk
-    chunk->uvw()(row) = uvwvec;
+    itsCachedPointing[beam] = dishPointing;
+    itsCacheValid[beam] = true;
 }
 
 /// @brief obtain ITRF coordinates of a given antenna
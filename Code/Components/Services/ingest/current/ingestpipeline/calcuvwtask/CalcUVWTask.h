@@ -27,11 +27,17 @@
 #ifndef ASKAP_CP_INGEST_CALCUVWTASK_H
 #define ASKAP_CP_INGEST_CALCUVWTASK_H
 
+// System includes
+#include <vector>
+
 // ASKAPsoft includes
 #include "boost/scoped_ptr.hpp"
 #include "Common/ParameterSet.h"
 #include "scimath/Mathematics/RigidVector.h"
 #include "casa/Arrays/Vector.h"
+#include "casa/Arrays/Matrix.h"
+#include "casa/Quanta/MVDirection.h"
+#include "measures/Measures/MeasFrame.h"
 #include "cpcommon/VisChunk.h"
 
 // Local package includes
@@ -54,6 +60,10 @@ namespace ingest {
 /// Once data is sourced into the pipeline, the process() method is called
 /// for each task (in a specific sequence), the VisChunk is read and/or modified
 /// by each task.
+///
+/// The UVW coordinates of all antennas are calculated once per beam and
+/// integration, the UVW coordinates of each baseline are then formed by
+/// differencing.
 class CalcUVWTask : public askap::cp::ingest::ITask {
     public:
 
@@ -104,7 +114,14 @@ class CalcUVWTask : public askap::cp::ingest::ITask {
  
     private:
         // Calculates UVW coordinates for the specified "row" in the "chunk"
-        void calcForRow(askap::cp::common::VisChunk::ShPtr chunk, const casa::uInt row);
+        // using the antenna UVWs cached for the beam of this row
+        void calcForRow(askap::cp::common::VisChunk::ShPtr chunk, const casa::uInt row,
+                        const double gast, const casa::MeasFrame& frame);
+
+        // Calculates UVW coordinates (in J2000) of all antennas for the
+        // specified beam and dish pointing, and stores them in the cache
+        void calcForBeam(const casa::uInt beam, const casa::MVDirection& dishPointing,
+                         const double gast, const casa::MeasFrame& frame);
 
         // Populates the antenna Position Matrix
         void createPositionMatrix(const Configuration& config);
@@ -121,6 +138,17 @@ class CalcUVWTask : public askap::cp::ingest::ITask {
         // two element vector containing the x and y offsets at index
         // 0 and 1 respectivly
         casa::Vector< casa::RigidVector<double, 2> > itsBeamOffset;
+
+        // Cache of antenna UVWs, one matrix per beam. Size of each matrix is
+        // 3 (u, v & w) rows by nAntenna columns. Only valid for the
+        // integration being processed.
+        std::vector< casa::Matrix<double> > itsAntUVW;
+
+        // The dish pointing each element of itsAntUVW was calculated for
+        std::vector<casa::MVDirection> itsCachedPointing;
+
+        // True if the corresponding element of itsAntUVW is valid
+        std::vector<bool> itsCacheValid;
 };
 
 }
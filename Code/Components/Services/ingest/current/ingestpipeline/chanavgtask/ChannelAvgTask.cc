@@ -34,8 +34,6 @@
 #include "askap/AskapLogging.h"
 #include "askap/AskapError.h"
 #include "casa/aips.h"
-#include "casa/Arrays/Vector.h"
-#include "casa/Arrays/Cube.h"
 #include "cpcommon/VisChunk.h"
 
 // Local package includes
@@ -67,67 +65,6 @@ void ChannelAvgTask::process(VisChunk::ShPtr chunk)
         return;
     }
 
-    const casa::uInt nChanOriginal = chunk->nChannel();
-    if (nChanOriginal % itsAveraging != 0) {
-        ASKAPTHROW(AskapError, "Number of channels not a multiple of averaging number");
-    }
-    const casa::uInt nChanNew = nChanOriginal / itsAveraging;
-
-    // Average frequencies vector
-    const casa::Vector<casa::Double>& origFreq = chunk->frequency();
-    casa::Vector<casa::Double> newFreq(nChanNew);
-
-    for (casa::uInt newIdx = 0; newIdx < nChanNew; ++newIdx) {
-        const casa::uInt origIdx = itsAveraging * newIdx;
-        casa::Double sum = 0.0;
-        for (casa::uInt i = 0; i < itsAveraging; ++i) {
-            sum += origFreq(origIdx + i);
-        }
-        newFreq(newIdx) = sum / itsAveraging;
-    }
-
-    // Update the channel width
-    chunk->channelWidth() = chunk->channelWidth() * itsAveraging;
-
-    // Average vis and flag cubes
-    const casa::uInt nRow = chunk->nRow();
-    const casa::uInt nPol = chunk->nPol();
-    const casa::Cube<casa::Complex>& origVis = chunk->visibility();
-    const casa::Cube<casa::Bool>& origFlag = chunk->flag();
-    casa::Cube<casa::Complex> newVis(nRow, nChanNew, nPol);
-    casa::Cube<casa::Bool> newFlag(nRow, nChanNew, nPol);
-
-    for (casa::uInt row = 0; row < nRow; ++row) {
-        for (casa::uInt newIdx = 0; newIdx < nChanNew; ++newIdx) {
-            for (casa::uInt pol = 0; pol < nPol; ++pol) {
-
-                // Track the samples added, since those flagged are not
-                casa::uInt numGoodSamples = 0;
-
-                // Calculate the average over the number of samples to
-                // be averaged together (itsAveraging)
-                const casa::uInt origIdx = itsAveraging * newIdx;
-                casa::Complex sum(0.0, 0.0);
-                for (casa::uInt i = 0; i < itsAveraging; ++i) {
-                    // Only sum if not flagged
-                    if (!origFlag(row, origIdx + i, pol)) {
-                        sum += origVis(row, origIdx + i, pol);
-                        numGoodSamples++;
-                    }
-                }
-
-                if (numGoodSamples > 0) {
-                    newVis(row, newIdx, pol) = casa::Complex(sum.real() / numGoodSamples,
-                                                             sum.imag() / numGoodSamples);
-                    newFlag(row, newIdx, pol) = false;
-                } else {
-                    newVis(row, newIdx, pol) = casa::Complex(0.0, 0.0);
-                    newFlag(row, newIdx, pol) = true;
-                }
-
-            }
-        }
-    }
-
-    chunk->resize(newVis, newFlag, newFreq);
+    ASKAPDEBUGASSERT(chunk);
+    itsReducer.average(*chunk, itsAveraging);
 }
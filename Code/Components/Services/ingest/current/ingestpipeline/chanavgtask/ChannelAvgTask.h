@@ -34,6 +34,7 @@
 
 // Local package includes
 #include "ingestpipeline/ITask.h"
+#include "ingestpipeline/chanavgtask/ChannelReducer.h"
 #include "configuration/Configuration.h" // Includes all configuration attributes too
 
 namespace askap {
@@ -50,6 +51,9 @@ namespace ingest {
 /// @endverbatim
 /// The above results in 54 channels being averaged to one. Note the number of
 /// channels in the VisChunk must be a multple of this number.
+///
+/// The averaging is done in place in the VisChunk's own storage (see
+/// ChannelReducer), so no visibility or flag cubes are allocated.
 class ChannelAvgTask : public askap::cp::ingest::ITask {
     public:
         /// @brief Constructor.
@@ -74,6 +78,9 @@ class ChannelAvgTask : public askap::cp::ingest::ITask {
 
         // Number of channels to average to one
         casa::uInt itsAveraging;
+
+        // Averaging kernel, which keeps its scratch buffers between cycles
+        ChannelReducer itsReducer;
 };
 
 }
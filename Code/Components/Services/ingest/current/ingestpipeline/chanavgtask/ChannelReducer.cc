@@ -0,0 +1,155 @@
+/// @file ChannelReducer.cc
+///
+/// @copyright (c) 2015 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+
+// Include own header file first
+#include "ChannelReducer.h"
+
+// Include package level header file
+#include "askap_cpingest.h"
+
+// System includes
+#include <algorithm>
+
+// ASKAPsoft includes
+#include "askap/AskapError.h"
+#include "casa/aips.h"
+#include "casa/Arrays/Vector.h"
+#include "casa/Arrays/Cube.h"
+#include "cpcommon/VisChunk.h"
+
+using namespace askap;
+using namespace askap::cp::common;
+using namespace askap::cp::ingest;
+
+void ChannelReducer::average(VisChunk& chunk, const casa::uInt nAvg)
+{
+    const casa::uInt nChanOriginal = chunk.nChannel();
+    if (nChanOriginal % nAvg != 0) {
+        ASKAPTHROW(AskapError, "Number of channels not a multiple of averaging number");
+    }
+    const casa::uInt nChanNew = nChanOriginal / nAvg;
+    const casa::uInt nRow = chunk.nRow();
+    const casa::uInt nPol = chunk.nPol();
+    ASKAPCHECK(chunk.visibility().contiguousStorage() && chunk.flag().contiguousStorage(),
+            "Channel averaging in place requires contiguous visibility and flag cubes");
+
+    // Average frequencies; each new channel is written at or before the
+    // first of the channels it is formed from, so this can be done in place
+    casa::Vector<casa::Double>& freq = chunk.frequency();
+    for (casa::uInt newIdx = 0; newIdx < nChanNew; ++newIdx) {
+        const casa::uInt origIdx = nAvg * newIdx;
+        casa::Double sum = 0.0;
+        for (casa::uInt i = 0; i < nAvg; ++i) {
+            sum += freq(origIdx + i);
+        }
+        freq(newIdx) = sum / nAvg;
+    }
+
+    // Update the channel width
+    chunk.channelWidth() = chunk.channelWidth() * nAvg;
+
+    // Average vis and flag cubes. In the column-major cube the rows of a
+    // given channel and polarisation are contiguous, so the inner loops
+    // run over rows. The averaged block for (chan, pol) is written to
+    // its place in the smaller cube after all of its input blocks have
+    // been read, and never overlaps a block still to be read.
+    casa::Complex* vis = chunk.visibility().data();
+    casa::Bool* flag = chunk.flag().data();
+    itsSum.resize(nRow);
+    itsCount.resize(nRow);
+    casa::Complex* sum = nRow > 0 ? &itsSum[0] : 0;
+    casa::uInt* count = nRow > 0 ? &itsCount[0] : 0;
+
+    for (casa::uInt pol = 0; pol < nPol; ++pol) {
+        for (casa::uInt newIdx = 0; newIdx < nChanNew; ++newIdx) {
+            std::fill(sum, sum + nRow, casa::Complex(0.0, 0.0));
+            std::fill(count, count + nRow, 0u);
+
+            for (casa::uInt i = 0; i < nAvg; ++i) {
+                const size_t offset = size_t(nRow) *
+                    (nAvg * newIdx + i + size_t(nChanOriginal) * pol);
+                const casa::Complex* inVis = vis + offset;
+                const casa::Bool* inFlag = flag + offset;
+                // Only sum if not flagged; written without a branch so
+                // the loop can be vectorised
+                for (casa::uInt row = 0; row < nRow; ++row) {
+                    const casa::Bool good = !inFlag[row];
+                    sum[row] += good ? inVis[row] : casa::Complex(0.0, 0.0);
+                    count[row] += good;
+                }
+            }
+
+            const size_t offset = size_t(nRow) * (newIdx + size_t(nChanNew) * pol);
+            casa::Complex* outVis = vis + offset;
+            casa::Bool* outFlag = flag + offset;
+            for (casa::uInt row = 0; row < nRow; ++row) {
+                if (count[row] > 0) {
+                    outVis[row] = casa::Complex(sum[row].real() / count[row],
+                                                sum[row].imag() / count[row]);
+                    outFlag[row] = false;
+                } else {
+                    outVis[row] = casa::Complex(0.0, 0.0);
+                    outFlag[row] = true;
+                }
+            }
+        }
+    }
+
+    chunk.shrinkChannels(nChanNew);
+}
+
+void ChannelReducer::select(VisChunk& chunk, const casa::uInt start, const casa::uInt nChan)
+{
+    const casa::uInt nChanOriginal = chunk.nChannel();
+    ASKAPCHECK(start + nChan <= nChanOriginal, "Unable to select " << nChan <<
+            " channels starting from " << start << " out of " << nChanOriginal);
+    const casa::uInt nRow = chunk.nRow();
+    const casa::uInt nPol = chunk.nPol();
+    ASKAPCHECK(chunk.visibility().contiguousStorage() && chunk.flag().contiguousStorage(),
+            "Channel selection in place requires contiguous visibility and flag cubes");
+
+    casa::Vector<casa::Double>& freq = chunk.frequency();
+    for (casa::uInt chan = 0; chan < nChan; ++chan) {
+        freq(chan) = freq(start + chan);
+    }
+
+    // Move each selected (chan, pol) block of rows down to its place in
+    // the smaller cube. Destinations never lie after their sources, so
+    // copying forwards is safe.
+    casa::Complex* vis = chunk.visibility().data();
+    casa::Bool* flag = chunk.flag().data();
+    for (casa::uInt pol = 0; pol < nPol; ++pol) {
+        for (casa::uInt chan = 0; chan < nChan; ++chan) {
+            const size_t from = size_t(nRow) * (start + chan + size_t(nChanOriginal) * pol);
+            const size_t to = size_t(nRow) * (chan + size_t(nChan) * pol);
+            if (from != to) {
+                std::copy(vis + from, vis + from + nRow, vis + to);
+                std::copy(flag + from, flag + from + nRow, flag + to);
+            }
+        }
+    }
+
+    chunk.shrinkChannels(nChan);
+}
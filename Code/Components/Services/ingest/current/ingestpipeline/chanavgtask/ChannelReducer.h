@@ -0,0 +1,86 @@
+/// @file ChannelReducer.h
+///
+/// @copyright (c) 2015 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+
+#ifndef ASKAP_CP_INGEST_CHANNELREDUCER_H
+#define ASKAP_CP_INGEST_CHANNELREDUCER_H
+
+// System includes
+#include <vector>
+
+// ASKAPsoft includes
+#include "casa/aips.h"
+#include "casa/BasicSL/Complex.h"
+#include "cpcommon/VisChunk.h"
+
+namespace askap {
+namespace cp {
+namespace ingest {
+
+/// @brief Reduces the number of channels in a VisChunk in place.
+///
+/// This is the common kernel of the channel averaging and channel
+/// selection tasks. The reduced visibilities and flags are packed into
+/// the start of the chunk's existing storage and the chunk is then
+/// shrunk with VisChunk::shrinkChannels(), so no new cubes are allocated.
+/// The data are processed a channel at a time, where all rows of one
+/// channel and polarisation are adjacent in memory, and the scratch
+/// buffers used for averaging are kept between calls, so once they have
+/// grown to the number of rows no further allocation takes place.
+class ChannelReducer {
+    public:
+        /// @brief Averages each group of nAvg adjacent channels to one.
+        ///
+        /// Flagged samples are excluded from the average. Where all
+        /// samples are flagged, the average is zero and is flagged.
+        /// Frequencies are averaged and the channel width is scaled.
+        ///
+        /// @param[in,out] chunk the chunk to average.
+        /// @param[in] nAvg number of channels to average to one, which
+        ///            must divide the number of channels in the chunk.
+        /// @throw AskapError if nAvg doesn't divide the number of channels.
+        void average(askap::cp::common::VisChunk& chunk, const casa::uInt nAvg);
+
+        /// @brief Keeps only a contiguous range of channels.
+        ///
+        /// @param[in,out] chunk the chunk to select channels from.
+        /// @param[in] start first channel to keep.
+        /// @param[in] nChan number of channels to keep.
+        /// @throw AskapError if the range exceeds the channels in the chunk.
+        void select(askap::cp::common::VisChunk& chunk,
+                    const casa::uInt start, const casa::uInt nChan);
+
+    private:
+        /// Sum of the unflagged visibilities of each row
+        std::vector<casa::Complex> itsSum;
+
+        /// Number of unflagged visibilities of each row
+        std::vector<casa::uInt> itsCount;
+};
+
+}
+}
+}
+
+#endif
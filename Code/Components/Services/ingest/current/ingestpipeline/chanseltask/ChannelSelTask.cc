@@ -36,8 +36,6 @@
 #include "askap/AskapLogging.h"
 #include "askap/AskapError.h"
 #include "casa/aips.h"
-#include "casa/Arrays/Vector.h"
-#include "casa/Arrays/Cube.h"
 #include "cpcommon/VisChunk.h"
 
 // Local package includes
@@ -78,25 +76,5 @@ void ChannelSelTask::process(VisChunk::ShPtr chunk)
         return;
     }
 
-    // extract required frequencies - don't take const reference to be able to
-    // take slice (although we don't change the chunk yet)
-    casa::Vector<casa::Double>& origFreq = chunk->frequency();
-    casa::Vector<casa::Double> newFreq = origFreq(casa::Slice(itsStart,itsNChan));
-    ASKAPDEBUGASSERT(newFreq.nelements() == itsNChan);
-
-    // Extract slices from vis and flag cubes
-    const casa::uInt nRow = chunk->nRow();
-    const casa::uInt nPol = chunk->nPol();
-    casa::Cube<casa::Complex>& origVis = chunk->visibility();
-    casa::Cube<casa::Bool>& origFlag = chunk->flag();
-    const casa::IPosition start(3, 0, itsStart, 0);
-    const casa::IPosition length(3, nRow, itsNChan, nPol);
-    const casa::Slicer slicer(start,length);
-
-    casa::Cube<casa::Complex> newVis = origVis(slicer);
-    casa::Cube<casa::Bool> newFlag = origFlag(slicer);
-    ASKAPDEBUGASSERT(newVis.shape() == length);
-    ASKAPDEBUGASSERT(newFlag.shape() == length);
-
-    chunk->resize(newVis, newFlag, newFreq);
+    itsReducer.select(*chunk, itsStart, itsNChan);
 }
@@ -36,6 +36,7 @@
 
 // Local package includes
 #include "ingestpipeline/ITask.h"
+#include "ingestpipeline/chanavgtask/ChannelReducer.h"
 #include "configuration/Configuration.h" // Includes all configuration attributes too
 
 namespace askap {
@@ -82,6 +83,9 @@ class ChannelSelTask : public askap::cp::ingest::ITask {
 
         /// @brief Number of channels to select
         casa::uInt itsNChan;
+
+        /// @brief Selection kernel, shared with the channel averaging task
+        ChannelReducer itsReducer;
 };
 
 }
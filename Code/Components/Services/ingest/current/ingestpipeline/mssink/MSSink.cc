@@ -39,6 +39,7 @@
 #include "askap/AskapLogging.h"
 #include "askap/AskapError.h"
 #include <askap/AskapUtil.h>
+#include "boost/bind.hpp"
 #include "cpcommon/VisChunk.h"
 
 // Casecore includes
@@ -81,18 +82,43 @@ using namespace casa;
 MSSink::MSSink(const LOFAR::ParameterSet& parset,
         const Configuration& config) :
     itsParset(parset), itsConfig(config), itsPreviousScanIndex(-1),
-    itsFieldRow(-1), itsDataDescRow(-1)
+    itsFieldRow(-1), itsDataDescRow(-1), itsUnflushed(0)
 {
     ASKAPLOG_DEBUG_STR(logger, "Constructor");
     itsPointingTableEnabled = parset.getBool("pointingtable.enable", false);
+    itsFlushCadence = parset.getUint32("flushcadence", 1);
     create();
     initAntennas(); // Includes FEED table
     initObs();
+
+    if (parset.getBool("asyncwrite", false)) {
+        const casa::uInt nBuffers = parset.getUint32("asyncwrite.buffers", 2);
+        ASKAPCHECK(nBuffers > 0, "asyncwrite.buffers should be positive");
+        ASKAPLOG_INFO_STR(logger, "Writing asynchronously with " << nBuffers
+                << " buffer(s), flushing every " << itsFlushCadence << " integration(s)");
+
+        // The free buffers start out empty, they are resized when the
+        // first chunk is copied in and then reused for every integration
+        itsFreeBuffers.reset(new BoundedQueue<VisChunk>(nBuffers));
+        itsWriteQueue.reset(new BoundedQueue<VisChunk>(nBuffers));
+        for (casa::uInt i = 0; i < nBuffers; ++i) {
+            itsFreeBuffers->push(VisChunk::ShPtr(new VisChunk(0, 0, 0, 0)));
+        }
+        itsWriterThread.reset(new boost::thread(boost::bind(&MSSink::writerLoop, this)));
+    }
 }
 
 MSSink::~MSSink()
 {
     ASKAPLOG_DEBUG_STR(logger, "Destructor");
+    if (itsWriterThread) {
+        // Let the writer thread drain the queue
+        itsWriteQueue->close();
+        itsWriterThread->join();
+    }
+    if (itsMs && itsUnflushed > 0) {
+        itsMs->flush();
+    }
     itsMs.reset();
 }
 
@@ -101,6 +127,30 @@ void MSSink::process(VisChunk::ShPtr chunk)
     // Calculate monitoring points and submit them
     submitMonitoringPoints(chunk);
 
+    if (!itsWriterThread) {
+        write(chunk);
+        return;
+    }
+
+    // Blocks if all buffers are waiting to be written. The pool is only
+    // closed if the writer thread has failed.
+    VisChunk::ShPtr buffer = itsFreeBuffers->pop();
+    if (buffer) {
+        copyChunk(*chunk, buffer);
+        if (itsWriteQueue->push(buffer)) {
+            return;
+        }
+    }
+    boost::mutex::scoped_lock lock(itsMutex);
+    ASKAPTHROW(AskapError, "MSSink writer thread failed: " << itsWriterError);
+}
+
+//////////////////////////////////
+// Private methods
+//////////////////////////////////
+
+void MSSink::write(VisChunk::ShPtr chunk)
+{
     // Handle the details for when a new scan starts
     if (itsPreviousScanIndex != static_cast<casa::Int>(chunk->scan())) {
         itsFieldRow = findOrAddField(chunk);
@@ -173,12 +223,74 @@ void MSSink::process(VisChunk::ShPtr chunk)
     //
     addPointingRows(*chunk);
 
-    itsMs->flush();
+    ++itsUnflushed;
+    if (itsUnflushed >= itsFlushCadence) {
+        itsMs->flush();
+        itsUnflushed = 0;
+    }
 }
 
-//////////////////////////////////
-// Private methods
-//////////////////////////////////
+void MSSink::writerLoop(void)
+{
+    ASKAPLOG_DEBUG_STR(logger, "Writer thread started");
+    while (true) {
+        VisChunk::ShPtr chunk(itsWriteQueue->pop());
+        if (chunk.get() == 0) {
+            break; // End of stream
+        }
+
+        try {
+            write(chunk);
+        } catch (const std::exception& e) {
+            ASKAPLOG_ERROR_STR(logger, "Writer thread failed: " << e.what());
+            {
+                boost::mutex::scoped_lock lock(itsMutex);
+                itsWriterError = e.what();
+            }
+            // Makes the next call to process() throw
+            itsWriteQueue->close();
+            itsFreeBuffers->close();
+            break;
+        }
+
+        // The buffer can be reused for a new integration
+        itsFreeBuffers->push(chunk);
+    }
+    ASKAPLOG_DEBUG_STR(logger, "Writer thread finished");
+}
+
+void MSSink::copyChunk(const VisChunk& src, VisChunk::ShPtr& dst)
+{
+    if (dst->nRow() != src.nRow() || dst->nChannel() != src.nChannel()
+            || dst->nPol() != src.nPol() || dst->nAntenna() != src.nAntenna()) {
+        dst.reset(new VisChunk(src.nRow(), src.nChannel(), src.nPol(), src.nAntenna()));
+    }
+
+    // The dimensions now match, so the arrays are normally copied without
+    // reallocation (assign() only resizes if the shape differs anyway)
+    dst->time() = src.time();
+    dst->targetName() = src.targetName();
+    dst->interval() = src.interval();
+    dst->scan() = src.scan();
+    dst->antenna1().assign(src.antenna1());
+    dst->antenna2().assign(src.antenna2());
+    dst->beam1().assign(src.beam1());
+    dst->beam2().assign(src.beam2());
+    dst->beam1PA().assign(src.beam1PA());
+    dst->beam2PA().assign(src.beam2PA());
+    dst->phaseCentre1().assign(src.phaseCentre1());
+    dst->phaseCentre2().assign(src.phaseCentre2());
+    dst->targetPointingCentre().assign(src.targetPointingCentre());
+    dst->actualPointingCentre().assign(src.actualPointingCentre());
+    dst->actualPolAngle().assign(src.actualPolAngle());
+    dst->visibility().assign(src.visibility());
+    dst->flag().assign(src.flag());
+    dst->uvw().assign(src.uvw());
+    dst->frequency().assign(src.frequency());
+    dst->channelWidth() = src.channelWidth();
+    dst->stokes().assign(src.stokes());
+    dst->directionFrame() = src.directionFrame();
+}
 
 /// @brief make substitution in the file name
 /// @details To simplify configuring the pipeline for different purposes certain
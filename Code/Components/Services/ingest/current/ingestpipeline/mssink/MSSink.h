@@ -29,6 +29,9 @@
 
 // ASKAPsoft includes
 #include "boost/scoped_ptr.hpp"
+#include "boost/shared_ptr.hpp"
+#include "boost/thread/thread.hpp"
+#include "boost/thread/mutex.hpp"
 #include "Common/ParameterSet.h"
 #include "ms/MeasurementSets/MeasurementSet.h"
 #include "casa/aips.h"
@@ -40,6 +43,7 @@
 
 // Local package includes
 #include "ingestpipeline/ITask.h"
+#include "ingestpipeline/BoundedQueue.h"
 #include "configuration/Configuration.h" // Includes all configuration attributes too
 
 namespace askap {
@@ -57,6 +61,16 @@ namespace ingest {
 /// the VisChunk passed to process() is the first chunk for a new scan then rows
 /// are added to the SPECTRAL WINDOW, POLARIZATION and DATA DESCRIPTION tables.
 /// The visibilities and related data are also written into the main table.
+///
+/// By default the data are written (and the measurement set flushed) by the
+/// thread calling process(). If "asyncwrite" is set to true the VisChunk is
+/// instead copied into one of a small number of preallocated buffers
+/// ("asyncwrite.buffers", default 2) and process() returns straight away,
+/// leaving a dedicated writer thread to commit it to the measurement set.
+/// process() only blocks if all buffers are waiting to be written, so the
+/// memory used is bounded. The measurement set is flushed every
+/// "flushcadence" integrations (default 1); the destructor waits for all
+/// queued integrations to be written and flushes the measurement set.
 class MSSink : public askap::cp::ingest::ITask {
     public:
         /// @brief Constructor.
@@ -74,6 +88,8 @@ class MSSink : public askap::cp::ingest::ITask {
         /// @param[in,out] chunk    the instance of VisChunk to write out. Note
         ///                         the VisChunk pointed to by "chunk" nor the pointer
         ///                         itself are modified by this function.
+        /// @throw AskapError   in the asynchronous mode, if the writer thread
+        ///                     failed while writing an earlier integration.
         virtual void process(askap::cp::common::VisChunk::ShPtr chunk);
 
     private:
@@ -96,6 +112,18 @@ class MSSink : public askap::cp::ingest::ITask {
         static std::string makeTwoElementString(const casa::uInt in);
           
 
+        // Writes the chunk to the measurement set, flushing it according
+        // to the flush cadence
+        void write(askap::cp::common::VisChunk::ShPtr chunk);
+
+        // Main loop of the writer thread (asynchronous mode only)
+        void writerLoop(void);
+
+        // Copies all of the contents of "src" into "dst". The arrays of
+        // "dst" are only reallocated if the dimensions differ.
+        static void copyChunk(const askap::cp::common::VisChunk& src,
+                askap::cp::common::VisChunk::ShPtr& dst);
+
         // Initialises the ANTENNA table
         void initAntennas(void);
 
@@ -196,6 +224,29 @@ class MSSink : public askap::cp::ingest::ITask {
         // Measurement set
         boost::scoped_ptr<casa::MeasurementSet> itsMs;
 
+        // Flush the measurement set every this many integrations
+        casa::uInt itsFlushCadence;
+
+        // Number of integrations written since the last flush
+        casa::uInt itsUnflushed;
+
+        // Buffers available to process() for copying the next chunk into
+        // (asynchronous mode only)
+        boost::scoped_ptr< BoundedQueue<askap::cp::common::VisChunk> > itsFreeBuffers;
+
+        // Buffers waiting to be written by the writer thread
+        // (asynchronous mode only)
+        boost::scoped_ptr< BoundedQueue<askap::cp::common::VisChunk> > itsWriteQueue;
+
+        // The writer thread (asynchronous mode only)
+        boost::shared_ptr<boost::thread> itsWriterThread;
+
+        // The error message if the writer thread failed
+        std::string itsWriterError;
+
+        // Mutex protecting itsWriterError
+        mutable boost::mutex itsMutex;
+
         // No support for assignment
         MSSink& operator=(const MSSink& rhs);
 
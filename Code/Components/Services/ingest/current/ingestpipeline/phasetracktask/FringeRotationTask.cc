@@ -106,29 +106,28 @@ void FringeRotationTask::process(askap::cp::common::VisChunk::ShPtr chunk)
     const double effLOFreq = getEffectiveLOFreq(*chunk);
     const double siderealRate = casa::C::_2pi / 86400. / (1. - 1./365.25);
 
-    for (casa::uInt ant = 0; ant < nAntennas(); ++ant) {
-         ASKAPASSERT(chunk->phaseCentre1().nelements() > 0);
-         const casa::MDirection dishPnt = casa::MDirection(chunk->phaseCentre1()[0],chunk->directionFrame());
-         // fixed delay in seconds
-         const double fixedDelay = ant < itsFixedDelays.size() ? itsFixedDelays[ant]*1e-9 : 0.;
-         for (casa::uInt beam = 0; beam < nBeams(); ++beam) {
-              // Current JTRUE phase center
-              const casa::MDirection fpc = casa::MDirection::Convert(phaseCentre(dishPnt, beam),
-                                    casa::MDirection::Ref(casa::MDirection::TOPO, frame))();
-              const double ra = fpc.getAngle().getValue()(0);
-              const double dec = fpc.getAngle().getValue()(1);
-
-              // Transformation from antenna position to the geocentric delay
-              const double H0 = gast - ra;
-              const double sH0 = sin(H0);
-              const double cH0 = cos(H0);
-              const double cd = cos(dec);
+    ASKAPASSERT(chunk->phaseCentre1().nelements() > 0);
+    const casa::MDirection dishPnt = casa::MDirection(chunk->phaseCentre1()[0],chunk->directionFrame());
+    for (casa::uInt beam = 0; beam < nBeams(); ++beam) {
+         // Current JTRUE phase center, the same for all antennas
+         const casa::MDirection fpc = casa::MDirection::Convert(phaseCentre(dishPnt, beam),
+                               casa::MDirection::Ref(casa::MDirection::TOPO, frame))();
+         const double ra = fpc.getAngle().getValue()(0);
+         const double dec = fpc.getAngle().getValue()(1);
+
+         // Transformation from antenna position to the geocentric delay
+         const double H0 = gast - ra;
+         const double sH0 = sin(H0);
+         const double cH0 = cos(H0);
+         const double cd = cos(dec);
+         const double sd = sin(dec);
+         for (casa::uInt ant = 0; ant < nAntennas(); ++ant) {
+              // fixed delay in seconds
+              const double fixedDelay = ant < itsFixedDelays.size() ? itsFixedDelays[ant]*1e-9 : 0.;
               // JTRUE delay is a scalar, so transformation matrix is just a vector
-              // we could probably use the matrix math to process all antennas at once, however
-              // do it explicitly for now for simplicity
               const casa::Vector<double> xyz = antXYZ(ant);
               ASKAPDEBUGASSERT(xyz.nelements() == 3);
-              const double delayInMetres = -cd * cH0 * xyz(0) + cd * sH0 * xyz(1) - sin(dec) * xyz(2);
+              const double delayInMetres = -cd * cH0 * xyz(0) + cd * sH0 * xyz(1) - sd * xyz(2);
               delays(ant,beam) = fixedDelay + delayInMetres / casa::C::c;
               rates(ant,beam) = (cd * sH0 * xyz(0) + cd * cH0 * xyz(1)) * siderealRate * casa::C::_2pi / casa::C::c * effLOFreq;
          }
@@ -126,16 +126,16 @@ void FrtDrxDelays::process(const askap::cp::common::VisChunk::ShPtr& chunk,
        }
   }
   //
+  itsRotator.reset(chunk->nRow());
   for (casa::uInt row = 0; row < chunk->nRow(); ++row) {
-       // slice to get this row of data
        const casa::uInt ant1 = chunk->antenna1()[row];
        const casa::uInt ant2 = chunk->antenna2()[row];
        ASKAPDEBUGASSERT(ant1 < delays.nrow());
        ASKAPDEBUGASSERT(ant2 < delays.nrow());
        if (itsFrtComm.isValid(ant1) && itsFrtComm.isValid(ant2)) {
            // desired delays are set and applied, do phase rotation
-           casa::Matrix<casa::Complex> thisRow = chunk->visibility().yzPlane(row);
            const double appliedDelay = samplePeriod * (itsFrtComm.requestedDRxDelay(ant2)-itsFrtComm.requestedDRxDelay(ant1));
+           const double phaseDueToAppliedDelay = 2. * casa::C::pi * effLO * appliedDelay;
 
            if (itsTrackResidualDelay) {
                // attempt to correct for residual delays in software
@@ -146,30 +146,10 @@ void FrtDrxDelays::process(const askap::cp::common::VisChunk::ShPtr& chunk,
                // actual delay, note the sign is flipped because we're correcting the delay here
                const double thisRowDelay = delays(ant1,beam1) - delays(ant2,beam2);
                const double residualDelay = thisRowDelay - appliedDelay;
-               
-               const double phaseDueToAppliedDelay = 2. * casa::C::pi * effLO * appliedDelay;
-               const casa::Vector<casa::Double>& freq = chunk->frequency();
-               ASKAPDEBUGASSERT(freq.nelements() == thisRow.nrow());
-               for (casa::uInt chan = 0; chan < thisRow.nrow(); ++chan) {
-                    //casa::Vector<casa::Complex> thisChan = thisRow.row(chan);
-                    const float phase = static_cast<float>(phaseDueToAppliedDelay + 
-                                 2. * casa::C::pi * freq[chan] * residualDelay);
-                    const casa::Complex phasor(cos(phase), sin(phase));
-
-                    // actual rotation (same for all polarisations)
-                    for (casa::uInt pol = 0; pol < thisRow.ncolumn(); ++pol) {
-                         thisRow(chan,pol) *= phasor;
-                    }
-                    //thisChan *= phasor;
-               }
-               
+               itsRotator.setRow(row, phaseDueToAppliedDelay, residualDelay);
            } else {
               // just correct phases corresponding to the applied delay in IF (simple phase tracking) 
-              const float phase = 2. * static_cast<float>(casa::C::pi * effLO * appliedDelay);
-              const casa::Complex phasor(cos(phase), sin(phase));
-
-              // actual rotation
-              thisRow *= phasor;
+              itsRotator.setRow(row, phaseDueToAppliedDelay, 0.);
            }
        } else {
          // the parameters for these antennas are being changed, flag the data
@@ -177,6 +157,8 @@ void FrtDrxDelays::process(const askap::cp::common::VisChunk::ShPtr& chunk,
          thisFlagRow.set(casa::True); 
        }
   }
+  // actual rotation (same for all polarisations)
+  itsRotator.apply(*chunk);
 }
 
 } // namespace ingest 
@@ -35,6 +35,7 @@
 // Local package includes
 #include "ingestpipeline/phasetracktask/IFrtApproach.h"
 #include "ingestpipeline/phasetracktask/FrtMetadataSource.h"
+#include "ingestpipeline/phasetracktask/PhaseRotator.h"
 #include "configuration/Configuration.h" // Includes all configuration attributes too
 
 // casa includes
@@ -90,6 +91,9 @@ class FrtDrxDelays : virtual public IFrtApproach {
 
         /// @brief index of an antenna used as a reference
         casa::uInt itsRefAntIndex;
+
+        /// @brief phase rotation kernel
+        PhaseRotator itsRotator;
 };
 
 } // namespace ingest
@@ -237,8 +237,8 @@ void FrtHWAndDrx::process(const askap::cp::common::VisChunk::ShPtr& chunk,
        } // if FR had an update for a given antenna
   } // loop over antennas
   //
+  itsRotator.reset(chunk->nRow());
   for (casa::uInt row = 0; row < chunk->nRow(); ++row) {
-       // slice to get this row of data
        const casa::uInt ant1 = chunk->antenna1()[row];
        const casa::uInt ant2 = chunk->antenna2()[row];
        ASKAPDEBUGASSERT(ant1 < delays.nrow());
@@ -247,7 +247,6 @@ void FrtHWAndDrx::process(const askap::cp::common::VisChunk::ShPtr& chunk,
        ASKAPDEBUGASSERT(ant2 < hwInRange.size());
        if (itsFrtComm.isValid(ant1) && itsFrtComm.isValid(ant2) && hwInRange[ant1] && hwInRange[ant2]) {
            // desired delays are set and applied, do phase rotation
-           casa::Matrix<casa::Complex> thisRow = chunk->visibility().yzPlane(row);
            const double appliedDelay = samplePeriod * (itsFrtComm.requestedDRxDelay(ant2)-itsFrtComm.requestedDRxDelay(ant1));
 
            // attempt to correct for residual delays in software
@@ -261,31 +260,18 @@ void FrtHWAndDrx::process(const askap::cp::common::VisChunk::ShPtr& chunk,
 
            // actual rate
            //const double thisRowRate = rates(ant1,beam1) - rates(ant2,beam2);
-              
-           
+
            const double phaseDueToAppliedDelay = 2. * casa::C::pi * effLO * appliedDelay;
            const double phaseDueToAppliedRate = itsPhases[ant1] - itsPhases[ant2];
-           const casa::Vector<casa::Double>& freq = chunk->frequency();
-           ASKAPDEBUGASSERT(freq.nelements() == thisRow.nrow());
-           for (casa::uInt chan = 0; chan < thisRow.nrow(); ++chan) {
-                //casa::Vector<casa::Complex> thisChan = thisRow.row(chan);
-                const float phase = static_cast<float>(phaseDueToAppliedDelay + phaseDueToAppliedRate +
-                             2. * casa::C::pi * freq[chan] * residualDelay);
-                const casa::Complex phasor(cos(phase), sin(phase));
-
-                // actual rotation (same for all polarisations)
-                for (casa::uInt pol = 0; pol < thisRow.ncolumn(); ++pol) {
-                     thisRow(chan,pol) *= phasor;
-                }
-                //thisChan *= phasor;
-           }
-           
+           itsRotator.setRow(row, phaseDueToAppliedDelay + phaseDueToAppliedRate, residualDelay);
        } else {
          // the parameters for these antennas are being changed, flag the data
          casa::Matrix<casa::Bool> thisFlagRow = chunk->flag().yzPlane(row);
          thisFlagRow.set(casa::True); 
        }
   }
+  // actual rotation (same for all polarisations)
+  itsRotator.apply(*chunk);
 }
 
 } // namespace ingest 
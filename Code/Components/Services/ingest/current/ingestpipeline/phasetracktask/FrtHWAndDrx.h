@@ -38,6 +38,7 @@
 #include "ingestpipeline/phasetracktask/IFrtApproach.h"
 #include "ingestpipeline/phasetracktask/FrtCommunicator.h"
 #include "ingestpipeline/phasetracktask/FrtMetadataSource.h"
+#include "ingestpipeline/phasetracktask/PhaseRotator.h"
 #include "configuration/Configuration.h" // Includes all configuration attributes too
 
 // casa includes
@@ -109,6 +110,9 @@ class FrtHWAndDrx : virtual public IFrtApproach {
 
         /// @brief time offset fudge factor to account for the fact that FR is updated at a different time w.r.t. correlator data stream (see #5736)
         int32_t itsUpdateTimeOffset;
+
+        /// @brief phase rotation kernel
+        PhaseRotator itsRotator;
 };
 
 } // namespace ingest
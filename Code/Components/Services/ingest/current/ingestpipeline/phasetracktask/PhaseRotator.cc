@@ -0,0 +1,154 @@
+/// @file PhaseRotator.cc
+///
+/// @copyright (c) 2015 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+
+// Include own header file first
+#include "PhaseRotator.h"
+
+// Include package level header file
+#include "askap_cpingest.h"
+
+// System includes
+#include <cmath>
+
+// ASKAPsoft includes
+#include "askap/AskapError.h"
+#include "casa/aips.h"
+#include "casa/BasicSL/Constants.h"
+#include "casa/Arrays/Vector.h"
+#include "casa/Arrays/Cube.h"
+#include "cpcommon/VisChunk.h"
+
+using namespace askap;
+using namespace askap::cp::common;
+using namespace askap::cp::ingest;
+
+const casa::uInt PhaseRotator::ReseedInterval;
+
+void PhaseRotator::reset(const casa::uInt nRow)
+{
+    itsPhase.assign(nRow, 0.);
+    itsDelay.assign(nRow, 0.);
+    itsActive.assign(nRow, false);
+}
+
+void PhaseRotator::setRow(const casa::uInt row, const double phase, const double delay)
+{
+    ASKAPDEBUGASSERT(row < itsActive.size());
+    itsPhase[row] = phase;
+    itsDelay[row] = delay;
+    itsActive[row] = true;
+}
+
+void PhaseRotator::seed(const double freq)
+{
+    const size_t nRow = itsActive.size();
+    for (size_t row = 0; row < nRow; ++row) {
+        if (itsActive[row]) {
+            const double phase = itsPhase[row] + 2. * casa::C::pi * itsDelay[row] * freq;
+            itsRe[row] = cos(phase);
+            itsIm[row] = sin(phase);
+        } else {
+            itsRe[row] = 1.;
+            itsIm[row] = 0.;
+        }
+    }
+}
+
+void PhaseRotator::apply(VisChunk& chunk)
+{
+    const casa::uInt nRow = chunk.nRow();
+    const casa::uInt nChan = chunk.nChannel();
+    const casa::uInt nPol = chunk.nPol();
+    ASKAPCHECK(itsActive.size() == nRow, "PhaseRotator was set up for "
+            << itsActive.size() << " rows, the chunk has " << nRow);
+    ASKAPCHECK(chunk.visibility().contiguousStorage(),
+            "Phase rotation requires a contiguous visibility cube");
+    if (nChan == 0 || nRow == 0) {
+        return;
+    }
+
+    // The recurrence is only exact for equally spaced channels, otherwise
+    // the phasors are evaluated for every channel
+    const casa::Vector<casa::Double>& freq = chunk.frequency();
+    ASKAPDEBUGASSERT(freq.nelements() == nChan);
+    const double chanInc = nChan > 1 ? freq(1) - freq(0) : 0.;
+    bool equallySpaced = true;
+    for (casa::uInt chan = 2; chan < nChan; ++chan) {
+        if (std::abs(freq(chan) - freq(0) - chan * chanInc) > 1e-6 * std::abs(chanInc)) {
+            equallySpaced = false;
+            break;
+        }
+    }
+    const casa::uInt reseedInterval = equallySpaced ? ReseedInterval : 1;
+
+    itsRe.resize(nRow);
+    itsIm.resize(nRow);
+    itsStepRe.resize(nRow);
+    itsStepIm.resize(nRow);
+    itsRe32.resize(nRow);
+    itsIm32.resize(nRow);
+    for (casa::uInt row = 0; row < nRow; ++row) {
+        const double stepPhase = itsActive[row] ? 2. * casa::C::pi * itsDelay[row] * chanInc : 0.;
+        itsStepRe[row] = cos(stepPhase);
+        itsStepIm[row] = sin(stepPhase);
+    }
+
+    // Visibilities as interleaved real and imaginary parts
+    float* vis = reinterpret_cast<float*>(chunk.visibility().data());
+    double* re = &itsRe[0];
+    double* im = &itsIm[0];
+    const double* stepRe = &itsStepRe[0];
+    const double* stepIm = &itsStepIm[0];
+    float* re32 = &itsRe32[0];
+    float* im32 = &itsIm32[0];
+
+    for (casa::uInt chan = 0; chan < nChan; ++chan) {
+        if (chan % reseedInterval == 0) {
+            seed(freq(chan));
+        }
+        for (casa::uInt row = 0; row < nRow; ++row) {
+            re32[row] = static_cast<float>(re[row]);
+            im32[row] = static_cast<float>(im[row]);
+        }
+
+        // Same phasor for all polarisations
+        for (casa::uInt pol = 0; pol < nPol; ++pol) {
+            float* block = vis + 2 * (static_cast<size_t>(pol) * nChan + chan) * nRow;
+            for (casa::uInt row = 0; row < nRow; ++row) {
+                const float visRe = block[2 * row];
+                const float visIm = block[2 * row + 1];
+                block[2 * row] = visRe * re32[row] - visIm * im32[row];
+                block[2 * row + 1] = visRe * im32[row] + visIm * re32[row];
+            }
+        }
+
+        // Advance the phasors to the next channel
+        for (casa::uInt row = 0; row < nRow; ++row) {
+            const double nextRe = re[row] * stepRe[row] - im[row] * stepIm[row];
+            im[row] = re[row] * stepIm[row] + im[row] * stepRe[row];
+            re[row] = nextRe;
+        }
+    }
+}
@@ -0,0 +1,107 @@
+/// @file PhaseRotator.h
+///
+/// @copyright (c) 2015 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+
+#ifndef ASKAP_CP_INGEST_PHASEROTATOR_H
+#define ASKAP_CP_INGEST_PHASEROTATOR_H
+
+// System includes
+#include <vector>
+
+// ASKAPsoft includes
+#include "casa/aips.h"
+#include "cpcommon/VisChunk.h"
+
+namespace askap {
+namespace cp {
+namespace ingest {
+
+/// @brief Applies a phase rotation, linear in frequency, to each row of a VisChunk.
+///
+/// This is the common kernel of the phase tracking and fringe rotation
+/// tasks. Each row gets a phase offset and a delay, and its visibilities
+/// are multiplied by exp(i * (phase + 2 * pi * delay * frequency)) for
+/// every channel and polarisation. Rows which are not set up are left
+/// untouched.
+///
+/// The trigonometric functions are only evaluated once per row every
+/// ReseedInterval channels. In between, the phasor of each row is advanced
+/// from one channel to the next by a complex multiplication, which is exact
+/// for equally spaced channels. Channels are processed one at a time, with
+/// the inner loops running over rows, where the visibilities of one channel
+/// and polarisation are adjacent in memory; these loops are kept free of
+/// branches and function calls so the compiler can vectorise them. The
+/// scratch buffers are kept between calls.
+class PhaseRotator {
+    public:
+        /// @brief Prepares for a new chunk, with no rows set up.
+        /// @param[in] nRow the number of rows of the chunk.
+        void reset(const casa::uInt nRow);
+
+        /// @brief Sets up the rotation of one row.
+        /// @param[in] row the row of the chunk
+        /// @param[in] phase phase offset in radians
+        /// @param[in] delay delay in seconds, the phase of each channel is
+        ///            offset further by 2 * pi * delay * frequency
+        void setRow(const casa::uInt row, const double phase, const double delay);
+
+        /// @brief Applies the rotation to the visibilities of the chunk.
+        /// @param[in,out] chunk the chunk, with the number of rows given to reset()
+        void apply(askap::cp::common::VisChunk& chunk);
+
+        /// @brief Number of channels between exact evaluations of the phasors.
+        static const casa::uInt ReseedInterval = 256;
+
+    private:
+        /// @brief Evaluates the phasors of all rows at the given frequency.
+        void seed(const double freq);
+
+        /// Phase offset of each row (radians)
+        std::vector<double> itsPhase;
+
+        /// Delay of each row (seconds)
+        std::vector<double> itsDelay;
+
+        /// True for the rows which were set up
+        std::vector<bool> itsActive;
+
+        /// Current phasor of each row
+        std::vector<double> itsRe;
+        std::vector<double> itsIm;
+
+        /// Phasor rotation from one channel to the next for each row
+        std::vector<double> itsStepRe;
+        std::vector<double> itsStepIm;
+
+        /// Single precision copies of the current phasors, applied to the
+        /// visibilities
+        std::vector<float> itsRe32;
+        std::vector<float> itsIm32;
+};
+
+}
+}
+}
+
+#endif
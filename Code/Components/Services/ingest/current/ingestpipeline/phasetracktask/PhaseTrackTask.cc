@@ -41,6 +41,7 @@
 #include <measures/Measures/MCDirection.h>
 #include <measures/Measures/MeasConvert.h>
 #include <casa/Arrays/MatrixMath.h>
+#include <casa/Arrays/ArrayLogical.h>
 
 ASKAP_LOGGER(logger, ".PhaseTrackTask");
 
@@ -129,81 +130,91 @@ PhaseTrackTask::PhaseTrackTask(const LOFAR::ParameterSet& parset,
 ///                       phase factors will be applied.
 void PhaseTrackTask::process(askap::cp::common::VisChunk::ShPtr chunk)
 {
-    // it may be practical to cache delay per antenna, beam
-    // for now calculate it from scratch (although it is not very efficient)
-    for (casa::uInt row = 0; row < chunk->nRow(); ++row) {
-        phaseRotateRow(chunk, row);
-    }
-}
-
-/// @brief phase rotate one row of the chunk
-/// @details
-/// @param[in] chunk vis chunk to work with
-/// @param[in] row the row of the chunk to work with
-void PhaseTrackTask::phaseRotateRow(askap::cp::common::VisChunk::ShPtr chunk,
-                                    const casa::uInt row) const
-{
-    ASKAPDEBUGASSERT(row < chunk->nRow());
-    const casa::uInt ant1 = chunk->antenna1()(row);
-    const casa::uInt ant2 = chunk->antenna2()(row);
-
     const casa::uInt nAnt = nAntennas();
 
-    ASKAPCHECK(ant1 < nAnt, "Antenna index (" << ant1 << ") is invalid");
-    ASKAPCHECK(ant2 < nAnt, "Antenna index (" << ant2 << ") is invalid");
-
     // Determine Greenwich Apparent Sidereal Time
     const double gast = calcGAST(chunk->time());
+    const casa::MeasFrame frame(casa::MEpoch(chunk->time(), casa::MEpoch::UTC));
+    const double effLOFreq = itsTrackDelay ? 0. : getEffectiveLOFreq(*chunk);
+
+    // the antenna delays are calculated once per beam for this integration
+    itsAntDelays.resize(nBeams());
+    itsCachedPointing.resize(nBeams());
+    itsCacheValid.assign(nBeams(), false);
 
+    itsRotator.reset(chunk->nRow());
+    for (casa::uInt row = 0; row < chunk->nRow(); ++row) {
+        const casa::uInt ant1 = chunk->antenna1()(row);
+        const casa::uInt ant2 = chunk->antenna2()(row);
+        const casa::uInt beam = chunk->beam1()(row);
+
+        ASKAPCHECK(ant1 < nAnt, "Antenna index (" << ant1 << ") is invalid");
+        ASKAPCHECK(ant2 < nAnt, "Antenna index (" << ant2 << ") is invalid");
+        ASKAPCHECK(beam < nBeams(), "Beam index (" << beam << ") is invalid");
+
+        // All rows of a beam normally share the dish pointing, recalculate
+        // antenna delays only if this row has a different one
+        const casa::MVDirection& dishPointing = chunk->phaseCentre1()(row);
+        if (!itsCacheValid[beam] ||
+                !casa::allEQ(itsCachedPointing[beam].getValue(), dishPointing.getValue())) {
+            calcAntennaDelays(beam, dishPointing, gast, frame);
+        }
+        const casa::Vector<double>& antDelays = itsAntDelays[beam];
+        const double delayInMetres = antDelays(ant2) - antDelays(ant1);
+
+        // phase rotation at the effective LO frequency
+        const double phase = itsTrackDelay ? 0. :
+                -2. * casa::C::pi * effLOFreq * delayInMetres / casa::C::c;
+
+        // delay, applied across the band
+        double delay = 0.;
+        if (itsTrackDelay || (ant1 < itsFixedDelays.size()) || (ant2 < itsFixedDelays.size())) {
+            // fixed component of the delay in seconds
+            const double fixedDelay = 1e-9 * (((ant2 < itsFixedDelays.size()) ? itsFixedDelays[ant2] : 0.) -
+                                              ((ant1 < itsFixedDelays.size()) ? itsFixedDelays[ant1] : 0.));
+            const double polDelayInMetres = antXYZ(ant2)(2) - antXYZ(ant1)(2);
+            delay = -fixedDelay - (itsTrackDelay ? delayInMetres -
+                    (itsTrackedSouthPole ? polDelayInMetres : 0.) : 0.) / casa::C::c;
+        }
+        itsRotator.setRow(row, phase, delay);
+    }
+    itsRotator.apply(*chunk);
+}
+
+/// @brief calculate the delays of all antennas for one beam
+/// @details The JTRUE delays (in metres, w.r.t. the Earth centre) are
+/// stored in the cache for the given beam. They are linear in antenna
+/// position, so the delay of each baseline is just the difference of
+/// the delays of its antennas.
+/// @param[in] beam beam index
+/// @param[in] dishPointing pointing centre for the whole dish
+/// @param[in] gast Greenwich Apparent Sidereal Time in radians
+/// @param[in] frame frame for the conversion to JTRUE
+void PhaseTrackTask::calcAntennaDelays(const casa::uInt beam, const casa::MVDirection& dishPointing,
+                                       const double gast, const casa::MeasFrame& frame)
+{
     // Current JTRUE phase center
-    casa::MeasFrame frame(casa::MEpoch(chunk->time(), casa::MEpoch::UTC));
-    const casa::MDirection fpc = casa::MDirection::Convert(phaseCentre(chunk->phaseCentre1()(row), chunk->beam1()(row)),
+    const casa::MDirection fpc = casa::MDirection::Convert(phaseCentre(casa::MDirection(dishPointing), beam),
                                  casa::MDirection::Ref(casa::MDirection::JTRUE, frame))();
     const double ra = fpc.getAngle().getValue()(0);
     const double dec = fpc.getAngle().getValue()(1);
 
-    // Transformation from antenna position difference (ant2-ant1) to uvw
+    // Transformation from antenna position to delay
     const double H0 = gast - ra;
     const double sH0 = sin(H0);
     const double cH0 = cos(H0);
     const double cd = cos(dec);
+    const double sd = sin(dec);
     // JTRUE delay is a scalar, so transformation matrix is just a vector
-    casa::Vector<double> baseline = antXYZ(ant2) - antXYZ(ant1);
-    ASKAPDEBUGASSERT(baseline.nelements() == 3);
-    const double delayInMetres = -cd * cH0 * baseline(0) + cd * sH0 * baseline(1) - sin(dec) * baseline(2);
-    const double polDelayInMetres = baseline(2);
-
-    // slice to get this row of data
-    casa::Matrix<casa::Complex> thisRow = chunk->visibility().yzPlane(row);
-
-    if (!itsTrackDelay) {
-        const double effLOFreq = getEffectiveLOFreq(*chunk);
-
-        const float phase = -2. * static_cast<float>(casa::C::pi * effLOFreq * delayInMetres / casa::C::c);
-        const casa::Complex phasor(cos(phase), sin(phase));
-
-        // actual rotation
-        thisRow *= phasor;
+    const casa::uInt nAnt = nAntennas();
+    casa::Vector<double>& antDelays = itsAntDelays[beam];
+    antDelays.resize(nAnt);
+    for (casa::uInt ant = 0; ant < nAnt; ++ant) {
+        const casa::Vector<double> xyz = antXYZ(ant);
+        ASKAPDEBUGASSERT(xyz.nelements() == 3);
+        antDelays(ant) = -cd * cH0 * xyz(0) + cd * sH0 * xyz(1) - sd * xyz(2);
     }
 
-    if (itsTrackDelay || (ant1 < itsFixedDelays.size()) || (ant2 < itsFixedDelays.size())) {
-        // fixed component of the delay in seconds
-        const double fixedDelay = 1e-9 * ((ant2 < itsFixedDelays.size()) ? itsFixedDelays[ant2] : 0. - ((ant1 < itsFixedDelays.size()) ? itsFixedDelays[ant1] : 0.));
-        const double delayBy2pi = -2. * casa::C::pi * (fixedDelay + (itsTrackDelay ? delayInMetres - (itsTrackedSouthPole ? polDelayInMetres : 0.) : 0.) / casa::C::c);
-        const casa::Vector<double>& freqs = chunk->frequency();
-        ASKAPDEBUGASSERT(thisRow.nrow() == freqs.nelements());
-
-        for (casa::uInt ch = 0; ch < thisRow.nrow(); ++ch) {
-            const float phase = static_cast<float>(delayBy2pi * (freqs[ch]));
-            const casa::Complex phasor(cos(phase), sin(phase));
-            casa::Vector<casa::Complex> allPols = thisRow.row(ch);
-            allPols *= phasor;
-            /*
-            // for debugging
-            if ((ant1!=ant2) && (ch == 4000)) {
-                std::cout<<ch<<" "<<delayInMetres<<" "<<delayBy2pi<<" "<<freqs[ch]-freqs[0]<<std::endl;
-            }
-            */
-        }
-    }
+    itsCachedPointing[beam] = dishPointing;
+    itsCacheValid[beam] = true;
 }
@@ -37,6 +37,7 @@
 // Local package includes
 #include "ingestpipeline/ITask.h"
 #include "ingestpipeline/calcuvwtask/CalcUVWTask.h"
+#include "ingestpipeline/phasetracktask/PhaseRotator.h"
 #include "configuration/Configuration.h" // Includes all configuration attributes too
 
 namespace askap {
@@ -80,11 +81,17 @@ class PhaseTrackTask : public askap::cp::ingest::CalcUVWTask {
         virtual void process(askap::cp::common::VisChunk::ShPtr chunk);
 
     protected:
-        /// @brief phase rotate one row of the chunk
-        /// @details
-        /// @param[in] chunk vis chunk to work with
-        /// @param[in] row the row of the chunk to work with
-        void phaseRotateRow(askap::cp::common::VisChunk::ShPtr chunk, const casa::uInt row) const;
+        /// @brief calculate the delays of all antennas for one beam
+        /// @details The JTRUE delays (in metres, w.r.t. the Earth centre) are
+        /// stored in the cache for the given beam. They are linear in antenna
+        /// position, so the delay of each baseline is just the difference of
+        /// the delays of its antennas.
+        /// @param[in] beam beam index
+        /// @param[in] dishPointing pointing centre for the whole dish
+        /// @param[in] gast Greenwich Apparent Sidereal Time in radians
+        /// @param[in] frame frame for the conversion to JTRUE
+        void calcAntennaDelays(const casa::uInt beam, const casa::MVDirection& dishPointing,
+                               const double gast, const casa::MeasFrame& frame);
 
     private:
         /// @brief configuration (need scan information)
@@ -110,6 +117,19 @@ class PhaseTrackTask : public askap::cp::ingest::CalcUVWTask {
         /// @note if itsTrackDelay is false and the length of this vector is zero, only phase
         /// rotation is applied
         std::vector<double> itsFixedDelays;
+
+        /// @brief delays (in metres) of all antennas, one vector per beam
+        /// @details Only valid for the integration being processed
+        std::vector<casa::Vector<double> > itsAntDelays;
+
+        /// @brief dish pointing each element of itsAntDelays was calculated for
+        std::vector<casa::MVDirection> itsCachedPointing;
+
+        /// @brief true if the corresponding element of itsAntDelays is valid
+        std::vector<bool> itsCacheValid;
+
+        /// @brief phase rotation kernel
+        PhaseRotator itsRotator;
 }; // PhaseTrackTask class
 
 } // ingest
@@ -0,0 +1,293 @@
+/// @file RecyclingBuffer.h
+///
+/// @copyright (c) 2015 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+
+#ifndef ASKAP_CP_INGEST_RECYCLINGBUFFER_H
+#define ASKAP_CP_INGEST_RECYCLINGBUFFER_H
+
+// System includes
+#include <vector>
+
+// ASKAPsoft includes
+#include "boost/shared_ptr.hpp"
+#include "boost/shared_array.hpp"
+#include "boost/atomic.hpp"
+#include "boost/thread/mutex.hpp"
+#include "boost/thread/condition.hpp"
+#include "boost/thread/thread_time.hpp"
+#include "boost/date_time/posix_time/posix_time.hpp"
+
+namespace askap {
+namespace cp {
+namespace ingest {
+
+/// @brief A single producer, single consumer queue of preallocated objects.
+///
+/// All objects live in a slab which is allocated once by the constructor.
+/// The producer takes free objects from a free list, fills them in place and
+/// publishes them to the consumer. The consumer gets a shared pointer to the
+/// object, once all copies of this pointer have been released the producer
+/// puts the object back on the free list. Neither side allocates memory or
+/// takes a lock per object, the consumer only locks a mutex when it has to
+/// wait for the producer.
+///
+/// The free list is a stack, so the most recently released (and likely
+/// cached) objects are reused first and the memory touched stays
+/// proportional to the number of queued objects rather than the capacity.
+///
+/// Usage by the producer:
+/// @code
+/// const size_t n = buffer.acquire(maxBatch);
+/// for (size_t i = 0; i < n; ++i) {
+///     fill(buffer.slot(i));
+///     buffer.publish(i);
+/// }
+/// buffer.commit();
+/// @endcode
+///
+/// If the consumer holds on to k objects, only capacity - k objects can be
+/// queued.
+template<class T>
+class RecyclingBuffer {
+    public:
+
+        /// @brief Constructor.
+        /// @param[in] bufSize  the number of objects (of type T) in the slab,
+        ///                     which is also the maximum number of objects
+        ///                     in the queue.
+        RecyclingBuffer(const unsigned int bufSize)
+            : itsCapacity(bufSize > 0 ? bufSize : 1),
+              itsSlab(new T[itsCapacity]), itsQueue(itsCapacity),
+              itsHead(0), itsTail(0), itsReclaimed(0), itsNPublished(0),
+              itsWaiting(false)
+        {
+            // The shared pointers (and their reference counts) are created
+            // once here and then copied to the consumer. The deleter keeps
+            // the slab alive until the last copy has gone.
+            itsSlots.reserve(itsCapacity);
+            itsFree.reserve(itsCapacity);
+            itsPending.reserve(itsCapacity);
+            itsAcquired.reserve(itsCapacity);
+            for (size_t i = 0; i < itsCapacity; ++i) {
+                itsSlots.push_back(boost::shared_ptr<T>(&itsSlab[i], SlabReference(itsSlab)));
+                itsFree.push_back(itsCapacity - 1 - i);
+            }
+        };
+
+        /// @brief Returns the maximum number of objects in the queue
+        size_t capacity(void) const {
+            return itsCapacity;
+        };
+
+        /// @brief Returns the number of objects in the queue
+        size_t size(void) const {
+            return itsTail.load() - itsHead.load();
+        };
+
+        /// @brief Take free objects for the producer to fill.
+        /// The objects previously acquired and not committed are returned
+        /// to the free list first.
+        /// @param[in] max  the maximum number of objects to acquire.
+        /// @return the number of objects acquired, zero if the consumer
+        ///         has not released any object yet (i.e. the buffer is full).
+        size_t acquire(const size_t max) {
+            // Return what wasn't committed
+            releaseAcquired();
+            reclaim();
+
+            const size_t n = max < itsFree.size() ? max : itsFree.size();
+            for (size_t i = 0; i < n; ++i) {
+                itsAcquired.push_back(itsFree.back());
+                itsFree.pop_back();
+            }
+            return n;
+        };
+
+        /// @brief Returns the i-th acquired object, for the producer to fill
+        T* slot(const size_t i) {
+            return itsSlots[itsAcquired[i]].get();
+        };
+
+        /// @brief Append the i-th acquired object to the queue.
+        /// The object becomes visible to the consumer by commit(), it must
+        /// not be modified after this call.
+        void publish(const size_t i) {
+            const size_t tail = itsTail.load(boost::memory_order_relaxed) + itsNPublished;
+            itsQueue[tail % itsCapacity] = itsAcquired[i];
+            itsAcquired[i] = NOT_ACQUIRED;
+            ++itsNPublished;
+        };
+
+        /// @brief Make the published objects visible to the consumer.
+        /// The acquired objects which have not been published are
+        /// returned to the free list.
+        void commit(void) {
+            if (itsNPublished > 0) {
+                // Sequentially consistent, see pop()
+                itsTail.store(itsTail.load(boost::memory_order_relaxed) + itsNPublished);
+                itsNPublished = 0;
+                if (itsWaiting.load()) {
+                    boost::mutex::scoped_lock lock(itsMutex);
+                    itsCondVar.notify_all();
+                }
+            }
+            releaseAcquired();
+        };
+
+        /// @brief Get the next object from the front of the queue.
+        /// Only one thread may call this method.
+        ///
+        /// @param[in] timeout how long to wait for data before returning
+        ///         a null pointer, in the case where the
+        ///         buffer is empty. The timeout is in microseconds,
+        ///         and anything less than zero will result in no
+        ///         timeout (i.e. blocking functionality). A timeout of zero
+        ///         will result in a non-blocking call.
+        boost::shared_ptr<T> pop(const long timeout = -1) {
+            const size_t head = itsHead.load(boost::memory_order_relaxed);
+            if (itsTail.load(boost::memory_order_acquire) == head) {
+                if (timeout == 0) {
+                    return boost::shared_ptr<T>(); // Null pointer
+                }
+                // Either the producer sees the flag set, or this thread sees
+                // the new tail. The producer notifies with the mutex held, so
+                // the notification can't be lost before the wait starts.
+                const boost::system_time deadline = boost::get_system_time()
+                    + boost::posix_time::microseconds(timeout);
+                boost::mutex::scoped_lock lock(itsMutex);
+                itsWaiting.store(true);
+                while (itsTail.load() == head) {
+                    if (timeout < 0) {
+                        itsCondVar.wait(lock);
+                    } else if (!itsCondVar.timed_wait(lock, deadline)
+                            && itsTail.load() == head) {
+                        itsWaiting.store(false);
+                        return boost::shared_ptr<T>(); // Null pointer
+                    }
+                }
+                itsWaiting.store(false);
+            }
+
+            boost::shared_ptr<T> obj(itsSlots[itsQueue[head % itsCapacity]]);
+            itsHead.store(head + 1, boost::memory_order_release);
+            return obj;
+        };
+
+    private:
+        /// The deleter of the slot pointers, doesn't delete anything but
+        /// holds a reference to the slab
+        struct SlabReference {
+            SlabReference(const boost::shared_array<T>& slab) : itsSlabRef(slab) {}
+            void operator()(T*) const {}
+            boost::shared_array<T> itsSlabRef;
+        };
+
+        /// Return the acquired objects which have not been published to
+        /// the free list
+        void releaseAcquired(void) {
+            for (size_t i = itsAcquired.size(); i > 0; --i) {
+                if (itsAcquired[i - 1] != NOT_ACQUIRED) {
+                    itsFree.push_back(itsAcquired[i - 1]);
+                }
+            }
+            itsAcquired.clear();
+        };
+
+        /// Move the objects popped by the consumer to the free list, once
+        /// the consumer has released them
+        void reclaim(void) {
+            const size_t head = itsHead.load(boost::memory_order_acquire);
+            for (; itsReclaimed != head; ++itsReclaimed) {
+                itsPending.push_back(itsQueue[itsReclaimed % itsCapacity]);
+            }
+            for (size_t i = 0; i < itsPending.size(); ) {
+                if (itsSlots[itsPending[i]].unique()) {
+                    itsFree.push_back(itsPending[i]);
+                    itsPending[i] = itsPending.back();
+                    itsPending.pop_back();
+                } else {
+                    ++i;
+                }
+            }
+            // Writes to the reclaimed objects must not start before the
+            // consumer has released them
+            boost::atomic_thread_fence(boost::memory_order_acquire);
+        };
+
+        /// Number of objects in the slab
+        const size_t itsCapacity;
+
+        /// The objects
+        boost::shared_array<T> itsSlab;
+
+        /// One shared pointer per object, copies are given to the consumer
+        std::vector< boost::shared_ptr<T> > itsSlots;
+
+        /// Ring of slot indices, between itsHead and itsTail
+        std::vector<size_t> itsQueue;
+
+        /// Position of the next slot index to pop (written by the consumer)
+        boost::atomic<size_t> itsHead;
+
+        /// Position after the last committed slot index (written by the producer)
+        boost::atomic<size_t> itsTail;
+
+        /// Position up to which popped slots have been moved to the pending
+        /// list (producer only)
+        size_t itsReclaimed;
+
+        /// Free slot indices, used as a stack (producer only)
+        std::vector<size_t> itsFree;
+
+        /// Popped slot indices which may still be in use (producer only)
+        std::vector<size_t> itsPending;
+
+        /// Slot indices acquired by the producer (producer only)
+        std::vector<size_t> itsAcquired;
+
+        /// Number of slots published since the last commit (producer only)
+        size_t itsNPublished;
+
+        /// Marks a published entry of itsAcquired
+        static const size_t NOT_ACQUIRED = static_cast<size_t>(-1);
+
+        /// True while the consumer waits on the condition variable
+        boost::atomic<bool> itsWaiting;
+
+        // Mutex and condition variable, only used when the consumer waits
+        boost::mutex itsMutex;
+        boost::condition itsCondVar;
+
+        // No support for assignment
+        RecyclingBuffer& operator=(const RecyclingBuffer& rhs);
+
+        // No support for copy constructor
+        RecyclingBuffer(const RecyclingBuffer& src);
+};
+
+}
+}
+}
+
+#endif
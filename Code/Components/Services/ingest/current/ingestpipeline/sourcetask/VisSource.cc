@@ -30,107 +30,187 @@
 // Include package level header file
 #include "askap_cpingest.h"
 
+// System includes
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <netinet/in.h>
+
 // ASKAPsoft includes
 #include "askap/AskapLogging.h"
 #include "askap/AskapError.h"
-#include "boost/scoped_ptr.hpp"
 #include "boost/thread.hpp"
+#include "boost/bind.hpp"
 
 // Using
 using namespace askap;
 using namespace askap::cp;
 using namespace askap::cp::ingest;
-using boost::asio::ip::udp;
 
 ASKAP_LOGGER(logger, ".VisSource");
 
+const unsigned int VisSource::MAX_BATCH;
+
 VisSource::VisSource(const unsigned int port, const unsigned int bufSize) :
-    itsBuffer(bufSize), itsStopRequested(false)
+    itsBuffer(bufSize), itsOverflow(new VisDatagram[MAX_BATCH]),
+    itsIov(MAX_BATCH), itsLengths(MAX_BATCH), itsStopRequested(false)
 {
     // Create socket
-    itsSocket.reset(new udp::socket(itsIOService, udp::endpoint(udp::v4(), port)));
+    itsSockFD = socket(PF_INET, SOCK_DGRAM, 0);
+    if (itsSockFD == -1) {
+        ASKAPTHROW(AskapError, "Could not create socket. Errno: " << errno);
+    }
 
     // Set an 16MB receive buffer to help deal with the bursty nature of the
     // communication
-    boost::asio::socket_base::receive_buffer_size option(1024 * 1024 * 16);
-    boost::system::error_code soerror;
-    itsSocket->set_option(option, soerror);
-    if (soerror) {
+    const int rcvsz = 16 * 1024 * 1024;
+    if (setsockopt(itsSockFD, SOL_SOCKET, SO_RCVBUF, &rcvsz, sizeof(rcvsz)) == -1) {
         ASKAPLOG_WARN_STR(logger, "Setting UDP receive buffer size failed. " <<
                 "This may result in dropped datagrams");
     }
 
-    start_receive();
+    // The receive thread checks for a stop request at least this often
+    struct timeval tv;
+    tv.tv_sec = 0;
+    tv.tv_usec = 100000;
+    if (setsockopt(itsSockFD, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv)) == -1) {
+        close(itsSockFD);
+        ASKAPTHROW(AskapError, "Could not set socket receive timeout. Errno: " << errno);
+    }
+
+    // Setup and bind to port
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(struct sockaddr_in));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = INADDR_ANY;
+    if (bind(itsSockFD, reinterpret_cast<const struct sockaddr *>(&addr), sizeof(addr)) == -1) {
+        close(itsSockFD);
+        ASKAPTHROW(AskapError, "Could not bind socket to port " << port
+                << ". Errno: " << errno);
+    }
+
+    // The message headers only ever point to the I/O vectors, only the
+    // buffers the I/O vectors point to change between calls
+#ifdef __linux__
+    itsMsgs.resize(MAX_BATCH);
+    memset(&itsMsgs[0], 0, MAX_BATCH * sizeof(struct mmsghdr));
+    for (unsigned int i = 0; i < MAX_BATCH; ++i) {
+        itsMsgs[i].msg_hdr.msg_iov = &itsIov[i];
+        itsMsgs[i].msg_hdr.msg_iovlen = 1;
+    }
+#endif
+    for (unsigned int i = 0; i < MAX_BATCH; ++i) {
+        itsIov[i].iov_len = sizeof(VisDatagram);
+    }
 
     // Start the thread
-    itsThread = boost::shared_ptr<boost::thread>(new boost::thread(boost::bind(&VisSource::run, this)));
+    itsThread.reset(new boost::thread(boost::bind(&VisSource::run, this)));
 }
 
 VisSource::~VisSource()
 {
-    // Signal stopped so now more calls to start_receive() will be made
+    // Signal stopped, the thread exits after the current receive call
+    // returns (at the latest when the receive timeout expires)
     itsStopRequested = true;
 
-    // Stop the io_service (non-blocking) and cancel an outstanding requests
-    itsIOService.stop();
-    itsSocket->cancel();
-
-    // Wait for the thread running the io_service to finish
+    // Wait for the thread to finish
     if (itsThread.get()) {
         itsThread->join();
     }
 
     // Finally close the socket
-    itsSocket->close();
+    close(itsSockFD);
 }
 
-void VisSource::start_receive(void)
+int VisSource::receive(unsigned int n)
 {
-    itsRecvBuffer.reset(new VisDatagram);
-    itsSocket->async_receive_from(
-            boost::asio::buffer(boost::asio::buffer(itsRecvBuffer.get(), sizeof(VisDatagram))),
-            itsRemoteEndpoint,
-            boost::bind(&VisSource::handle_receive, this,
-                boost::asio::placeholders::error,
-                boost::asio::placeholders::bytes_transferred));
+#ifdef __linux__
+    const int count = recvmmsg(itsSockFD, &itsMsgs[0], n, MSG_WAITFORONE, 0);
+    for (int i = 0; i < count; ++i) {
+        itsLengths[i] = itsMsgs[i].msg_len;
+    }
+    return count;
+#else
+    // One datagram per call
+    const ssize_t size = recv(itsSockFD, itsIov[0].iov_base, itsIov[0].iov_len, 0);
+    if (size == -1) {
+        return -1;
+    }
+    itsLengths[0] = size;
+    return 1;
+#endif
 }
 
-void VisSource::handle_receive(const boost::system::error_code& error,
-        std::size_t bytes)
+bool VisSource::isValid(const VisDatagram& vis, std::size_t bytes) const
 {
-    if (!error || error == boost::asio::error::message_size) {
-        if (bytes != sizeof(VisDatagram)) {
-            ASKAPLOG_WARN_STR(logger, "Error: Failed to read a full VisDatagram struct");
-        }
-        if (itsRecvBuffer->version != VISPAYLOAD_VERSION) {
-            ASKAPLOG_ERROR_STR(logger, "Version mismatch. Expected "
-                    << VISPAYLOAD_VERSION
-                    << " got " << itsRecvBuffer->version);
-        }
-
-        // TODO: Remove this for ADE - For BETA only beams 1-9 are valid/used.
-        if (itsRecvBuffer->beamid <= 9) {
-            // Add a pointer to the message to the back of the circular buffer.
-            // Waiters are notified.
-            itsBuffer.add(itsRecvBuffer);
-        }
-        itsRecvBuffer.reset();
-    } else {
-        ASKAPLOG_WARN_STR(logger, "Error reading visibilities from UDP socket. Error Code: "
-                << error);
+    if (bytes != sizeof(VisDatagram)) {
+        ASKAPLOG_WARN_STR(logger, "Error: Failed to read a full VisDatagram struct");
+        return false;
     }
-
-    if (!itsStopRequested) {
-        start_receive();
+    if (vis.version != VISPAYLOAD_VERSION) {
+        ASKAPLOG_ERROR_STR(logger, "Version mismatch. Expected "
+                << VISPAYLOAD_VERSION
+                << " got " << vis.version);
+        return false;
     }
+
+    // TODO: Remove this for ADE - For BETA only beams 1-9 are valid/used.
+    return vis.beamid <= 9;
 }
 
 void VisSource::run(void)
 {
-    itsIOService.run();    
+    unsigned long discarded = 0;
+    while (!itsStopRequested) {
+        // Receive straight into the free datagrams of the buffer. If there
+        // are none, keep draining the socket into the overflow area so the
+        // datagrams arriving after the consumer has caught up are current.
+        const unsigned int nFree = itsBuffer.acquire(MAX_BATCH);
+        const bool overflow = (nFree == 0);
+        const unsigned int n = overflow ? MAX_BATCH : nFree;
+        for (unsigned int i = 0; i < n; ++i) {
+            itsIov[i].iov_base = overflow ? &itsOverflow[i] : itsBuffer.slot(i);
+        }
+
+        const int count = receive(n);
+
+        // Will normally expect EAGAIN if no data arrived within the receive
+        // timeout
+        if (count == -1) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                ASKAPLOG_WARN_STR(logger, "Error reading visibilities from UDP socket. " <<
+                        "Error Code: " << errno);
+            }
+            continue;
+        }
+
+        if (overflow) {
+            if (discarded == 0) {
+                ASKAPLOG_WARN_STR(logger, "Buffer full, discarding VisDatagrams");
+            }
+            discarded += count;
+            continue;
+        }
+        if (discarded > 0) {
+            ASKAPLOG_WARN_STR(logger, "Discarded " << discarded
+                    << " VisDatagrams while the buffer was full");
+            discarded = 0;
+        }
+
+        for (int i = 0; i < count; ++i) {
+            if (isValid(*itsBuffer.slot(i), itsLengths[i])) {
+                itsBuffer.publish(i);
+            }
+        }
+        itsBuffer.commit();
+    }
 }
 
 boost::shared_ptr<VisDatagram> VisSource::next(const long timeout)
 {
-    return itsBuffer.next(timeout);
+    return itsBuffer.pop(timeout);
 }
@@ -27,26 +27,38 @@
 #ifndef ASKAP_CP_INGEST_VISSOURCE_H
 #define ASKAP_CP_INGEST_VISSOURCE_H
 
+// System includes
+#include <vector>
+#include <sys/types.h>
+#include <sys/socket.h>
+
 // ASKAPsoft includes
 #include "boost/shared_ptr.hpp"
-#include "boost/scoped_ptr.hpp"
+#include "boost/scoped_array.hpp"
 #include "boost/thread.hpp"
-#include "boost/asio.hpp"
+#include "boost/atomic.hpp"
 #include "cpcommon/VisDatagram.h"
 
 // Local package includes
 #include "ingestpipeline/sourcetask/IVisSource.h"
-#include "ingestpipeline/sourcetask/CircularBuffer.h"
+#include "ingestpipeline/sourcetask/RecyclingBuffer.h"
 
 namespace askap {
 namespace cp {
 namespace ingest {
 
+/// @brief Receives VisDatagrams from the correlator via UDP.
+///
+/// The datagrams are received in batches (with recvmmsg() where available)
+/// directly into a preallocated buffer of bufSize VisDatagrams. The buffer
+/// is recycled, so no memory is allocated and no lock is taken per datagram.
+/// If the consumer falls behind and the buffer is full, incoming datagrams
+/// are discarded.
 class VisSource : public IVisSource {
     public:
         /// Constructor
         VisSource(const unsigned int port, const unsigned int bufSize);
-        
+
         /// Destructor
         ~VisSource();
 
@@ -54,31 +66,47 @@ class VisSource : public IVisSource {
         boost::shared_ptr<VisDatagram> next(const long timeout = -1);
 
     private:
-        void start_receive(void);
-
-        void handle_receive(const boost::system::error_code& error,
-                            std::size_t bytes);
-
+        /// Entry point for the thread that receives the UDP data stream
         void run(void);
 
-        // Circular buffer of VisDatagram objects
-        askap::cp::ingest::CircularBuffer< VisDatagram > itsBuffer;
+        /// Receive up to n datagrams into the buffers set up in itsIov, the
+        /// sizes of the received datagrams are stored in itsLengths.
+        /// Blocks until at least one datagram is received or the receive
+        /// timeout expires.
+        /// @return the number of datagrams received, or -1 on error (errno
+        ///         is set).
+        int receive(unsigned int n);
+
+        /// Returns true if the received datagram is valid and should be
+        /// passed on
+        bool isValid(const VisDatagram& vis, std::size_t bytes) const;
+
+        /// Maximum number of datagrams received by one system call
+        static const unsigned int MAX_BATCH = 64;
+
+        // Recycling buffer of VisDatagram objects
+        RecyclingBuffer<VisDatagram> itsBuffer;
+
+        // Datagrams received while the buffer is full are read into this
+        // (and discarded)
+        boost::scoped_array<VisDatagram> itsOverflow;
+
+        // I/O vectors, message headers and received sizes for the
+        // batched receive
+        std::vector<struct iovec> itsIov;
+#ifdef __linux__
+        std::vector<struct mmsghdr> itsMsgs;
+#endif
+        std::vector<std::size_t> itsLengths;
 
         // Service thread
         boost::shared_ptr<boost::thread> itsThread;
 
         // Used to request the service thread to stop
-        bool itsStopRequested;
-
-        // Boost io_service
-        boost::asio::io_service itsIOService;
-
-        // UDP socket
-        boost::scoped_ptr<boost::asio::ip::udp::socket> itsSocket;
-
-        boost::asio::ip::udp::endpoint itsRemoteEndpoint;
+        boost::atomic<bool> itsStopRequested;
 
-        boost::shared_ptr<VisDatagram> itsRecvBuffer;
+        // UDP socket file descriptor
+        int itsSockFD;
 
         // No support for assignment
         VisSource& operator=(const VisSource& rhs);
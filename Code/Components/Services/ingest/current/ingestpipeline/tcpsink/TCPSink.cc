@@ -32,12 +32,13 @@
 
 // System includes
 #include <string>
+#include <vector>
+#include <complex>
 #include <stdint.h>
 
 // ASKAPsoft includes
 #include "boost/scoped_ptr.hpp"
-#include "boost/thread/mutex.hpp"
-#include "boost/thread/condition.hpp"
+#include "boost/shared_ptr.hpp"
 #include "boost/asio.hpp"
 #include "askap/AskapLogging.h"
 #include "askap/AskapError.h"
@@ -64,9 +65,16 @@ using boost::asio::ip::tcp;
 
 TCPSink::TCPSink(const LOFAR::ParameterSet& parset,
                  const Configuration& config)
-    : itsParset(parset), itsSocket(itsIOService)
+    : itsParset(parset),
+    itsFreeSlots(parset.getUint32("buffers", 4)),
+    itsSendQueue(parset.getUint32("buffers", 4)),
+    itsDropped(0), itsSocket(itsIOService)
 {
     ASKAPLOG_DEBUG_STR(logger, "Constructor");
+    const size_t nSlots = itsFreeSlots.capacity();
+    for (size_t i = 0; i < nSlots; ++i) {
+        itsFreeSlots.push(boost::shared_ptr<Slot>(new Slot));
+    }
     itsThread.reset(new boost::thread(boost::bind(&TCPSink::runSender, this)));
 }
 
@@ -74,6 +82,7 @@ TCPSink::~TCPSink()
 {
     ASKAPLOG_DEBUG_STR(logger, "Destructor");
     if (itsThread.get()) {
+        itsSendQueue.close();
         itsThread->interrupt();
         itsThread->join();
     }
@@ -81,18 +90,53 @@ TCPSink::~TCPSink()
 
 void TCPSink::process(VisChunk::ShPtr chunk)
 {
-    // 1: Try to acquire the mutex protecting the buffer. Don't wait because we
-    // don't want to block the main thread
-    boost::mutex::scoped_lock lock(itsMutex, boost::try_to_lock);
-    if (!lock) return;
-
-    // 2: Serialise the VisChunk to a byte-array
-    itsBuf.clear();
-    serialiseVisChunk(*chunk, itsBuf);
-
-    // 3: Release the lock and signal the network sender thread
-    lock.unlock();
-    itsCondVar.notify_all();
+    // 1: Get a free slot. Don't wait because we don't want to block the
+    // main thread
+    boost::shared_ptr<Slot> slot(itsFreeSlots.tryPop());
+    if (!slot) {
+        ++itsDropped;
+        ASKAPLOG_WARN_STR(logger, "All " << itsFreeSlots.capacity()
+                << " buffers are waiting to be sent, dropping integration ("
+                << itsDropped << " dropped so far)");
+        return;
+    }
+
+    // 2: Copy the integration into the slot, the chunk may be modified by
+    // the following tasks while the slot is being sent
+    try {
+        prepareSlot(*chunk, *slot);
+    } catch (...) {
+        itsFreeSlots.push(slot);
+        throw;
+    }
+
+    // 3: Hand the slot to the network sender thread
+    itsSendQueue.push(slot);
+}
+
+void TCPSink::packFlags(const casa::Array<casa::Bool>& flag, std::vector<uint8_t>& packed)
+{
+    ASKAPCHECK(flag.contiguousStorage(), "Flags are not contiguous");
+    const casa::Bool* data = flag.data();
+    const size_t n = flag.size();
+    packed.resize((n + 7) / 8);
+
+    // Whole bytes first, the conversion from bool is guaranteed to give 0 or 1
+    const size_t nWhole = n / 8;
+    for (size_t i = 0; i < nWhole; ++i) {
+        const casa::Bool* in = data + 8 * i;
+        packed[i] = static_cast<uint8_t>(in[0]) | (static_cast<uint8_t>(in[1]) << 1) |
+                    (static_cast<uint8_t>(in[2]) << 2) | (static_cast<uint8_t>(in[3]) << 3) |
+                    (static_cast<uint8_t>(in[4]) << 4) | (static_cast<uint8_t>(in[5]) << 5) |
+                    (static_cast<uint8_t>(in[6]) << 6) | (static_cast<uint8_t>(in[7]) << 7);
+    }
+    if (nWhole < packed.size()) {
+        uint8_t last = 0;
+        for (size_t i = 8 * nWhole; i < n; ++i) {
+            last |= static_cast<uint8_t>(data[i]) << (i - 8 * nWhole);
+        }
+        packed[nWhole] = last;
+    }
 }
 
 //////////////////////////////////
@@ -109,90 +153,90 @@ void TCPSink::pushBack(const T src, std::vector<uint8_t>& dest)
 }
 
 template <typename T>
-void TCPSink::pushBackArray(const casa::Array<T>& src, std::vector<uint8_t>& dest)
-{
-    const size_t idx = dest.size(); // Must be before resize
-    const size_t nbytes = src.size() * sizeof(T);
-    dest.resize(dest.size() + nbytes);
-    memcpy(&dest[idx], src.data(), nbytes);
-}
-
-template <typename T>
-void TCPSink::pushBackVector(const std::vector<T>& src, std::vector<uint8_t>& dest)
+void TCPSink::copyArray(const casa::Array<T>& src, std::vector<T>& dest)
 {
-    const size_t idx = dest.size(); // Must be before resize
-    const size_t nbytes = src.size() * sizeof(T);
-    dest.resize(dest.size() + nbytes);
-    memcpy(&dest[idx], src.data(), nbytes);
+    ASKAPCHECK(src.contiguousStorage(), "Array to send is not contiguous");
+    dest.assign(src.data(), src.data() + src.size());
 }
 
-void TCPSink::serialiseVisChunk(const askap::cp::common::VisChunk& chunk, std::vector<uint8_t>& v)
+void TCPSink::prepareSlot(const VisChunk& chunk, Slot& slot)
 {
-    pushBack<uint32_t>(chunk.nRow(), v);
-    pushBack<uint32_t>(chunk.nChannel(), v);
-    pushBack<uint32_t>(chunk.nPol(), v);
-    pushBack<uint64_t>(askap::epoch2bat(MEpoch(chunk.time(), MEpoch::UTC)), v);
-    pushBack<uint32_t>(chunk.scan(), v);
-
-    pushBack<double>(chunk.channelWidth(), v);
-    pushBackArray<double>(chunk.frequency(), v);
-
-    pushBackArray<uint32_t>(chunk.antenna1(), v);
-    pushBackArray<uint32_t>(chunk.antenna2(), v);
-    pushBackArray<uint32_t>(chunk.beam1(), v);
+    slot.header.clear();
+    pushBack<uint32_t>(chunk.nRow(), slot.header);
+    pushBack<uint32_t>(chunk.nChannel(), slot.header);
+    pushBack<uint32_t>(chunk.nPol(), slot.header);
+    pushBack<uint64_t>(askap::epoch2bat(MEpoch(chunk.time(), MEpoch::UTC)), slot.header);
+    pushBack<uint32_t>(chunk.scan(), slot.header);
+    pushBack<double>(chunk.channelWidth(), slot.header);
 
     // Stokes - Map from casa:StokesTypes to 0=XX, 1=XY, 2=YX, 3=YY
-    vector<uint32_t> stokesvec;
     const casa::Vector<casa::Stokes::StokesTypes>& casaStokes = chunk.stokes();
+    slot.stokes.resize(casaStokes.size());
     for (size_t i = 0; i < casaStokes.size(); ++i) {
-        stokesvec.push_back(mapStokes(casaStokes[i]));
+        slot.stokes[i] = mapStokes(casaStokes[i]);
     }
-    pushBackVector<uint32_t>(stokesvec, v);
 
-    // Visibilities
-    pushBackArray< std::complex<float> >(chunk.visibility(), v);
+    copyArray(chunk.frequency(), slot.frequency);
+    copyArray(chunk.antenna1(), slot.antenna1);
+    copyArray(chunk.antenna2(), slot.antenna2);
+    copyArray(chunk.beam1(), slot.beam1);
+    copyArray(chunk.visibility(), slot.visibility);
 
     // Treat bool more specifically because there is no guarantee how they are
     // represented in memory
-    const casa::Bool* data = chunk.flag().data();
-    vector<uint8_t> flagvec(chunk.flag().size(), 0);
-    for (size_t i = 0; i < flagvec.size(); ++i) {
-        if (data[i]) flagvec[i] = 1;
+    packFlags(chunk.flag(), slot.flag);
+}
+
+bool TCPSink::send(const Slot& slot)
+{
+    std::vector<boost::asio::const_buffer> buffers;
+    buffers.reserve(8);
+    buffers.push_back(boost::asio::buffer(slot.header));
+    buffers.push_back(boost::asio::buffer(slot.frequency));
+    buffers.push_back(boost::asio::buffer(slot.antenna1));
+    buffers.push_back(boost::asio::buffer(slot.antenna2));
+    buffers.push_back(boost::asio::buffer(slot.beam1));
+    buffers.push_back(boost::asio::buffer(slot.stokes));
+    buffers.push_back(boost::asio::buffer(slot.visibility));
+    buffers.push_back(boost::asio::buffer(slot.flag));
+
+    boost::system::error_code error;
+    boost::asio::write(itsSocket, buffers, error);
+    if (error) {
+        ASKAPLOG_WARN_STR(logger, "Send failed: " << error.message());
+        itsSocket.close();
+        return false;
     }
-    pushBackVector<uint8_t>(flagvec, v);
+    return true;
 }
 
 void TCPSink::runSender()
 {
     while (!boost::this_thread::interruption_requested()) {
-        boost::mutex::scoped_lock lock(itsMutex);
-        while (itsBuf.empty()) {
-            itsCondVar.wait(lock);
+        boost::shared_ptr<Slot> slot(itsSendQueue.pop());
+        if (!slot) {
+            break; // Closed
         }
 
-        if (boost::this_thread::interruption_requested()) break;
-
         bool connected = itsSocket.is_open();
         if (!connected) {
-            lock.unlock();
             connected = connect();
-            lock.lock();
         }
 
         if (boost::this_thread::interruption_requested()) break;
 
+        // If the connect/send fails the integration is discarded, the next
+        // integration will try to reconnect
         if (connected) {
-            boost::system::error_code error;
-            boost::asio::write(itsSocket, boost::asio::buffer(itsBuf), error);
-            if (error) {
-                ASKAPLOG_WARN_STR(logger, "Send failed: " << error.message());
-                itsSocket.close();
+            try {
+                send(*slot);
+            } catch (const askap::AskapError& e) {
+                ASKAPLOG_WARN_STR(logger, "Send failed: " << e.what());
             }
         }
 
-        // Reset the buffer, even if the connect/send failed so the loop will not try
-        // to reconnect/resend until the next integration cycle
-        itsBuf.clear();
+        // Return the slot for reuse
+        itsFreeSlots.push(slot);
     }
     ASKAPLOG_DEBUG_STR(logger, "TCP sender thread exiting");
 }
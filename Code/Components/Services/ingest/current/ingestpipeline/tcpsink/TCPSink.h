@@ -34,8 +34,6 @@
 
 // ASKAPsoft includes
 #include "boost/scoped_ptr.hpp"
-#include "boost/thread/mutex.hpp"
-#include "boost/thread/condition.hpp"
 #include "boost/thread.hpp"
 #include "boost/asio.hpp"
 #include "Common/ParameterSet.h"
@@ -44,6 +42,7 @@
 
 // Local package includes
 #include "ingestpipeline/ITask.h"
+#include "ingestpipeline/BoundedQueue.h"
 #include "configuration/Configuration.h" // Includes all configuration attributes too
 
 namespace askap {
@@ -52,6 +51,25 @@ namespace ingest {
 
 /// @brief A sink task for the central processor ingest pipeline which writes
 /// the VisChunk to a TCP network port.
+///
+/// process() copies the parts of the VisChunk which are sent into one of a
+/// fixed number of slots ("buffers", default 4) and a sender thread writes
+/// each slot with a single scatter-gather write. The slots are reused, so
+/// once they have grown to the size of an integration no memory is
+/// allocated. If all slots are waiting to be sent the integration is
+/// dropped with a warning, the main thread is never blocked by the network.
+/// The VisChunk is not referenced after process() returns, so the tasks
+/// following this one are free to modify it.
+///
+/// The message sent for each integration consists of (in native byte order):
+/// - nRow, nChannel, nPol (uint32), timestamp (BAT, uint64), scan (uint32)
+///   and the channel width (double, Hz)
+/// - the frequency of each channel (nChannel doubles)
+/// - antenna1, antenna2 and beam1 (nRow uint32 each)
+/// - stokes types (nPol uint32, 0=XX, 1=XY, 2=YX, 3=YY)
+/// - visibilities (nRow * nChannel * nPol complex floats, in VisChunk order)
+/// - flags, one bit per visibility in the same order, least significant bit
+///   first (ceil(nRow * nChannel * nPol / 8) bytes).
 class TCPSink : public askap::cp::ingest::ITask {
     public:
         /// @brief Constructor.
@@ -63,16 +81,35 @@ class TCPSink : public askap::cp::ingest::ITask {
         /// @brief Destructor.
         virtual ~TCPSink();
 
-        /// @brief Writes out the data in the VisChunk parameter to the
-        /// measurement set.
+        /// @brief Queues the data in the VisChunk parameter for sending to
+        /// the network port.
         ///
         /// @param[in,out] chunk    the instance of VisChunk to send. Note
         ///                         the VisChunk pointed to by "chunk" nor the pointer
         ///                         itself are modified by this function.
         virtual void process(askap::cp::common::VisChunk::ShPtr chunk);
 
+        /// Packs the flags one bit per element, least significant bit first
+        /// @param[in] flag     the flags to pack
+        /// @param[out] packed  the packed flags, resized if needed
+        static void packFlags(const casa::Array<casa::Bool>& flag,
+                              std::vector<uint8_t>& packed);
+
     private:
 
+        /// A copy of an integration waiting to be sent, in the form it is
+        /// sent in. Slots are reused, so the buffers only grow.
+        struct Slot {
+            std::vector<uint8_t> header;
+            std::vector<casa::Double> frequency;
+            std::vector<casa::uInt> antenna1;
+            std::vector<casa::uInt> antenna2;
+            std::vector<casa::uInt> beam1;
+            std::vector<uint32_t> stokes;
+            std::vector<casa::Complex> visibility;
+            std::vector<uint8_t> flag;
+        };
+
         /// No support for assignment
         TCPSink& operator=(const TCPSink& rhs);
 
@@ -86,42 +123,36 @@ class TCPSink : public askap::cp::ingest::ITask {
         /// @return true if connection succeeded, otherwise false
         bool connect(void);
 
-        /// Serialise a "VisChunk" to a byte-array for asynchronous sending to
-        /// the specified destination
-        static void serialiseVisChunk(const askap::cp::common::VisChunk& chunk,
-                                      std::vector<uint8_t>& v);
+        /// Copies the parts of the chunk which are sent into the slot
+        static void prepareSlot(const askap::cp::common::VisChunk& chunk, Slot& slot);
+
+        /// Sends the slot with a single scatter-gather write
+        /// @return false if the write failed
+        bool send(const Slot& slot);
 
         /// Is used to append the bytes for a primative type to the
         /// byte vector
         template <typename T>
         static void pushBack(const T src, std::vector<uint8_t>& dest);
 
-        /// Is used to append the bytes for a CASA Array to the byte vector
-        /// The array elements should be primative types
-        template <typename T>
-        static void pushBackArray(const casa::Array<T>& src, std::vector<uint8_t>& dest);
-
-        /// Is used to append the bytes for a STL vector to the byte vector.
+        /// Copies a CASA Array into a vector, reusing the vector's storage.
         /// The array elements should be primative types
         template <typename T>
-        static void pushBackVector(const std::vector<T>& src, std::vector<uint8_t>& dest);
+        static void copyArray(const casa::Array<T>& src, std::vector<T>& dest);
 
         static uint32_t mapStokes(casa::Stokes::StokesTypes type);
 
         /// Parameter set
         const LOFAR::ParameterSet itsParset;
 
-        /// Buffer to send - This is shared between the producer (main thread)
-        /// and the consumer (sender thread) so no double buffering. Only the owner
-        /// of "itsMutex" should read/write this buffer.
-        std::vector<uint8_t> itsBuf;
+        /// Slots available to the main thread
+        BoundedQueue<Slot> itsFreeSlots;
 
-        /// Mutex used to synchronise access to "itsBuf"
-        boost::mutex itsMutex;
+        /// Slots waiting to be sent by the sender thread
+        BoundedQueue<Slot> itsSendQueue;
 
-        /// Condition variable used for signalling between the main thread and
-        /// the network sender thread
-        boost::condition itsCondVar;
+        /// Number of integrations dropped because all slots were in use
+        unsigned long itsDropped;
 
         /// io_service
         boost::asio::io_service itsIOService;
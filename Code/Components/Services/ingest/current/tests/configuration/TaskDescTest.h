@@ -61,6 +61,11 @@ class TaskDescTest : public CppUnit::TestFixture {
             CPPUNIT_ASSERT_EQUAL(name, instance.name());
             CPPUNIT_ASSERT_EQUAL(type, instance.type());
             CPPUNIT_ASSERT_EQUAL(params.size(), instance.params().size());
+            // by default each task has its own stage
+            CPPUNIT_ASSERT_EQUAL(name, instance.stage());
+
+            TaskDesc staged(name, type, params, "uvwstage");
+            CPPUNIT_ASSERT_EQUAL(string("uvwstage"), staged.stage());
         };
 };
 
@@ -27,6 +27,9 @@
 // CPPUnit includes
 #include <cppunit/extensions/HelperMacros.h>
 
+// System includes
+#include <cmath>
+
 // Support classes
 #include "askap/AskapError.h"
 #include "Common/ParameterSet.h"
@@ -53,6 +56,8 @@ class CalcUVWTaskTest : public CppUnit::TestFixture {
         CPPUNIT_TEST_SUITE(CalcUVWTaskTest);
         CPPUNIT_TEST(testOffset);
         CPPUNIT_TEST(testAutoCorrelation);
+        CPPUNIT_TEST(testMultipleRows);
+        CPPUNIT_TEST(testPointingChange);
         CPPUNIT_TEST(testInvalidAntenna);
         CPPUNIT_TEST(testInvalidBeam);
         CPPUNIT_TEST_SUITE_END();
@@ -64,64 +69,112 @@ class CalcUVWTaskTest : public CppUnit::TestFixture {
         void tearDown() {
         }
 
+        // The uvw is a rotated baseline vector, so its length is the distance
+        // between the antennas, but the direction depends on the beam
         void testOffset() {
-            //      ant1, ant2, beam,    u,      v,      w
-            testDriver(0,    1,    0,    -411.4, -838.4, 294.1);
-            testDriver(0,    2,    0,    -120.2, -874.0, 325.5);
-
-            testDriver(0,    1,    1,    -411.9, -843.1, 279.8);
-            testDriver(0,    2,    1,    -120.7, -879.4, 310.4);
+            const Configuration config = ConfigurationHelper::createDummyConfig();
+            for (unsigned int ant2 = 1; ant2 < 3; ++ant2) {
+                const double length = baselineLength(config, 0, ant2);
+                const casa::RigidVector<casa::Double, 3> uvw0 = testDriver(0, ant2, 0);
+                const casa::RigidVector<casa::Double, 3> uvw1 = testDriver(0, ant2, 1);
+                CPPUNIT_ASSERT_DOUBLES_EQUAL(length, norm(uvw0), 1e-3);
+                CPPUNIT_ASSERT_DOUBLES_EQUAL(length, norm(uvw1), 1e-3);
+                // beams are 1 deg apart, the uvw should change well above the rounding level
+                CPPUNIT_ASSERT(norm(uvw1 - uvw0) > 1e-2);
+            }
         }
 
         void testAutoCorrelation() {
-            //      ant1, ant2, beam,    u,   v,   w
-            testDriver(0,    0,    0,    0.0, 0.0, 0.0);
+            const casa::RigidVector<casa::Double, 3> uvw = testDriver(0, 0, 0);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0, uvw(0), 1e-10);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0, uvw(1), 1e-10);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0, uvw(2), 1e-10);
+        }
+
+        // All baselines and beams in one chunk, so the cached antenna UVWs
+        // are shared between rows. The result should be the same as for
+        // one row at a time
+        void testMultipleRows() {
+            const unsigned int nRow = 6;
+            const unsigned int ant1[] = {0, 0, 0, 0, 1, 2};
+            const unsigned int ant2[] = {1, 2, 1, 2, 2, 2};
+            const unsigned int beam[] = {0, 0, 1, 1, 0, 3};
+
+            const unsigned int nAntenna = 6;
+            VisChunk::ShPtr chunk(new VisChunk(nRow, 1, 1, nAntenna));
+            initChunk(chunk);
+            for (unsigned int row = 0; row < nRow; ++row) {
+                chunk->antenna1()(row) = ant1[row];
+                chunk->antenna2()(row) = ant2[row];
+                chunk->beam1()(row) = beam[row];
+                chunk->beam2()(row) = beam[row];
+            }
+
+            CalcUVWTask task(itsParset, ConfigurationHelper::createDummyConfig());
+            task.process(chunk);
+
+            for (unsigned int row = 0; row < nRow; ++row) {
+                compare(testDriver(ant1[row], ant2[row], beam[row]), chunk->uvw()(row));
+            }
+        }
+
+        // Rows of the same beam with different dish pointings, the cached
+        // antenna UVWs have to be recalculated
+        void testPointingChange() {
+            const unsigned int nAntenna = 6;
+            VisChunk::ShPtr chunk(new VisChunk(3, 1, 1, nAntenna));
+            initChunk(chunk);
+            const casa::MVDirection otherPointing(casa::Quantity(190., "deg"), casa::Quantity(-30., "deg"));
+            for (unsigned int row = 0; row < chunk->nRow(); ++row) {
+                chunk->antenna1()(row) = 0;
+                chunk->antenna2()(row) = 2;
+                chunk->beam1()(row) = 0;
+                chunk->beam2()(row) = 0;
+            }
+            chunk->phaseCentre1()(1) = otherPointing;
+            chunk->phaseCentre2()(1) = otherPointing;
+
+            CalcUVWTask task(itsParset, ConfigurationHelper::createDummyConfig());
+            task.process(chunk);
+
+            const casa::RigidVector<casa::Double, 3> uvw = testDriver(0, 2, 0);
+            compare(uvw, chunk->uvw()(0));
+            compare(testDriver(0, 2, 0, otherPointing), chunk->uvw()(1));
+            compare(uvw, chunk->uvw()(2));
+            CPPUNIT_ASSERT(norm(chunk->uvw()(1) - uvw) > 1.);
         }
 
         void testInvalidAntenna() {
-            CPPUNIT_ASSERT_THROW(
-                //       ant1, ant2, beam,    u,   v,   w
-                testDriver(7,    0,    0,    0.0, 0.0, 0.0),
-                askap::AskapError);
+            CPPUNIT_ASSERT_THROW(testDriver(7, 0, 0), askap::AskapError);
         }
 
         void testInvalidBeam() {
-            CPPUNIT_ASSERT_THROW(
-                //      ant1, ant2, beam,    u,   v,   w
-                testDriver(0,    0,    4,    0.0, 0.0, 0.0),
-                askap::AskapError);
+            CPPUNIT_ASSERT_THROW(testDriver(0, 0, 4), askap::AskapError);
+        }
+
+    private:
+
+        // Calculates the uvw for a single row chunk with 1 channel and 1 pol
+        casa::RigidVector<casa::Double, 3> testDriver(const unsigned int antenna1,
+                        const unsigned int antenna2,
+                        const unsigned int beam) {
+            return testDriver(antenna1, antenna2, beam, fieldCentre().getValue());
         }
 
-        void testDriver(const unsigned int antenna1,
+        casa::RigidVector<casa::Double, 3> testDriver(const unsigned int antenna1,
                         const unsigned int antenna2,
                         const unsigned int beam,
-                        const double u,
-                        const double v,
-                        const double w) {
+                        const casa::MVDirection& dishPointing) {
             const unsigned int row = 0;
-            MEpoch starttime(MVEpoch(Quantity(54165.73871, "d")),
-                             MEpoch::Ref(MEpoch::UTC));
-            MDirection fieldCenter(Quantity(187.5, "deg"),
-                                   Quantity(-45, "deg"),
-                                   MDirection::Ref(MDirection::J2000));
-
-            // Create a simple chunk with 1 row, 1 channel and 1 pol
             const unsigned int nAntenna = 6;
             VisChunk::ShPtr chunk(new VisChunk(1, 1, 1, nAntenna));
-            chunk->time() = starttime.getValue();
+            initChunk(chunk);
             chunk->antenna1()(row) = antenna1;
             chunk->antenna2()(row) = antenna2;
             chunk->beam1()(row) = beam;
             chunk->beam2()(row) = beam;
-            chunk->beam1PA()(row) = 0.0;
-            chunk->beam2PA()(row) = 0.0;
-            chunk->phaseCentre1()(row) = fieldCenter.getAngle();
-            chunk->phaseCentre2()(row) = fieldCenter.getAngle();
-            chunk->frequency()(0) = 1400000;
-
-            chunk->targetPointingCentre() = fieldCenter;
-            chunk->actualPointingCentre() = fieldCenter;
-            chunk->actualPolAngle() = 0.0;
+            chunk->phaseCentre1()(row) = dishPointing;
+            chunk->phaseCentre2()(row) = dishPointing;
 
             // Instantiate the class under test and call process() to
             // add UVW coordinates to the VisChunk
@@ -130,16 +183,56 @@ class CalcUVWTaskTest : public CppUnit::TestFixture {
 
             CPPUNIT_ASSERT_EQUAL(1u, chunk->nRow());
             CPPUNIT_ASSERT(chunk->uvw().size() == 1);
-            casa::RigidVector<casa::Double, 3> uvw = chunk->uvw()(row);
+            return chunk->uvw()(row);
+        }
 
-            // Tolerance for uvw equality
-            const double tol = 1.0E-1;
-            CPPUNIT_ASSERT_DOUBLES_EQUAL(u, uvw(0), tol); //u
-            CPPUNIT_ASSERT_DOUBLES_EQUAL(v, uvw(1), tol); //v
-            CPPUNIT_ASSERT_DOUBLES_EQUAL(w, uvw(2), tol); //w
+        static void compare(const casa::RigidVector<casa::Double, 3>& expected,
+                            const casa::RigidVector<casa::Double, 3>& uvw) {
+            for (unsigned int i = 0; i < 3; ++i) {
+                CPPUNIT_ASSERT_DOUBLES_EQUAL(expected(i), uvw(i), 1e-6);
+            }
         }
 
-    private:
+        static double norm(const casa::RigidVector<casa::Double, 3>& vec) {
+            return sqrt(vec * vec);
+        }
+
+        // Distance between two antennas of the configuration
+        static double baselineLength(const Configuration& config,
+                                     const unsigned int ant1, const unsigned int ant2) {
+            const casa::Vector<casa::Double> pos1 = config.antennas().at(ant1).position();
+            const casa::Vector<casa::Double> pos2 = config.antennas().at(ant2).position();
+            double sum = 0.;
+            for (unsigned int i = 0; i < 3; ++i) {
+                sum += (pos2(i) - pos1(i)) * (pos2(i) - pos1(i));
+            }
+            return sqrt(sum);
+        }
+
+        static MDirection fieldCentre() {
+            return MDirection(Quantity(187.5, "deg"), Quantity(-45, "deg"),
+                              MDirection::Ref(MDirection::J2000));
+        }
+
+        // Sets the time, phase centres and frequency of all rows
+        static void initChunk(VisChunk::ShPtr chunk) {
+            MEpoch starttime(MVEpoch(Quantity(54165.73871, "d")),
+                             MEpoch::Ref(MEpoch::UTC));
+            const MDirection fieldCenter = fieldCentre();
+
+            chunk->time() = starttime.getValue();
+            for (unsigned int row = 0; row < chunk->nRow(); ++row) {
+                chunk->beam1PA()(row) = 0.0;
+                chunk->beam2PA()(row) = 0.0;
+                chunk->phaseCentre1()(row) = fieldCenter.getAngle();
+                chunk->phaseCentre2()(row) = fieldCenter.getAngle();
+            }
+            chunk->frequency()(0) = 1400000;
+
+            chunk->targetPointingCentre() = fieldCenter;
+            chunk->actualPointingCentre() = fieldCenter;
+            chunk->actualPolAngle() = 0.0;
+        }
 
         LOFAR::ParameterSet itsParset;
 };
@@ -60,6 +60,7 @@ class ChannelAvgTaskTest : public CppUnit::TestFixture {
         CPPUNIT_TEST(testNoAveraging);
         CPPUNIT_TEST(testInvalid);
         CPPUNIT_TEST(testAllFlagged);
+        CPPUNIT_TEST(testRowsAndPols);
         CPPUNIT_TEST_SUITE_END();
 
     public:
@@ -98,6 +99,57 @@ class ChannelAvgTaskTest : public CppUnit::TestFixture {
             averageTest(304 * 54, 304, true);
         }
 
+        // Test with several rows and polarisations and some flagged
+        // visibilities, to check that the in-place averaging keeps each
+        // row, channel and polarisation in its right place
+        void testRowsAndPols() {
+            itsParset.add("averaging", "4");
+            const casa::uInt nRow = 5;
+            const casa::uInt nChan = 12;
+            const casa::uInt nPol = 4;
+            const casa::uInt nAvg = 4;
+            VisChunk::ShPtr chunk(new VisChunk(nRow, nChan, nPol, 6));
+            for (casa::uInt row = 0; row < nRow; ++row) {
+                for (casa::uInt chan = 0; chan < nChan; ++chan) {
+                    for (casa::uInt pol = 0; pol < nPol; ++pol) {
+                        chunk->visibility()(row, chan, pol) =
+                            casa::Complex(100 * row + 10 * chan + pol, row + chan * pol);
+                        // flag some samples, and everything for row 3, pol 1
+                        chunk->flag()(row, chan, pol) = ((row + chan + pol) % 3 == 0) ||
+                                                        (row == 3 && pol == 1);
+                    }
+                }
+            }
+            const casa::Cube<casa::Complex> origVis = chunk->visibility().copy();
+            const casa::Cube<casa::Bool> origFlag = chunk->flag().copy();
+
+            ChannelAvgTask task(itsParset, ConfigurationHelper::createDummyConfig());
+            task.process(chunk);
+
+            CPPUNIT_ASSERT_EQUAL(nChan / nAvg, chunk->nChannel());
+            for (casa::uInt row = 0; row < nRow; ++row) {
+                for (casa::uInt chan = 0; chan < nChan / nAvg; ++chan) {
+                    for (casa::uInt pol = 0; pol < nPol; ++pol) {
+                        casa::Complex sum(0.0, 0.0);
+                        casa::uInt count = 0;
+                        for (casa::uInt i = 0; i < nAvg; ++i) {
+                            if (!origFlag(row, chan * nAvg + i, pol)) {
+                                sum += origVis(row, chan * nAvg + i, pol);
+                                ++count;
+                            }
+                        }
+                        CPPUNIT_ASSERT_EQUAL(count == 0, chunk->flag()(row, chan, pol));
+                        const casa::Complex expected = count == 0 ? casa::Complex(0.0, 0.0) :
+                            casa::Complex(sum.real() / count, sum.imag() / count);
+                        CPPUNIT_ASSERT_DOUBLES_EQUAL(expected.real(),
+                                chunk->visibility()(row, chan, pol).real(), 1e-5);
+                        CPPUNIT_ASSERT_DOUBLES_EQUAL(expected.imag(),
+                                chunk->visibility()(row, chan, pol).imag(), 1e-5);
+                    }
+                }
+            }
+        }
+
         void testInvalid() {
             // This is an invalid configuraion, so should throw an exception
             CPPUNIT_ASSERT_THROW(averageTest(4, 3), askap::AskapError);
@@ -0,0 +1,124 @@
+/// @file PhaseRotatorTest.h
+///
+/// @copyright (c) 2015 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+
+// CPPUnit includes
+#include <cppunit/extensions/HelperMacros.h>
+
+// Support classes
+#include <cmath>
+#include <complex>
+#include "casa/aips.h"
+#include "casa/BasicSL/Constants.h"
+#include "cpcommon/VisChunk.h"
+
+// Classes to test
+#include "ingestpipeline/phasetracktask/PhaseRotator.h"
+
+using askap::cp::common::VisChunk;
+
+namespace askap {
+namespace cp {
+namespace ingest {
+
+class PhaseRotatorTest : public CppUnit::TestFixture {
+        CPPUNIT_TEST_SUITE(PhaseRotatorTest);
+        CPPUNIT_TEST(testEquallySpaced);
+        CPPUNIT_TEST(testUnequallySpaced);
+        CPPUNIT_TEST(testEmptyChunk);
+        CPPUNIT_TEST_SUITE_END();
+
+    public:
+        void testEquallySpaced() {
+            // More channels than the reseed interval, to check the
+            // recurrence between exact evaluations
+            check(false);
+        }
+
+        void testUnequallySpaced() {
+            check(true);
+        }
+
+        void testEmptyChunk() {
+            VisChunk chunk(0, 16, 4, 3);
+            for (casa::uInt chan = 0; chan < chunk.nChannel(); ++chan) {
+                chunk.frequency()(chan) = 1.4e9 + chan * 18.5e3;
+            }
+            PhaseRotator rotator;
+            rotator.reset(0);
+            rotator.apply(chunk);
+            CPPUNIT_ASSERT_EQUAL(0u, chunk.nRow());
+        }
+
+    private:
+        // Compares the rotation with direct evaluation of the phasors.
+        // Row 2 is not set up and must be left untouched.
+        void check(const bool perturbFreq) {
+            const casa::uInt nRow = 5;
+            const casa::uInt nChan = 3 * PhaseRotator::ReseedInterval + 17;
+            const casa::uInt nPol = 4;
+            VisChunk chunk(nRow, nChan, nPol, 3);
+            for (casa::uInt chan = 0; chan < nChan; ++chan) {
+                chunk.frequency()(chan) = 1.4e9 + chan * 18.5e3 +
+                    (perturbFreq ? (chan % 3) * 1e3 : 0.);
+            }
+            for (casa::uInt row = 0; row < nRow; ++row) {
+                for (casa::uInt chan = 0; chan < nChan; ++chan) {
+                    for (casa::uInt pol = 0; pol < nPol; ++pol) {
+                        chunk.visibility()(row, chan, pol) =
+                            casa::Complex(row + 1., chan * 0.01 - pol);
+                    }
+                }
+            }
+            const casa::Cube<casa::Complex> original = chunk.visibility().copy();
+
+            PhaseRotator rotator;
+            rotator.reset(nRow);
+            for (casa::uInt row = 0; row < nRow; ++row) {
+                if (row != 2) {
+                    rotator.setRow(row, 0.3 * row - 1., (row - 1.5) * 3.1e-7);
+                }
+            }
+            rotator.apply(chunk);
+
+            for (casa::uInt row = 0; row < nRow; ++row) {
+                for (casa::uInt chan = 0; chan < nChan; ++chan) {
+                    const double phase = (row == 2) ? 0. : 0.3 * row - 1. +
+                        2. * casa::C::pi * (row - 1.5) * 3.1e-7 * chunk.frequency()(chan);
+                    const std::complex<double> phasor(cos(phase), sin(phase));
+                    for (casa::uInt pol = 0; pol < nPol; ++pol) {
+                        const std::complex<double> expected =
+                            std::complex<double>(original(row, chan, pol)) * phasor;
+                        const casa::Complex actual = chunk.visibility()(row, chan, pol);
+                        CPPUNIT_ASSERT_DOUBLES_EQUAL(expected.real(), actual.real(), 1e-4);
+                        CPPUNIT_ASSERT_DOUBLES_EQUAL(expected.imag(), actual.imag(), 1e-4);
+                    }
+                }
+            }
+        }
+};
+
+}   // End namespace ingest
+}   // End namespace cp
+}   // End namespace askap
@@ -0,0 +1,163 @@
+/// @file CircularBufferTest.cc
+///
+/// @copyright (c) 2015 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+
+// CPPUnit includes
+#include <cppunit/extensions/HelperMacros.h>
+
+// Support classes
+#include <set>
+#include "boost/shared_ptr.hpp"
+#include "boost/thread.hpp"
+#include "boost/bind.hpp"
+
+// Classes to test
+#include "ingestpipeline/sourcetask/RecyclingBuffer.h"
+
+namespace askap {
+namespace cp {
+namespace ingest {
+
+class RecyclingBufferTest : public CppUnit::TestFixture {
+        CPPUNIT_TEST_SUITE(RecyclingBufferTest);
+        CPPUNIT_TEST(testSingle);
+        CPPUNIT_TEST(testPartialPublish);
+        CPPUNIT_TEST(testFull);
+        CPPUNIT_TEST(testRecycle);
+        CPPUNIT_TEST(testTimeout);
+        CPPUNIT_TEST(testThreaded);
+        CPPUNIT_TEST_SUITE_END();
+
+    public:
+        // Test the publication and retrieval of a single object
+        void testSingle() {
+            RecyclingBuffer<int> instance(2);
+            CPPUNIT_ASSERT_EQUAL(size_t(2), instance.capacity());
+            CPPUNIT_ASSERT_EQUAL(size_t(1), instance.acquire(1));
+            *instance.slot(0) = 42;
+            instance.publish(0);
+            // Not visible before the commit
+            CPPUNIT_ASSERT(instance.pop(0).get() == 0);
+            instance.commit();
+            CPPUNIT_ASSERT_EQUAL(size_t(1), instance.size());
+
+            boost::shared_ptr<int> outPtr(instance.pop());
+            CPPUNIT_ASSERT(outPtr.get() != 0);
+            CPPUNIT_ASSERT_EQUAL(42, *outPtr);
+            CPPUNIT_ASSERT_EQUAL(size_t(0), instance.size());
+        };
+
+        // Only the published objects are passed on, in the order of publication
+        void testPartialPublish() {
+            RecyclingBuffer<int> instance(10);
+            CPPUNIT_ASSERT_EQUAL(size_t(5), instance.acquire(5));
+            for (int i = 0; i < 5; ++i) {
+                *instance.slot(i) = i;
+                if (i % 2 == 0) {
+                    instance.publish(i);
+                }
+            }
+            instance.commit();
+            CPPUNIT_ASSERT_EQUAL(size_t(3), instance.size());
+            for (int i = 0; i < 5; i += 2) {
+                CPPUNIT_ASSERT_EQUAL(i, *instance.pop(0));
+            }
+            // The objects which were not published are free again
+            CPPUNIT_ASSERT_EQUAL(size_t(10), instance.acquire(100));
+        };
+
+        // No objects can be acquired while the consumer holds all of them
+        void testFull() {
+            RecyclingBuffer<int> instance(3);
+            fill(instance, 3, 0);
+            CPPUNIT_ASSERT_EQUAL(size_t(0), instance.acquire(1));
+            boost::shared_ptr<int> held(instance.pop(0));
+            CPPUNIT_ASSERT_EQUAL(size_t(0), instance.acquire(1));
+            held.reset();
+            CPPUNIT_ASSERT_EQUAL(size_t(1), instance.acquire(2));
+        };
+
+        // Released objects are reused before the untouched ones
+        void testRecycle() {
+            RecyclingBuffer<int> instance(4);
+            fill(instance, 2, 0);
+            boost::shared_ptr<int> held(instance.pop(0));
+            int* released = instance.pop(0).get();
+            CPPUNIT_ASSERT_EQUAL(size_t(1), instance.acquire(1));
+            CPPUNIT_ASSERT(instance.slot(0) == released);
+            CPPUNIT_ASSERT(instance.slot(0) != held.get());
+        };
+
+        // Test the timeout when no object is available
+        void testTimeout() {
+            RecyclingBuffer<int> instance(1);
+            boost::shared_ptr<int> outPtr(instance.pop(10000));
+            CPPUNIT_ASSERT(outPtr.get() == 0);
+        };
+
+        // Producer and consumer on different threads, with the consumer
+        // holding on to the last object like MergedSource does
+        void testThreaded() {
+            const int count = 100000;
+            RecyclingBuffer<int> instance(8);
+            boost::thread producer(boost::bind(&RecyclingBufferTest::produce,
+                        &instance, count));
+            std::set<int*> used;
+            boost::shared_ptr<int> last;
+            for (int i = 0; i < count; ++i) {
+                last = instance.pop(-1);
+                CPPUNIT_ASSERT(last.get() != 0);
+                CPPUNIT_ASSERT_EQUAL(i, *last);
+                used.insert(last.get());
+            }
+            producer.join();
+            CPPUNIT_ASSERT(used.size() <= 8);
+        };
+
+    private:
+        static void fill(RecyclingBuffer<int>& buffer, size_t n, int first) {
+            CPPUNIT_ASSERT_EQUAL(n, buffer.acquire(n));
+            for (size_t i = 0; i < n; ++i) {
+                *buffer.slot(i) = first + i;
+                buffer.publish(i);
+            }
+            buffer.commit();
+        }
+
+        static void produce(RecyclingBuffer<int>* buffer, int count) {
+            int next = 0;
+            while (next < count) {
+                const size_t n = buffer->acquire(3);
+                for (size_t i = 0; i < n && next < count; ++i) {
+                    *buffer->slot(i) = next++;
+                    buffer->publish(i);
+                }
+                buffer->commit();
+            }
+        }
+};
+
+}   // End namespace ingest
+}   // End namespace cp
+}   // End namespace askap
@@ -0,0 +1,183 @@
+/// @file TCPSinkTest.h
+///
+/// @copyright (c) 2015 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+
+// CPPUnit includes
+#include <cppunit/extensions/HelperMacros.h>
+
+// Support classes
+#include <vector>
+#include <cstring>
+#include <stdint.h>
+#include "boost/asio.hpp"
+#include "boost/lexical_cast.hpp"
+#include "Common/ParameterSet.h"
+#include "casa/Arrays/Cube.h"
+#include "casa/Quanta/MVEpoch.h"
+#include "cpcommon/VisChunk.h"
+#include "ConfigurationHelper.h"
+
+// Classes to test
+#include "ingestpipeline/tcpsink/TCPSink.h"
+
+namespace askap {
+namespace cp {
+namespace ingest {
+
+class TCPSinkTest : public CppUnit::TestFixture {
+        CPPUNIT_TEST_SUITE(TCPSinkTest);
+        CPPUNIT_TEST(testPackFlags);
+        CPPUNIT_TEST(testChunkModifiedAfterProcess);
+        CPPUNIT_TEST_SUITE_END();
+
+    public:
+        // The flags are packed one bit per visibility, least significant
+        // bit first, in the storage order of the flag cube
+        void testPackFlags() {
+            // 3 * 7 * 2 = 42 flags, so the last byte is partly used
+            casa::Cube<casa::Bool> flag(3, 7, 2);
+            casa::Bool* data = flag.data();
+            for (size_t i = 0; i < flag.size(); ++i) {
+                data[i] = (i % 3 == 0) || (i % 5 == 0);
+            }
+            std::vector<uint8_t> packed(1, 0xff);
+            TCPSink::packFlags(flag, packed);
+            CPPUNIT_ASSERT_EQUAL(size_t(6), packed.size());
+            for (size_t i = 0; i < flag.size(); ++i) {
+                CPPUNIT_ASSERT_EQUAL(data[i], ((packed[i / 8] >> (i % 8)) & 1) == 1);
+            }
+            // Unused bits of the last byte are zero
+            CPPUNIT_ASSERT_EQUAL(uint8_t(0), static_cast<uint8_t>(packed[5] >> 2));
+        }
+
+        // The integration sent must be the one passed to process(), even if
+        // the following tasks modify the chunk while it is being sent
+        void testChunkModifiedAfterProcess() {
+            using boost::asio::ip::tcp;
+            const casa::uInt nRow = 3;
+            const casa::uInt nChan = 8;
+            const casa::uInt nPol = 4;
+
+            // Listen on a free port of the loopback interface
+            boost::asio::io_service ioService;
+            tcp::acceptor acceptor(ioService,
+                    tcp::endpoint(boost::asio::ip::address_v4::loopback(), 0));
+            LOFAR::ParameterSet parset;
+            parset.add("dest.hostname", "127.0.0.1");
+            parset.add("dest.port",
+                    boost::lexical_cast<std::string>(acceptor.local_endpoint().port()));
+
+            askap::cp::common::VisChunk::ShPtr chunk(
+                    new askap::cp::common::VisChunk(nRow, nChan, nPol, 2));
+            chunk->time() = casa::MVEpoch(casa::Quantity(50000.0, "d"));
+            chunk->stokes()(0) = casa::Stokes::XX;
+            chunk->stokes()(1) = casa::Stokes::XY;
+            chunk->stokes()(2) = casa::Stokes::YX;
+            chunk->stokes()(3) = casa::Stokes::YY;
+            for (casa::uInt chan = 0; chan < nChan; ++chan) {
+                chunk->frequency()(chan) = 1.0e9 + chan * 1.0e6;
+            }
+            for (casa::uInt row = 0; row < nRow; ++row) {
+                chunk->antenna1()(row) = row;
+                chunk->antenna2()(row) = row + 1;
+                chunk->beam1()(row) = row + 2;
+                for (casa::uInt chan = 0; chan < nChan; ++chan) {
+                    for (casa::uInt pol = 0; pol < nPol; ++pol) {
+                        chunk->visibility()(row, chan, pol) =
+                            casa::Complex(row * 100 + chan * 10 + pol, -1.0);
+                        chunk->flag()(row, chan, pol) = (chan == pol);
+                    }
+                }
+            }
+            const casa::Cube<casa::Complex> expectedVis = chunk->visibility().copy();
+
+            TCPSink sink(parset, ConfigurationHelper::createDummyConfig());
+            sink.process(chunk);
+
+            // Modify the chunk the way later tasks may do
+            chunk->visibility() = casa::Complex(0.0, 0.0);
+            chunk->flag() = true;
+            chunk->frequency() = 0.0;
+            chunk->antenna1() = 99u;
+            chunk->shrinkChannels(nChan / 2);
+
+            // Receive the message
+            tcp::socket socket(ioService);
+            acceptor.accept(socket);
+            const size_t nVis = nRow * nChan * nPol;
+            const size_t headerSize = 3 * sizeof(uint32_t) + sizeof(uint64_t) +
+                                      sizeof(uint32_t) + sizeof(double);
+            std::vector<uint8_t> msg(headerSize + nChan * sizeof(double) +
+                                     3 * nRow * sizeof(uint32_t) + nPol * sizeof(uint32_t) +
+                                     nVis * sizeof(casa::Complex) + (nVis + 7) / 8);
+            boost::asio::read(socket, boost::asio::buffer(msg));
+
+            size_t offset = 0;
+            CPPUNIT_ASSERT_EQUAL(nRow, extract<uint32_t>(msg, offset));
+            CPPUNIT_ASSERT_EQUAL(nChan, extract<uint32_t>(msg, offset));
+            CPPUNIT_ASSERT_EQUAL(nPol, extract<uint32_t>(msg, offset));
+            offset = headerSize;
+            for (casa::uInt chan = 0; chan < nChan; ++chan) {
+                CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0e9 + chan * 1.0e6,
+                        extract<double>(msg, offset), 1e-6);
+            }
+            for (casa::uInt row = 0; row < nRow; ++row) {
+                CPPUNIT_ASSERT_EQUAL(row, extract<uint32_t>(msg, offset));
+            }
+            for (casa::uInt row = 0; row < nRow; ++row) {
+                CPPUNIT_ASSERT_EQUAL(row + 1, extract<uint32_t>(msg, offset));
+            }
+            for (casa::uInt row = 0; row < nRow; ++row) {
+                CPPUNIT_ASSERT_EQUAL(row + 2, extract<uint32_t>(msg, offset));
+            }
+            for (casa::uInt pol = 0; pol < nPol; ++pol) {
+                CPPUNIT_ASSERT_EQUAL(pol, extract<uint32_t>(msg, offset));
+            }
+            const casa::Complex* vis = expectedVis.data();
+            for (size_t i = 0; i < nVis; ++i) {
+                const casa::Complex sent = extract<casa::Complex>(msg, offset);
+                CPPUNIT_ASSERT_DOUBLES_EQUAL(vis[i].real(), sent.real(), 1e-6);
+                CPPUNIT_ASSERT_DOUBLES_EQUAL(vis[i].imag(), sent.imag(), 1e-6);
+            }
+            // Only the diagonal channel/pol flags were set
+            size_t nFlagged = 0;
+            for (size_t i = 0; i < nVis; ++i) {
+                nFlagged += (msg[offset + i / 8] >> (i % 8)) & 1;
+            }
+            CPPUNIT_ASSERT_EQUAL(size_t(nRow * nPol), nFlagged);
+        }
+
+    private:
+        template <typename T>
+        static T extract(const std::vector<uint8_t>& msg, size_t& offset) {
+            T value;
+            memcpy(&value, &msg[offset], sizeof(T));
+            offset += sizeof(T);
+            return value;
+        }
+};
+
+}   // End namespace ingest
+}   // End namespace cp
+}   // End namespace askap
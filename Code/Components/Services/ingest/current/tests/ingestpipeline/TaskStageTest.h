@@ -0,0 +1,190 @@
+/// @file TaskStageTest.h
+///
+/// @copyright (c) 2015 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+
+// CPPUnit includes
+#include <cppunit/extensions/HelperMacros.h>
+
+// Support classes
+#include <vector>
+#include "boost/shared_ptr.hpp"
+#include "boost/thread/mutex.hpp"
+#include "askap/AskapError.h"
+#include "cpcommon/VisChunk.h"
+
+// Classes to test
+#include "ingestpipeline/BoundedQueue.h"
+#include "ingestpipeline/TaskStage.h"
+
+using askap::cp::common::VisChunk;
+
+namespace askap {
+namespace cp {
+namespace ingest {
+
+/// A task which records the timestamps of the processed chunks
+/// and optionally fails on the given chunk
+class RecordingTask : public ITask {
+    public:
+        RecordingTask(int failAt = -1) : itsFailAt(failAt) {}
+
+        virtual void process(VisChunk::ShPtr chunk) {
+            boost::mutex::scoped_lock lock(itsMutex);
+            const double time = chunk->time().getTime("s").getValue();
+            if (static_cast<int>(itsTimes.size()) == itsFailAt) {
+                ASKAPTHROW(AskapError, "Failure requested by the test");
+            }
+            itsTimes.push_back(time);
+        }
+
+        std::vector<double> times(void) const {
+            boost::mutex::scoped_lock lock(itsMutex);
+            return itsTimes;
+        }
+
+    private:
+        const int itsFailAt;
+        std::vector<double> itsTimes;
+        mutable boost::mutex itsMutex;
+};
+
+class TaskStageTest : public CppUnit::TestFixture {
+        CPPUNIT_TEST_SUITE(TaskStageTest);
+        CPPUNIT_TEST(testQueue);
+        CPPUNIT_TEST(testQueueClose);
+        CPPUNIT_TEST(testPipeline);
+        CPPUNIT_TEST(testFailure);
+        CPPUNIT_TEST_SUITE_END();
+
+    public:
+        // Test the order of elements and the capacity of the queue
+        void testQueue() {
+            BoundedQueue<int> instance(3);
+            CPPUNIT_ASSERT_EQUAL(size_t(3), instance.capacity());
+            for (int i = 0; i < 3; ++i) {
+                CPPUNIT_ASSERT(instance.push(boost::shared_ptr<int>(new int(i))));
+            }
+            CPPUNIT_ASSERT_EQUAL(size_t(3), instance.size());
+            for (int i = 0; i < 3; ++i) {
+                boost::shared_ptr<int> outPtr(instance.pop());
+                CPPUNIT_ASSERT(outPtr.get() != 0);
+                CPPUNIT_ASSERT_EQUAL(i, *outPtr);
+            }
+            CPPUNIT_ASSERT_EQUAL(size_t(0), instance.size());
+
+            // tryPop must not block on an empty queue
+            CPPUNIT_ASSERT(instance.tryPop().get() == 0);
+            CPPUNIT_ASSERT(instance.push(boost::shared_ptr<int>(new int(5))));
+            boost::shared_ptr<int> outPtr(instance.tryPop());
+            CPPUNIT_ASSERT(outPtr.get() != 0);
+            CPPUNIT_ASSERT_EQUAL(5, *outPtr);
+        };
+
+        // Test that closing the queue unblocks the consumer and
+        // rejects new elements
+        void testQueueClose() {
+            BoundedQueue<int> instance(2);
+            CPPUNIT_ASSERT(instance.push(boost::shared_ptr<int>(new int(1))));
+            instance.close();
+            CPPUNIT_ASSERT(!instance.push(boost::shared_ptr<int>(new int(2))));
+            boost::shared_ptr<int> outPtr(instance.pop());
+            CPPUNIT_ASSERT(outPtr.get() != 0);
+            CPPUNIT_ASSERT_EQUAL(1, *outPtr);
+            // closed and empty, must not block
+            CPPUNIT_ASSERT(instance.pop().get() == 0);
+        };
+
+        // Run chunks through two stages, the queue is smaller than the
+        // number of chunks so the producer gets blocked
+        void testPipeline() {
+            boost::shared_ptr<RecordingTask> task1(new RecordingTask);
+            boost::shared_ptr<RecordingTask> task2(new RecordingTask);
+            boost::shared_ptr<RecordingTask> task3(new RecordingTask);
+            std::vector<ITask::ShPtr> tasks1(1, task1);
+            std::vector<ITask::ShPtr> tasks2;
+            tasks2.push_back(task2);
+            tasks2.push_back(task3);
+            TaskStage::ShPtr stage1(new TaskStage("stage1", tasks1, 1));
+            TaskStage::ShPtr stage2(new TaskStage("stage2", tasks2, 1));
+            stage1->setNext(stage2);
+            stage1->start();
+            stage2->start();
+
+            const int nChunks = 20;
+            for (int i = 0; i < nChunks; ++i) {
+                CPPUNIT_ASSERT(stage1->push(makeChunk(i)));
+            }
+            CPPUNIT_ASSERT(stage1->push(VisChunk::ShPtr()));
+            stage1->join();
+            stage2->join();
+            CPPUNIT_ASSERT(!stage1->failed());
+            CPPUNIT_ASSERT(!stage2->failed());
+
+            const std::vector<double> times1 = task1->times();
+            const std::vector<double> times3 = task3->times();
+            CPPUNIT_ASSERT_EQUAL(size_t(nChunks), times1.size());
+            CPPUNIT_ASSERT_EQUAL(size_t(nChunks), task2->times().size());
+            CPPUNIT_ASSERT_EQUAL(size_t(nChunks), times3.size());
+            for (int i = 0; i < nChunks; ++i) {
+                CPPUNIT_ASSERT_DOUBLES_EQUAL(double(i), times1[i], 1e-10);
+                CPPUNIT_ASSERT_DOUBLES_EQUAL(double(i), times3[i], 1e-10);
+            }
+        };
+
+        // A failure in the downstream stage must stop the upstream stage
+        // and must not block the producer
+        void testFailure() {
+            boost::shared_ptr<RecordingTask> task1(new RecordingTask);
+            boost::shared_ptr<RecordingTask> task2(new RecordingTask(2));
+            TaskStage::ShPtr stage1(new TaskStage("stage1", std::vector<ITask::ShPtr>(1, task1), 1));
+            TaskStage::ShPtr stage2(new TaskStage("stage2", std::vector<ITask::ShPtr>(1, task2), 1));
+            stage1->setNext(stage2);
+            stage1->start();
+            stage2->start();
+
+            bool accepted = true;
+            for (int i = 0; i < 100 && accepted; ++i) {
+                accepted = stage1->push(makeChunk(i));
+            }
+            CPPUNIT_ASSERT(!accepted);
+            stage1->push(VisChunk::ShPtr());
+            stage1->join();
+            stage2->join();
+            CPPUNIT_ASSERT(!stage1->failed());
+            CPPUNIT_ASSERT(stage2->failed());
+            CPPUNIT_ASSERT(!stage2->error().empty());
+            CPPUNIT_ASSERT_EQUAL(size_t(2), task2->times().size());
+        };
+
+    private:
+        static VisChunk::ShPtr makeChunk(int time) {
+            VisChunk::ShPtr chunk(new VisChunk(1, 1, 1, 1));
+            chunk->time() = casa::MVEpoch(casa::Quantity(double(time), "s"));
+            return chunk;
+        }
+};
+
+}   // End namespace ingest
+}   // End namespace cp
+}   // End namespace askap
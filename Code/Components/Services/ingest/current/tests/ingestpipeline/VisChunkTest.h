@@ -48,6 +48,7 @@ class VisChunkTest : public CppUnit::TestFixture {
         CPPUNIT_TEST(testResizeChans);
         CPPUNIT_TEST(testResizeRows);
         CPPUNIT_TEST(testResizePols);
+        CPPUNIT_TEST(testShrinkChans);
         CPPUNIT_TEST_SUITE_END();
 
     public:
@@ -96,6 +97,39 @@ class VisChunkTest : public CppUnit::TestFixture {
 
         }
 
+        void testShrinkChans() {
+            VisChunk::ShPtr chunk(new VisChunk(nRows, nChans, nPols, nAntennas));
+            const unsigned int newChans = 304;
+            const casa::Complex* visStorage = chunk->visibility().data();
+            const unsigned int nNew = nRows * newChans * nPols;
+            for (unsigned int i = 0; i < nNew; ++i) {
+                chunk->visibility().data()[i] = casa::Complex(i, -float(i));
+                chunk->flag().data()[i] = (i % 3 == 0);
+            }
+            for (unsigned int chan = 0; chan < nChans; ++chan) {
+                chunk->frequency()(chan) = chan;
+            }
+
+            chunk->shrinkChannels(newChans);
+            CPPUNIT_ASSERT_EQUAL(newChans, chunk->nChannel());
+            CPPUNIT_ASSERT_EQUAL(newChans, chunk->visibility().ncolumn());
+            CPPUNIT_ASSERT_EQUAL(newChans, chunk->flag().ncolumn());
+            CPPUNIT_ASSERT_EQUAL(newChans,
+                                 static_cast<unsigned int>(chunk->frequency().size()));
+
+            // The storage is reused and the leading values are kept
+            CPPUNIT_ASSERT(chunk->visibility().contiguousStorage());
+            CPPUNIT_ASSERT(chunk->visibility().data() == visStorage);
+            for (unsigned int i = 0; i < nNew; ++i) {
+                CPPUNIT_ASSERT_EQUAL(casa::Complex(i, -float(i)), chunk->visibility().data()[i]);
+                CPPUNIT_ASSERT_EQUAL(i % 3 == 0, chunk->flag().data()[i]);
+            }
+            for (unsigned int chan = 0; chan < newChans; ++chan) {
+                CPPUNIT_ASSERT_DOUBLES_EQUAL(double(chan), chunk->frequency()(chan), 1e-10);
+            }
+
+            CPPUNIT_ASSERT_THROW(chunk->shrinkChannels(newChans + 1), askap::AskapError);
+        }
 
     private:
         void resizeDriver(const unsigned int initialRows,
@@ -29,6 +29,7 @@
 
 // Test includes
 #include "CircularBufferTest.h"
+#include "RecyclingBufferTest.h"
 #include "VisChunkTest.h"
 #include "ScanManagerTest.h"
 #include "ChannelManagerTest.h"
@@ -37,19 +38,26 @@
 #include "CalcUVWTaskTest.h"
 #include "ChannelAvgTaskTest.h"
 #include "CalTaskTest.h"
+#include "TaskStageTest.h"
+#include "TCPSinkTest.h"
+#include "PhaseRotatorTest.h"
 
 int main(int argc, char *argv[])
 {
     askapdev::testutils::AskapTestRunner runner(argv[0]);
     runner.addTest(askap::cp::ingest::CircularBufferTest::suite());
+    runner.addTest(askap::cp::ingest::RecyclingBufferTest::suite());
     runner.addTest(askap::cp::ingest::VisChunkTest::suite());
     runner.addTest(askap::cp::ingest::ScanManagerTest::suite());
     runner.addTest(askap::cp::ingest::ChannelManagerTest::suite());
     runner.addTest(askap::cp::ingest::MergedSourceTest::suite());
     runner.addTest(askap::cp::ingest::NoMetadataSourceTest::suite());
-    //runner.addTest(askap::cp::ingest::CalcUVWTaskTest::suite());
+    runner.addTest(askap::cp::ingest::CalcUVWTaskTest::suite());
     runner.addTest(askap::cp::ingest::ChannelAvgTaskTest::suite());
     runner.addTest(askap::cp::ingest::CalTaskTest::suite());
+    runner.addTest(askap::cp::ingest::TaskStageTest::suite());
+    runner.addTest(askap::cp::ingest::TCPSinkTest::suite());
+    runner.addTest(askap::cp::ingest::PhaseRotatorTest::suite());
     bool wasSucessful = runner.run();
 
     return wasSucessful ? 0 : 1;
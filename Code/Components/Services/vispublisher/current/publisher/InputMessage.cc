@@ -63,7 +63,13 @@ InputMessage InputMessage::build(boost::asio::ip::tcp::socket& socket)
     msg.itsStokes = readVector<uint32_t>(socket, msg.itsNPol);
     const size_t cubeSize = msg.itsNRow * msg.itsNChannel * msg.itsNPol;
     msg.itsVisibilities = readVector< std::complex<float> >(socket, cubeSize);
-    msg.itsFlag = readVector<uint8_t>(socket, cubeSize);
+
+    // The flags are sent packed, one bit per visibility
+    const std::vector<uint8_t> packed = readVector<uint8_t>(socket, (cubeSize + 7) / 8);
+    msg.itsFlag.resize(cubeSize);
+    for (size_t i = 0; i < cubeSize; ++i) {
+        msg.itsFlag[i] = (packed[i / 8] >> (i % 8)) & 1;
+    }
     return msg;
 }
 
@@ -55,6 +55,7 @@
 #include <measurementequation/SynthesisParamsHelper.h>
 #include <fitting/Params.h>
 #include <profile/AskapProfiler.h>
+#include <fft/FFTWrapper.h>
 
 
 ASKAP_LOGGER(logger, ".cimager");
@@ -110,6 +111,24 @@ class CimagerApp : public askap::Application
                     // NOTE: This MUST happen after the %w substitutions. (Move both to act on makeSubset output above?)
                     LOFAR::ParameterSet fullset(ImagerParallel::autoSetParameters(comms, subset));
 
+                    // FFT configuration: threads per transform and FFTW wisdom reused between runs
+                    const int nFFTThreads = fullset.getInt32("fft.nthreads", 1);
+                    if (nFFTThreads > 1) {
+                        ASKAPLOG_INFO_STR(logger, "Each FFT will use "<<nFFTThreads<<" threads");
+                        scimath::fftSetNumberOfThreads(nFFTThreads);
+                    }
+                    const std::string fftPlanner = fullset.getString("fft.planner", "estimate");
+                    scimath::fftSetPlannerRigour(fftPlanner);
+                    const std::string wisdomFile = fullset.getString("fft.wisdom", "");
+                    if (wisdomFile != "") {
+                        if (scimath::fftImportWisdom(wisdomFile)) {
+                            ASKAPLOG_INFO_STR(logger, "FFTW wisdom has been read from "<<wisdomFile);
+                        } else {
+                            ASKAPLOG_WARN_STR(logger, "Unable to read FFTW wisdom from "<<wisdomFile<<
+                                              ", plans will be made from scratch ("<<fftPlanner<<")");
+                        }
+                    }
+
                     ImagerParallel imager(comms, fullset);
                     ASKAPLOG_INFO_STR(logger, "ASKAP synthesis imager " << ASKAP_PACKAGE_VERSION);
 
@@ -197,6 +216,12 @@ class CimagerApp : public askap::Application
 
                     /// This is the final step - restore the image and write it out
                     imager.writeModel();
+
+                    // only one rank writes the wisdom (the first worker does the most of the FFTs)
+                    if ((wisdomFile != "") && (comms.rank() == (comms.isParallel() ? 1 : 0))) {
+                        ASKAPLOG_INFO_STR(logger, "Writing FFTW wisdom to "<<wisdomFile);
+                        scimath::fftExportWisdom(wisdomFile);
+                    }
                 }
                 stats.logSummary();
             } catch (const askap::AskapError& x) {
@@ -38,6 +38,10 @@
 #include <typeinfo>
 
 #include <iostream>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <limits>
 
 // other 3rd party
 #include <Common/ParameterSet.h>
@@ -163,6 +167,31 @@ class LinmosAccumulator {
     /// @brief call the regridder for the buffered plane
     void regrid(void);
 
+    /// @brief check whether the cached regridder can be used for the current input image
+    /// @details The cached regridder supports nearest and linear interpolation of images
+    /// whose direction axes are the first two pixel axes.
+    /// @return bool: true if accumulateRegridded can be used
+    bool cachedRegridPossible(void);
+
+    /// @brief compute the mapping from output to input pixels for the current input image
+    /// @details The input pixel and interpolation offsets of each output pixel
+    /// are the same for all planes of an input image, so they are computed once
+    /// per input image and cached.
+    void initialiseRegridMap(void);
+
+    /// @brief regrid and accumulate all planes of the current input image
+    /// @details Uses the mapping cached by initialiseRegridMap. The planes are
+    /// independent, so they are shared between threads.
+    /// @param[in,out] Array<float>& outPix: accumulated weighted image pixels
+    /// @param[in,out] Array<float>& outWgtPix: accumulated weight pixels
+    /// @param[in,out] Array<float>& outSenPix: accumulated sensitivity pixels
+    /// @param[in] const Array<float>& inPix: input image pixels
+    /// @param[in] const Array<float>& inWgtPix: input weight pixels
+    /// @param[in] const Array<float>& inSenPix: input sensitivity pixels
+    void accumulateRegridded(Array<float>& outPix, Array<float>& outWgtPix, Array<float>& outSenPix,
+                             const Array<float>& inPix, const Array<float>& inWgtPix,
+                             const Array<float>& inSenPix);
+
     /// @brief add the current plane to the accumulation arrays
     /// @details This method adds from the regridded buffers
     /// @param[out] Array<float>& outPix: accumulated weighted image pixels
@@ -223,6 +252,11 @@ class LinmosAccumulator {
     /// @return IPosition vector containing BLC and TRC of the current input image, relative to another coord. system
     Vector<IPosition> convertImageCornersToRef(const DirectionCoordinate& refDC);
 
+    /// @brief interpolate a single plane using the cached mapping
+    /// @param[in] const float* in: input plane
+    /// @param[out] float* out: output plane, pixels outside the input image are set to zero
+    void regridPlane(const float* in, float* out) const;
+
     /// @brief check to see if the input coordinate system is consistent enough with the reference system to merge
     /// @param[in] const CoordinateSystem& refCoordSys: reference coordinate system
     /// @return bool: true if they are consistent
@@ -236,6 +270,14 @@ class LinmosAccumulator {
     Bool itsReplicate;
     Bool itsForce;
     Interpolate2D::Method itsEmethod;
+    Bool itsCacheRegrid;
+    // cached mapping of output pixels to input pixels: for each output pixel which falls
+    // within the input image, the offsets of the output pixel and of the bottom-left input
+    // pixel used for interpolation, and the fractional offsets from that input pixel
+    std::vector<uInt> itsMapOut, itsMapIn;
+    std::vector<float> itsMapFx, itsMapFy;
+    // squared angular distance of each output pixel from the input beam centre
+    std::vector<float> itsMapOffset2;
     // regridding buffers
     TempImage<float> itsInBuffer, itsInWgtBuffer, itsInSenBuffer, itsInSnrBuffer;
     TempImage<float> itsOutBuffer, itsOutWgtBuffer, itsOutSnrBuffer;
@@ -271,6 +313,7 @@ class LinmosAccumulator {
 };
 
 LinmosAccumulator::LinmosAccumulator() : itsMethod("linear"), itsDecimate(3), itsReplicate(false), itsForce(false),
+                                         itsCacheRegrid(true),
                                          itsWeightType(-1), itsWeightState(-1), itsNumTaylorTerms(-1),
                                          itsCutoff(0.01), itsMosaicTag("linmos"), itsTaylorTag("taylor.0") {}
 
@@ -438,6 +481,7 @@ bool LinmosAccumulator::loadParset(const LOFAR::ParameterSet &parset) {
     if (parset.isDefined("regrid.decimate")) itsDecimate = parset.getInt("regrid.decimate");
     if (parset.isDefined("regrid.replicate")) itsReplicate = parset.getBool("regrid.replicate");
     if (parset.isDefined("regrid.force")) itsForce = parset.getBool("regrid.force");
+    if (parset.isDefined("regrid.cache")) itsCacheRegrid = parset.getBool("regrid.cache");
 
     if (parset.isDefined("psfref")) {
         ASKAPCHECK(parset.getUint("psfref")<inImgNames.size(), "PSF reference-image number is too large");
@@ -1120,6 +1164,209 @@ void LinmosAccumulator::regrid() {
 
 }
 
+bool LinmosAccumulator::cachedRegridPossible(void) {
+    if (!itsCacheRegrid) return false;
+    const Interpolate2D::Method method = Interpolate2D::stringToMethod(itsMethod);
+    if ((method != Interpolate2D::NEAREST) && (method != Interpolate2D::LINEAR)) return false;
+
+    // the direction axes need to be the first two pixel axes of both images
+    const int inPos = itsInCoordSys.findCoordinate(Coordinate::DIRECTION,-1);
+    const int outPos = itsOutCoordSys.findCoordinate(Coordinate::DIRECTION,-1);
+    if ((inPos < 0) || (outPos < 0)) return false;
+    const Vector<Int> inAxes = itsInCoordSys.pixelAxes(inPos);
+    const Vector<Int> outAxes = itsOutCoordSys.pixelAxes(outPos);
+    if ((inAxes.nelements() < 2) || (inAxes[0] != 0) || (inAxes[1] != 1)) return false;
+    if ((outAxes.nelements() < 2) || (outAxes[0] != 0) || (outAxes[1] != 1)) return false;
+
+    // each input plane needs to map onto the output plane with the same indices
+    if (itsInShape.nelements() != itsOutShape.nelements()) return false;
+    for (uInt dim=2; dim<itsInShape.nelements(); ++dim) {
+        if (itsInShape(dim) != itsOutShape(dim)) return false;
+    }
+    return (itsInShape(0) >= 2) && (itsInShape(1) >= 2);
+}
+
+void LinmosAccumulator::initialiseRegridMap(void) {
+    const bool nearest = (Interpolate2D::stringToMethod(itsMethod) == Interpolate2D::NEAREST);
+    ASKAPLOG_INFO_STR(logger, " - caching the pixel mapping for " << itsMethod << " interpolation");
+
+    const int inPos = itsInCoordSys.findCoordinate(Coordinate::DIRECTION,-1);
+    const int outPos = itsOutCoordSys.findCoordinate(Coordinate::DIRECTION,-1);
+    const DirectionCoordinate inDC = itsInCoordSys.directionCoordinate(inPos);
+    const DirectionCoordinate outDC = itsOutCoordSys.directionCoordinate(outPos);
+
+    const int nxIn = itsInShape(0);
+    const int nyIn = itsInShape(1);
+    const int nxOut = itsOutShape(0);
+    const int nyOut = itsOutShape(1);
+
+    itsMapOut.clear();
+    itsMapIn.clear();
+    itsMapFx.clear();
+    itsMapFy.clear();
+    itsMapOffset2.clear();
+
+    // the primary-beam model is centred on the reference pixel of the input image
+    const bool beamModel = (itsWeightType == FROM_BP_MODEL);
+    MVDirection world0;
+    if (beamModel) {
+        inDC.toWorld(world0,inDC.referencePixel());
+        // pixels without a world coordinate keep an infinite offset, i.e. zero weight
+        itsMapOffset2.resize(nxOut * nyOut, std::numeric_limits<float>::infinity());
+    }
+
+    Vector<Double> pixel(2), inPixel(2);
+    MVDirection world;
+    for (int y=0; y<nyOut; ++y) {
+        for (int x=0; x<nxOut; ++x) {
+            pixel[0] = double(x);
+            pixel[1] = double(y);
+            if (!outDC.toWorld(world,pixel)) continue;
+            if (beamModel) {
+                const float offsetBeam = world0.separation(world);
+                itsMapOffset2[x + y * nxOut] = offsetBeam * offsetBeam;
+            }
+            if (!inDC.toPixel(inPixel,world)) continue;
+
+            double px = inPixel[0];
+            double py = inPixel[1];
+            if (nearest) {
+                px = floor(px + 0.5);
+                py = floor(py + 0.5);
+            }
+            if ((px < 0.) || (py < 0.) || (px > nxIn - 1) || (py > nyIn - 1)) continue;
+
+            // use the pixel to the left/below on the last column/row, so all four
+            // interpolation points are always within the input plane
+            int x0 = std::min(int(px), nxIn - 2);
+            int y0 = std::min(int(py), nyIn - 2);
+            itsMapOut.push_back(x + y * nxOut);
+            itsMapIn.push_back(x0 + y0 * nxIn);
+            itsMapFx.push_back(float(px - x0));
+            itsMapFy.push_back(float(py - y0));
+        }
+    }
+    ASKAPLOG_INFO_STR(logger, " - " << itsMapOut.size() << " of " << nxOut * nyOut <<
+                      " output pixels overlap the input image");
+}
+
+void LinmosAccumulator::regridPlane(const float* in, float* out) const {
+    const int nxIn = itsInShape(0);
+    const size_t nOut = size_t(itsOutShape(0)) * size_t(itsOutShape(1));
+    std::fill(out, out + nOut, 0.f);
+    const size_t nMap = itsMapOut.size();
+    for (size_t i=0; i<nMap; ++i) {
+        const float* p = in + itsMapIn[i];
+        const float fx = itsMapFx[i];
+        const float fy = itsMapFy[i];
+        out[itsMapOut[i]] = (1.f - fy) * ((1.f - fx) * p[0] + fx * p[1]) +
+                                   fy  * ((1.f - fx) * p[nxIn] + fx * p[nxIn + 1]);
+    }
+}
+
+void LinmosAccumulator::accumulateRegridded(Array<float>& outPix, Array<float>& outWgtPix,
+                                            Array<float>& outSenPix, const Array<float>& inPix,
+                                            const Array<float>& inWgtPix, const Array<float>& inSenPix) {
+
+    ASKAPCHECK(inPix.contiguousStorage() && outPix.contiguousStorage() && outWgtPix.contiguousStorage(),
+               "Cached regridding requires contiguous arrays");
+    const bool useWgtImages = (itsWeightType == FROM_WEIGHT_IMAGES);
+
+    const size_t nInPlane = size_t(itsInShape(0)) * size_t(itsInShape(1));
+    const size_t nOutPlane = size_t(itsOutShape(0)) * size_t(itsOutShape(1));
+    const int nPlanes = int(itsInShape.product() / nInPlane);
+
+    // frequency dependent primary-beam width of each plane, if weights are from the beam model
+    std::vector<float> fwhm(nPlanes, 0.);
+    if (!useWgtImages) {
+        const int scPos = itsInCoordSys.findCoordinate(Coordinate::SPECTRAL,-1);
+        const SpectralCoordinate inSC = itsInCoordSys.spectralCoordinate(scPos);
+        const int chPos = itsInCoordSys.pixelAxes(scPos)[0];
+        scimath::MultiDimArrayPlaneIter planeIter(itsInShape);
+        for (; planeIter.hasMore(); planeIter.next()) {
+            const IPosition curpos = planeIter.position();
+            const float freq = inSC.referenceValue()[0] +
+                               (curpos[chPos] - inSC.referencePixel()[0]) * inSC.increment()[0];
+            fwhm[planeIter.sequenceNumber()] = 3e8/freq/12;
+        }
+    }
+
+    const float* inData = inPix.data();
+    const float* inWgtData = useWgtImages ? inWgtPix.data() : 0;
+    const float* inSenData = itsDoSensitivity ? inSenPix.data() : 0;
+    float* outData = outPix.data();
+    float* outWgtData = outWgtPix.data();
+    float* outSenData = itsDoSensitivity ? outSenPix.data() : 0;
+
+    ASKAPLOG_INFO_STR(logger, " - regridding and accumulating " << nPlanes << " planes");
+
+#ifdef _OPENMP
+    #pragma omp parallel
+#endif
+    {
+        // buffers for the regridded planes of each thread
+        std::vector<float> img(nOutPlane), wgt(nOutPlane), snr, inSnr;
+        if (itsDoSensitivity) {
+            snr.resize(nOutPlane);
+            inSnr.resize(nInPlane);
+        }
+
+#ifdef _OPENMP
+        #pragma omp for schedule(dynamic)
+#endif
+        for (int plane = 0; plane < nPlanes; ++plane) {
+            const size_t inOffset = plane * nInPlane;
+            const size_t outOffset = plane * nOutPlane;
+
+            regridPlane(inData + inOffset, &img[0]);
+
+            // set the weights, either to those read in or using the primary-beam model
+            if (useWgtImages) {
+                regridPlane(inWgtData + inOffset, &wgt[0]);
+            } else {
+                const float scale = 4.*log(2.)/fwhm[plane]/fwhm[plane];
+                for (size_t i=0; i<nOutPlane; ++i) {
+                    const float pb = exp(-itsMapOffset2[i]*scale);
+                    wgt[i] = pb * pb;
+                }
+            }
+            const float wgtCutoff = itsCutoff * itsCutoff * *std::max_element(wgt.begin(), wgt.end());
+
+            float* outPlane = outData + outOffset;
+            float* outWgtPlane = outWgtData + outOffset;
+            for (size_t i=0; i<nOutPlane; ++i) {
+                if (wgt[i]>=wgtCutoff) {
+                    if (itsWeightState == CORRECTED) {
+                        outPlane[i] += img[i] * wgt[i];
+                    } else if (itsWeightState == INHERENT) {
+                        outPlane[i] += img[i] * sqrt(wgt[i]);
+                    } else if (itsWeightState == WEIGHTED) {
+                        outPlane[i] += img[i];
+                    }
+                    outWgtPlane[i] += wgt[i];
+                }
+            }
+
+            // Accumulate sensitivity for this plane, inverted before regridding to avoid
+            // artefacts at sharp edges in the sensitivity image
+            if (itsDoSensitivity) {
+                const float* inSenPlane = inSenData + inOffset;
+                for (size_t i=0; i<nInPlane; ++i) {
+                    inSnr[i] = inSenPlane[i] > 0 ? 1.0 / (inSenPlane[i] * inSenPlane[i]) : 0.0;
+                }
+                regridPlane(&inSnr[0], &snr[0]);
+                const float snrCutoff = itsCutoff * itsCutoff * *std::max_element(snr.begin(), snr.end());
+                float* outSenPlane = outSenData + outOffset;
+                for (size_t i=0; i<nOutPlane; ++i) {
+                    if (snr[i]>=snrCutoff && wgt[i]>=wgtCutoff) {
+                        outSenPlane[i] += snr[i];
+                    }
+                }
+            }
+        }
+    }
+}
+
 void LinmosAccumulator::accumulatePlane(Array<float>& outPix, Array<float>& outWgtPix,
                                         Array<float>& outSenPix, const IPosition& curpos) {
 
@@ -1613,8 +1860,18 @@ static void merge(const LOFAR::ParameterSet &parset) {
             // test whether to simply add weighted pixels, or whether a regrid is required
             bool regridRequired = !accumulator.coordinatesAreEqual();
 
+            // if regridding is required and possible with a cached pixel mapping, use it for all planes
+            const bool cachedRegrid = regridRequired && accumulator.cachedRegridPossible();
+
             // if regridding is required, set up buffer some images
-            if ( regridRequired ) {
+            if ( cachedRegrid ) {
+
+                ASKAPLOG_INFO_STR(logger, " - regridding -- input pixel grid is different from the output");
+                accumulator.initialiseRegridMap();
+                accumulator.accumulateRegridded(outPix, outWgtPix, outSenPix, inPix, inWgtPix, inSenPix);
+                continue;
+
+            } else if ( regridRequired ) {
 
                 ASKAPLOG_INFO_STR(logger, " - regridding -- input pixel grid is different from the output");
 
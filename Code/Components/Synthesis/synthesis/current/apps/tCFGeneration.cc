@@ -98,8 +98,15 @@ int main(int argc, const char** argv)
             ASKAPLOG_INFO_STR(logger, "Setting up the gridder to test and the model");
             boost::shared_ptr<TestCFGenPerformance> tester = TestCFGenPerformance::createGridder(subset.makeSubset("gridder.AWProject."));
             ASKAPCHECK(tester, "Gridder is not defined");
+            // threads used inside one gridder to generate w-planes concurrently. If more
+            // than one thread is requested, a single instance is tested, otherwise a number
+            // of independent instances are run in parallel (one per OpenMP thread)
+            const int nCFThreads = subset.getInt32("gridder.nthreads", 1);
+            ASKAPCHECK(nCFThreads > 0, "gridder.nthreads should be positive, you have "<<nCFThreads);
+            tester->setNumberOfThreads(nCFThreads);
+            const int nRuns = subset.getInt32("gridder.nruns", 1);
             #ifdef _OPENMP
-            const int nthreads = omp_get_max_threads();
+            const int nthreads = nCFThreads > 1 ? 1 : omp_get_max_threads();
             std::vector<boost::shared_ptr<TestCFGenPerformance> > testers(nthreads);
             ASKAPLOG_INFO_STR(logger, "Will attempt to run "<<nthreads<<" instances in parallel");
             for (int i=0; i<nthreads; ++i) {
@@ -128,11 +135,11 @@ int main(int argc, const char** argv)
             { 
                #pragma omp for 
                for (int i=0; i<nthreads; ++i) {
-                 testers[i]->run();
+                 testers[i]->run(nRuns);
                }
             }
             #else
-            tester->run();
+            tester->run(nRuns);
             #endif
         }
         stats.logSummary();
@@ -12,6 +12,9 @@
 // For further details contact Tim.Cornwell@csiro.au
 // November 22, 2007
 // - Rewritten from tConvolve to use BLAS, and to be much smarter about not using strides in C
+// - The kernels from the synthesis library (GridKernel) are timed as well for all
+//   implementations supported by the CPU, so this program is now built with the library
+//   as one of the apps in this package
 
 /// @copyright (c) 2007 CSIRO
 /// Australia Telescope National Facility (ATNF)
@@ -42,6 +45,9 @@
 #include <complex>
 #include <vector>
 #include <algorithm>
+#include <string>
+
+#include <gridding/GridKernel.h>
 
 #ifdef USEBLAS
 
@@ -167,6 +173,46 @@ void degridKernel(const std::vector<Value>& grid, const int gSize, const int sup
 
   }
 }
+
+// Same as gridKernel, but using the kernel of the synthesis library. It is
+// dispatched to the implementation selected with GridKernel::selectImplementation.
+void libGridKernel(const std::vector<Value>& data, const int support,
+    const std::vector<Value>& C, const std::vector<int>& cOffset,
+    const std::vector<int>& iu, const std::vector<int>& iv,
+    std::vector<Value>& grid, const int gSize)
+{
+  const int sSize=2*support+1;
+  for (int dind=0; dind<int(data.size()); ++dind)
+  {
+    const int gind=iu[dind]+gSize*iv[dind]-support;
+    askap::synthesis::GridKernel::gridPatch(&grid[gind], gSize, &C[cOffset[dind]], sSize,
+         data[dind], sSize, sSize);
+  }
+}
+
+// Same as degridKernel, but using the kernel of the synthesis library.
+// Note, the library kernel conjugates the grid (as required by TableVisGridder).
+void libDegridKernel(const std::vector<Value>& grid, const int gSize, const int support,
+    const std::vector<Value>& C, const std::vector<int>& cOffset,
+    const std::vector<int>& iu, const std::vector<int>& iv,
+    std::vector<Value>& data)
+{
+  const int sSize=2*support+1;
+  for (int dind=0; dind<int(data.size()); ++dind)
+  {
+    const int gind=iu[dind]+gSize*iv[dind]-support;
+    data[dind]=askap::synthesis::GridKernel::degridPatch(&C[cOffset[dind]], sSize,
+         &grid[gind], gSize, sSize, sSize);
+  }
+}
+
+// Report timings for one pass
+void report(const std::string& what, const double time, const size_t nData, const int sSize)
+{
+  cout << "    Time " << time << " (s) " << endl;
+  cout << "    Time per visibility spectral sample " << 1e6*time/double(nData) << " (us) " << endl;
+  cout << "    Time per " << what << " " << 1e9*time/(double(nData)* double((sSize)*(sSize))) << " (ns) " << endl;
+}
 /////////////////////////////////////////////////////////////////////////////////
 
 // Initialize W project convolution function 
@@ -379,11 +425,8 @@ int main()
   gridKernel(data, support, C, cOffset, iu, iv, grid, gSize);
   finish = clock();
   // Report on timings
-  // Report on timings
   time = (double(finish)-double(start))/CLOCKS_PER_SEC;
-  cout << "    Time " << time << " (s) " << endl;
-  cout << "    Time per visibility spectral sample " << 1e6*time/double(data.size()) << " (us) " << endl;
-  cout << "    Time per gridding   " << 1e9*time/(double(data.size())* double((sSize)*(sSize))) << " (ns) " << endl;
+  report("gridding  ", time, data.size(), sSize);
 
   cout << "+++++ Reverse processing +++++" << endl;
   grid.assign(grid.size(), Value(1.0));
@@ -393,9 +436,45 @@ int main()
   finish = clock();
   // Report on timings
   time = (double(finish)-double(start))/CLOCKS_PER_SEC;
-  cout << "    Time " << time << " (s) " << endl;
-  cout << "    Time per visibility spectral sample " << 1e6*time/double(data.size()) << " (us) " << endl;
-  cout << "    Time per degridding " << 1e9*time/(double(data.size())* double((sSize)*(sSize))) << " (ns) " << endl;
+  report("degridding", time, data.size(), sSize);
+
+  // Now the same with the library kernels for all implementations supported on this machine
+  using askap::synthesis::GridKernel;
+  const std::vector<Value> reference(outdata);
+  for (int impl=0; impl<int(GridKernel::N_IMPLEMENTATIONS); ++impl)
+  {
+    const GridKernel::Implementation thisImpl = GridKernel::Implementation(impl);
+    if (!GridKernel::isSupported(thisImpl))
+    {
+      cout << "+++++ GridKernel " << GridKernel::name(thisImpl) << " is not supported by this CPU +++++" << endl;
+      continue;
+    }
+    GridKernel::selectImplementation(thisImpl);
+
+    cout << "+++++ Forward processing, GridKernel " << GridKernel::name(thisImpl) << " +++++" << endl;
+    grid.assign(grid.size(), Value(0.0));
+    start = clock();
+    libGridKernel(data, support, C, cOffset, iu, iv, grid, gSize);
+    finish = clock();
+    time = (double(finish)-double(start))/CLOCKS_PER_SEC;
+    report("gridding  ", time, data.size(), sSize);
+
+    cout << "+++++ Reverse processing, GridKernel " << GridKernel::name(thisImpl) << " +++++" << endl;
+    grid.assign(grid.size(), Value(1.0));
+    start = clock();
+    libDegridKernel(grid, gSize, support, C, cOffset, iu, iv, outdata);
+    finish = clock();
+    time = (double(finish)-double(start))/CLOCKS_PER_SEC;
+    report("degridding", time, data.size(), sSize);
+
+    // the grid is real, so conjugation doesn't matter and results should agree with the reference
+    Real maxDiff = 0.0;
+    for (size_t i=0; i<outdata.size(); ++i)
+    {
+      maxDiff = std::max(maxDiff, abs(outdata[i]-reference[i]));
+    }
+    cout << "    Maximum difference from the reference degridding " << maxDiff << endl;
+  }
 
   cout << "Done" << endl;
 
@@ -98,6 +98,38 @@ namespace askap {
                 /// @brief Perform the deconvolution
                 /// @detail This is the main deconvolution method.
                 bool oneIteration();
+
+                /// @brief Subtract a component and find the extrema of the residual
+                /// @detail This does one pass over the residual image. The scaled
+                /// PSF is subtracted from the rows of the residual image which
+                /// overlap the patch given by residualStart/residualEnd (inclusive,
+                /// psfStart is the matching corner in the PSF) and then the minimum
+                /// and maximum of each row are found while the row is still in
+                /// cache. If a mask is used the extrema of the weighted residual
+                /// are found, but the unweighted residual values are stored. The
+                /// result is kept for the next iteration. Rows are shared between
+                /// threads if OpenMP is available.
+                /// @param[in] residualStart first pixel of the patch in the residual
+                /// @param[in] residualEnd last pixel of the patch in the residual
+                /// @param[in] psfStart first pixel of the patch in the PSF
+                /// @param[in] scale the PSF is multiplied by this before subtraction,
+                /// nothing is subtracted if it is zero
+                void subtractAndFindPeak(const casa::IPosition& residualStart,
+                                         const casa::IPosition& residualEnd,
+                                         const casa::IPosition& psfStart,
+                                         const T scale);
+
+                /// @brief True if the extrema below are those of the current residual
+                bool itsPeakCached;
+
+                /// @brief Minimum and maximum of the residual and their positions
+                T itsMinVal;
+                T itsMaxVal;
+                casa::IPosition itsMinPos;
+                casa::IPosition itsMaxPos;
+
+                /// @brief Running total of the model flux
+                T itsTotalFlux;
         };
 
     } // namespace synthesis
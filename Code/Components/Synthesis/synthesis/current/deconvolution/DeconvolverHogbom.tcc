@@ -58,7 +58,8 @@ namespace askap {
 
         template<class T, class FT>
         DeconvolverHogbom<T, FT>::DeconvolverHogbom(Vector<Array<T> >& dirty, Vector<Array<T> >& psf)
-                : DeconvolverBase<T, FT>::DeconvolverBase(dirty, psf)
+                : DeconvolverBase<T, FT>::DeconvolverBase(dirty, psf),
+                itsPeakCached(false), itsMinVal(0.0), itsMaxVal(0.0), itsTotalFlux(0.0)
         {
             if (this->itsNumberDirtyTerms > 1) {
                 throw(AskapError("Hogbom CLEAN cannot perform multi-term deconvolutions"));
@@ -67,7 +68,8 @@ namespace askap {
 
         template<class T, class FT>
         DeconvolverHogbom<T, FT>::DeconvolverHogbom(Array<T>& dirty, Array<T>& psf)
-                : DeconvolverBase<T, FT>::DeconvolverBase(dirty, psf)
+                : DeconvolverBase<T, FT>::DeconvolverBase(dirty, psf),
+                itsPeakCached(false), itsMinVal(0.0), itsMaxVal(0.0), itsTotalFlux(0.0)
         {
         };
 
@@ -75,6 +77,10 @@ namespace askap {
         void DeconvolverHogbom<T, FT>::initialise()
         {
             DeconvolverBase<T, FT>::initialise();
+
+            // The residual or model may have been replaced since the last call
+            itsPeakCached = false;
+            itsTotalFlux = sum(this->model());
         }
 
         template<class T, class FT>
@@ -108,62 +114,42 @@ namespace askap {
         template<class T, class FT>
         bool DeconvolverHogbom<T, FT>::oneIteration()
         {
-            const bool isMasked(this->weight(0).shape().conform(this->dirty(0).shape()));
-
-            // Find peak in residual image
-            casa::IPosition minPos;
-            casa::IPosition maxPos;
-            T minVal, maxVal;
-            if (isMasked) {
-                casa::minMaxMasked(minVal, maxVal, minPos, maxPos, this->dirty(0), this->weight(0));
-                minVal = this->dirty(0)(minPos);
-                maxVal = this->dirty(0)(maxPos);
-            } else {
-                casa::minMax(minVal, maxVal, minPos, maxPos, this->dirty(0));
+            // Find peak in residual image. Apart from the first iteration this
+            // was done while the previous component was subtracted.
+            if (!itsPeakCached) {
+                subtractAndFindPeak(IPosition(2, 0), IPosition(2, -1), IPosition(2, 0), T(0.0));
             }
+            const T minVal = itsMinVal;
+            const T maxVal = itsMaxVal;
             //
-            ASKAPLOG_INFO_STR(dechogbomlogger, "Maximum = " << maxVal << " at location " << maxPos);
-            ASKAPLOG_INFO_STR(dechogbomlogger, "Minimum = " << minVal << " at location " << minPos);
+            ASKAPLOG_INFO_STR(dechogbomlogger, "Maximum = " << maxVal << " at location " << itsMaxPos);
+            ASKAPLOG_INFO_STR(dechogbomlogger, "Minimum = " << minVal << " at location " << itsMinPos);
 
             T absPeakVal = 0.0;
             casa::IPosition absPeakPos;
             if (abs(minVal) < abs(maxVal)) {
                 absPeakVal = maxVal;
-                absPeakPos = maxPos;
+                absPeakPos = itsMaxPos;
             } else {
                 absPeakVal = minVal;
-                absPeakPos = minPos;
+                absPeakPos = itsMinPos;
             }
 
             this->state()->setPeakResidual(absPeakVal);
             this->state()->setObjectiveFunction(absPeakVal);
-            this->state()->setTotalFlux(sum(this->model()));
+            this->state()->setTotalFlux(itsTotalFlux);
 
             // Has this terminated for any reason?
             if (this->control()->terminate(*(this->state()))) {
                 return True;
             }
 
-            const uInt nx(this->psf(0).shape()(0));
-            const uInt ny(this->psf(0).shape()(1));
-
-            IPosition subPsfShape(this->findSubPsfShape());
-
             // Now we adjust model and residual for this component
             const casa::IPosition residualShape(this->dirty(0).shape().nonDegenerate());
-            const IPosition subPsfStart(2, nx / 2 - subPsfShape(0) / 2, ny / 2 - subPsfShape(1) / 2);
-            const IPosition subPsfEnd(2, nx / 2 + subPsfShape(0) / 2 - 1, ny / 2 + subPsfShape(1) / 2 - 1);
-            const IPosition subPsfStride(2, 1, 1);
+            const casa::IPosition psfShape(this->psf(0).shape().nonDegenerate());
 
-            Slicer subPsfSlicer(subPsfStart, subPsfEnd, subPsfStride, Slicer::endIsLast);
-
-            const casa::IPosition psfShape(2, nx, ny);
-
-            casa::IPosition residualStart(2, 0), residualEnd(2, 0), residualStride(2, 1);
-            casa::IPosition psfStart(2, 0), psfEnd(2, 0), psfStride(2, 1);
-
-            const casa::IPosition modelShape(this->model(0).shape().nonDegenerate());
-            casa::IPosition modelStart(2, 0), modelEnd(2, 0), modelStride(2, 1);
+            casa::IPosition residualStart(2, 0), residualEnd(2, 0);
+            casa::IPosition psfStart(2, 0), psfEnd(2, 0);
 
             // Wrangle the start, end, and shape into consistent form.
             for (uInt dim = 0; dim < 2; dim++) {
@@ -174,36 +160,142 @@ namespace askap {
                 psfStart(dim) = max(0, Int(this->itsPeakPSFPos(dim) - (absPeakPos(dim) - residualStart(dim))));
                 psfEnd(dim) = min(Int(this->itsPeakPSFPos(dim) - (absPeakPos(dim) - residualEnd(dim))),
                                   Int(psfShape(dim) - 1));
-
-                modelStart(dim) = residualStart(dim);
-                modelEnd(dim) = residualEnd(dim);
             }
 
-            casa::Slicer psfSlicer(psfStart, psfEnd, psfStride, Slicer::endIsLast);
-            casa::Slicer residualSlicer(residualStart, residualEnd, residualStride, Slicer::endIsLast);
-            casa::Slicer modelSlicer(modelStart, modelEnd, modelStride, Slicer::endIsLast);
-
-            if (!(residualSlicer.length() == psfSlicer.length()) || !(residualSlicer.stride() == psfSlicer.stride())) {
+            if (!((residualEnd - residualStart) == (psfEnd - psfStart))) {
                 ASKAPLOG_INFO_STR(dechogbomlogger, "Peak of PSF  : " << this->itsPeakPSFPos);
                 ASKAPLOG_INFO_STR(dechogbomlogger, "Peak of residual: " << absPeakPos);
                 ASKAPLOG_INFO_STR(dechogbomlogger, "Residual start  : " << residualStart << " end: " << residualEnd);
                 ASKAPLOG_INFO_STR(dechogbomlogger, "PSF   start  : " << psfStart << " end: " << psfEnd);
-                ASKAPLOG_INFO_STR(dechogbomlogger, "Residual slicer : " << residualSlicer);
-                ASKAPLOG_INFO_STR(dechogbomlogger, "PSF slicer   : " << psfSlicer);
                 throw AskapError("Mismatch in slicers for residual and psf images");
             }
 
             // Add to model
-            this->model()(absPeakPos) = this->model()(absPeakPos) + this->control()->gain() * absPeakVal;
-
-            // Subtract entire PSF from residual image
+            const T component = this->control()->gain() * absPeakVal;
+            this->model()(absPeakPos) = this->model()(absPeakPos) + component;
+            itsTotalFlux += component;
 
-            this->dirty()(residualSlicer) = this->dirty()(residualSlicer)
-                                            - this->control()->gain() * absPeakVal * this->psf()(psfSlicer);
+            // Subtract entire PSF from residual image, and find the peak
+            // for the next iteration on the way
+            subtractAndFindPeak(residualStart, residualEnd, psfStart, component);
 
             return True;
         }
 
+        template<class T, class FT>
+        void DeconvolverHogbom<T, FT>::subtractAndFindPeak(const casa::IPosition& residualStart,
+                const casa::IPosition& residualEnd, const casa::IPosition& psfStart, const T scale)
+        {
+            casa::Array<T>& residual = this->dirty(0);
+            const casa::Array<T>& psf = this->psf(0);
+            const casa::Array<T>& weight = this->weight(0);
+            const bool isMasked(weight.shape().conform(residual.shape()));
+
+            ASKAPCHECK(residual.contiguousStorage() && psf.contiguousStorage(),
+                       "Residual image and PSF must be contiguous");
+            ASKAPCHECK(!isMasked || weight.contiguousStorage(), "Weight image must be contiguous");
+
+            const long nx = residual.shape().nonDegenerate()(0);
+            const long ny = residual.nelements() / nx;
+            const long psfNx = psf.shape().nonDegenerate()(0);
+            const long patchStartX = residualStart(0);
+            const long patchStartY = residualStart(1);
+            const long patchEndY = (scale != T(0.0)) ? residualEnd(1) : -1;
+            const long patchWidth = residualEnd(0) - residualStart(0) + 1;
+
+            T* const resPtr = residual.data();
+            const T* const psfPtr = psf.data() + psfStart(0) + psfStart(1) * psfNx;
+            const T* const wtPtr = isMasked ? weight.data() : 0;
+
+            // Overall extrema, position -1 means nothing has been found yet
+            T minVal = 0.0, maxVal = 0.0;
+            long minIdx = -1, maxIdx = -1;
+
+            #ifdef _OPENMP
+            #pragma omp parallel default(shared)
+            {
+            #endif
+                T threadMin = 0.0, threadMax = 0.0;
+                long threadMinIdx = -1, threadMaxIdx = -1;
+
+                #ifdef _OPENMP
+                #pragma omp for schedule(static)
+                #endif
+                for (long y = 0; y < ny; ++y) {
+                    T* const row = resPtr + y * nx;
+
+                    if (y >= patchStartY && y <= patchEndY) {
+                        T* const out = row + patchStartX;
+                        const T* const in = psfPtr + (y - patchStartY) * psfNx;
+                        for (long x = 0; x < patchWidth; ++x) {
+                            out[x] -= scale * in[x];
+                        }
+                    }
+
+                    // Find the extrema of the row with a plain reduction first,
+                    // the position is only needed for rows holding a new extremum
+                    const T* const wtRow = isMasked ? wtPtr + y * nx : 0;
+                    T rowMin = isMasked ? row[0] * wtRow[0] : row[0];
+                    T rowMax = rowMin;
+                    if (isMasked) {
+                        for (long x = 1; x < nx; ++x) {
+                            const T val = row[x] * wtRow[x];
+                            rowMin = val < rowMin ? val : rowMin;
+                            rowMax = val > rowMax ? val : rowMax;
+                        }
+                    } else {
+                        for (long x = 1; x < nx; ++x) {
+                            const T val = row[x];
+                            rowMin = val < rowMin ? val : rowMin;
+                            rowMax = val > rowMax ? val : rowMax;
+                        }
+                    }
+                    if (threadMinIdx < 0 || rowMin < threadMin) {
+                        long x = 0;
+                        while (x < nx - 1 && (isMasked ? row[x] * wtRow[x] : row[x]) != rowMin) {
+                            ++x;
+                        }
+                        threadMin = rowMin;
+                        threadMinIdx = y * nx + x;
+                    }
+                    if (threadMaxIdx < 0 || rowMax > threadMax) {
+                        long x = 0;
+                        while (x < nx - 1 && (isMasked ? row[x] * wtRow[x] : row[x]) != rowMax) {
+                            ++x;
+                        }
+                        threadMax = rowMax;
+                        threadMaxIdx = y * nx + x;
+                    }
+                }
+
+            #ifdef _OPENMP
+                // Ties go to the first pixel, as for casa::minMax
+                #pragma omp critical
+                {
+            #endif
+                    if (threadMinIdx >= 0 && (minIdx < 0 || threadMin < minVal ||
+                                              (threadMin == minVal && threadMinIdx < minIdx))) {
+                        minVal = threadMin;
+                        minIdx = threadMinIdx;
+                    }
+                    if (threadMaxIdx >= 0 && (maxIdx < 0 || threadMax > maxVal ||
+                                              (threadMax == maxVal && threadMaxIdx < maxIdx))) {
+                        maxVal = threadMax;
+                        maxIdx = threadMaxIdx;
+                    }
+            #ifdef _OPENMP
+                }
+            }
+            #endif
+
+            ASKAPDEBUGASSERT(minIdx >= 0 && maxIdx >= 0);
+            itsMinPos = casa::IPosition(2, minIdx % nx, minIdx / nx);
+            itsMaxPos = casa::IPosition(2, maxIdx % nx, maxIdx / nx);
+            itsMinVal = resPtr[minIdx];
+            itsMaxVal = resPtr[maxIdx];
+            itsPeakCached = true;
+        }
+
     } // namespace synthesis
 
 } // namespace askap
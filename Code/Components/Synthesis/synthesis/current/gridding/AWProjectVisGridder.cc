@@ -49,6 +49,12 @@ ASKAP_LOGGER(logger, ".gridding.awprojectvisgridder");
 #include <gridding/SupportSearcher.h>
 #include <profile/AskapProfiler.h>
 
+// std includes
+#include <string>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 namespace askap {
 namespace synthesis {
@@ -284,6 +290,9 @@ void AWProjectVisGridder::initConvolutionFunction(const accessors::IConstDataAcc
     ASKAPDEBUGASSERT(thisPlane.nrow() == nx);
     ASKAPDEBUGASSERT(thisPlane.ncolumn() == ny);
 
+    // number of threads generating w-planes for the given feed and channel
+    const int nThreads = nCFThreads();
+
     int nDone = 0;
 
     for (int row = 0; row < nSamples; ++row) {
@@ -314,143 +323,41 @@ void AWProjectVisGridder::initConvolutionFunction(const accessors::IConstDataAcc
                 /// Calculate the total convolution function including
                 /// the w term and the antenna convolution function
 
-                for (int iw = 0; iw < nWPlanes(); ++iw) {
-                    thisPlane.set(0.0);
-
-
-                    // Loop over the central nx, ny region, setting it to the product
-                    // of the phase screen and the spheroidal function
-                    double maxCF = 0.0;
-                    const double w = 2.0f * casa::C::pi * getWTerm(iw);
-                    //std::cout<<"plane "<<iw<<" w="<<w<<std::endl;
-
-                    for (int iy = 0; iy < int(ny); ++iy) {
-                        const double y2 = casa::square((double(iy) - double(ny) / 2) * ccelly);
-
-                        for (int ix = 0; ix < int(nx); ++ix) {
-                            const double x2 = casa::square((double(ix) - double(nx) / 2) * ccellx);
-                            const double r2 = x2 + y2;
-
-                            if (r2 < 1.0) {
-                                const double phase = w * (1.0 - sqrt(1.0 - r2));
-                                // grid correction is temporary disabled as otherwise the fluxes are overestimated
-                                const casa::DComplex wt = pattern(ix, iy) * conj(pattern(ix, iy));
-                                //*casa::DComplex(ccfx(ix)*ccfy(iy));
-                                // this ensures the oversampling is done
-                                thisPlane(ix, iy) = wt * casa::DComplex(cos(phase), -sin(phase));
-                                //thisPlane(ix, iy)=wt*casa::DComplex(cos(phase));
-                                maxCF += casa::abs(wt);
-                            }
-                        }
-                    }
-
-                    ASKAPCHECK(maxCF > 0.0, "Convolution function is empty");
-
-
-                    // At this point, we have the phase screen multiplied by the spheroidal
-                    // function, sampled on larger cellsize (itsOverSample larger) in image
-                    // space. Only the inner qnx, qny pixels have a non-zero value
-
-                    // Now we have to calculate the Fourier transform to get the
-                    // convolution function in uv space
-                    scimath::fft2d(thisPlane, true);
-
-                    // Now correct for normalization of FFT
-                    thisPlane *= casa::DComplex(1.0 / (double(nx) * double(ny)));
-                    // use this norm later on during normalisation
-                    const double thisPlaneNorm = sum(real(thisPlane));
-                    ASKAPDEBUGASSERT(thisPlaneNorm > 0.);
-
-                    const int zIndex = iw + nWPlanes() * (chan + nChan * (feed + itsMaxFeeds * currentField()));
-
-                    // If the support is not yet set, find it and size the
-                    // convolution function appropriately
-
-                    // by default the common support without offset is used
-                    CFSupport cfSupport(itsSupport);
-
-                    if (isSupportPlaneDependent() || (itsSupport == 0)) {
-                        //  SynthesisParamsHelper::saveAsCasaImage("dbg.img", amplitude(thisPlane));
-                        cfSupport = extractSupport(thisPlane);
-                        const int support = cfSupport.itsSize;
-
-                        ASKAPCHECK(support*itsOverSample < int(nx) / 2,
-                                   "Overflowing convolution function - increase maxSupport or decrease overSample. " <<
-                                   "Current support size = " << support << " oversampling factor=" << itsOverSample <<
-                                   " image size nx=" << nx)
-
-                        cfSupport.itsSize = limitSupportIfNecessary(support);
-
-                        if (itsSupport == 0) {
-                            itsSupport = cfSupport.itsSize;
-                            ASKAPLOG_DEBUG_STR(logger, "Number of planes in convolution function = "
-                                                   << itsConvFunc.size() << " or " << itsConvFunc.size() / itsOverSample / itsOverSample <<
-                                               " before oversampling with factor " << itsOverSample);
-                        }
-
-                        if (isOffsetSupportAllowed()) {
-                            setConvFuncOffset(zIndex, cfSupport.itsOffsetU, cfSupport.itsOffsetV);
-                        }
-
-                        // just for log output
-                        const double cell = std::abs(itsUVCellSize(0) * (casa::C::c
-                                                     / acc.frequency()[chan]));
-                        ASKAPLOG_DEBUG_STR(logger, "CF cache w-plane=" << iw << " feed=" << feed << " field=" << currentField() <<
-                                           ": maximum extent = " << support*cell << " (m) sampled at " << cell / itsOverSample << " (m)" <<
-                                           " offset (m): " << cfSupport.itsOffsetU*cell << " " << cfSupport.itsOffsetV*cell);
-                    }
-
-                    // use either support determined for this particular plane or a generic one,
-                    // determined from the first plane (largest support as we have the largest w-term)
-                    const int support = isSupportPlaneDependent() ? cfSupport.itsSize : itsSupport;
-
-                    // Since we are decimating, we need to rescale by the
-                    // decimation factor
-                    const double rescale = double(itsOverSample * itsOverSample);
-                    const int cSize = 2 * support + 1;
-
-                    for (int fracu = 0; fracu < itsOverSample; fracu++) {
-                        for (int fracv = 0; fracv < itsOverSample; fracv++) {
-                            const int plane = fracu + itsOverSample * (fracv + itsOverSample
-                                              * zIndex);
-                            ASKAPDEBUGASSERT(plane >= 0 && plane < int(itsConvFunc.size()));
-                            itsConvFunc[plane].resize(cSize, cSize);
-                            itsConvFunc[plane].set(0.0);
-
-                            // Now cut out the inner part of the convolution function and
-                            // insert it into the convolution function
-                            for (int iy = -support; iy < support; iy++) {
-                                for (int ix = -support; ix < support; ix++) {
-                                    ASKAPDEBUGASSERT((ix + support >= 0) && (iy + support >= 0));
-                                    ASKAPDEBUGASSERT(ix + support < int(itsConvFunc[plane].nrow()));
-                                    ASKAPDEBUGASSERT(iy + support < int(itsConvFunc[plane].ncolumn()));
-                                    ASKAPDEBUGASSERT((ix + cfSupport.itsOffsetU)*itsOverSample + fracu + int(nx) / 2 >= 0);
-                                    ASKAPDEBUGASSERT((iy + cfSupport.itsOffsetV)*itsOverSample + fracv + int(ny) / 2 >= 0);
-                                    ASKAPDEBUGASSERT((ix + cfSupport.itsOffsetU)*itsOverSample + fracu + int(nx) / 2 < int(thisPlane.nrow()));
-                                    ASKAPDEBUGASSERT((iy + cfSupport.itsOffsetV)*itsOverSample + fracv + int(ny) / 2 < int(thisPlane.ncolumn()));
-
-                                    itsConvFunc[plane](ix + support, iy + support)
-                                    = rescale * thisPlane((ix + cfSupport.itsOffsetU) * itsOverSample + fracu + nx / 2,
-                                                          (iy + cfSupport.itsOffsetV) * itsOverSample + fracv + ny / 2);
-                                } // for ix
-                            } // for iy
-
-
-                            /*
-                            // force normalization for all fractional offsets (or planes)
-                            const double norm = sum(real(itsConvFunc[plane]));
-                            //    ASKAPLOG_INFO_STR(logger, "Sum of convolution function = " << norm<<" for plane "<<plane<<
-                            //       " full buffer has sum="<<thisPlaneNorm<<" ratio="<<norm/thisPlaneNorm);
-                            ASKAPDEBUGASSERT(norm>0.);
-                            if (norm>0.) {
-                                //itsConvFunc[plane]*=casa::Complex(norm/thisPlaneNorm);
-                            }
-                            */
-
-                        } // for fracv
-                    } // for fracu
+                // uv-cell size in metres, just for log output
+                const double cell = std::abs(itsUVCellSize(0) * (casa::C::c / acc.frequency()[chan]));
+                const int zIndexOffset = nWPlanes() * (chan + nChan * (feed + itsMaxFeeds * currentField()));
+
+                // If the support is not yet known, the first plane (the largest w-term) is
+                // done serially to set it. All other planes are independent and are generated
+                // concurrently, each thread uses its own buffer.
+                int firstPlane = 0;
+                if ((itsSupport == 0) && (nWPlanes() > 0)) {
+                    generateAWPlane(0, zIndexOffset, feed, pattern, thisPlane, ccellx, ccelly, cell);
+                    firstPlane = 1;
+                }
 
+                std::string errorMsg;
+
+                #ifdef _OPENMP
+                #pragma omp parallel for schedule(dynamic) num_threads(nThreads) if (nThreads > 1)
+                #endif
+                for (int iw = firstPlane; iw < nWPlanes(); ++iw) {
+                     try {
+                         #ifdef _OPENMP
+                         casa::Matrix<casa::DComplex> threadPlane = getCFBuffer(omp_get_thread_num());
+                         #else
+                         casa::Matrix<casa::DComplex> threadPlane = thisPlane;
+                         #endif
+                         generateAWPlane(iw, zIndexOffset + iw, feed, pattern, threadPlane, ccellx, ccelly, cell);
+                     }
+                     catch (const std::exception &ex) {
+                         #ifdef _OPENMP
+                         #pragma omp critical (awprojectcferror)
+                         #endif
+                         errorMsg = ex.what();
+                     }
                 } // w loop
+                ASKAPCHECK(errorMsg == "", "Convolution function generation failed: "<<errorMsg);
             } // chan loop
 
         } // row of the accessor
@@ -478,6 +385,156 @@ void AWProjectVisGridder::initConvolutionFunction(const accessors::IConstDataAcc
 }
 
 
+/// @brief generate convolution function for one w-plane
+/// @details This method multiplies the w-term by the illumination pattern (already
+/// transformed to the image plane), does the FFT and cuts out the support into itsConvFunc.
+/// It is called concurrently for different w-planes, therefore the common support
+/// (itsSupport) must be determined before the concurrent calls.
+/// @param[in] iw w-plane to generate
+/// @param[in] zIndex index of the CF cache plane (before oversampling)
+/// @param[in] feed feed number (for log output)
+/// @param[in] pattern illumination pattern in the image plane
+/// @param[in] thisPlane buffer for the full-sized convolution function (used for FFT)
+/// @param[in] ccellx cell size in x
+/// @param[in] ccelly cell size in y
+/// @param[in] cell uv-cell size in metres (for log output)
+void AWProjectVisGridder::generateAWPlane(int iw, int zIndex, int feed, const UVPattern &pattern,
+                        casa::Matrix<casa::DComplex> &thisPlane, double ccellx, double ccelly, double cell)
+{
+    const casa::uInt nx = thisPlane.nrow();
+    const casa::uInt ny = thisPlane.ncolumn();
+
+    thisPlane.set(0.0);
+
+
+    // Loop over the central nx, ny region, setting it to the product
+    // of the phase screen and the spheroidal function
+    double maxCF = 0.0;
+    const double w = 2.0f * casa::C::pi * getWTerm(iw);
+    //std::cout<<"plane "<<iw<<" w="<<w<<std::endl;
+
+    for (int iy = 0; iy < int(ny); ++iy) {
+        const double y2 = casa::square((double(iy) - double(ny) / 2) * ccelly);
+
+        for (int ix = 0; ix < int(nx); ++ix) {
+            const double x2 = casa::square((double(ix) - double(nx) / 2) * ccellx);
+            const double r2 = x2 + y2;
+
+            if (r2 < 1.0) {
+                const double phase = w * (1.0 - sqrt(1.0 - r2));
+                // grid correction is temporary disabled as otherwise the fluxes are overestimated
+                const casa::DComplex wt = pattern(ix, iy) * conj(pattern(ix, iy));
+                //*casa::DComplex(ccfx(ix)*ccfy(iy));
+                // this ensures the oversampling is done
+                thisPlane(ix, iy) = wt * casa::DComplex(cos(phase), -sin(phase));
+                //thisPlane(ix, iy)=wt*casa::DComplex(cos(phase));
+                maxCF += casa::abs(wt);
+            }
+        }
+    }
+
+    ASKAPCHECK(maxCF > 0.0, "Convolution function is empty");
+
+
+    // At this point, we have the phase screen multiplied by the spheroidal
+    // function, sampled on larger cellsize (itsOverSample larger) in image
+    // space. Only the inner qnx, qny pixels have a non-zero value
+
+    // Now we have to calculate the Fourier transform to get the
+    // convolution function in uv space
+    scimath::fft2d(thisPlane, true);
+
+    // Now correct for normalization of FFT
+    thisPlane *= casa::DComplex(1.0 / (double(nx) * double(ny)));
+    // use this norm later on during normalisation
+    const double thisPlaneNorm = sum(real(thisPlane));
+    ASKAPDEBUGASSERT(thisPlaneNorm > 0.);
+
+    // If the support is not yet set, find it and size the
+    // convolution function appropriately
+
+    // by default the common support without offset is used
+    CFSupport cfSupport(itsSupport);
+
+    if (isSupportPlaneDependent() || (itsSupport == 0)) {
+        //  SynthesisParamsHelper::saveAsCasaImage("dbg.img", amplitude(thisPlane));
+        cfSupport = extractSupport(thisPlane);
+        const int support = cfSupport.itsSize;
+
+        ASKAPCHECK(support*itsOverSample < int(nx) / 2,
+                   "Overflowing convolution function - increase maxSupport or decrease overSample. " <<
+                   "Current support size = " << support << " oversampling factor=" << itsOverSample <<
+                   " image size nx=" << nx)
+
+        cfSupport.itsSize = limitSupportIfNecessary(support);
+
+        if (itsSupport == 0) {
+            itsSupport = cfSupport.itsSize;
+            ASKAPLOG_DEBUG_STR(logger, "Number of planes in convolution function = "
+                                   << itsConvFunc.size() << " or " << itsConvFunc.size() / itsOverSample / itsOverSample <<
+                               " before oversampling with factor " << itsOverSample);
+        }
+
+        if (isOffsetSupportAllowed()) {
+            setConvFuncOffset(zIndex, cfSupport.itsOffsetU, cfSupport.itsOffsetV);
+        }
+
+        ASKAPLOG_DEBUG_STR(logger, "CF cache w-plane=" << iw << " feed=" << feed << " field=" << currentField() <<
+                           ": maximum extent = " << support*cell << " (m) sampled at " << cell / itsOverSample << " (m)" <<
+                           " offset (m): " << cfSupport.itsOffsetU*cell << " " << cfSupport.itsOffsetV*cell);
+    }
+
+    // use either support determined for this particular plane or a generic one,
+    // determined from the first plane (largest support as we have the largest w-term)
+    const int support = isSupportPlaneDependent() ? cfSupport.itsSize : itsSupport;
+
+    // Since we are decimating, we need to rescale by the
+    // decimation factor
+    const double rescale = double(itsOverSample * itsOverSample);
+    const int cSize = 2 * support + 1;
+
+    for (int fracu = 0; fracu < itsOverSample; fracu++) {
+        for (int fracv = 0; fracv < itsOverSample; fracv++) {
+            const int plane = fracu + itsOverSample * (fracv + itsOverSample
+                              * zIndex);
+            ASKAPDEBUGASSERT(plane >= 0 && plane < int(itsConvFunc.size()));
+            itsConvFunc[plane].resize(cSize, cSize);
+            itsConvFunc[plane].set(0.0);
+
+            // Now cut out the inner part of the convolution function and
+            // insert it into the convolution function
+            for (int iy = -support; iy < support; iy++) {
+                for (int ix = -support; ix < support; ix++) {
+                    ASKAPDEBUGASSERT((ix + support >= 0) && (iy + support >= 0));
+                    ASKAPDEBUGASSERT(ix + support < int(itsConvFunc[plane].nrow()));
+                    ASKAPDEBUGASSERT(iy + support < int(itsConvFunc[plane].ncolumn()));
+                    ASKAPDEBUGASSERT((ix + cfSupport.itsOffsetU)*itsOverSample + fracu + int(nx) / 2 >= 0);
+                    ASKAPDEBUGASSERT((iy + cfSupport.itsOffsetV)*itsOverSample + fracv + int(ny) / 2 >= 0);
+                    ASKAPDEBUGASSERT((ix + cfSupport.itsOffsetU)*itsOverSample + fracu + int(nx) / 2 < int(thisPlane.nrow()));
+                    ASKAPDEBUGASSERT((iy + cfSupport.itsOffsetV)*itsOverSample + fracv + int(ny) / 2 < int(thisPlane.ncolumn()));
+
+                    itsConvFunc[plane](ix + support, iy + support)
+                    = rescale * thisPlane((ix + cfSupport.itsOffsetU) * itsOverSample + fracu + nx / 2,
+                                          (iy + cfSupport.itsOffsetV) * itsOverSample + fracv + ny / 2);
+                } // for ix
+            } // for iy
+
+
+            /*
+            // force normalization for all fractional offsets (or planes)
+            const double norm = sum(real(itsConvFunc[plane]));
+            //    ASKAPLOG_INFO_STR(logger, "Sum of convolution function = " << norm<<" for plane "<<plane<<
+            //       " full buffer has sum="<<thisPlaneNorm<<" ratio="<<norm/thisPlaneNorm);
+            ASKAPDEBUGASSERT(norm>0.);
+            if (norm>0.) {
+                //itsConvFunc[plane]*=casa::Complex(norm/thisPlaneNorm);
+            }
+            */
+
+        } // for fracv
+    } // for fracu
+}
+
 /// To finalize the transform of the weights, we use the following steps:
 /// 1. For each plane of the convolution function, transform to image plane
 /// and multiply by conjugate to get abs value squared.
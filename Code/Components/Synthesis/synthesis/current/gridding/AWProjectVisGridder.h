@@ -163,6 +163,22 @@ namespace askap
                 virtual void correctConvolution(casa::Array<double>& image);
 
             private:
+                /// @brief generate convolution function for one w-plane
+                /// @details This method multiplies the w-term by the illumination pattern (already
+                /// transformed to the image plane), does the FFT and cuts out the support into itsConvFunc.
+                /// It is called concurrently for different w-planes, therefore the common support
+                /// (itsSupport) must be determined before the concurrent calls.
+                /// @param[in] iw w-plane to generate
+                /// @param[in] zIndex index of the CF cache plane (before oversampling)
+                /// @param[in] feed feed number (for log output)
+                /// @param[in] pattern illumination pattern in the image plane
+                /// @param[in] thisPlane buffer for the full-sized convolution function (used for FFT)
+                /// @param[in] ccellx cell size in x
+                /// @param[in] ccelly cell size in y
+                /// @param[in] cell uv-cell size in metres (for log output)
+                void generateAWPlane(int iw, int zIndex, int feed, const UVPattern &pattern,
+                        casa::Matrix<casa::DComplex> &thisPlane, double ccellx, double ccelly, double cell);
+
                 /// @brief assignment operator (not to be called)
                 /// @details It is made private, so we can't call it inadvertently
                 /// @param[in] other input object
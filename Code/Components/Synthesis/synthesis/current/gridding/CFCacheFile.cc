@@ -0,0 +1,346 @@
+/// @file
+/// @brief Persistent cache of convolution functions
+/// @details Convolution functions of w-projection gridders depend only on the
+/// gridder parameters and the image geometry. Computing them is a noticeable startup
+/// cost, which is multiplied by the number of ranks. This class stores the whole CF cache
+/// of a gridder in a single binary file, which is memory-mapped read-only when loaded.
+/// All processes on the same node using the same file share the physical memory
+/// taken by the convolution functions, and later runs can reuse the file. Each file
+/// carries a key string describing all parameters the convolution functions depend on,
+/// a cache file is only used if the key matches exactly.
+///
+/// @copyright (c) 2007 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+
+// Package level header file
+#include <askap_synthesis.h>
+
+// ASKAPsoft includes
+#include <askap/AskapLogging.h>
+#include <askap/AskapError.h>
+#include <askap/AskapUtil.h>
+
+// Local package includes
+#include <gridding/CFCacheFile.h>
+
+// system includes
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdint.h>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+ASKAP_LOGGER(logger, ".gridding.cfcachefile");
+
+namespace askap {
+
+namespace synthesis {
+
+namespace {
+
+/// @brief signature at the start of each cache file (also encodes the format version)
+const char cfCacheMagic[8] = {'A','S','K','A','P','C','F','1'};
+
+/// @brief alignment of the data for each plane in bytes
+const size_t cfCacheAlignment = 64;
+
+/// @brief fixed part at the start of the file
+struct FileHeader {
+   /// @brief signature
+   char itsMagic[8];
+   /// @brief length of the key string in bytes
+   uint64_t itsKeyLength;
+   /// @brief number of planes
+   uint64_t itsNPlanes;
+   /// @brief number of offsets
+   uint64_t itsNOffsets;
+   /// @brief common support size
+   int32_t itsSupport;
+   /// @brief size of one element in bytes (sanity check)
+   int32_t itsElementSize;
+};
+
+/// @brief entry of the plane table
+struct PlaneEntry {
+   /// @brief offset of the data in bytes w.r.t. the start of the file
+   uint64_t itsDataOffset;
+   /// @brief number of rows
+   int32_t itsNRow;
+   /// @brief number of columns
+   int32_t itsNColumn;
+};
+
+/// @brief entry of the offset table
+struct OffsetEntry {
+   /// @brief offset in u
+   int32_t itsU;
+   /// @brief offset in v
+   int32_t itsV;
+};
+
+/// @brief round the value up to the given alignment
+/// @param[in] value value to round
+/// @param[in] alignment required alignment
+/// @return the smallest multiple of alignment which is not less than value
+inline size_t alignTo(size_t value, size_t alignment)
+{
+   return (value + alignment - 1) / alignment * alignment;
+}
+
+/// @brief offset of the plane table in bytes
+/// @param[in] keyLength length of the key string
+/// @return offset w.r.t. the start of the file
+inline size_t planeTableOffset(size_t keyLength)
+{
+   return alignTo(sizeof(FileHeader) + keyLength, sizeof(uint64_t));
+}
+
+} // anonymous namespace
+
+/// @brief constructor, only used by the open method
+CFCacheFile::CFCacheFile() : itsData(MAP_FAILED), itsSize(0), itsSupport(0) {}
+
+/// @brief destructor, unmaps the file
+CFCacheFile::~CFCacheFile()
+{
+   if (itsData != MAP_FAILED) {
+       munmap(itsData, itsSize);
+   }
+}
+
+/// @brief map an existing cache file
+/// @details The file is mapped read-only. An empty shared pointer is returned if the
+/// file does not exist, is not a valid cache file or has been made for a different key.
+/// @param[in] name file name
+/// @param[in] key key describing the parameters of convolution functions
+/// @return shared pointer to the mapped cache file (empty pointer if the file can't be used)
+boost::shared_ptr<CFCacheFile> CFCacheFile::open(const std::string &name, const std::string &key)
+{
+   boost::shared_ptr<CFCacheFile> result;
+   const int fd = ::open(name.c_str(), O_RDONLY);
+   if (fd < 0) {
+       if (errno != ENOENT) {
+           ASKAPLOG_WARN_STR(logger, "Unable to open CF cache file "<<name<<": "<<strerror(errno));
+       }
+       return result;
+   }
+   struct stat st;
+   if ((fstat(fd, &st) != 0) || (size_t(st.st_size) < sizeof(FileHeader))) {
+       ::close(fd);
+       ASKAPLOG_WARN_STR(logger, "CF cache file "<<name<<" is too short, ignoring it");
+       return result;
+   }
+   boost::shared_ptr<CFCacheFile> cache(new CFCacheFile);
+   cache->itsSize = size_t(st.st_size);
+   cache->itsData = mmap(0, cache->itsSize, PROT_READ, MAP_SHARED, fd, 0);
+   // the mapping stays valid after the file is closed
+   ::close(fd);
+   if (cache->itsData == MAP_FAILED) {
+       ASKAPLOG_WARN_STR(logger, "Unable to map CF cache file "<<name<<": "<<strerror(errno));
+       return result;
+   }
+
+   const char *base = static_cast<const char*>(cache->itsData);
+   const FileHeader &header = *reinterpret_cast<const FileHeader*>(base);
+   if ((memcmp(header.itsMagic, cfCacheMagic, sizeof(cfCacheMagic)) != 0) ||
+       (header.itsElementSize != int32_t(sizeof(casa::Complex)))) {
+       ASKAPLOG_WARN_STR(logger, "File "<<name<<" is not a valid CF cache file, ignoring it");
+       return result;
+   }
+   if ((header.itsKeyLength != key.size()) || (sizeof(FileHeader) + key.size() > cache->itsSize) ||
+       (key.compare(0, key.size(), base + sizeof(FileHeader), key.size()) != 0)) {
+       ASKAPLOG_WARN_STR(logger, "CF cache file "<<name<<" has been made for different parameters, ignoring it");
+       return result;
+   }
+
+   const size_t tableOffset = planeTableOffset(key.size());
+   const size_t offsetsOffset = tableOffset + header.itsNPlanes * sizeof(PlaneEntry);
+   if (offsetsOffset + header.itsNOffsets * sizeof(OffsetEntry) > cache->itsSize) {
+       ASKAPLOG_WARN_STR(logger, "CF cache file "<<name<<" is truncated, ignoring it");
+       return result;
+   }
+
+   const PlaneEntry *planes = reinterpret_cast<const PlaneEntry*>(base + tableOffset);
+   cache->itsPlanes.resize(header.itsNPlanes);
+   for (size_t plane = 0; plane < cache->itsPlanes.size(); ++plane) {
+        PlaneInfo &info = cache->itsPlanes[plane];
+        info.itsDataOffset = size_t(planes[plane].itsDataOffset);
+        info.itsNRow = planes[plane].itsNRow;
+        info.itsNColumn = planes[plane].itsNColumn;
+        const size_t planeSize = size_t(info.itsNRow) * size_t(info.itsNColumn) * sizeof(casa::Complex);
+        if ((info.itsNRow < 0) || (info.itsNColumn < 0) || (info.itsDataOffset + planeSize > cache->itsSize)) {
+            ASKAPLOG_WARN_STR(logger, "CF cache file "<<name<<" is corrupted, ignoring it");
+            return result;
+        }
+   }
+
+   const OffsetEntry *offsets = reinterpret_cast<const OffsetEntry*>(base + offsetsOffset);
+   cache->itsOffsets.resize(header.itsNOffsets);
+   for (size_t plane = 0; plane < cache->itsOffsets.size(); ++plane) {
+        cache->itsOffsets[plane] = std::pair<int,int>(offsets[plane].itsU, offsets[plane].itsV);
+   }
+   cache->itsSupport = header.itsSupport;
+
+   result = cache;
+   return result;
+}
+
+/// @brief write a cache file
+/// @details The file is written under a temporary name first and then renamed. Therefore,
+/// other processes either see the complete file or no file at all, which makes it safe
+/// for a number of ranks to write (and read) the same cache file concurrently.
+/// Unused (empty) planes of the cache are allowed.
+/// @param[in] name file name
+/// @param[in] key key describing the parameters of convolution functions
+/// @param[in] cfs convolution functions (all planes of the cache, including oversampling)
+/// @param[in] offsets offsets of convolution functions (per plane before oversampling, can be empty)
+/// @param[in] support common support size
+/// @return true if successful, false otherwise (the reason is logged)
+bool CFCacheFile::write(const std::string &name, const std::string &key,
+                        const std::vector<casa::Matrix<casa::Complex> > &cfs,
+                        const std::vector<std::pair<int,int> > &offsets, int support)
+{
+   FileHeader header;
+   memcpy(header.itsMagic, cfCacheMagic, sizeof(cfCacheMagic));
+   header.itsKeyLength = key.size();
+   header.itsNPlanes = cfs.size();
+   header.itsNOffsets = offsets.size();
+   header.itsSupport = support;
+   header.itsElementSize = int32_t(sizeof(casa::Complex));
+
+   // layout of the file
+   const size_t tableOffset = planeTableOffset(key.size());
+   size_t dataOffset = alignTo(tableOffset + cfs.size() * sizeof(PlaneEntry) + offsets.size() * sizeof(OffsetEntry),
+                               cfCacheAlignment);
+   std::vector<PlaneEntry> planes(cfs.size());
+   for (size_t plane = 0; plane < cfs.size(); ++plane) {
+        planes[plane].itsDataOffset = dataOffset;
+        planes[plane].itsNRow = int32_t(cfs[plane].nrow());
+        planes[plane].itsNColumn = int32_t(cfs[plane].ncolumn());
+        dataOffset = alignTo(dataOffset + cfs[plane].nelements() * sizeof(casa::Complex), cfCacheAlignment);
+   }
+   std::vector<OffsetEntry> offsetTable(offsets.size());
+   for (size_t plane = 0; plane < offsets.size(); ++plane) {
+        offsetTable[plane].itsU = offsets[plane].first;
+        offsetTable[plane].itsV = offsets[plane].second;
+   }
+
+   const std::string tmpName = name + ".tmp" + utility::toString(getpid());
+   {
+     std::ofstream os(tmpName.c_str(), std::ios::binary | std::ios::trunc);
+     if (!os) {
+         ASKAPLOG_WARN_STR(logger, "Unable to create CF cache file "<<tmpName);
+         return false;
+     }
+     const std::vector<char> padding(cfCacheAlignment, 0);
+     os.write(reinterpret_cast<const char*>(&header), sizeof(header));
+     os.write(key.data(), key.size());
+     os.write(&padding[0], tableOffset - sizeof(header) - key.size());
+     if (planes.size() > 0) {
+         os.write(reinterpret_cast<const char*>(&planes[0]), planes.size() * sizeof(PlaneEntry));
+     }
+     if (offsetTable.size() > 0) {
+         os.write(reinterpret_cast<const char*>(&offsetTable[0]), offsetTable.size() * sizeof(OffsetEntry));
+     }
+     size_t position = tableOffset + planes.size() * sizeof(PlaneEntry) + offsetTable.size() * sizeof(OffsetEntry);
+     for (size_t plane = 0; plane < cfs.size(); ++plane) {
+          ASKAPDEBUGASSERT(planes[plane].itsDataOffset >= position);
+          os.write(&padding[0], planes[plane].itsDataOffset - position);
+          position = planes[plane].itsDataOffset;
+          if (cfs[plane].nelements() > 0) {
+              bool deleteIt = false;
+              const casa::Complex *data = cfs[plane].getStorage(deleteIt);
+              os.write(reinterpret_cast<const char*>(data), cfs[plane].nelements() * sizeof(casa::Complex));
+              cfs[plane].freeStorage(data, deleteIt);
+              position += cfs[plane].nelements() * sizeof(casa::Complex);
+          }
+     }
+     if (!os) {
+         ASKAPLOG_WARN_STR(logger, "Failed to write CF cache file "<<tmpName);
+         os.close();
+         std::remove(tmpName.c_str());
+         return false;
+     }
+   }
+   if (std::rename(tmpName.c_str(), name.c_str()) != 0) {
+       ASKAPLOG_WARN_STR(logger, "Unable to rename "<<tmpName<<" into "<<name<<": "<<strerror(errno));
+       std::remove(tmpName.c_str());
+       return false;
+   }
+   return true;
+}
+
+/// @brief form a file name for the given key
+/// @details The file name is built from the given prefix and a hash of the key, so
+/// gridders with different parameters use different files in the same directory.
+/// @param[in] dir directory for cache files
+/// @param[in] prefix prefix of the file name (e.g. gridder name)
+/// @param[in] key key describing the parameters of convolution functions
+/// @return file name
+std::string CFCacheFile::fileName(const std::string &dir, const std::string &prefix, const std::string &key)
+{
+   // 64-bit FNV-1a hash, collisions are harmless as the full key is checked on load
+   uint64_t hash = 14695981039346656037ULL;
+   for (std::string::const_iterator ci = key.begin(); ci != key.end(); ++ci) {
+        hash ^= uint64_t(static_cast<unsigned char>(*ci));
+        hash *= 1099511628211ULL;
+   }
+   std::ostringstream os;
+   if (dir != "") {
+       os<<dir;
+       if (dir[dir.size() - 1] != '/') {
+           os<<'/';
+       }
+   }
+   os<<prefix<<"-"<<std::hex<<std::setw(16)<<std::setfill('0')<<hash<<".cfcache";
+   return os.str();
+}
+
+/// @brief obtain a plane of the cache
+/// @details The matrix references the mapped memory, it must not be modified.
+/// @param[in] plane plane number
+/// @return matrix with the convolution function (empty for unused planes)
+casa::Matrix<casa::Complex> CFCacheFile::plane(size_t plane) const
+{
+   ASKAPCHECK(plane < itsPlanes.size(), "Requested plane "<<plane<<" is outside the CF cache with "<<
+              itsPlanes.size()<<" planes");
+   const PlaneInfo &info = itsPlanes[plane];
+   if ((info.itsNRow == 0) || (info.itsNColumn == 0)) {
+       return casa::Matrix<casa::Complex>();
+   }
+   // the mapping is read-only, the casa array is only used to read the data
+   casa::Complex *data = reinterpret_cast<casa::Complex*>(static_cast<char*>(itsData) + info.itsDataOffset);
+   return casa::Matrix<casa::Complex>(casa::IPosition(2, info.itsNRow, info.itsNColumn), data, casa::SHARE);
+}
+
+} // namespace synthesis
+
+} // namespace askap
+
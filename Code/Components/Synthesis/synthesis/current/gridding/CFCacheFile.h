@@ -0,0 +1,160 @@
+/// @file
+/// @brief Persistent cache of convolution functions
+/// @details Convolution functions of w-projection gridders depend only on the
+/// gridder parameters and the image geometry. Computing them is a noticeable startup
+/// cost, which is multiplied by the number of ranks. This class stores the whole CF cache
+/// of a gridder in a single binary file, which is memory-mapped read-only when loaded.
+/// All processes on the same node using the same file share the physical memory
+/// taken by the convolution functions, and later runs can reuse the file. Each file
+/// carries a key string describing all parameters the convolution functions depend on,
+/// a cache file is only used if the key matches exactly.
+///
+/// @copyright (c) 2007 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+
+#ifndef ASKAP_SYNTHESIS_CF_CACHE_FILE_H
+#define ASKAP_SYNTHESIS_CF_CACHE_FILE_H
+
+// casa includes
+#include <casa/Arrays/Matrix.h>
+#include <casa/BasicSL/Complex.h>
+
+// boost includes
+#include <boost/shared_ptr.hpp>
+#include <boost/utility.hpp>
+
+// std includes
+#include <string>
+#include <vector>
+#include <utility>
+
+namespace askap {
+
+namespace synthesis {
+
+/// @brief Persistent cache of convolution functions
+/// @details This class stores the whole CF cache of a gridder in a single binary file,
+/// which is memory-mapped read-only when loaded. Matrices returned by the plane method
+/// reference the mapped memory directly, so they must not be modified and the object
+/// must outlive them (i.e. a gridder should hold a shared pointer to this class while
+/// it uses the convolution functions). The file is in the native byte order, it is
+/// intended to be shared between processes on the same cluster rather than to be
+/// exchanged between machines of different architectures.
+/// @ingroup gridding
+class CFCacheFile : private boost::noncopyable {
+public:
+
+   /// @brief map an existing cache file
+   /// @details The file is mapped read-only. An empty shared pointer is returned if the
+   /// file does not exist, is not a valid cache file or has been made for a different key.
+   /// @param[in] name file name
+   /// @param[in] key key describing the parameters of convolution functions
+   /// @return shared pointer to the mapped cache file (empty pointer if the file can't be used)
+   static boost::shared_ptr<CFCacheFile> open(const std::string &name, const std::string &key);
+
+   /// @brief write a cache file
+   /// @details The file is written under a temporary name first and then renamed. Therefore,
+   /// other processes either see the complete file or no file at all, which makes it safe
+   /// for a number of ranks to write (and read) the same cache file concurrently.
+   /// Unused (empty) planes of the cache are allowed.
+   /// @param[in] name file name
+   /// @param[in] key key describing the parameters of convolution functions
+   /// @param[in] cfs convolution functions (all planes of the cache, including oversampling)
+   /// @param[in] offsets offsets of convolution functions (per plane before oversampling, can be empty)
+   /// @param[in] support common support size
+   /// @return true if successful, false otherwise (the reason is logged)
+   static bool write(const std::string &name, const std::string &key,
+                     const std::vector<casa::Matrix<casa::Complex> > &cfs,
+                     const std::vector<std::pair<int,int> > &offsets, int support);
+
+   /// @brief form a file name for the given key
+   /// @details The file name is built from the given prefix and a hash of the key, so
+   /// gridders with different parameters use different files in the same directory.
+   /// @param[in] dir directory for cache files
+   /// @param[in] prefix prefix of the file name (e.g. gridder name)
+   /// @param[in] key key describing the parameters of convolution functions
+   /// @return file name
+   static std::string fileName(const std::string &dir, const std::string &prefix, const std::string &key);
+
+   /// @brief destructor, unmaps the file
+   ~CFCacheFile();
+
+   /// @brief number of planes in the cache
+   /// @return number of convolution functions (including oversampling planes)
+   inline size_t nPlanes() const { return itsPlanes.size(); }
+
+   /// @brief obtain a plane of the cache
+   /// @details The matrix references the mapped memory, it must not be modified.
+   /// @param[in] plane plane number
+   /// @return matrix with the convolution function (empty for unused planes)
+   casa::Matrix<casa::Complex> plane(size_t plane) const;
+
+   /// @brief number of offsets stored in the cache
+   /// @return number of planes (before oversampling) with offsets, 0 if offsets are not used
+   inline size_t nOffsets() const { return itsOffsets.size(); }
+
+   /// @brief obtain offset of the convolution function
+   /// @param[in] plane plane number (before oversampling)
+   /// @return offsets in u and v
+   inline const std::pair<int,int>& offset(size_t plane) const { return itsOffsets.at(plane); }
+
+   /// @brief common support size
+   /// @return support stored in the cache
+   inline int support() const { return itsSupport; }
+
+private:
+   /// @brief constructor, only used by the open method
+   CFCacheFile();
+
+   /// @brief description of one plane
+   struct PlaneInfo {
+      /// @brief offset of the first element in bytes w.r.t. the start of the file
+      size_t itsDataOffset;
+      /// @brief number of rows
+      int itsNRow;
+      /// @brief number of columns
+      int itsNColumn;
+   };
+
+   /// @brief start of the mapped region
+   void *itsData;
+
+   /// @brief size of the mapped region in bytes
+   size_t itsSize;
+
+   /// @brief description of all planes
+   std::vector<PlaneInfo> itsPlanes;
+
+   /// @brief offsets of convolution functions
+   std::vector<std::pair<int,int> > itsOffsets;
+
+   /// @brief common support size
+   int itsSupport;
+};
+
+} // namespace synthesis
+
+} // namespace askap
+
+#endif // #ifndef ASKAP_SYNTHESIS_CF_CACHE_FILE_H
+
@@ -24,6 +24,8 @@
 // Include own header file first
 #include "GridKernel.h"
 
+#include <askap/AskapError.h>
+
 /// Use pointers instead of casa::Matrix operators to grid
 //#define ASKAP_GRID_WITH_POINTERS 1
 
@@ -38,42 +40,368 @@
 #endif
 #endif
 
+/// Hand-vectorised kernels are compiled in with the per-function target attribute,
+/// so no special compiler flags are required and the choice is done at run time.
+/// Define ASKAP_GRID_NO_SIMD to build the plain C++ version only.
+#if !defined(ASKAP_GRID_NO_SIMD) && defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define ASKAP_GRID_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
 namespace askap {
 namespace synthesis {
 
+namespace {
+
+/// @brief signature of the patch gridding kernel
+typedef void (*GridPatchFunc)(float*, int, const float*, int, float, float, int, int);
+
+/// @brief signature of the patch degridding kernel
+typedef void (*DegridPatchFunc)(const float*, int, const float*, int, int, int, float&, float&);
+
+/// @brief plain C++ gridding of a patch
+/// @details Complex values are passed as interleaved floats; strides are in complex elements.
+void gridPatchScalar(float *grid, const int gridStride, const float *cf, const int cfStride,
+                     const float visRe, const float visIm, const int nu, const int nv)
+{
+   for (int v = 0; v < nv; ++v, grid += 2 * gridStride, cf += 2 * cfStride) {
+        for (int u = 0; u < 2 * nu; u += 2) {
+             grid[u] += visRe * cf[u] - visIm * cf[u + 1];
+             grid[u + 1] += visRe * cf[u + 1] + visIm * cf[u];
+        }
+   }
+}
+
+/// @brief plain C++ degridding of a patch
+/// @details Accumulates cf*conj(grid) into (re,im).
+void degridPatchScalar(const float *cf, const int cfStride, const float *grid, const int gridStride,
+                       const int nu, const int nv, float &re, float &im)
+{
+   float sumRe = 0., sumIm = 0.;
+   for (int v = 0; v < nv; ++v, grid += 2 * gridStride, cf += 2 * cfStride) {
+        for (int u = 0; u < 2 * nu; u += 2) {
+             sumRe += cf[u] * grid[u] + cf[u + 1] * grid[u + 1];
+             sumIm += cf[u + 1] * grid[u] - cf[u] * grid[u + 1];
+        }
+   }
+   re = sumRe;
+   im = sumIm;
+}
+
+#ifdef ASKAP_GRID_X86_SIMD
+
+// The complex multiplication (a+ib)*(c+id) is done as addsub(a*[c,d], b*[d,c]) which
+// maps to a single (fused) instruction per 2, 4 or 8 complex values. For degridding
+// cf*conj(grid) two accumulators are kept: cf*grid and cf*swap(grid). The real part is
+// the sum of all elements of the first one, the imaginary part is the difference between
+// odd and even elements of the second one. The horizontal sums are done after the loop.
+
+__attribute__((target("sse3")))
+void gridPatchSSE3(float *grid, const int gridStride, const float *cf, const int cfStride,
+                   const float visRe, const float visIm, const int nu, const int nv)
+{
+   const __m128 vRe = _mm_set1_ps(visRe);
+   const __m128 vIm = _mm_set1_ps(visIm);
+   const int nVec = nu / 2;
+   for (int v = 0; v < nv; ++v, grid += 2 * gridStride, cf += 2 * cfStride) {
+        for (int k = 0; k < nVec; ++k) {
+             const __m128 c = _mm_loadu_ps(cf + 4 * k);
+             const __m128 cSwapped = _mm_shuffle_ps(c, c, 0xB1);
+             const __m128 prod = _mm_addsub_ps(_mm_mul_ps(c, vRe), _mm_mul_ps(cSwapped, vIm));
+             _mm_storeu_ps(grid + 4 * k, _mm_add_ps(_mm_loadu_ps(grid + 4 * k), prod));
+        }
+        if (nu % 2) {
+            const int u = 4 * nVec;
+            grid[u] += visRe * cf[u] - visIm * cf[u + 1];
+            grid[u + 1] += visRe * cf[u + 1] + visIm * cf[u];
+        }
+   }
+}
+
+__attribute__((target("sse3")))
+void degridPatchSSE3(const float *cf, const int cfStride, const float *grid, const int gridStride,
+                     const int nu, const int nv, float &re, float &im)
+{
+   __m128 accDirect = _mm_setzero_ps();
+   __m128 accSwapped = _mm_setzero_ps();
+   float tailRe = 0., tailIm = 0.;
+   const int nVec = nu / 2;
+   for (int v = 0; v < nv; ++v, grid += 2 * gridStride, cf += 2 * cfStride) {
+        for (int k = 0; k < nVec; ++k) {
+             const __m128 c = _mm_loadu_ps(cf + 4 * k);
+             const __m128 g = _mm_loadu_ps(grid + 4 * k);
+             accDirect = _mm_add_ps(accDirect, _mm_mul_ps(c, g));
+             accSwapped = _mm_add_ps(accSwapped, _mm_mul_ps(c, _mm_shuffle_ps(g, g, 0xB1)));
+        }
+        if (nu % 2) {
+            const int u = 4 * nVec;
+            tailRe += cf[u] * grid[u] + cf[u + 1] * grid[u + 1];
+            tailIm += cf[u + 1] * grid[u] - cf[u] * grid[u + 1];
+        }
+   }
+   float direct[4], swapped[4];
+   _mm_storeu_ps(direct, accDirect);
+   _mm_storeu_ps(swapped, accSwapped);
+   re = tailRe + (direct[0] + direct[1]) + (direct[2] + direct[3]);
+   im = tailIm + (swapped[1] - swapped[0]) + (swapped[3] - swapped[2]);
+}
+
+__attribute__((target("avx2,fma")))
+void gridPatchAVX2(float *grid, const int gridStride, const float *cf, const int cfStride,
+                   const float visRe, const float visIm, const int nu, const int nv)
+{
+   const __m256 vRe = _mm256_set1_ps(visRe);
+   const __m256 vIm = _mm256_set1_ps(visIm);
+   const int nVec = nu / 4;
+   for (int v = 0; v < nv; ++v, grid += 2 * gridStride, cf += 2 * cfStride) {
+        for (int k = 0; k < nVec; ++k) {
+             const __m256 c = _mm256_loadu_ps(cf + 8 * k);
+             const __m256 cSwapped = _mm256_permute_ps(c, 0xB1);
+             const __m256 prod = _mm256_fmaddsub_ps(c, vRe, _mm256_mul_ps(cSwapped, vIm));
+             _mm256_storeu_ps(grid + 8 * k, _mm256_add_ps(_mm256_loadu_ps(grid + 8 * k), prod));
+        }
+        for (int u = 8 * nVec; u < 2 * nu; u += 2) {
+             grid[u] += visRe * cf[u] - visIm * cf[u + 1];
+             grid[u + 1] += visRe * cf[u + 1] + visIm * cf[u];
+        }
+   }
+}
+
+__attribute__((target("avx2,fma")))
+void degridPatchAVX2(const float *cf, const int cfStride, const float *grid, const int gridStride,
+                     const int nu, const int nv, float &re, float &im)
+{
+   __m256 accDirect = _mm256_setzero_ps();
+   __m256 accSwapped = _mm256_setzero_ps();
+   float tailRe = 0., tailIm = 0.;
+   const int nVec = nu / 4;
+   for (int v = 0; v < nv; ++v, grid += 2 * gridStride, cf += 2 * cfStride) {
+        for (int k = 0; k < nVec; ++k) {
+             const __m256 c = _mm256_loadu_ps(cf + 8 * k);
+             const __m256 g = _mm256_loadu_ps(grid + 8 * k);
+             accDirect = _mm256_fmadd_ps(c, g, accDirect);
+             accSwapped = _mm256_fmadd_ps(c, _mm256_permute_ps(g, 0xB1), accSwapped);
+        }
+        for (int u = 8 * nVec; u < 2 * nu; u += 2) {
+             tailRe += cf[u] * grid[u] + cf[u + 1] * grid[u + 1];
+             tailIm += cf[u + 1] * grid[u] - cf[u] * grid[u + 1];
+        }
+   }
+   float direct[8], swapped[8];
+   _mm256_storeu_ps(direct, accDirect);
+   _mm256_storeu_ps(swapped, accSwapped);
+   re = tailRe;
+   im = tailIm;
+   for (int i = 0; i < 8; i += 2) {
+        re += direct[i] + direct[i + 1];
+        im += swapped[i + 1] - swapped[i];
+   }
+}
+
+__attribute__((target("avx512f")))
+void gridPatchAVX512(float *grid, const int gridStride, const float *cf, const int cfStride,
+                     const float visRe, const float visIm, const int nu, const int nv)
+{
+   const __m512 vRe = _mm512_set1_ps(visRe);
+   const __m512 vIm = _mm512_set1_ps(visIm);
+   const int nVec = nu / 8;
+   // the remainder (less than 8 complex values) is done with a masked load/store
+   const __mmask16 tailMask = static_cast<__mmask16>((1u << (2 * (nu % 8))) - 1u);
+   for (int v = 0; v < nv; ++v, grid += 2 * gridStride, cf += 2 * cfStride) {
+        for (int k = 0; k < nVec; ++k) {
+             const __m512 c = _mm512_loadu_ps(cf + 16 * k);
+             const __m512 cSwapped = _mm512_permute_ps(c, 0xB1);
+             const __m512 prod = _mm512_fmaddsub_ps(c, vRe, _mm512_mul_ps(cSwapped, vIm));
+             _mm512_storeu_ps(grid + 16 * k, _mm512_add_ps(_mm512_loadu_ps(grid + 16 * k), prod));
+        }
+        if (tailMask) {
+            const __m512 c = _mm512_maskz_loadu_ps(tailMask, cf + 16 * nVec);
+            const __m512 cSwapped = _mm512_permute_ps(c, 0xB1);
+            const __m512 prod = _mm512_fmaddsub_ps(c, vRe, _mm512_mul_ps(cSwapped, vIm));
+            const __m512 g = _mm512_maskz_loadu_ps(tailMask, grid + 16 * nVec);
+            _mm512_mask_storeu_ps(grid + 16 * nVec, tailMask, _mm512_add_ps(g, prod));
+        }
+   }
+}
+
+__attribute__((target("avx512f")))
+void degridPatchAVX512(const float *cf, const int cfStride, const float *grid, const int gridStride,
+                       const int nu, const int nv, float &re, float &im)
+{
+   __m512 accDirect = _mm512_setzero_ps();
+   __m512 accSwapped = _mm512_setzero_ps();
+   const int nVec = nu / 8;
+   const __mmask16 tailMask = static_cast<__mmask16>((1u << (2 * (nu % 8))) - 1u);
+   for (int v = 0; v < nv; ++v, grid += 2 * gridStride, cf += 2 * cfStride) {
+        for (int k = 0; k < nVec; ++k) {
+             const __m512 c = _mm512_loadu_ps(cf + 16 * k);
+             const __m512 g = _mm512_loadu_ps(grid + 16 * k);
+             accDirect = _mm512_fmadd_ps(c, g, accDirect);
+             accSwapped = _mm512_fmadd_ps(c, _mm512_permute_ps(g, 0xB1), accSwapped);
+        }
+        if (tailMask) {
+            const __m512 c = _mm512_maskz_loadu_ps(tailMask, cf + 16 * nVec);
+            const __m512 g = _mm512_maskz_loadu_ps(tailMask, grid + 16 * nVec);
+            accDirect = _mm512_fmadd_ps(c, g, accDirect);
+            accSwapped = _mm512_fmadd_ps(c, _mm512_permute_ps(g, 0xB1), accSwapped);
+        }
+   }
+   // odd elements of accSwapped hold b*c, even elements hold a*d
+   // so flip the sign of even elements (low half of each 64-bit pair) before the sum
+   const __m512i sign = _mm512_set1_epi64(0x80000000LL);
+   re = _mm512_reduce_add_ps(accDirect);
+   im = _mm512_reduce_add_ps(_mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(accSwapped), sign)));
+}
+
+#endif // ASKAP_GRID_X86_SIMD
+
+/// @brief dispatch table holding the kernels in use
+struct KernelDispatch {
+   /// @brief set up the table with the best implementation available
+   KernelDispatch() { select(best()); }
+
+   /// @brief fastest implementation supported by this CPU
+   static GridKernel::Implementation best() {
+      if (GridKernel::isSupported(GridKernel::AVX512)) {
+          return GridKernel::AVX512;
+      }
+      if (GridKernel::isSupported(GridKernel::AVX2)) {
+          return GridKernel::AVX2;
+      }
+      if (GridKernel::isSupported(GridKernel::SSE3)) {
+          return GridKernel::SSE3;
+      }
+      return GridKernel::SCALAR;
+   }
+
+   /// @brief fill the table
+   /// @param[in] impl implementation to use (assumed to be supported)
+   void select(const GridKernel::Implementation impl) {
+      itsImpl = impl;
+      itsGrid = &gridPatchScalar;
+      itsDegrid = &degridPatchScalar;
+#ifdef ASKAP_GRID_X86_SIMD
+      if (impl == GridKernel::SSE3) {
+          itsGrid = &gridPatchSSE3;
+          itsDegrid = &degridPatchSSE3;
+      } else if (impl == GridKernel::AVX2) {
+          itsGrid = &gridPatchAVX2;
+          itsDegrid = &degridPatchAVX2;
+      } else if (impl == GridKernel::AVX512) {
+          itsGrid = &gridPatchAVX512;
+          itsDegrid = &degridPatchAVX512;
+      }
+#endif
+   }
+
+   /// @brief implementation in use
+   GridKernel::Implementation itsImpl;
+   /// @brief gridding kernel
+   GridPatchFunc itsGrid;
+   /// @brief degridding kernel
+   DegridPatchFunc itsDegrid;
+};
+
+/// @brief access to the dispatch table
+/// @details The table is set up on first use (function-level static).
+KernelDispatch& dispatch() {
+   static KernelDispatch theDispatch;
+   return theDispatch;
+}
+
+} // anonymous namespace
+
 std::string GridKernel::info() {
 #ifdef ASKAP_GRID_WITH_BLAS
 	return std::string("Gridding with BLAS");
 #else 
 #ifdef ASKAP_GRID_WITH_POINTERS
-	return std::string("Gridding with casa::Matrix pointers");
+	return std::string("Gridding with casa::Matrix pointers, ") + name(implementation()) + " kernel";
 #else
 	return std::string("Standard gridding/degridding with casa::Matrix");
 #endif
 #endif
 }
 
+GridKernel::Implementation GridKernel::implementation() {
+	return dispatch().itsImpl;
+}
+
+bool GridKernel::isSupported(const Implementation impl) {
+	if (impl == SCALAR) {
+	    return true;
+	}
+#ifdef ASKAP_GRID_X86_SIMD
+	__builtin_cpu_init();
+	if (impl == SSE3) {
+	    return __builtin_cpu_supports("sse3");
+	}
+	if (impl == AVX2) {
+	    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+	}
+	if (impl == AVX512) {
+	    return __builtin_cpu_supports("avx512f");
+	}
+#endif
+	return false;
+}
+
+void GridKernel::selectImplementation(const Implementation impl) {
+	ASKAPCHECK(isSupported(impl), "Gridding kernel implementation "<<name(impl)<<
+	           " is not supported on this machine");
+	dispatch().select(impl);
+}
+
+std::string GridKernel::name(const Implementation impl) {
+	switch (impl) {
+	    case SCALAR: return "scalar";
+	    case SSE3: return "SSE3";
+	    case AVX2: return "AVX2";
+	    case AVX512: return "AVX-512";
+	    default: break;
+	}
+	return "unknown";
+}
+
+void GridKernel::gridPatch(casa::Complex *gridPtr, const int gridStride,
+		const casa::Complex *cfPtr, const int cfStride,
+		const casa::Complex &cVis, const int nu, const int nv) {
+	dispatch().itsGrid(reinterpret_cast<float*>(gridPtr), gridStride,
+	                   reinterpret_cast<const float*>(cfPtr), cfStride,
+	                   casa::real(cVis), casa::imag(cVis), nu, nv);
+}
+
+casa::Complex GridKernel::degridPatch(const casa::Complex *cfPtr, const int cfStride,
+		const casa::Complex *gridPtr, const int gridStride,
+		const int nu, const int nv) {
+	float re = 0., im = 0.;
+	dispatch().itsDegrid(reinterpret_cast<const float*>(cfPtr), cfStride,
+	                     reinterpret_cast<const float*>(gridPtr), gridStride, nu, nv, re, im);
+	return casa::Complex(re, im);
+}
+
 /// Totally selfcontained gridding
 void GridKernel::grid(casa::Matrix<casa::Complex>& grid,
 		casa::Matrix<casa::Complex>& convFunc, const casa::Complex& cVis,
 		const int iu, const int iv, const int support) {
 
-#if defined ( ASKAP_GRID_WITH_POINTERS ) || defined ( ASKAP_GRID_WITH_BLAS )
+#ifdef ASKAP_GRID_WITH_BLAS
 	for (int suppv = -support; suppv < +support; suppv++) {
 		const int voff = suppv + support;
 		const int uoff = -support + support;
 		casa::Complex *wtPtr = &convFunc(uoff, voff);
 		casa::Complex *gridPtr = &(grid(iu - support, iv + suppv));
-#ifdef ASKAP_GRID_WITH_BLAS
 		cblas_caxpy(2*support+1, &cVis, wtPtr, 1, gridPtr, 1);
-#else
-		for (int suppu = -support; suppu < +support; suppu++) {
-			(*gridPtr) += cVis * (*wtPtr);
-			wtPtr += 1;
-			gridPtr++;
-		}
-#endif
 	}
+#else
+#ifdef ASKAP_GRID_WITH_POINTERS
+	// u is contiguous for both grid and CF, the distance between rows is
+	// obtained from the array itself as we may be given a reference to a slice
+	casa::Complex *gridPtr = &(grid(iu - support, iv - support));
+	const int gridStride = grid.ncolumn() > 1 ? int(&grid(0, 1) - &grid(0, 0)) : 0;
+	const casa::Complex *wtPtr = &convFunc(0, 0);
+	const int cfStride = convFunc.ncolumn() > 1 ? int(&convFunc(0, 1) - &convFunc(0, 0)) : 0;
+	gridPatch(gridPtr, gridStride, wtPtr, cfStride, cVis, 2 * support, 2 * support);
 #else
 	for (int suppv=-support; suppv<+support; suppv++)
 	{
@@ -86,6 +414,7 @@ void GridKernel::grid(casa::Matrix<casa::Complex>& grid,
 		}
 	}
 #endif
+#endif
 }
 
 /// Totally selfcontained degridding
@@ -96,24 +425,23 @@ void GridKernel::degrid(casa::Complex& cVis,
 	/// Degridding from grid to visibility. Here we just take a weighted sum of the visibility
 	/// data using the convolution function as the weighting function. 
 	cVis = 0.0;
-#if defined ( ASKAP_GRID_WITH_POINTERS ) || defined ( ASKAP_GRID_WITH_BLAS )
+#ifdef ASKAP_GRID_WITH_BLAS
 	for (int suppv = -support; suppv < +support; suppv++) {
 		const int voff = suppv + support;
 		const int uoff = -support + support;
 		const casa::Complex *wtPtr = &convFunc(uoff, voff);
 		const casa::Complex *gridPtr = &(grid(iu - support, iv + suppv));
-#ifdef ASKAP_GRID_WITH_BLAS
 		casa::Complex dot;
 		cblas_cdotc_sub(2*support+1, gridPtr, 1, wtPtr, 1, &dot);
 		cVis+=dot;
-#else
-		for (int suppu = -support; suppu < +support; suppu++) {
-			cVis += (*wtPtr) * conj(*gridPtr);
-			wtPtr += 1;
-			gridPtr++;
-		}
-#endif
 	}
+#else
+#ifdef ASKAP_GRID_WITH_POINTERS
+	const casa::Complex *gridPtr = &(grid(iu - support, iv - support));
+	const int gridStride = grid.ncolumn() > 1 ? int(&grid(0, 1) - &grid(0, 0)) : 0;
+	const casa::Complex *wtPtr = &convFunc(0, 0);
+	const int cfStride = convFunc.ncolumn() > 1 ? int(&convFunc(0, 1) - &convFunc(0, 0)) : 0;
+	cVis = degridPatch(wtPtr, cfStride, gridPtr, gridStride, 2 * support, 2 * support);
 #else
 	for (int suppv=-support; suppv<+support; suppv++)
 	{
@@ -126,6 +454,7 @@ void GridKernel::degrid(casa::Complex& cVis,
 		}
 	}
 #endif
+#endif
 }
 
 }
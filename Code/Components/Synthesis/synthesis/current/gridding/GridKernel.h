@@ -41,9 +41,32 @@ namespace askap {
     namespace synthesis {
         /// @brief Holder for gridding kernels
         ///
+        /// @details The inner loops over the support are implemented in a
+        /// number of flavours (plain C++ and hand-vectorised SSE3, AVX2/FMA and
+        /// AVX-512 versions). The fastest implementation supported by the CPU
+        /// the code is running on is selected at run time the first time the
+        /// kernel is used, so the same binary can be deployed on different nodes.
+        /// Vectorised kernels are used when the code is compiled with
+        /// ASKAP_GRID_WITH_POINTERS (default); BLAS and casa::Matrix-based
+        /// versions are left as they were for comparison.
+        ///
         /// @ingroup gridding
         class GridKernel {
             public:
+                /// @brief implementations of the inner gridding loop
+                enum Implementation {
+                    /// plain C++ loop over raw pointers
+                    SCALAR = 0,
+                    /// SSE3 (2 complex values per instruction)
+                    SSE3,
+                    /// AVX2 with fused multiply-add (4 complex values per instruction)
+                    AVX2,
+                    /// AVX-512F (8 complex values per instruction)
+                    AVX512,
+                    /// number of implementations, not a valid choice
+                    N_IMPLEMENTATIONS
+                };
+
                 /// Information about gridding options
                 static std::string info();
 
@@ -60,6 +83,50 @@ namespace askap {
                         const int iu, const int iv,
                         const int support);
 
+                /// @brief grid a rectangular patch given as raw pointers
+                /// @details grid(i,j) += cVis * convFunc(i,j) is done for
+                /// i in [0,nu) and j in [0,nv). Both arrays are column-major
+                /// (i.e. u is the fastest varying index).
+                /// @param[in] gridPtr pointer to the bottom left corner of the patch on the grid
+                /// @param[in] gridStride distance (in elements) between adjacent rows of the grid
+                /// @param[in] cfPtr pointer to the bottom left corner of the convolution function
+                /// @param[in] cfStride distance (in elements) between adjacent rows of the CF
+                /// @param[in] cVis visibility to grid
+                /// @param[in] nu number of elements in u
+                /// @param[in] nv number of elements in v
+                static void gridPatch(casa::Complex *gridPtr, const int gridStride,
+                        const casa::Complex *cfPtr, const int cfStride,
+                        const casa::Complex &cVis, const int nu, const int nv);
+
+                /// @brief degrid a rectangular patch given as raw pointers
+                /// @details returns the sum of convFunc(i,j) * conj(grid(i,j))
+                /// for i in [0,nu) and j in [0,nv). See gridPatch for parameters.
+                /// @return degridded value
+                static casa::Complex degridPatch(const casa::Complex *cfPtr, const int cfStride,
+                        const casa::Complex *gridPtr, const int gridStride,
+                        const int nu, const int nv);
+
+                /// @brief implementation currently in use
+                /// @return implementation selected at run time
+                static Implementation implementation();
+
+                /// @brief check whether the given implementation can run on this CPU
+                /// @param[in] impl implementation to check
+                /// @return true, if the implementation is compiled in and the CPU supports it
+                static bool isSupported(const Implementation impl);
+
+                /// @brief force a particular implementation
+                /// @details This method is intended for benchmarking and testing. It is not
+                /// thread safe and should not be called while gridding is in progress.
+                /// An exception is thrown if the implementation is not supported.
+                /// @param[in] impl implementation to use from now on
+                static void selectImplementation(const Implementation impl);
+
+                /// @brief human-readable name of the implementation
+                /// @param[in] impl implementation
+                /// @return name
+                static std::string name(const Implementation impl);
+
         };
     }
 }
@@ -59,6 +59,7 @@ using namespace askap;
 #include <ostream>
 #include <sstream>
 #include <iomanip>
+#include <algorithm>
 
 #include <casa/OS/Timer.h>
 
@@ -94,7 +95,7 @@ TableVisGridder::TableVisGridder() : itsSumWeights(),
 	itsTimeDegridded(0.0), itsDopsf(false),
 	itsFirstGriddedVis(true), itsFeedUsedForPSF(0), itsUseAllDataForPSF(false),
 	itsMaxPointingSeparation(-1.), itsRowsRejectedDueToMaxPointingSeparation(0),
-	itsTrackWeightPerOversamplePlane(false)
+	itsTrackWeightPerOversamplePlane(false), itsNumberOfThreads(1)
 
 {}
 
@@ -107,7 +108,7 @@ TableVisGridder::TableVisGridder(const int overSample, const int support,
         itsTimeDegridded(0.0), itsDopsf(false),
         itsFirstGriddedVis(true), itsFeedUsedForPSF(0), itsUseAllDataForPSF(false), 	
         itsMaxPointingSeparation(-1.), itsRowsRejectedDueToMaxPointingSeparation(0),
-        itsTrackWeightPerOversamplePlane(false)
+        itsTrackWeightPerOversamplePlane(false), itsNumberOfThreads(1)
 	{
 		
 		ASKAPCHECK(overSample>0, "Oversampling must be greater than 0");
@@ -142,7 +143,8 @@ TableVisGridder::TableVisGridder(const int overSample, const int support,
      itsMaxPointingSeparation(other.itsMaxPointingSeparation),
      itsRowsRejectedDueToMaxPointingSeparation(other.itsRowsRejectedDueToMaxPointingSeparation),
      itsConvFuncOffsets(other.itsConvFuncOffsets), 
-     itsTrackWeightPerOversamplePlane(other.itsTrackWeightPerOversamplePlane)
+     itsTrackWeightPerOversamplePlane(other.itsTrackWeightPerOversamplePlane),
+     itsNumberOfThreads(other.itsNumberOfThreads)
 {
    deepCopyOfSTDVector(other.itsConvFunc,itsConvFunc);
    deepCopyOfSTDVector(other.itsGrid, itsGrid);   
@@ -461,260 +463,259 @@ void TableVisGridder::generic(accessors::IDataAccessor& acc, bool forward) {
    #endif   
 			      
    ASKAPDEBUGASSERT(itsShape.nelements()>=2);
-   const casa::IPosition onePlane4D(4, itsShape(0), itsShape(1), 1, 1);
-   const casa::IPosition onePlane(2, itsShape(0), itsShape(1));
    
-   // Loop over all samples adding them to the grid
-   // First scale to the correct pixel location
-   // Then find the fraction of a pixel to the nearest pixel
-   // Loop over the entire itsSupport, calculating weights from
-   // the convolution function and adding the scaled
-   // visibility to the grid.
+   // number of polarisation planes in the grid
+   const casa::uInt nImagePols = (shape().nelements()<=2) ? 1 : shape()[2];
+   // number of elements in one plane of the grid and the stride between adjacent v rows
+   const long gridPlaneSize = long(itsShape(0)) * long(itsShape(1));
+   const int gridStride = itsShape(0);
+   
+   // The work is done in two stages for a block of rows. First, all samples are converted
+   // into a flat table of grid operations (GridOp) with the coordinate conversion, virtual
+   // index lookups and consistency checks done there. Then a tight loop goes over this table
+   // and calls the kernel with raw pointers. The blocks are just to limit the size of
+   // the buffers (which are data members and are reused between calls).
+   const uint maxOpsPerBlock = 262144;
+   const uint rowsPerBlock = std::max(1u, maxOpsPerBlock / std::max(1u, nChan * nImagePols));
    
    ASKAPDEBUGASSERT(casa::uInt(nChan) <= frequencyList.nelements());
    ASKAPDEBUGASSERT(casa::uInt(nSamples) == acc.uvw().nelements());
    
-   for (uint i=0; i<nSamples; ++i) {
-       if (itsMaxPointingSeparation > 0.) {
-           // need to reject samples, if too far from the image centre
-           const casa::MVDirection thisPointing  = acc.pointingDir1()(i);
-           if (imageCentre.separation(thisPointing) > itsMaxPointingSeparation) {
-               ++itsRowsRejectedDueToMaxPointingSeparation;
-               continue;
-           }
-       }
+   for (uint blockStart = 0; blockStart < nSamples; blockStart += rowsPerBlock) {
+        const uint blockEnd = std::min(nSamples, blockStart + rowsPerBlock);
+        const uint nBlockSamples = (blockEnd - blockStart) * nChan;
+        
+        // per (row, chan) tables: phasor, visibility vector in the grid polarisation frame
+        // and noise weights (the latter are only used for gridding)
+        itsPhasorBuffer.resize(nBlockSamples);
+        itsVisBuffer.assign(nBlockSamples * nImagePols, casa::Complex(0.,0.));
+        if (!forward) {
+            itsNoiseWtBuffer.resize(nBlockSamples * nImagePols);
+        }
+        itsGridOps.clear();
+        
+        // Stage 1: fill the tables
+        for (uint i = blockStart; i < blockEnd; ++i) {
+             if (itsMaxPointingSeparation > 0.) {
+                 // need to reject samples, if too far from the image centre
+                 const casa::MVDirection thisPointing  = acc.pointingDir1()(i);
+                 if (imageCentre.separation(thisPointing) > itsMaxPointingSeparation) {
+                     ++itsRowsRejectedDueToMaxPointingSeparation;
+                     continue;
+                 }
+             }
    
-       if (itsFirstGriddedVis && isPSFGridder()) {
-           // data members related to representative feed and field are used for
-           // reverse problem only (from visibilities to image). 
-           if (itsUseAllDataForPSF) {
-               ASKAPLOG_DEBUG_STR(logger, "All data are used to estimate PSF");       
-           } else {
-               itsFeedUsedForPSF = acc.feed1()(i);
-               itsPointingUsedForPSF = acc.dishPointing1()(i);    
-               ASKAPLOG_DEBUG_STR(logger, "Using the data for feed "<<itsFeedUsedForPSF<<
-                  " and field at "<<printDirection(itsPointingUsedForPSF)<<" to estimate the PSF");
-           }
-           itsFirstGriddedVis = false;
-       }
+             if (itsFirstGriddedVis && isPSFGridder()) {
+                 // data members related to representative feed and field are used for
+                 // reverse problem only (from visibilities to image). 
+                 if (itsUseAllDataForPSF) {
+                     ASKAPLOG_DEBUG_STR(logger, "All data are used to estimate PSF");       
+                 } else {
+                     itsFeedUsedForPSF = acc.feed1()(i);
+                     itsPointingUsedForPSF = acc.dishPointing1()(i);    
+                     ASKAPLOG_DEBUG_STR(logger, "Using the data for feed "<<itsFeedUsedForPSF<<
+                        " and field at "<<printDirection(itsPointingUsedForPSF)<<" to estimate the PSF");
+                 }
+                 itsFirstGriddedVis = false;
+             }
+             
+             // the row contributes to the PSF (only used in the PSF gridding mode)
+             const bool psfRow = isPSFGridder() && (itsUseAllDataForPSF || ((itsFeedUsedForPSF == acc.feed1()(i)) &&
+                                 (itsPointingUsedForPSF.separation(acc.dishPointing1()(i))<1e-6)));
 	   
-	   for (uint chan=0; chan<nChan; ++chan) {
+             for (uint chan=0; chan<nChan; ++chan) {
+                  const uint visIndex = (i - blockStart) * nChan + chan;
 		   
-		   const double reciprocalToWavelength = frequencyList[chan]/casa::C::c;
-		   if (chan == 0) {
-		      // check for ridiculous frequency to pick up a possible error with input file,
-		      // not essential for processing as such
-		      ASKAPCHECK((reciprocalToWavelength>0.1) && (reciprocalToWavelength<30000), 
-		          "Check frequencies in the input file as the order of magnitude is likely to be wrong, "
-		          "comment this statement in the code if you're trying something non-standard. Frequency = "<<
-		          frequencyList[chan]/1e9<<" GHz");
-		   }
+                  const double reciprocalToWavelength = frequencyList[chan]/casa::C::c;
+                  if (chan == 0) {
+                      // check for ridiculous frequency to pick up a possible error with input file,
+                      // not essential for processing as such
+                      ASKAPCHECK((reciprocalToWavelength>0.1) && (reciprocalToWavelength<30000), 
+                          "Check frequencies in the input file as the order of magnitude is likely to be wrong, "
+                          "comment this statement in the code if you're trying something non-standard. Frequency = "<<
+                          frequencyList[chan]/1e9<<" GHz");
+                  }
 		   
-		   /// Scale U,V to integer pixels plus fractional terms
-		   const double uScaled=frequencyList[chan]*outUVW(i)(0)/(casa::C::c *itsUVCellSize(0));
-		   int iu = askap::nint(uScaled);
-		   int fracu=askap::nint(itsOverSample*(double(iu)-uScaled));
-		   if (fracu<0) {
-                       iu+=1;
-                       fracu += itsOverSample;
-		   } else if (fracu>=itsOverSample) {
-                       iu-=1;
-                       fracu -= itsOverSample;
-		   }
-		   ASKAPCHECK(fracu>-1, "Fractional offset in u is negative, uScaled="<<uScaled<<" iu="<<iu<<" oversample="<<itsOverSample<<" fracu="<<fracu);
-		   ASKAPCHECK(fracu<itsOverSample,
-				   "Fractional offset in u exceeds oversampling, uScaled="<<uScaled<<" iu="<<iu<<" oversample="<<itsOverSample<<" fracu="<<fracu);
-		   iu+=itsShape(0)/2;
+                  /// Scale U,V to integer pixels plus fractional terms
+                  const double uScaled=frequencyList[chan]*outUVW(i)(0)/(casa::C::c *itsUVCellSize(0));
+                  int iu = askap::nint(uScaled);
+                  int fracu=askap::nint(itsOverSample*(double(iu)-uScaled));
+                  if (fracu<0) {
+                      iu+=1;
+                      fracu += itsOverSample;
+                  } else if (fracu>=itsOverSample) {
+                      iu-=1;
+                      fracu -= itsOverSample;
+                  }
+                  ASKAPCHECK(fracu>-1, "Fractional offset in u is negative, uScaled="<<uScaled<<" iu="<<iu<<" oversample="<<itsOverSample<<" fracu="<<fracu);
+                  ASKAPCHECK(fracu<itsOverSample,
+                      "Fractional offset in u exceeds oversampling, uScaled="<<uScaled<<" iu="<<iu<<" oversample="<<itsOverSample<<" fracu="<<fracu);
+                  iu+=itsShape(0)/2;
 		   
-		   const double vScaled=frequencyList[chan]*outUVW(i)(1)/(casa::C::c *itsUVCellSize(1));
-		   int iv = askap::nint(vScaled);
-		   int fracv=askap::nint(itsOverSample*(double(iv)-vScaled));
-		   if (fracv<0) {
-                       iv+=1;
-                       fracv += itsOverSample;
-		   } else if (fracv>=itsOverSample) {
-                       iv-=1;
-                       fracv -= itsOverSample;
-		   }
-		   ASKAPCHECK(fracv>-1, "Fractional offset in v is negative, vScaled="<<vScaled<<" iv="<<iv<<" oversample="<<itsOverSample<<" fracv="<<fracv);
-		   ASKAPCHECK(fracv<itsOverSample,
-				   "Fractional offset in v exceeds oversampling, vScaled="<<vScaled<<" iv="<<iv<<" oversample="<<itsOverSample<<" fracv="<<fracv);
-		   iv+=itsShape(1)/2;
+                  const double vScaled=frequencyList[chan]*outUVW(i)(1)/(casa::C::c *itsUVCellSize(1));
+                  int iv = askap::nint(vScaled);
+                  int fracv=askap::nint(itsOverSample*(double(iv)-vScaled));
+                  if (fracv<0) {
+                      iv+=1;
+                      fracv += itsOverSample;
+                  } else if (fracv>=itsOverSample) {
+                      iv-=1;
+                      fracv -= itsOverSample;
+                  }
+                  ASKAPCHECK(fracv>-1, "Fractional offset in v is negative, vScaled="<<vScaled<<" iv="<<iv<<" oversample="<<itsOverSample<<" fracv="<<fracv);
+                  ASKAPCHECK(fracv<itsOverSample,
+                      "Fractional offset in v exceeds oversampling, vScaled="<<vScaled<<" iv="<<iv<<" oversample="<<itsOverSample<<" fracv="<<fracv);
+                  iv+=itsShape(1)/2;
 		   
-		   // Calculate the delay phasor
-		   const double phase=2.0f*casa::C::pi*frequencyList[chan]*delay(i)/(casa::C::c);
-			          
-		   const casa::Complex phasor(cos(phase), sin(phase));
+                  // Calculate the delay phasor
+                  const double phase=2.0f*casa::C::pi*frequencyList[chan]*delay(i)/(casa::C::c);
+                  itsPhasorBuffer[visIndex] = casa::Complex(cos(phase), sin(phase));
 		   
-		   bool allPolGood=true;
-		   for (uint pol=0; pol<nPol; ++pol) {
-			   if (acc.flag()(i, chan, pol))
-				   allPolGood=false;
-		   }
-  
-           /*
-           // temporary for debugging
-           if (allPolGood && !itsFreqMapper.isMapped(chan)) {
-              ASKAPLOG_DEBUG_STR(logger, "Channel "<<chan<<" is not mapped to the image cube");       
-           }
-           */
+                  bool allPolGood=true;
+                  for (uint pol=0; pol<nPol; ++pol) {
+                       if (acc.flag()(i, chan, pol))
+                           allPolGood=false;
+                  }
            
-		   // Ensure that we only use unflagged data, incomplete polarisation vectors are 
-		   // ignored
-		   // @todo Be more careful about matching polarizations
-		   if (allPolGood && itsFreqMapper.isMapped(chan)) {
-		     // obtain which channel of the image this accessor channel is mapped to
-		     const int imageChan = itsFreqMapper(chan);
-
-             // number of polarisation planes in the grid
-			 const casa::uInt nImagePols = (shape().nelements()<=2) ? 1 : shape()[2];
-			 
-			 // a buffer for the visibility vector in the polarisation frame used for the grid
-			 casa::Vector<casa::Complex> imagePolFrameVis(nImagePols,casa::Complex(0.,0.));
-             casa::Vector<casa::Complex> imagePolFrameNoise(nImagePols);
-             
-             if (!forward) {
-                 if (!isPSFGridder()) {
-                     imagePolFrameVis = gridPolConv(syncHelper.zVector(acc.visibility(),i,chan));			     
-                 }
-                 // we just don't need this quantity for the forward gridder, although there would be no
-                 // harm to always compute it
-                 imagePolFrameNoise = gridPolConv.noise(syncHelper.zVector(acc.noise(),i,chan));			     
-             }		 
+                  // Ensure that we only use unflagged data, incomplete polarisation vectors are 
+                  // ignored
+                  // @todo Be more careful about matching polarizations
+                  if (!allPolGood || !itsFreqMapper.isMapped(chan)) {
+                      if (!forward) {
+                          itsVectorsFlagged+=1;
+                      } 
+                      continue;
+                  }
+                  
+                  // obtain which channel of the image this accessor channel is mapped to
+                  const int imageChan = itsFreqMapper(chan);
+                  
+                  if (!forward) {
+                      if (!isPSFGridder()) {
+                          const casa::Vector<casa::Complex> imagePolFrameVis = 
+                                gridPolConv(syncHelper.zVector(acc.visibility(),i,chan));
+                          ASKAPDEBUGASSERT(imagePolFrameVis.nelements() == nImagePols);
+                          for (uint pol=0; pol<nImagePols; ++pol) {
+                               itsVisBuffer[visIndex * nImagePols + pol] = imagePolFrameVis[pol];
+                          }
+                      }
+                      // we just don't need this quantity for the forward gridder
+                      const casa::Vector<casa::Complex> imagePolFrameNoise = 
+                                gridPolConv.noise(syncHelper.zVector(acc.noise(),i,chan));
+                      ASKAPDEBUGASSERT(imagePolFrameNoise.nelements() == nImagePols);
+                      for (uint pol=0; pol<nImagePols; ++pol) {
+                           const casa::Complex visComplexNoise = imagePolFrameNoise[pol];
+                           const float visNoise = casa::square(casa::real(visComplexNoise));
+                           // positivity is checked in gridOps for the samples actually gridded
+                           const float visNoiseWt = (visNoise > 0.) ? 1./visNoise : 0.;
+                           itsNoiseWtBuffer[visIndex * nImagePols + pol] = visNoiseWt;
+                      }
+                  }		 
 		     
-            // Now loop over all image polarizations
-            for (uint pol=0; pol<nImagePols; ++pol) {
-	         // Lookup the portion of grid to be
-	         // used for this row, polarisation and channel
-                 const int gInd=gIndex(i, pol, chan);
-	         ASKAPCHECK(gInd>-1,"Index into image grid is less than zero");
-                 ASKAPCHECK(gInd<int(itsGrid.size()), "Index into image grid exceeds number of planes");
-			   			   
-                 /// Make a slicer to extract just this plane
-                 const casa::IPosition ipStart(4, 0, 0, pol, imageChan);
-                 const casa::Slicer slicer(ipStart, onePlane4D);
+                  // Now loop over all image polarizations
+                  for (uint pol=0; pol<nImagePols; ++pol) {
+                       // Lookup the portion of grid to be
+                       // used for this row, polarisation and channel
+                       const int gInd=gIndex(i, pol, chan);
+                       ASKAPCHECK(gInd>-1,"Index into image grid is less than zero");
+                       ASKAPCHECK(gInd<int(itsGrid.size()), "Index into image grid exceeds number of planes");
+                       ASKAPDEBUGASSERT(itsGrid[gInd].contiguousStorage());
 			   
-                 // Lookup the convolution function to be
-                 // used for this row, polarisation and channel
-                 // cIndex gives the index for this row, polarization and channel. On top of
-                 // that, we need to adjust for the oversampling since each oversampled
-                 // plane is kept as a separate matrix.
-                 const int beforeOversamplePlaneIndex = cIndex(i,pol,chan);
-                 const int cInd=fracu+itsOverSample*(fracv+itsOverSample*beforeOversamplePlaneIndex);
-                 ASKAPCHECK(cInd>-1,"Index into convolution functions is less than zero");
-                 ASKAPCHECK(cInd<int(itsConvFunc.size()),
-                            "Index into convolution functions exceeds number of planes");
+                       // Lookup the convolution function to be
+                       // used for this row, polarisation and channel
+                       // cIndex gives the index for this row, polarization and channel. On top of
+                       // that, we need to adjust for the oversampling since each oversampled
+                       // plane is kept as a separate matrix.
+                       const int beforeOversamplePlaneIndex = cIndex(i,pol,chan);
+                       const int cInd=fracu+itsOverSample*(fracv+itsOverSample*beforeOversamplePlaneIndex);
+                       ASKAPCHECK(cInd>-1,"Index into convolution functions is less than zero");
+                       ASKAPCHECK(cInd<int(itsConvFunc.size()),
+                                  "Index into convolution functions exceeds number of planes");
 			   
-                 casa::Matrix<casa::Complex> & convFunc(itsConvFunc[cInd]);
-
-                 // support only square convolution functions at the moment
-                 ASKAPDEBUGASSERT(convFunc.nrow() == convFunc.ncolumn());
-                 ASKAPCHECK(convFunc.nrow() % 2 == 1, 
-                            "Expect convolution function with an odd number of pixels for each axis, CF["<<cInd<<
-                            "] has shape="<<convFunc.shape());
-                 // we now use support size for this given plane in the CF cache; itsSupport is a maximum
-                 // support across all CFs (this allows plane-dependent support size)      
-                 const int support = (int(convFunc.nrow()) - 1) / 2;
-                 ASKAPCHECK(support > 0, "Support must be greater than zero, CF["<<cInd<<"] has shape="<<
-                            convFunc.shape()<<" giving a support of "<<support);
-                
-                 casa::Array<casa::Complex> aGrid(itsGrid[gInd](slicer));
-                 casa::Matrix<casa::Complex> grid(aGrid.nonDegenerate());
+                       const casa::Matrix<casa::Complex> & convFunc(itsConvFunc[cInd]);
+
+                       // support only square convolution functions at the moment
+                       ASKAPDEBUGASSERT(convFunc.nrow() == convFunc.ncolumn());
+                       ASKAPCHECK(convFunc.nrow() % 2 == 1, 
+                                  "Expect convolution function with an odd number of pixels for each axis, CF["<<cInd<<
+                                  "] has shape="<<convFunc.shape());
+                       // we now use support size for this given plane in the CF cache; itsSupport is a maximum
+                       // support across all CFs (this allows plane-dependent support size)      
+                       const int support = (int(convFunc.nrow()) - 1) / 2;
+                       ASKAPCHECK(support > 0, "Support must be greater than zero, CF["<<cInd<<"] has shape="<<
+                                  convFunc.shape()<<" giving a support of "<<support);
+                       ASKAPDEBUGASSERT(convFunc.contiguousStorage());
   
-                 // the following accounts for a possible offset of the convolution function
-                 const std::pair<int,int> cfOffset = getConvFuncOffset(beforeOversamplePlaneIndex);
-                 const int iuOffset = iu + cfOffset.first;
-                 const int ivOffset = iv + cfOffset.second;
-
-                 
-                 
-                 /*
-                 if (isPSFGridder()) {
-                     if (i!=0) continue;
-                     std::cout<<"sample "<<i<<" iu="<<iu<<" uScaled="<<uScaled<<" fracu="<<fracu<<" "<<
-                            "iv="<<iv<<" vScaled="<<vScaled<<" fracv="<<fracv<<
-                            " wplane="<<beforeOversamplePlaneIndex<<std::endl;
-                 }
-                 */
-                 
+                       // the following accounts for a possible offset of the convolution function
+                       const std::pair<int,int> cfOffset = getConvFuncOffset(beforeOversamplePlaneIndex);
+                       const int iuOffset = iu + cfOffset.first;
+                       const int ivOffset = iv + cfOffset.second;
 			   
-                 /// Need to check if this point lies on the grid (taking into 
-                 /// account the support)
-	         if (((iuOffset-support)>0)&&((ivOffset-support)>0)&&
-	             ((iuOffset+support) <itsShape(0))&&((ivOffset+support)<itsShape(1))) {
-                     if (forward) {
-                         casa::Complex cVis(0.,0.);
-                         GridKernel::degrid(cVis, convFunc, grid, iuOffset, ivOffset, support);
-                         itsSamplesDegridded+=1.0;
-                         itsNumberDegridded+=double((2*support+1)*(2*support+1));
-                         if (itsVisWeight) {
-                             cVis *= itsVisWeight->getWeight(i,frequencyList[chan],pol);
-                         }
-                         imagePolFrameVis[pol] += cVis*phasor;
-                     } else {
-                         const casa::Complex visComplexNoise = imagePolFrameNoise[pol];
-                          
-                         const float visNoise = casa::square(casa::real(visComplexNoise));
-                         //const float visNoise = casa::norm(visComplexNoise);
-                         const float visNoiseWt = (visNoise > 0.) ? 1./visNoise : 0.;
-                         ASKAPCHECK(visNoiseWt>0., "Weight is supposed to be a positive number; visNoiseWt="<<
-                                    visNoiseWt<<" visNoise="<<visNoise<<" visComplexNoise="<<visComplexNoise);
-                         
-                         // row in itsSumWeights to work with
-                         const int sumWeightsRow = itsTrackWeightPerOversamplePlane ? cInd : beforeOversamplePlaneIndex;
+                       /// Need to check if this point lies on the grid (taking into 
+                       /// account the support)
+                       if (((iuOffset-support)>0)&&((ivOffset-support)>0)&&
+                           ((iuOffset+support) <itsShape(0))&&((ivOffset+support)<itsShape(1))) {
+                           if (!forward && isPSFGridder() && !psfRow) {
+                               // only representative feed and field are used for the PSF
+                               continue;
+                           }
+                           GridOp op;
+                           // the plane is given by image polarisation and channel (see the grid shape), 
+                           // u is the fastest varying axis
+                           op.gridPtr = itsGrid[gInd].data() + gridPlaneSize * (long(pol) + long(nImagePols) * long(imageChan)) +
+                                        long(ivOffset - support) * gridStride + (iuOffset - support);
+                           op.cfPtr = convFunc.data();
+                           op.cfStride = int(convFunc.nrow());
+                           op.patchSize = 2 * support;
+                           op.vStart = ivOffset - support;
+                           op.visIndex = visIndex * nImagePols + pol;
+                           op.visWeight = itsVisWeight ? itsVisWeight->getWeight(i,frequencyList[chan],pol) : 1.;
+                           op.sumWeightsPtr = 0;
+                           if (!forward) {
+                               // row in itsSumWeights to work with
+                               const int sumWeightsRow = itsTrackWeightPerOversamplePlane ? cInd : beforeOversamplePlaneIndex;
       
-                         ASKAPCHECK(itsSumWeights.nelements()>0, "Sum of weights not yet initialised");
-                         ASKAPDEBUGASSERT(itsSumWeights.shape().nelements() >= 3);
-                         ASKAPCHECK(sumWeightsRow < int(itsSumWeights.shape()(0)),
-                                    "Index into itsSumWeights of " << sumWeightsRow << " is greater than allowed " << 
-                                     int(itsSumWeights.shape()(0)));
-                         ASKAPDEBUGASSERT(pol < uint(itsSumWeights.shape()(1)));
-                         ASKAPDEBUGASSERT(imageChan < int(itsSumWeights.shape()(2)));
-                                  
-                         if (!isPSFGridder()) {
-                             /// Gridding visibility data onto grid
-                             casa::Complex rVis = phasor*conj(imagePolFrameVis[pol])*visNoiseWt;
-                             if (itsVisWeight) {
-                                 rVis *= itsVisWeight->getWeight(i,frequencyList[chan],pol);
-                             }
-				   
-                             GridKernel::grid(grid, convFunc, rVis, iuOffset, ivOffset, support);
-          
-                             itsSamplesGridded+=1.0;
-                             itsNumberGridded+=double((2*support+1)*(2*support+1));
-      
-                             itsSumWeights(sumWeightsRow, pol, imageChan) += visNoiseWt; //1.0;
-                         }
-                         /// Grid PSF?
-                         if (isPSFGridder() && (itsUseAllDataForPSF || ((itsFeedUsedForPSF == acc.feed1()(i)) &&
-                             (itsPointingUsedForPSF.separation(acc.dishPointing1()(i))<1e-6)))) {
-                              casa::Complex uVis(1.,0.);
-                              uVis *= visNoiseWt;
-                              if (itsVisWeight) {
-                                  uVis *= itsVisWeight->getWeight(i,frequencyList[chan],pol);
-                              }
-                              GridKernel::grid(grid, convFunc, uVis, iuOffset, ivOffset, support);
-                      
-                              itsSamplesGridded+=1.0;
-                              itsNumberGridded+=double((2*support+1)*(2*support+1));
-    
-                              itsSumWeights(sumWeightsRow, pol, imageChan) += visNoiseWt; //1.0;               
-                         } // end if psf needs to be done
-		     } // end if forward (else case, reverse operation)
-                 } // end of on-grid if statement
-            }//end of pol loop
-	    // need to write back the result for degridding
-            if (forward) {
-                casa::Vector<casa::Complex> thisPolVector = acc.rwVisibility().yzPlane(i).row(chan);
-	            thisPolVector += degridPolConv(imagePolFrameVis);
-            }		     
-         } else { 
-            if (!forward) {
-                itsVectorsFlagged+=1;
-	    } 
-         } // end of if (allPolGood), else statement
-      }//end of chan loop
-   }//end of i loop
+                               ASKAPCHECK(itsSumWeights.nelements()>0, "Sum of weights not yet initialised");
+                               ASKAPDEBUGASSERT(itsSumWeights.shape().nelements() >= 3);
+                               ASKAPCHECK(sumWeightsRow < int(itsSumWeights.shape()(0)),
+                                          "Index into itsSumWeights of " << sumWeightsRow << " is greater than allowed " << 
+                                          int(itsSumWeights.shape()(0)));
+                               ASKAPDEBUGASSERT(pol < uint(itsSumWeights.shape()(1)));
+                               ASKAPDEBUGASSERT(imageChan < int(itsSumWeights.shape()(2)));
+                               op.sumWeightsPtr = &itsSumWeights(sumWeightsRow, pol, imageChan);
+                           }
+                           itsGridOps.push_back(op);
+                       } // end of on-grid if statement
+                  } // end of pol loop
+             } // end of chan loop
+        } // end of i loop
+        
+        // Stage 2: the kernel loop, no virtual calls or array views beyond this point
+        if (forward) {
+            degridOps(nImagePols, gridStride);
+        } else {
+            gridOps(nImagePols, gridStride);
+        }
+        
+        // need to write back the result for degridding
+        if (forward) {
+            casa::Vector<casa::Complex> imagePolFrameVis(nImagePols);
+            for (uint i = blockStart; i < blockEnd; ++i) {
+                 for (uint chan=0; chan<nChan; ++chan) {
+                      const uint visIndex = (i - blockStart) * nChan + chan;
+                      bool nonZero = false;
+                      for (uint pol=0; pol<nImagePols; ++pol) {
+                           imagePolFrameVis[pol] = itsVisBuffer[visIndex * nImagePols + pol];
+                           nonZero |= (imagePolFrameVis[pol] != casa::Complex(0.,0.));
+                      }
+                      if (nonZero) {
+                          casa::Vector<casa::Complex> thisPolVector = acc.rwVisibility().yzPlane(i).row(chan);
+                          thisPolVector += degridPolConv(imagePolFrameVis);
+                      }
+                 }
+            }
+        }
+   } // end of block loop
    if (forward) {
        itsTimeDegridded+=timer.real();
    } else {
@@ -722,6 +723,132 @@ void TableVisGridder::generic(accessors::IDataAccessor& acc, bool forward) {
    }
 }
 
+/// @brief set the number of threads used for gridding and degridding
+/// @param[in] nThreads number of threads
+void TableVisGridder::setNumberOfThreads(const int nThreads)
+{
+   ASKAPCHECK(nThreads > 0, "Number of gridding threads should be positive, you have "<<nThreads);
+   #ifndef _OPENMP
+   if (nThreads > 1) {
+       ASKAPLOG_WARN_STR(logger, "Multi-threaded gridding requires OpenMP, "<<nThreads<<
+                         " threads requested, but serial gridding will be done");
+   }
+   #endif
+   itsNumberOfThreads = nThreads;
+}
+
+/// @brief degrid all operations in itsGridOps
+/// @details The result is accumulated in itsVisBuffer. Each operation writes into its own
+/// element of the buffer, so the operations are distributed between threads without any
+/// synchronisation, if multi-threaded gridding is enabled.
+/// @param[in] nImagePols number of polarisation planes in the grid
+/// @param[in] gridStride stride between adjacent v rows of the grid
+void TableVisGridder::degridOps(const casa::uInt nImagePols, const int gridStride)
+{
+   const long nOps = long(itsGridOps.size());
+   #ifdef _OPENMP
+   #pragma omp parallel for schedule(static) num_threads(itsNumberOfThreads) if (itsNumberOfThreads > 1)
+   #endif
+   for (long index = 0; index < nOps; ++index) {
+        const GridOp &op = itsGridOps[index];
+        casa::Complex cVis = GridKernel::degridPatch(op.cfPtr, op.cfStride, op.gridPtr, gridStride,
+                                                     op.patchSize, op.patchSize);
+        if (itsVisWeight) {
+            cVis *= op.visWeight;
+        }
+        itsVisBuffer[op.visIndex] += cVis*itsPhasorBuffer[op.visIndex / nImagePols];
+   }
+   for (long index = 0; index < nOps; ++index) {
+        const int patchSize = itsGridOps[index].patchSize;
+        itsSamplesDegridded+=1.0;
+        itsNumberDegridded+=double((patchSize+1)*(patchSize+1));
+   }
+}
+
+/// @brief grid all operations in itsGridOps
+/// @details The noise weight of each operation is checked to be positive before any
+/// gridding is done. In the multi-threaded mode the uv-plane is split into strips along v with
+/// the height not less than the largest patch size. Each operation is assigned to the
+/// strip containing the first v row of its patch, so it can only touch this strip and
+/// the next one. Therefore, all even strips can be gridded in parallel without any locks,
+/// followed by all odd strips. Within the strip, the operations are done in the original
+/// order. Weights and statistics are always accumulated by the calling thread.
+/// @param[in] nImagePols number of polarisation planes in the grid
+/// @param[in] gridStride stride between adjacent v rows of the grid
+void TableVisGridder::gridOps(const casa::uInt nImagePols, const int gridStride)
+{
+   const long nOps = long(itsGridOps.size());
+   for (long index = 0; index < nOps; ++index) {
+        const GridOp &op = itsGridOps[index];
+        ASKAPDEBUGASSERT(op.sumWeightsPtr);
+        const float visNoiseWt = itsNoiseWtBuffer[op.visIndex];
+        ASKAPCHECK(visNoiseWt>0., "Weight is supposed to be a positive number; visNoiseWt="<<
+                   visNoiseWt<<" for visibility index "<<op.visIndex);
+        *(op.sumWeightsPtr) += visNoiseWt;
+        itsSamplesGridded+=1.0;
+        itsNumberGridded+=double((op.patchSize+1)*(op.patchSize+1));
+   }
+   
+   #ifdef _OPENMP
+   if ((itsNumberOfThreads > 1) && (nOps > 1)) {
+       // strip height
+       int stripHeight = 1;
+       for (long index = 0; index < nOps; ++index) {
+            stripHeight = std::max(stripHeight, itsGridOps[index].patchSize);
+       }
+       const int nStrips = itsShape(1) / stripHeight + 1;
+       // bucket sort of operations by strips preserving the order within each strip
+       std::vector<long> stripStart(nStrips + 1, 0);
+       for (long index = 0; index < nOps; ++index) {
+            ++stripStart[itsGridOps[index].vStart / stripHeight + 1];
+       }
+       for (int strip = 0; strip < nStrips; ++strip) {
+            stripStart[strip + 1] += stripStart[strip];
+       }
+       itsGridOpOrder.resize(nOps);
+       {
+          std::vector<long> fillPos(stripStart.begin(), stripStart.end() - 1);
+          for (long index = 0; index < nOps; ++index) {
+               itsGridOpOrder[fillPos[itsGridOps[index].vStart / stripHeight]++] = index;
+          }
+       }
+       for (int parity = 0; parity < 2; ++parity) {
+            #pragma omp parallel for schedule(dynamic) num_threads(itsNumberOfThreads)
+            for (int strip = parity; strip < nStrips; strip += 2) {
+                 for (long pos = stripStart[strip]; pos < stripStart[strip + 1]; ++pos) {
+                      gridOne(itsGridOps[itsGridOpOrder[pos]], nImagePols, gridStride);
+                 }
+            }
+       }
+       return;
+   }
+   #endif
+   for (long index = 0; index < nOps; ++index) {
+        gridOne(itsGridOps[index], nImagePols, gridStride);
+   }
+}
+
+/// @brief grid one operation
+/// @param[in] op grid operation 
+/// @param[in] nImagePols number of polarisation planes in the grid
+/// @param[in] gridStride stride between adjacent v rows of the grid
+inline void TableVisGridder::gridOne(const GridOp &op, const casa::uInt nImagePols, const int gridStride)
+{
+   const float visNoiseWt = itsNoiseWtBuffer[op.visIndex];
+   casa::Complex rVis(1.,0.);
+   if (isPSFGridder()) {
+       rVis *= visNoiseWt;
+   } else {
+       /// Gridding visibility data onto grid
+       rVis = itsPhasorBuffer[op.visIndex / nImagePols]*conj(itsVisBuffer[op.visIndex])*visNoiseWt;
+   }
+   if (itsVisWeight) {
+       rVis *= op.visWeight;
+   }
+   GridKernel::gridPatch(op.gridPtr, gridStride, op.cfPtr, op.cfStride, rVis, 
+                         op.patchSize, op.patchSize);
+}
+
 /// @brief correct visibilities, if necessary
 /// @details This method is intended for on-the-fly correction of visibilities (i.e. 
 /// facet-based correction needed for LOFAR). This method does nothing in this class, but
@@ -39,6 +39,7 @@
 
 // std includes
 #include <string>
+#include <vector>
 
 // casa includes
 #include <casa/BasicSL/Complex.h>
@@ -173,6 +174,21 @@ namespace askap
       /// @param[in] threshold largest allowed angular separation in radians, use negative value to select all data
       void inline maxPointingSeparation(double threshold = -1.) { itsMaxPointingSeparation = threshold; }
 
+      /// @brief set the number of threads used for gridding and degridding
+      /// @details Samples of each accessor can be gridded by a number of threads at once.
+      /// For gridding, the uv-plane is split into strips which are processed in two
+      /// passes (even and odd strips) without any locks, so the same grid is shared between
+      /// threads. This works for all gridders derived from this class and is only effective
+      /// if the code is compiled with OpenMP. The default is 1 (i.e. serial gridding).
+      /// Gridders computing convolution functions on the fly (e.g. w- and aw-projection)
+      /// use the same number of threads to generate planes of the CF cache.
+      /// @param[in] nThreads number of threads
+      void setNumberOfThreads(const int nThreads);
+
+      /// @brief obtain the number of threads used for gridding and degridding
+      /// @return number of threads set by setNumberOfThreads (1 by default)
+      inline int numberOfThreads() const { return itsNumberOfThreads; }
+
       /// @brief set table name to store the CFs to
       /// @details This method makes it possible to enable writing CFs to disk in destructor after the 
       /// gridder is created. The main use case is to allow a better control of this feature in the parallel
@@ -538,6 +554,67 @@ protected:
       /// @brief true, if itsSumWeights tracks weights per oversampling plane
       bool itsTrackWeightPerOversamplePlane;
 
+      /// @brief precomputed parameters of a single (de)gridding operation
+      /// @details generic() converts all samples of a block of accessor rows into
+      /// a flat table of these structures first (coordinate conversion, index lookups
+      /// via virtual cIndex/gIndex and all consistency checks are done at this stage). 
+      /// The kernel loop then runs through this table with raw pointers only.
+      struct GridOp {
+         /// @brief bottom left corner of the affected patch of the grid
+         casa::Complex *gridPtr;
+         /// @brief bottom left corner of the convolution function
+         const casa::Complex *cfPtr;
+         /// @brief stride between adjacent v rows of the convolution function
+         int cfStride;
+         /// @brief size of the patch in both u and v (2*support)
+         int patchSize;
+         /// @brief index into itsVisBuffer/itsNoiseWtBuffer (sample*nImagePols+pol)
+         casa::uInt visIndex;
+         /// @brief visibility weight (from itsVisWeight, if defined)
+         float visWeight;
+         /// @brief element of itsSumWeights to update (gridding only)
+         double *sumWeightsPtr;
+         /// @brief first row (v) of the grid affected by this operation
+         int vStart;
+      };
+
+      /// @brief degrid all operations in itsGridOps
+      /// @details The result is accumulated in itsVisBuffer.
+      /// @param[in] nImagePols number of polarisation planes in the grid
+      /// @param[in] gridStride stride between adjacent v rows of the grid
+      void degridOps(const casa::uInt nImagePols, const int gridStride);
+
+      /// @brief grid all operations in itsGridOps
+      /// @details This method uses multiple threads if allowed by itsNumberOfThreads.
+      /// @param[in] nImagePols number of polarisation planes in the grid
+      /// @param[in] gridStride stride between adjacent v rows of the grid
+      void gridOps(const casa::uInt nImagePols, const int gridStride);
+
+      /// @brief grid one operation
+      /// @param[in] op grid operation 
+      /// @param[in] nImagePols number of polarisation planes in the grid
+      /// @param[in] gridStride stride between adjacent v rows of the grid
+      void gridOne(const GridOp &op, const casa::uInt nImagePols, const int gridStride);
+
+      /// @brief table of grid operations for the current block of data
+      std::vector<GridOp> itsGridOps;
+
+      /// @brief order in which itsGridOps are processed in the multi-threaded mode
+      std::vector<long> itsGridOpOrder;
+
+      /// @brief delay phasor for each (row, channel) of the current block of data
+      std::vector<casa::Complex> itsPhasorBuffer;
+
+      /// @brief visibilities in the grid polarisation frame for each (row, channel, pol)
+      /// @details Input for gridding and accumulated result for degridding
+      std::vector<casa::Complex> itsVisBuffer;
+
+      /// @brief noise-based weight for each (row, channel, pol), used for gridding only
+      std::vector<float> itsNoiseWtBuffer;
+
+      /// @brief number of threads used to grid/degrid data from a single accessor
+      int itsNumberOfThreads;
+
       #ifdef _OPENMP
       /// @brief synchronisation mutex
       mutable boost::mutex itsMutex;
@@ -33,6 +33,7 @@
 
 #include <casa/Quanta/MVDirection.h>
 #include <casa/Quanta/Quantum.h>
+#include <casa/OS/Timer.h>
 
 #include <askap_synthesis.h>
 #include <askap/AskapLogging.h>
@@ -144,17 +145,29 @@ void TestCFGenPerformance::initialiseGrid(const scimath::Axes& axes,
 }
 
 /// @brief main method which initialises CFs
-/// @details 
+/// @details The time taken by each run is reported along with the average
+/// rate of CF generation (in w-planes per second).
 /// @param[in] nRuns number of initialisations
 void TestCFGenPerformance::run(const int nRuns)
 {
+  casa::Timer timer;
+  double totalTime = 0.;
   for (int i=0; i<nRuns; ++i) {
        ASKAPLOG_INFO_STR(logger, "CF generation run "<<(i+1));
+       timer.mark();
        initIndices(itsAccessor);
        initConvolutionFunction(itsAccessor);
+       const double runTime = timer.real();
+       totalTime += runTime;
+       ASKAPLOG_INFO_STR(logger, "Run "<<(i+1)<<": "<<itsNBeams * nWPlanes()<<" w-planes generated in "<<
+                         runTime<<" seconds using "<<nCFThreads()<<" thread(s)");
        // force recalculation
        resetCFCache();
   }
+  if ((nRuns > 0) && (totalTime > 0.)) {
+      ASKAPLOG_INFO_STR(logger, "Average CF generation rate: "<<double(itsNBeams * nWPlanes() * nRuns) / totalTime<<
+                        " w-planes per second");
+  }
 }
 
 
@@ -99,7 +99,8 @@ public:
   static boost::shared_ptr<TestCFGenPerformance> createGridder(const LOFAR::ParameterSet& parset);
 
   /// @brief main method which initialises CFs
-  /// @details 
+  /// @details The time taken by each run is reported along with the average
+  /// rate of CF generation (in w-planes per second).
   /// @param[in] nRuns number of initialisations
   void run(const int nRuns = 1);
   
@@ -182,6 +182,17 @@ IVisGridder::ShPtr VisGridderFactory::make(const LOFAR::ParameterSet &parset) {
 	   }
 	}	
 	
+	if (parset.isDefined("gridder.nthreads")) {
+	    const casa::Int nThreads = parset.getInt32("gridder.nthreads");
+	    ASKAPCHECK(nThreads > 0, "gridder.nthreads should be positive, you have "<<nThreads);
+	    ASKAPLOG_INFO_STR(logger, "Each accessor will be gridded by "<<nThreads<<" thread(s)");
+	    boost::shared_ptr<TableVisGridder> tvg = 
+	        boost::dynamic_pointer_cast<TableVisGridder>(gridder);
+	    ASKAPCHECK(tvg, "Gridder type ("<<parset.getString("gridder")<<
+	               ") is incompatible with the nthreads option");
+	    tvg->setNumberOfThreads(nThreads);
+	}
+
 	// Initialize the Visibility Weights
 	if (parset.getString("visweights","")=="MFS")
 	{
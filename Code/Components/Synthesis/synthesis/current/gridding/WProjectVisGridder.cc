@@ -41,6 +41,17 @@
 #include <gridding/WProjectVisGridder.h>
 #include <gridding/SupportSearcher.h>
 
+// std includes
+#include <string>
+#include <sstream>
+#include <iomanip>
+#include <vector>
+#include <utility>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 ASKAP_LOGGER(logger, ".gridding.wprojectvisgridder");
 
 namespace askap {
@@ -80,7 +91,8 @@ WProjectVisGridder::WProjectVisGridder(const WProjectVisGridder &other) :
         itsCutoff(other.itsCutoff), itsLimitSupport(other.itsLimitSupport),
         itsPlaneDependentCFSupport(other.itsPlaneDependentCFSupport),
         itsOffsetSupportAllowed(other.itsOffsetSupportAllowed),
-        itsCutoffAbs(other.itsCutoffAbs) {}
+        itsCutoffAbs(other.itsCutoffAbs), itsCFCacheDir(other.itsCFCacheDir),
+        itsCFCacheFile(other.itsCFCacheFile) {}
 
 
 /// Clone a copy of this Gridder
@@ -156,6 +168,11 @@ void WProjectVisGridder::initConvolutionFunction(const accessors::IConstDataAcce
         initConvFuncOffsets(nWPlanes());
     }
 
+    // convolution functions may have been computed for the same parameters by another
+    // process (or a previous run), reuse them if available
+    if ((itsCFCacheDir != "") && loadCFCache()) {
+        return;
+    }
 
     /// These are the actual cell sizes used
     const double cellx = 1.0 / (double(itsShape(0)) * itsUVCellSize(0));
@@ -203,129 +220,41 @@ void WProjectVisGridder::initConvolutionFunction(const accessors::IConstDataAcce
 
     // We pad here to do sinc interpolation of the convolution
     // function in uv space
-    casa::Matrix<casa::DComplex> thisPlane = getCFBuffer();
-    ASKAPDEBUGASSERT(thisPlane.nrow() == casa::uInt(nx));
-    ASKAPDEBUGASSERT(thisPlane.ncolumn() == casa::uInt(ny));
-
-    for (int iw = 0; iw < nWPlanes(); ++iw) {
-        thisPlane.set(0.0);
-
-        //const double w = isPSFGridder() ? 0. : 2.0f*casa::C::pi*getWTerm(iw);
-        const double w = 2.0f * casa::C::pi * getWTerm(iw);
-
-        // Loop over the central nx, ny region, setting it to the product
-        // of the phase screen and the spheroidal function
-        for (int iy = 0; iy < qny; iy++) {
-            double y2 = double(iy - qny / 2) * ccelly;
-            y2 *= y2;
-
-            for (int ix = 0; ix < qnx; ix++) {
-                double x2 = double(ix - qnx / 2) * ccellx;
-                x2 *= x2;
-                const float r2 = x2 + y2;
-
-                if (r2 < 1.0) {
-                    const double phase = w * (1.0 - sqrt(1.0 - r2));
-                    const float wt = ccfx(ix) * ccfy(iy);
-                    ASKAPDEBUGASSERT(ix - qnx / 2 + nx / 2 < nx);
-                    ASKAPDEBUGASSERT(iy - qny / 2 + ny / 2 < ny);
-                    ASKAPDEBUGASSERT(ix + nx / 2 >= qnx / 2);
-                    ASKAPDEBUGASSERT(iy + ny / 2 >= qny / 2);
-                    thisPlane(ix - qnx / 2 + nx / 2, iy - qny / 2 + ny / 2) = casa::DComplex(wt * cos(phase), -wt * sin(phase));
-                    //thisPlane(ix-qnx/2+nx/2, iy-qny/2+ny/2)=casa::DComplex(wt*cos(phase));
-                }
-            }
-        }
-
-        // At this point, we have the phase screen multiplied by the spheroidal
-        // function, sampled on larger cellsize (itsOverSample larger) in image
-        // space. Only the inner qnx, qny pixels have a non-zero value
-
-        // Now we have to calculate the Fourier transform to get the
-        // convolution function in uv space
-        //casa::Matrix<casa::DComplex> buffer(thisPlane.nrow(),thisPlane.ncolumn());
-        //casa::convertArray<casa::DComplex,casa::Complex>(buffer,thisPlane);
-        scimath::fft2d(thisPlane, true);
-        //scimath::fft2d(buffer, true);
-        //casa::convertArray<casa::Complex,casa::DComplex>(thisPlane,buffer);
-
-
-        /*
-            for (uint xx=0;xx<thisPlane.nrow();++xx) {
-             for (uint yy=0;yy<thisPlane.ncolumn();++yy) {
-                  ASKAPCHECK(!std::isinf(casa::abs(thisPlane(xx,yy))), "Infinite value detected for plane="<<iw<<" at "<<xx<<","<<yy<<" "<<thisPlane(xx,yy));
-                 }
-        }
-        */
-
-        // Now thisPlane is filled with convolution function
-        // sampled on a finer grid in u,v
-        //
-        // If the support is not yet set, find it and size the
-        // convolution function appropriately
-
-        // by default the common support without offset is used
-        CFSupport cfSupport(itsSupport);
-
-        if (isSupportPlaneDependent() || (itsSupport == 0)) {
-            cfSupport = extractSupport(thisPlane);
-            const int support = cfSupport.itsSize;
-
-            ASKAPCHECK(support*itsOverSample < nx / 2,
-                       "Overflowing convolution function for w-plane " << iw <<
-                       " - increase maxSupport or decrease overSample; support=" << support << " oversample=" << itsOverSample <<
-                       " nx=" << nx);
-            cfSupport.itsSize = limitSupportIfNecessary(support);
+    ASKAPDEBUGASSERT(nCFThreads() > 0);
+    ASKAPDEBUGASSERT(getCFBuffer().nrow() == casa::uInt(nx));
+    ASKAPDEBUGASSERT(getCFBuffer().ncolumn() == casa::uInt(ny));
+
+    // the first plane defines the common support and is done serially,
+    // all other planes are independent and can be generated concurrently
+    // (each thread uses its own buffer)
+    if (nWPlanes() > 0) {
+        casa::Matrix<casa::DComplex> thisPlane = getCFBuffer();
+        generateWPlane(0, thisPlane, ccfx, ccfy, ccellx, ccelly);
+    }
 
-            if (itsSupport == 0) {
-                itsSupport = cfSupport.itsSize;
-            }
+    const int nThreads = nCFThreads();
+    std::string errorMsg;
 
-            if (isOffsetSupportAllowed()) {
-                setConvFuncOffset(iw, cfSupport.itsOffsetU, cfSupport.itsOffsetV);
-            }
-        }
-
-        ASKAPCHECK(itsConvFunc.size() > 0, "Convolution function not sized correctly");
-        // use either support determined for this particular plane or a generic one,
-        // determined from the first plane (largest support as we have the largest w-term)
-        const int support = isSupportPlaneDependent() ? cfSupport.itsSize : itsSupport;
-
-        const int cSize = 2 * support + 1;
-
-        for (int fracu = 0; fracu < itsOverSample; ++fracu) {
-            for (int fracv = 0; fracv < itsOverSample; ++fracv) {
-                const int plane = fracu + itsOverSample * (fracv + itsOverSample * iw);
-                ASKAPDEBUGASSERT(plane < int(itsConvFunc.size()));
-                itsConvFunc[plane].resize(cSize, cSize);
-                itsConvFunc[plane].set(0.0);
-
-                // Now cut out the inner part of the convolution function and
-                // insert it into the convolution function
-                for (int iy = -support; iy < support; ++iy) {
-                    for (int ix = -support; ix < support; ++ix) {
-                        ASKAPDEBUGASSERT((ix + support >= 0) && (iy + support >= 0));
-                        ASKAPDEBUGASSERT(ix + support < int(itsConvFunc[plane].nrow()));
-                        ASKAPDEBUGASSERT(iy + support < int(itsConvFunc[plane].ncolumn()));
-                        ASKAPDEBUGASSERT((ix + cfSupport.itsOffsetU)*itsOverSample + fracu + nx / 2 >= 0);
-                        ASKAPDEBUGASSERT((iy + cfSupport.itsOffsetV)*itsOverSample + fracv + ny / 2 >= 0);
-                        ASKAPDEBUGASSERT((ix + cfSupport.itsOffsetU)*itsOverSample + fracu + nx / 2 < int(thisPlane.nrow()));
-                        ASKAPDEBUGASSERT((iy + cfSupport.itsOffsetV)*itsOverSample + fracv + ny / 2 < int(thisPlane.ncolumn()));
-                        //if (w < 0) {
-                        //    itsConvFunc[plane](ix + support, iy + support) =
-                        //        conj(thisPlane((ix + cfSupport.itsOffsetU) * itsOverSample + fracu + nx / 2,
-                        //              (iy + cfSupport.itsOffsetV) * itsOverSample + fracv + ny / 2));
-                        //} else {
-                        itsConvFunc[plane](ix + support, iy + support) =
-                            thisPlane((ix + cfSupport.itsOffsetU) * itsOverSample + fracu + nx / 2,
-                                   (iy + cfSupport.itsOffsetV) * itsOverSample + fracv + ny / 2);
-                        //}
-                    } // for ix
-                } // for iy
-            } // for fracv
-        } // for fracu
-
-    } // for iw
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(dynamic) num_threads(nThreads) if (nThreads > 1)
+#endif
+    for (int iw = 1; iw < nWPlanes(); ++iw) {
+         try {
+#ifdef _OPENMP
+             casa::Matrix<casa::DComplex> thisPlane = getCFBuffer(omp_get_thread_num());
+#else
+             casa::Matrix<casa::DComplex> thisPlane = getCFBuffer();
+#endif
+             generateWPlane(iw, thisPlane, ccfx, ccfy, ccellx, ccelly);
+         }
+         catch (const std::exception &ex) {
+#ifdef _OPENMP
+             #pragma omp critical (wprojectcferror)
+#endif
+             errorMsg = ex.what();
+         }
+    }
+    ASKAPCHECK(errorMsg == "", "Convolution function generation failed: "<<errorMsg);
 
     // force normalization for all fractional offsets (or planes)
     for (size_t plane = 0; plane < itsConvFunc.size(); ++plane) {
@@ -360,7 +289,215 @@ void WProjectVisGridder::initConvolutionFunction(const accessors::IConstDataAcce
 
     ASKAPCHECK(itsSupport > 0, "Support not calculated correctly");
     // we can free up the memory because for WProject gridder this method is called only once!
-    itsCFBuffer.reset();
+    itsCFBuffers.clear();
+
+    if (itsCFCacheDir != "") {
+        saveCFCache();
+    }
+}
+
+/// @brief key describing all parameters convolution functions depend on
+/// @details It is used to match the persistent cache of convolution functions.
+/// @return key string
+std::string WProjectVisGridder::cfCacheKey() const
+{
+    std::ostringstream os;
+    os << std::setprecision(17) << gridderName() << ": shape=" << itsShape(0) << "x" << itsShape(1) <<
+       " cell=" << itsUVCellSize(0) << "," << itsUVCellSize(1) << " oversample=" << itsOverSample <<
+       " maxsupport=" << itsMaxSupport << " limitsupport=" << itsLimitSupport << " cutoff=" << itsCutoff <<
+       " abscutoff=" << itsCutoffAbs << " variablesupport=" << itsPlaneDependentCFSupport <<
+       " offsetsupport=" << itsOffsetSupportAllowed << " nwplanes=" << nWPlanes() << " wterms=";
+    // w-terms take care of wmax and non-linear sampling in w
+    for (int iw = 0; iw < nWPlanes(); ++iw) {
+         os << (iw > 0 ? "," : "") << getWTerm(iw);
+    }
+    return os.str();
+}
+
+/// @brief load convolution functions from the persistent cache
+/// @details The file is memory-mapped, so the convolution functions reference
+/// memory shared with other processes using the same file.
+/// @return true, if convolution functions have been loaded
+bool WProjectVisGridder::loadCFCache()
+{
+    const std::string key = cfCacheKey();
+    const std::string name = CFCacheFile::fileName(itsCFCacheDir, gridderName(), key);
+    const boost::shared_ptr<CFCacheFile> cache = CFCacheFile::open(name, key);
+    if (!cache) {
+        return false;
+    }
+    if ((cache->nPlanes() != itsConvFunc.size()) || (cache->support() <= 0) ||
+        (isOffsetSupportAllowed() && (cache->nOffsets() != size_t(nWPlanes())))) {
+        ASKAPLOG_WARN_STR(logger, "CF cache file " << name << " is inconsistent with the gridder setup, ignoring it");
+        return false;
+    }
+    for (size_t plane = 0; plane < itsConvFunc.size(); ++plane) {
+         itsConvFunc[plane].reference(cache->plane(plane));
+    }
+    for (size_t plane = 0; plane < cache->nOffsets(); ++plane) {
+         setConvFuncOffset(int(plane), cache->offset(plane).first, cache->offset(plane).second);
+    }
+    itsSupport = cache->support();
+    itsCFCacheFile = cache;
+    ASKAPLOG_INFO_STR(logger, "Convolution functions (" << itsConvFunc.size() << " planes, support = " <<
+                      itsSupport << ") have been loaded from " << name);
+    return true;
+}
+
+/// @brief save convolution functions to the persistent cache
+void WProjectVisGridder::saveCFCache() const
+{
+    const std::string key = cfCacheKey();
+    const std::string name = CFCacheFile::fileName(itsCFCacheDir, gridderName(), key);
+    std::vector<std::pair<int, int> > offsets;
+    if (isOffsetSupportAllowed()) {
+        offsets.resize(nWPlanes());
+        for (int iw = 0; iw < nWPlanes(); ++iw) {
+             offsets[iw] = getConvFuncOffset(iw);
+        }
+    }
+    if (CFCacheFile::write(name, key, itsConvFunc, offsets, itsSupport)) {
+        ASKAPLOG_INFO_STR(logger, "Convolution functions have been stored in " << name);
+    }
+}
+
+/// @brief generate convolution function for one w-plane
+/// @details This method fills the given buffer with the w-term multiplied by the
+/// spheroidal function, does the FFT and cuts out the support into itsConvFunc.
+/// It is called concurrently for different w-planes, therefore the common support
+/// (itsSupport) must be determined before the concurrent calls, i.e. by
+/// processing the first plane.
+/// @param[in] iw w-plane to generate
+/// @param[in] thisPlane buffer for the full-sized convolution function (used for FFT)
+/// @param[in] ccfx spheroidal function along x
+/// @param[in] ccfy spheroidal function along y
+/// @param[in] ccellx cell size in x (after oversampling)
+/// @param[in] ccelly cell size in y (after oversampling)
+void WProjectVisGridder::generateWPlane(int iw, casa::Matrix<casa::DComplex> &thisPlane,
+                        const casa::Vector<float> &ccfx, const casa::Vector<float> &ccfy,
+                        double ccellx, double ccelly)
+{
+    const int nx = int(thisPlane.nrow());
+    const int ny = int(thisPlane.ncolumn());
+    const int qnx = int(ccfx.nelements());
+    const int qny = int(ccfy.nelements());
+
+    thisPlane.set(0.0);
+
+    //const double w = isPSFGridder() ? 0. : 2.0f*casa::C::pi*getWTerm(iw);
+    const double w = 2.0f * casa::C::pi * getWTerm(iw);
+
+    // Loop over the central nx, ny region, setting it to the product
+    // of the phase screen and the spheroidal function
+    for (int iy = 0; iy < qny; iy++) {
+        double y2 = double(iy - qny / 2) * ccelly;
+        y2 *= y2;
+
+        for (int ix = 0; ix < qnx; ix++) {
+            double x2 = double(ix - qnx / 2) * ccellx;
+            x2 *= x2;
+            const float r2 = x2 + y2;
+
+            if (r2 < 1.0) {
+                const double phase = w * (1.0 - sqrt(1.0 - r2));
+                const float wt = ccfx(ix) * ccfy(iy);
+                ASKAPDEBUGASSERT(ix - qnx / 2 + nx / 2 < nx);
+                ASKAPDEBUGASSERT(iy - qny / 2 + ny / 2 < ny);
+                ASKAPDEBUGASSERT(ix + nx / 2 >= qnx / 2);
+                ASKAPDEBUGASSERT(iy + ny / 2 >= qny / 2);
+                thisPlane(ix - qnx / 2 + nx / 2, iy - qny / 2 + ny / 2) = casa::DComplex(wt * cos(phase), -wt * sin(phase));
+                //thisPlane(ix-qnx/2+nx/2, iy-qny/2+ny/2)=casa::DComplex(wt*cos(phase));
+            }
+        }
+    }
+
+    // At this point, we have the phase screen multiplied by the spheroidal
+    // function, sampled on larger cellsize (itsOverSample larger) in image
+    // space. Only the inner qnx, qny pixels have a non-zero value
+
+    // Now we have to calculate the Fourier transform to get the
+    // convolution function in uv space
+    //casa::Matrix<casa::DComplex> buffer(thisPlane.nrow(),thisPlane.ncolumn());
+    //casa::convertArray<casa::DComplex,casa::Complex>(buffer,thisPlane);
+    scimath::fft2d(thisPlane, true);
+    //scimath::fft2d(buffer, true);
+    //casa::convertArray<casa::Complex,casa::DComplex>(thisPlane,buffer);
+
+
+    /*
+        for (uint xx=0;xx<thisPlane.nrow();++xx) {
+         for (uint yy=0;yy<thisPlane.ncolumn();++yy) {
+              ASKAPCHECK(!std::isinf(casa::abs(thisPlane(xx,yy))), "Infinite value detected for plane="<<iw<<" at "<<xx<<","<<yy<<" "<<thisPlane(xx,yy));
+             }
+    }
+    */
+
+    // Now thisPlane is filled with convolution function
+    // sampled on a finer grid in u,v
+    //
+    // If the support is not yet set, find it and size the
+    // convolution function appropriately
+
+    // by default the common support without offset is used
+    CFSupport cfSupport(itsSupport);
+
+    if (isSupportPlaneDependent() || (itsSupport == 0)) {
+        cfSupport = extractSupport(thisPlane);
+        const int support = cfSupport.itsSize;
+
+        ASKAPCHECK(support*itsOverSample < nx / 2,
+                   "Overflowing convolution function for w-plane " << iw <<
+                   " - increase maxSupport or decrease overSample; support=" << support << " oversample=" << itsOverSample <<
+                   " nx=" << nx);
+        cfSupport.itsSize = limitSupportIfNecessary(support);
+
+        if (itsSupport == 0) {
+            itsSupport = cfSupport.itsSize;
+        }
+
+        if (isOffsetSupportAllowed()) {
+            setConvFuncOffset(iw, cfSupport.itsOffsetU, cfSupport.itsOffsetV);
+        }
+    }
+
+    ASKAPCHECK(itsConvFunc.size() > 0, "Convolution function not sized correctly");
+    // use either support determined for this particular plane or a generic one,
+    // determined from the first plane (largest support as we have the largest w-term)
+    const int support = isSupportPlaneDependent() ? cfSupport.itsSize : itsSupport;
+
+    const int cSize = 2 * support + 1;
+
+    for (int fracu = 0; fracu < itsOverSample; ++fracu) {
+        for (int fracv = 0; fracv < itsOverSample; ++fracv) {
+            const int plane = fracu + itsOverSample * (fracv + itsOverSample * iw);
+            ASKAPDEBUGASSERT(plane < int(itsConvFunc.size()));
+            itsConvFunc[plane].resize(cSize, cSize);
+            itsConvFunc[plane].set(0.0);
+
+            // Now cut out the inner part of the convolution function and
+            // insert it into the convolution function
+            for (int iy = -support; iy < support; ++iy) {
+                for (int ix = -support; ix < support; ++ix) {
+                    ASKAPDEBUGASSERT((ix + support >= 0) && (iy + support >= 0));
+                    ASKAPDEBUGASSERT(ix + support < int(itsConvFunc[plane].nrow()));
+                    ASKAPDEBUGASSERT(iy + support < int(itsConvFunc[plane].ncolumn()));
+                    ASKAPDEBUGASSERT((ix + cfSupport.itsOffsetU)*itsOverSample + fracu + nx / 2 >= 0);
+                    ASKAPDEBUGASSERT((iy + cfSupport.itsOffsetV)*itsOverSample + fracv + ny / 2 >= 0);
+                    ASKAPDEBUGASSERT((ix + cfSupport.itsOffsetU)*itsOverSample + fracu + nx / 2 < int(thisPlane.nrow()));
+                    ASKAPDEBUGASSERT((iy + cfSupport.itsOffsetV)*itsOverSample + fracv + ny / 2 < int(thisPlane.ncolumn()));
+                    //if (w < 0) {
+                    //    itsConvFunc[plane](ix + support, iy + support) =
+                    //        conj(thisPlane((ix + cfSupport.itsOffsetU) * itsOverSample + fracu + nx / 2,
+                    //              (iy + cfSupport.itsOffsetV) * itsOverSample + fracv + ny / 2));
+                    //} else {
+                    itsConvFunc[plane](ix + support, iy + support) =
+                        thisPlane((ix + cfSupport.itsOffsetU) * itsOverSample + fracu + nx / 2,
+                               (iy + cfSupport.itsOffsetV) * itsOverSample + fracv + ny / 2);
+                    //}
+                } // for ix
+            } // for iy
+        } // for fracv
+    } // for fracu
 }
 
 /// @brief search for support parameters
@@ -451,6 +588,11 @@ IVisGridder::ShPtr WProjectVisGridder::createGridder(const LOFAR::ParameterSet&
             maxSupport, limitSupport, tablename));
     gridder->configureGridder(parset);
     gridder->configureWSampling(parset);
+    const string cfCacheDir = parset.getString("cfcache", "");
+    if (cfCacheDir != "") {
+        ASKAPLOG_INFO_STR(logger, "Convolution functions will be cached in " << cfCacheDir);
+        gridder->setCFCacheDir(cfCacheDir);
+    }
     return gridder;
 }
 
@@ -491,11 +633,32 @@ void WProjectVisGridder::configureGridder(const LOFAR::ParameterSet& parset)
 
 
 /// @brief obtain buffer used to create convolution functions
+/// @details There is one buffer per thread used for CF generation.
+/// @param[in] thread thread number (0 for the serial case)
 /// @return a reference to the buffer held as a shared pointer
-casa::Matrix<casa::DComplex> WProjectVisGridder::getCFBuffer() const
+casa::Matrix<casa::DComplex> WProjectVisGridder::getCFBuffer(const int thread) const
 {
-    ASKAPDEBUGASSERT(itsCFBuffer);
-    return *itsCFBuffer;
+    ASKAPDEBUGASSERT((thread >= 0) && (thread < int(itsCFBuffers.size())));
+    ASKAPDEBUGASSERT(itsCFBuffers[thread]);
+    return *itsCFBuffers[thread];
+}
+
+/// @brief initialise buffers for full-sized convolution function
+/// @details One buffer is created for each thread allowed by numberOfThreads(),
+/// so the planes of the CF cache can be generated concurrently.
+/// @param[in] uSize size in U
+/// @param[in] vSize size in V
+void WProjectVisGridder::initCFBuffer(casa::uInt uSize, casa::uInt vSize)
+{
+#ifdef _OPENMP
+    const int nThreads = numberOfThreads();
+#else
+    const int nThreads = 1;
+#endif
+    itsCFBuffers.resize(nThreads);
+    for (int thread = 0; thread < nThreads; ++thread) {
+         itsCFBuffers[thread].reset(new casa::Matrix<casa::DComplex>(uSize, vSize));
+    }
 }
 
 /// @brief assignment operator
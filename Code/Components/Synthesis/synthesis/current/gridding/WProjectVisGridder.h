@@ -31,10 +31,14 @@
 
 // ASKAPsoft includes
 #include <gridding/WDependentGridderBase.h>
+#include <gridding/CFCacheFile.h>
 
 // Local package includes
 #include <dataaccess/IConstDataAccessor.h>
 
+// std includes
+#include <vector>
+
 namespace askap
 {
     namespace synthesis
@@ -97,6 +101,14 @@ namespace askap
                 /// @return a shared pointer to the gridder instance					 
                 static IVisGridder::ShPtr createGridder(const LOFAR::ParameterSet& parset);
 
+                /// @brief set directory for the persistent cache of convolution functions
+                /// @details If the directory is set, convolution functions are loaded from
+                /// a memory-mapped file in this directory if it has been created for the same
+                /// parameters (e.g. by another rank or a previous run). Otherwise, they are
+                /// computed and written into this directory to be reused later.
+                /// @param[in] dir directory name, an empty string disables the persistent cache
+                inline void setCFCacheDir(const std::string &dir) { itsCFCacheDir = dir; }
+
             protected:
                 /// @brief additional operations to configure gridder
                 /// @details This method is supposed to be called from createGridder and could be
@@ -106,14 +118,22 @@ namespace askap
                 void configureGridder(const LOFAR::ParameterSet& parset);
 
                 /// @brief obtain buffer used to create convolution functions
+                /// @details There is one buffer per thread used for CF generation.
+                /// @param[in] thread thread number (0 for the serial case)
                 /// @return a reference to the buffer held as a shared pointer   
-                casa::Matrix<casa::DComplex> getCFBuffer() const; 
+                casa::Matrix<casa::DComplex> getCFBuffer(const int thread = 0) const; 
 
-                /// @brief initialise buffer for full-sized convolution function
+                /// @brief initialise buffers for full-sized convolution function
+                /// @details One buffer is created for each thread allowed by numberOfThreads(),
+                /// so the planes of the CF cache can be generated concurrently.
                 /// @param[in] uSize size in U
                 /// @param[in] vSize size in V
-                inline void initCFBuffer(casa::uInt uSize, casa::uInt vSize) 
-                { itsCFBuffer.reset(new casa::Matrix<casa::DComplex>(uSize,vSize)); } 
+                void initCFBuffer(casa::uInt uSize, casa::uInt vSize);
+
+                /// @brief number of threads available for CF generation
+                /// @details This is the number of buffers created by initCFBuffer.
+                /// @return number of threads which can be used to generate CF planes concurrently
+                inline int nCFThreads() const { return int(itsCFBuffers.size()); }
 
                 /// @brief initialise sum of weights
                 /// @details We keep track the number of times each convolution function is used per
@@ -199,6 +219,36 @@ namespace askap
                 inline void setAbsCutoffFlag(const bool flag) { itsCutoffAbs = flag; }
 
             private:    
+                /// @brief key describing all parameters convolution functions depend on
+                /// @details It is used to match the persistent cache of convolution functions.
+                /// @return key string
+                std::string cfCacheKey() const;
+
+                /// @brief load convolution functions from the persistent cache
+                /// @details The file is memory-mapped, so the convolution functions reference
+                /// memory shared with other processes using the same file.
+                /// @return true, if convolution functions have been loaded
+                bool loadCFCache();
+
+                /// @brief save convolution functions to the persistent cache
+                void saveCFCache() const;
+
+                /// @brief generate convolution function for one w-plane
+                /// @details This method fills the given buffer with the w-term multiplied by the
+                /// spheroidal function, does the FFT and cuts out the support into itsConvFunc.
+                /// It is called concurrently for different w-planes, therefore the common support
+                /// (itsSupport) must be determined before the concurrent calls, i.e. by
+                /// processing the first plane.
+                /// @param[in] iw w-plane to generate
+                /// @param[in] thisPlane buffer for the full-sized convolution function (used for FFT)
+                /// @param[in] ccfx spheroidal function along x
+                /// @param[in] ccfy spheroidal function along y
+                /// @param[in] ccellx cell size in x (after oversampling)
+                /// @param[in] ccelly cell size in y (after oversampling)
+                void generateWPlane(int iw, casa::Matrix<casa::DComplex> &thisPlane,
+                        const casa::Vector<float> &ccfx, const casa::Vector<float> &ccfy,
+                        double ccellx, double ccelly);
+
                 /// @brief assignment operator
                 /// @details Defined as private, so it can't be called (to enforce usage of the 
                 /// copy constructor
@@ -223,16 +273,25 @@ namespace askap
                 /// @details If this parameter is true, offset convolution functions will be built.
                 bool itsOffsetSupportAllowed;
 
-                /// @brief buffer for full-sized convolution function
+                /// @brief buffers for full-sized convolution function
                 /// @details We have to calculate convolution functions on a larger grid and then cut out
                 /// a limited support out of it. Mosaicing gridders may need to compute a significant number
                 /// of convolution functions. To speed things up, the allocation of the buffer is taken
-                /// outside initConvolutionFunction method. A shared pointer to this buffer is held as a 
+                /// outside initConvolutionFunction method. Shared pointers to buffers are held as a 
                 /// data member as initialisation and usage happen in different methods of this class.
-                boost::shared_ptr<casa::Matrix<casa::DComplex> > itsCFBuffer;  
+                /// There is one buffer per thread generating convolution functions.
+                std::vector<boost::shared_ptr<casa::Matrix<casa::DComplex> > > itsCFBuffers;  
 
                 /// @brief itsCutoff is an absolute cutoff, rather than relative to the peak of a particular CF plane
                 bool itsCutoffAbs;       
+
+                /// @brief directory for the persistent cache of convolution functions (empty to disable)
+                std::string itsCFCacheDir;
+
+                /// @brief mapped cache file
+                /// @details Convolution functions loaded from the persistent cache reference the memory
+                /// mapped by this object, so it is held for as long as they are used.
+                boost::shared_ptr<CFCacheFile> itsCFCacheFile;
         };
     }
 }
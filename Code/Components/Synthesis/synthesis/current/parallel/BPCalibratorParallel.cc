@@ -88,6 +88,10 @@ ASKAP_LOGGER(logger, ".parallel");
 #include <casa/aips.h>
 #include <casa/OS/Timer.h>
 
+// std includes
+#include <map>
+#include <vector>
+
 namespace askap {
 
 namespace synthesis {
@@ -101,6 +105,7 @@ BPCalibratorParallel::BPCalibratorParallel(askap::askapparallel::AskapParallel&
           const LOFAR::ParameterSet& parset) : MEParallelApp(comms,emptyDatasetKeyword(parset)), 
       itsPerfectModel(new scimath::Params()), itsRefAntenna(-1), itsSolutionID(-1), itsSolutionIDValid(false)
 {
+  ASKAPCHECK(nChanPerPass() > 0, "nChanPerPass should be a positive number");
   ASKAPLOG_INFO_STR(logger, "Bandpass will be solved for using a specialised pipeline");
   if (itsComms.isMaster()) {                        
       // setup solution source (or sink to be exact, because we're writing the solution here)
@@ -136,7 +141,7 @@ BPCalibratorParallel::BPCalibratorParallel(askap::askapparallel::AskapParallel&
           // greater benefits if multiple measurement sets are present (more likely to be scheduled for different ranks)
           ASKAPLOG_INFO_STR(logger, "Work for "<<nBeam()<<" beams and "<<nChan()<<" channels will be split between "<<
                    (itsComms.nProcs() - 1)<<" ranks, this one handles chunk "<<(itsComms.rank() - 1));
-          itsWorkUnitIterator.init(casa::IPosition(2, nBeam(), nChan()), itsComms.nProcs() - 1, itsComms.rank() - 1);
+          itsWorkUnitIterator.init(casa::IPosition(2, nBeam(), nChanBlocks()), itsComms.nProcs() - 1, itsComms.rank() - 1);
       } 
 
       ASKAPCHECK((measurementSets().size() == 1) || (measurementSets().size() == nBeam()), 
@@ -146,7 +151,10 @@ BPCalibratorParallel::BPCalibratorParallel(askap::askapparallel::AskapParallel&
   if (!itsComms.isParallel()) {
       // setup work units in the serial case - all work to be done here
       ASKAPLOG_INFO_STR(logger, "All work for "<<nBeam()<<" beams and "<<nChan()<<" channels will be handled by this rank");
-      itsWorkUnitIterator.init(casa::IPosition(2, nBeam(), nChan()));
+      itsWorkUnitIterator.init(casa::IPosition(2, nBeam(), nChanBlocks()));
+  }
+  if (nChanPerPass() > 1) {
+      ASKAPLOG_INFO_STR(logger, "Data for "<<nChanPerPass()<<" channels will be accumulated in one pass over the dataset");
   }
 
 }          
@@ -181,18 +189,35 @@ void BPCalibratorParallel::run()
            itsEquation.reset();
             
            const std::pair<casa::uInt, casa::uInt> indices = currentBeamAndChannel();
+           const bool multiChan = (nChanPerPass() > 1);
            
            ASKAPLOG_INFO_STR(logger, "Initialise bandpass (unknowns) for "<<nAnt()<<" antennas for beam="<<indices.first<<
-                             " and channel="<<indices.second);
+                             " and channel="<<indices.second<<(multiChan ? " onwards" : ""));
            itsModel->reset();                             
-           for (casa::uInt ant = 0; ant<nAnt(); ++ant) {
-                itsModel->add(accessors::CalParamNameHelper::paramName(ant, indices.first, casa::Stokes::XX), casa::Complex(1.,0.));
-                itsModel->add(accessors::CalParamNameHelper::paramName(ant, indices.first, casa::Stokes::YY), casa::Complex(1.,0.));                
-           }       
+           if (multiChan) {
+               // frequency-dependent gains for all channels of this block, the channel
+               // offset is used by the measurement equation to form parameter names
+               const casa::uInt nChanThisPass = nChanInPass(indices.second);
+               for (casa::uInt chan = indices.second; chan < indices.second + nChanThisPass; ++chan) {
+                    for (casa::uInt ant = 0; ant<nAnt(); ++ant) {
+                         itsModel->add(accessors::CalParamNameHelper::addChannelInfo(
+                              accessors::CalParamNameHelper::paramName(ant, indices.first, casa::Stokes::XX, true), chan), casa::Complex(1.,0.));
+                         itsModel->add(accessors::CalParamNameHelper::addChannelInfo(
+                              accessors::CalParamNameHelper::paramName(ant, indices.first, casa::Stokes::YY, true), chan), casa::Complex(1.,0.));
+                    }
+               }
+               itsModel->add("chan_offset", static_cast<double>(indices.second));
+               itsModel->fix("chan_offset");
+           } else {
+               for (casa::uInt ant = 0; ant<nAnt(); ++ant) {
+                    itsModel->add(accessors::CalParamNameHelper::paramName(ant, indices.first, casa::Stokes::XX), casa::Complex(1.,0.));
+                    itsModel->add(accessors::CalParamNameHelper::paramName(ant, indices.first, casa::Stokes::YY), casa::Complex(1.,0.));                
+               }       
+           }
            
-           // setup reference gain, if needed
+           // setup reference gain, if needed (without channel info in the multi-channel case)
            if (itsRefAntenna >= 0) {
-               itsRefGain = accessors::CalParamNameHelper::paramName(itsRefAntenna, indices.first, casa::Stokes::XX);
+               itsRefGain = accessors::CalParamNameHelper::paramName(itsRefAntenna, indices.first, casa::Stokes::XX, multiChan);
            } else {
                itsRefGain = "";
            }
@@ -218,7 +243,7 @@ void BPCalibratorParallel::run()
       }     
   }
   if (itsComms.isMaster() && itsComms.isParallel()) {
-      const casa::uInt numberOfWorkUnits = nBeam() * nChan();
+      const casa::uInt numberOfWorkUnits = nBeam() * nChanBlocks();
       for (casa::uInt chunk = 0; chunk < numberOfWorkUnits; ++chunk) {
            // asynchronously receive result from workers
            receiveModelFromWorker();
@@ -249,7 +274,8 @@ std::pair<casa::uInt, casa::uInt> BPCalibratorParallel::currentBeamAndChannel()
       const casa::IPosition cursor = itsWorkUnitIterator.cursor();
       ASKAPDEBUGASSERT(cursor.nelements() == 2);
       ASKAPDEBUGASSERT((cursor[0] >= 0) && (cursor[1] >= 0));
-      const std::pair<casa::uInt,casa::uInt> result(static_cast<casa::uInt>(cursor[0]), static_cast<casa::uInt>(cursor[1]));
+      const std::pair<casa::uInt,casa::uInt> result(static_cast<casa::uInt>(cursor[0]), 
+                                  static_cast<casa::uInt>(cursor[1]) * nChanPerPass());
       ASKAPDEBUGASSERT(result.first < nBeam());
       ASKAPDEBUGASSERT(result.second < nChan());
       return result;
@@ -339,9 +365,32 @@ void BPCalibratorParallel::solveNE()
       itsSolver->init();
       itsSolver->addNormalEquations(*itsNe);
       itsSolver->setAlgorithm("SVD");     
-      itsSolver->solveNormalEquations(*itsModel,q);
-      ASKAPLOG_INFO_STR(logger, "Solved normal equations in "<< timer.real() << " seconds ");
-      ASKAPLOG_INFO_STR(logger, "Solution quality: "<<q);
+      if (nChanPerPass() > 1) {
+          // channels are independent, solve for each of them separately rather
+          // than doing SVD of the matrix covering the whole block
+          std::map<casa::uInt, std::vector<std::string> > namesPerChan;
+          const std::vector<std::string> names(itsModel->freeNames());
+          for (std::vector<std::string>::const_iterator it = names.begin(); it != names.end(); ++it) {
+               namesPerChan[accessors::CalParamNameHelper::extractChannelInfo(*it).first].push_back(*it);
+          }
+          for (std::map<casa::uInt, std::vector<std::string> >::const_iterator ci = namesPerChan.begin(); 
+               ci != namesPerChan.end(); ++ci) {
+               scimath::Params chanModel;
+               for (std::vector<std::string>::const_iterator it = ci->second.begin(); it != ci->second.end(); ++it) {
+                    chanModel.add(*it, itsModel->complexValue(*it));
+               }
+               itsSolver->solveNormalEquations(chanModel,q);
+               for (std::vector<std::string>::const_iterator it = ci->second.begin(); it != ci->second.end(); ++it) {
+                    itsModel->update(*it, chanModel.complexValue(*it));
+               }
+               ASKAPLOG_DEBUG_STR(logger, "Solution quality for channel "<<ci->first<<": "<<q);
+          }
+          ASKAPLOG_INFO_STR(logger, "Solved normal equations for "<<namesPerChan.size()<<" channels in "<< timer.real() << " seconds ");
+      } else {
+          itsSolver->solveNormalEquations(*itsModel,q);
+          ASKAPLOG_INFO_STR(logger, "Solved normal equations in "<< timer.real() << " seconds ");
+          ASKAPLOG_INFO_STR(logger, "Solution quality: "<<q);
+      }
       if (itsRefGain != "") {
           ASKAPLOG_INFO_STR(logger, "Rotating phases to have that of "<<itsRefGain<<" equal to 0");
           rotatePhases();
@@ -375,12 +424,15 @@ void BPCalibratorParallel::writeModel(const std::string &)
   std::vector<std::string> parlist = itsModel->freeNames();
   for (std::vector<std::string>::const_iterator it = parlist.begin(); it != parlist.end(); ++it) {
        const casa::Complex val = itsModel->complexValue(*it);           
+       // bandpass parameters carry the channel if more than one channel is solved for in one go
+       const std::pair<casa::uInt, std::string> parsedParam = accessors::CalParamNameHelper::bpParam(*it) ?
+             accessors::CalParamNameHelper::extractChannelInfo(*it) : std::make_pair(indices.second, *it);
        const std::pair<accessors::JonesIndex, casa::Stokes::StokesTypes> paramType = 
-             accessors::CalParamNameHelper::parseParam(*it);
+             accessors::CalParamNameHelper::parseParam(parsedParam.second);
        // beam is also coded in the parameters, although we don't need it because the data are partitioned
        // just cross-check it  
        ASKAPDEBUGASSERT(static_cast<casa::uInt>(paramType.first.beam()) == indices.first);             
-       solAcc->setBandpassElement(paramType.first, paramType.second, indices.second, val);
+       solAcc->setBandpassElement(paramType.first, paramType.second, parsedParam.first, val);
   }
 }
 
@@ -400,11 +452,17 @@ void BPCalibratorParallel::createCalibrationME(const accessors::IDataSharedIter
    // it is handy to have a shared pointer to the base type because it is
    // not templated
    boost::shared_ptr<PreAvgCalMEBase> preAvgME;
-   // solve as normal gains (rather than bandpass) because only one channel is supposed to be selected
-   // this also opens a possibility to use several (e.g. 54 = coarse resolution) channels to get one gain
-   // solution which is then replicated to all channels involved. We can also add frequency-dependent leakage, if
-   // tests show it is required (currently it is not in the calibration model)
-   preAvgME.reset(new CalibrationME<NoXPolGain, PreAvgCalMEBase>());           
+   if (nChanPerPass() > 1) {
+       // a block of channels is selected, the buffer keeps separate sums for every channel and 
+       // all channels are accumulated in one iteration over the data
+       preAvgME.reset(new CalibrationME<NoXPolFreqDependentGain, PreAvgCalMEBase>());
+   } else {
+       // solve as normal gains (rather than bandpass) because only one channel is supposed to be selected
+       // this also opens a possibility to use several (e.g. 54 = coarse resolution) channels to get one gain
+       // solution which is then replicated to all channels involved. We can also add frequency-dependent leakage, if
+       // tests show it is required (currently it is not in the calibration model)
+       preAvgME.reset(new CalibrationME<NoXPolGain, PreAvgCalMEBase>());           
+   }
    ASKAPDEBUGASSERT(preAvgME);
    
    ASKAPDEBUGASSERT(dsi.hasMore());  
@@ -430,11 +488,33 @@ void BPCalibratorParallel::rotatePhases()
   ASKAPDEBUGASSERT(itsComms.isWorker());
   ASKAPDEBUGASSERT(itsModel);
   
+  std::vector<std::string> names(itsModel->freeNames());
+  if (nChanPerPass() > 1) {
+      // reference phase is taken separately for each channel
+      std::map<casa::uInt, casa::Complex> refPhaseTerms;
+      for (std::vector<std::string>::const_iterator it=names.begin(); it!=names.end();++it)  {
+           const casa::uInt chan = accessors::CalParamNameHelper::extractChannelInfo(*it).first;
+           if (refPhaseTerms.find(chan) == refPhaseTerms.end()) {
+               const std::string refName = accessors::CalParamNameHelper::addChannelInfo(itsRefGain, chan);
+               ASKAPCHECK(itsModel->has(refName), "phase rotation to `"<<refName<<
+                          "` is impossible because this parameter is not present in the model");
+               refPhaseTerms[chan] = casa::polar(1.f,-arg(itsModel->complexValue(refName)));
+           }
+      }
+      for (std::vector<std::string>::const_iterator it=names.begin(); it!=names.end();++it)  {
+           const std::string parname = *it;
+           if (parname.find("gain") != std::string::npos) {
+               const casa::uInt chan = accessors::CalParamNameHelper::extractChannelInfo(parname).first;
+               itsModel->update(parname, itsModel->complexValue(parname) * refPhaseTerms[chan]);
+           }
+      }
+      return;
+  }
+
   ASKAPCHECK(itsModel->has(itsRefGain), "phase rotation to `"<<itsRefGain<<
              "` is impossible because this parameter is not present in the model");
   casa::Complex  refPhaseTerm = casa::polar(1.f,-arg(itsModel->complexValue(itsRefGain)));
                        
-  std::vector<std::string> names(itsModel->freeNames());
   for (std::vector<std::string>::const_iterator it=names.begin(); it!=names.end();++it)  {
        const std::string parname = *it;
        if (parname.find("gain") != std::string::npos) {
@@ -477,7 +557,9 @@ void BPCalibratorParallel::calcOne(const std::string& ms, const casa::uInt chan,
 {
   casa::Timer timer;
   timer.mark();
-  ASKAPLOG_INFO_STR(logger, "Calculating normal equations for " << ms <<" channel "<<chan<<" beam "<<beam);
+  const casa::uInt nChanThisPass = nChanInPass(chan);
+  ASKAPLOG_INFO_STR(logger, "Calculating normal equations for " << ms <<" channel "<<chan<<" beam "<<beam<<
+                    " ("<<nChanThisPass<<" channel(s) in this pass)");
   // First time around we need to generate the equation 
   if (!itsEquation) {
       ASKAPLOG_INFO_STR(logger, "Creating measurement equation" );
@@ -485,7 +567,7 @@ void BPCalibratorParallel::calcOne(const std::string& ms, const casa::uInt chan,
       ds.configureUVWMachineCache(uvwMachineCacheSize(),uvwMachineCacheTolerance());      
       accessors::IDataSelectorPtr sel=ds.createSelector();
       sel << parset();
-      sel->chooseChannels(1,chan);
+      sel->chooseChannels(nChanThisPass,chan);
       sel->chooseFeed(beam);
       accessors::IDataConverterPtr conv=ds.createConverter();
       conv->setFrequencyFrame(getFreqRefFrame(), "Hz");
@@ -56,6 +56,7 @@
 
 // std includes
 #include <utility>
+#include <algorithm>
 
 // boost includes
 #include <boost/shared_ptr.hpp>
@@ -76,6 +77,8 @@ namespace askap
     ///      * does not support a distributed model (e.h. with individual workers dealing with individual Taylor terms)
     ///      * does not require exact match between number of workers and number of channel chunks, data are dealt with
     ///        serially by each worker with multiple iterations over data, if required.
+    ///      * can accumulate a block of channels in one pass over the data (nChanPerPass), channels
+    ///        are still solved for independently
     ///      * solves normal equations at the worker level in the parallel case
     ///
     /// This specialised tool matches closely BETA needs and will be used for BETA initially (at least until we converge
@@ -101,6 +104,23 @@ namespace askap
       /// then sends the result to master for writing.
       void run(); 
 
+      /// @brief number of channel blocks for the given channel split
+      /// @param[in] nChan total number of channels
+      /// @param[in] nChanPerPass number of channels per block, must be positive
+      /// @return number of blocks required to cover all channels
+      static inline casa::uInt nChanBlocks(const casa::uInt nChan, const casa::uInt nChanPerPass) 
+         { return (nChan + nChanPerPass - 1) / nChanPerPass; }
+
+      /// @brief number of channels in the given block
+      /// @details This is nChanPerPass except for the last block which can be shorter
+      /// @param[in] nChan total number of channels
+      /// @param[in] nChanPerPass number of channels per block, must be positive
+      /// @param[in] startChan first channel of the block, must be less than nChan
+      /// @return number of channels in the block
+      static inline casa::uInt nChanInPass(const casa::uInt nChan, const casa::uInt nChanPerPass,
+                                           const casa::uInt startChan) 
+         { return std::min(nChanPerPass, nChan - startChan); }
+
       protected:      
 
       // virtual methods of the abstract base, define them as protected because they
@@ -178,6 +198,24 @@ namespace askap
       /// @brief number of channels to solve for
       /// @return number of channels to solve for
       inline casa::uInt nChan() const { return parset().getInt32("nChan", 304); }
+
+      /// @brief number of channels accumulated in one pass over the data
+      /// @details The work is split into units of this many adjacent channels for one beam.
+      /// Each unit is read once with the pre-averaging buffer keeping separate sums for
+      /// every channel, but the normal equations are solved channel by channel.
+      /// @return number of channels per pass over the data
+      inline casa::uInt nChanPerPass() const { return parset().getUint32("nChanPerPass", 1); }
+
+      /// @brief number of channel blocks to iterate over
+      /// @return number of passes over the data required to cover all channels of one beam
+      inline casa::uInt nChanBlocks() const { return nChanBlocks(nChan(), nChanPerPass()); }
+
+      /// @brief number of channels in the block starting at the given channel
+      /// @details This is nChanPerPass except for the last block which can be shorter
+      /// @param[in] startChan first channel of the block
+      /// @return number of channels in the block
+      inline casa::uInt nChanInPass(const casa::uInt startChan) const 
+         { return nChanInPass(nChan(), nChanPerPass(), startChan); }
       
       /// @brief extract current beam/channel pair from the iterator
       /// @details This method encapsulates interpretation of the output of itsWorkUnitIterator.cursor() for workers and
@@ -185,11 +223,14 @@ namespace askap
       /// in the parallel case. This is done because calibration data are sent to the master asynchronously and there is no
       /// way of knowing what iteration in the worker they correspond to without looking at the data.
       /// @return pair of beam (first) and channel (second) indices
+      /// @note If more than one channel is processed per pass, the first channel
+      /// of the current block is returned
       std::pair<casa::uInt, casa::uInt> currentBeamAndChannel() const; 
  
       /// Calculate normal equations for one data set, channel and beam
       /// @param[in] ms Name of data set
-      /// @param[in] chan channel to work with
+      /// @param[in] chan channel to work with (the first channel of the block,
+      /// if more than one channel is processed per pass)
       /// @param[in] beam beam to work with
       void calcOne(const std::string& ms, const casa::uInt chan, const casa::uInt beam);
       
@@ -39,6 +39,10 @@
 
 // System includes
 #include <cmath>
+#include <algorithm>
+#include <functional>
+#include <string>
+#include <vector>
 
 // Askapsoft includes
 #include <askap/AskapLogging.h>
@@ -48,11 +52,16 @@
 #include <askapparallel/BlobOBufMW.h>
 #include <Blob/BlobIStream.h>
 #include <Blob/BlobOStream.h>
+#include <Blob/BlobArray.h>
+#include <Blob/BlobString.h>
+#include <Blob/BlobOBufString.h>
+#include <Blob/BlobIBufString.h>
 #include <Common/ParameterSet.h>
 #include <fitting/Equation.h>
 #include <fitting/Solver.h>
 #include <fitting/INormalEquations.h>
 #include <fitting/ImagingNormalEquations.h>
+#include <fitting/ImagingNormalEquationsLayout.h>
 #include <fitting/GenericNormalEquations.h>
 #include <profile/AskapProfiler.h>
 #include <casa/OS/Timer.h>
@@ -66,8 +75,35 @@ using namespace askap::scimath;
 namespace askap {
 namespace synthesis {
 
+namespace {
+
+/// @brief description of one parameter of the streamed normal equations
+struct StreamedParameter {
+    /// @brief parameter name
+    std::string itsName;
+    /// @brief shape of the parameter
+    casa::IPosition itsShape;
+    /// @brief reference point for the slice
+    casa::IPosition itsReference;
+    /// @brief number of elements in the slice, diagonal and data vector
+    LOFAR::uint64 itsSize[3];
+};
+
+/// @brief wait for completion of all given non-blocking requests
+/// @param[in] comms communication object
+/// @param[in,out] requests request indices, the vector is cleared on exit
+void waitAll(AskapParallel &comms, std::vector<size_t> &requests)
+{
+    for (std::vector<size_t>::const_iterator ci = requests.begin(); ci != requests.end(); ++ci) {
+        comms.wait(*ci);
+    }
+    requests.clear();
+}
+
+} // anonymous namespace
+
 MEParallel::MEParallel(askap::askapparallel::AskapParallel& comms, const LOFAR::ParameterSet& parset) :
-        SynParallel(comms, parset)
+        SynParallel(comms, parset), itsFlatReduction(parset.getBool("flatreduction", false))
 {
     itsSolver = Solver::ShPtr(new Solver);
     itsNe = ImagingNormalEquations::ShPtr(new ImagingNormalEquations(*itsModel));
@@ -162,6 +198,19 @@ void MEParallel::reduceNE(askap::scimath::INormalEquations::ShPtr ne)
     const int depth = int(floor(log2(rank + 1)));
     ASKAPCHECK(depth <= height, "Depth exceeds height");
 
+    // Imaging normal equations can be huge, they are streamed parameter by
+    // parameter and merged on the fly rather than serialised as a whole.
+    // All ranks hold normal equations of the same type, so both ends of each
+    // transfer take the same decision here.
+    askap::scimath::ImagingNormalEquations *imagingNE =
+        dynamic_cast<askap::scimath::ImagingNormalEquations*>(ne.get());
+
+    // Optionally sum everything with a single collective call. The option is the same
+    // on all ranks, so either all of them or none get here.
+    if (itsFlatReduction && imagingNE && reduceFlatNormalEquations(*imagingNE)) {
+        return;
+    }
+
     // One reduction step is executed for each level of the tree
     // (except the top level)
     for (int level = height; level > 0; --level) {
@@ -171,7 +220,11 @@ void MEParallel::reduceNE(askap::scimath::INormalEquations::ShPtr ne)
         if (depth == level) {
             // This round I am a sender
             const int parent = int(floor((rank - 1) / 2));
-            sendNormalEquations(ne, parent);
+            if (imagingNE) {
+                sendNormalEquations(*imagingNE, parent);
+            } else {
+                sendNormalEquations(ne, parent);
+            }
 
         } else if (depth == level - 1) {
             // This round I am a receiver
@@ -179,13 +232,21 @@ void MEParallel::reduceNE(askap::scimath::INormalEquations::ShPtr ne)
             // Receive from the left child if it exists
             const int left = (2 * rank) + 1;
             if (left < nProcs) {
-                ne->merge(*receiveNormalEquations(left));
+                if (imagingNE) {
+                    receiveAndMergeNormalEquations(*imagingNE, left);
+                } else {
+                    ne->merge(*receiveNormalEquations(left));
+                }
             }
 
             // Receive from the right child if it exists
             const int right = (2 * rank) + 2;
             if (right < nProcs) {
-                ne->merge(*receiveNormalEquations(right));
+                if (imagingNE) {
+                    receiveAndMergeNormalEquations(*imagingNE, right);
+                } else {
+                    ne->merge(*receiveNormalEquations(right));
+                }
             }
         } else {
             // This round I am a non-participant
@@ -250,6 +311,209 @@ askap::scimath::INormalEquations::ShPtr MEParallel::receiveNormalEquations(int s
     return ne;
 }
 
+/*
+ * The imaging normal equations are streamed in two parts. First, a small blob
+ * describing all parameters (names, shapes, reference points and the sizes of
+ * the slice, diagonal and data vector) is sent. Then, the vectors of each
+ * parameter follow as raw buffers sent with non-blocking MPI directly from
+ * the storage of the normal equations, i.e. the bulk of the data is never
+ * serialised or copied. MPI guarantees that messages between the same pair
+ * of ranks are matched in the order they are posted, so the receiver just
+ * posts receives for the same sequence of buffers.
+ */
+void MEParallel::sendNormalEquations(const askap::scimath::ImagingNormalEquations &ne, int dest)
+{
+    ASKAPDEBUGTRACE("MEParallel::sendNormalEquations");
+
+    casa::Timer timer;
+    timer.mark();
+    ASKAPLOG_DEBUG_STR(logger, "Streaming normal equations to rank " << dest);
+
+    const std::vector<std::string> names = ne.unknowns();
+
+    std::vector<const casa::Vector<double>*> vectors;
+    vectors.reserve(3 * names.size());
+    for (std::vector<std::string>::const_iterator ci = names.begin(); ci != names.end(); ++ci) {
+        ASKAPDEBUGASSERT(ne.normalMatrixDiagonal().find(*ci) != ne.normalMatrixDiagonal().end());
+        ASKAPDEBUGASSERT(ne.dataVector().find(*ci) != ne.dataVector().end());
+        vectors.push_back(&(ne.normalMatrixSlice().find(*ci)->second));
+        vectors.push_back(&(ne.normalMatrixDiagonal().find(*ci)->second));
+        vectors.push_back(&(ne.dataVector().find(*ci)->second));
+    }
+
+    // send the header
+    BlobOBufMW bobmw(itsComms, dest);
+    LOFAR::BlobOStream out(bobmw);
+    out.putStart("nestream", 1);
+    out << itsComms.rank() << static_cast<LOFAR::uint64>(names.size());
+    for (size_t par = 0; par < names.size(); ++par) {
+        ASKAPDEBUGASSERT(ne.shape().find(names[par]) != ne.shape().end());
+        ASKAPDEBUGASSERT(ne.reference().find(names[par]) != ne.reference().end());
+        out << names[par] << ne.shape().find(names[par])->second <<
+               ne.reference().find(names[par])->second;
+        for (size_t i = 0; i < 3; ++i) {
+            const casa::Vector<double> &vec = *vectors[3 * par + i];
+            ASKAPCHECK(vec.contiguousStorage(), "Normal equations for " << names[par] <<
+                       " are expected to have contiguous storage");
+            out << static_cast<LOFAR::uint64>(vec.nelements());
+        }
+    }
+    out.putEnd();
+    bobmw.flush();
+
+    // stream the vectors, keeping at most two parameters in flight to match the receiver
+    std::vector<size_t> previous;
+    std::vector<size_t> current;
+    for (size_t par = 0; par < names.size(); ++par) {
+        for (size_t i = 0; i < 3; ++i) {
+            const casa::Vector<double> &vec = *vectors[3 * par + i];
+            if (vec.nelements() > 0) {
+                current.push_back(itsComms.sendNonBlocking(vec.data(),
+                                  vec.nelements() * sizeof(double), dest));
+            }
+        }
+        waitAll(itsComms, previous);
+        previous.swap(current);
+    }
+    waitAll(itsComms, previous);
+
+    ASKAPLOG_DEBUG_STR(logger, "Streamed " << names.size() << " parameters to rank " << dest <<
+            " in " << timer.real() << " seconds ");
+}
+
+void MEParallel::receiveAndMergeNormalEquations(askap::scimath::ImagingNormalEquations &ne, int source)
+{
+    ASKAPDEBUGTRACE("MEParallel::receiveAndMergeNormalEquations");
+
+    ASKAPLOG_DEBUG_STR(logger, "Waiting to receive normal equations from rank " << source);
+    casa::Timer timer;
+    timer.mark();
+
+    // receive the header
+    std::vector<StreamedParameter> params;
+    {
+        BlobIBufMW bibmw(itsComms, source);
+        LOFAR::BlobIStream in(bibmw);
+        const int version = in.getStart("nestream");
+        ASKAPASSERT(version == 1);
+        int rank;
+        LOFAR::uint64 nParams;
+        in >> rank >> nParams;
+        ASKAPCHECK(rank == source, "Received normal equations are from an unexpected source");
+        params.resize(nParams);
+        for (size_t par = 0; par < params.size(); ++par) {
+            in >> params[par].itsName >> params[par].itsShape >> params[par].itsReference;
+            for (size_t i = 0; i < 3; ++i) {
+                in >> params[par].itsSize[i];
+            }
+        }
+        in.getEnd();
+    }
+
+    // double buffering: one parameter is merged while the next one is being received
+    std::vector<casa::Vector<double> > buffers[2];
+    std::vector<size_t> requests[2];
+    buffers[0].resize(3);
+    buffers[1].resize(3);
+    for (size_t par = 0; par <= params.size(); ++par) {
+        if (par < params.size()) {
+            const size_t buf = par % 2;
+            ASKAPDEBUGASSERT(requests[buf].size() == 0);
+            for (size_t i = 0; i < 3; ++i) {
+                casa::Vector<double> &vec = buffers[buf][i];
+                vec.resize(params[par].itsSize[i]);
+                if (vec.nelements() > 0) {
+                    requests[buf].push_back(itsComms.receiveNonBlocking(vec.data(),
+                                            vec.nelements() * sizeof(double), source));
+                }
+            }
+        }
+        if (par > 0) {
+            const size_t buf = (par - 1) % 2;
+            const StreamedParameter &param = params[par - 1];
+            waitAll(itsComms, requests[buf]);
+            ne.mergeParameter(param.itsName, buffers[buf][0], buffers[buf][1], buffers[buf][2],
+                              param.itsShape, param.itsReference);
+        }
+    }
+
+    ASKAPLOG_DEBUG_STR(logger, "Received and merged " << params.size() <<
+            " parameters from rank " << source << " after " << timer.real() << " seconds");
+}
+
+/*
+ * The flat reduction needs the same layout of the buffer on all ranks. The master
+ * (and possibly some workers) may have empty normal equations, so the layout is
+ * taken from the first rank which has some data and broadcast to everybody. Ranks
+ * with empty normal equations contribute zeros.
+ */
+bool MEParallel::reduceFlatNormalEquations(askap::scimath::ImagingNormalEquations &ne)
+{
+    ASKAPDEBUGTRACE("MEParallel::reduceFlatNormalEquations");
+
+    casa::Timer timer;
+    timer.mark();
+
+    const int nProcs = itsComms.nProcs();
+    const int rank = itsComms.rank();
+    const ImagingNormalEquationsLayout layout(ne);
+
+    // find out which ranks have some data
+    std::vector<double> hasData(nProcs, 0.);
+    hasData[rank] = layout.size() > 0 ? 1. : 0.;
+    itsComms.sumAndBroadcast(&hasData[0], hasData.size(), 0);
+    const int root = int(std::find_if(hasData.begin(), hasData.end(),
+                         std::bind2nd(std::greater<double>(), 0.)) - hasData.begin());
+    if (root == nProcs) {
+        ASKAPLOG_DEBUG_STR(logger, "Normal equations are empty on all ranks, nothing to reduce");
+        return true;
+    }
+
+    // distribute the layout of the first rank with data
+    LOFAR::BlobString bs;
+    bs.resize(0);
+    if (rank == root) {
+        LOFAR::BlobOBufString bob(bs);
+        LOFAR::BlobOStream out(bob);
+        out.putStart("nelayout", 1);
+        out << layout;
+        out.putEnd();
+    }
+    itsComms.broadcastBlob(bs, root);
+    ImagingNormalEquationsLayout commonLayout;
+    {
+        LOFAR::BlobIBufString bib(bs);
+        LOFAR::BlobIStream in(bib);
+        const int version = in.getStart("nelayout");
+        ASKAPASSERT(version == 1);
+        in >> commonLayout;
+        in.getEnd();
+    }
+
+    bool mismatch = (layout.size() > 0) && (layout != commonLayout);
+    itsComms.aggregateFlag(mismatch, 0);
+    if (mismatch) {
+        ASKAPLOG_WARN_STR(logger, "Normal equations have different layouts on different ranks, "
+                "using tree reduction instead");
+        return false;
+    }
+
+    ASKAPDEBUGASSERT(commonLayout.size() > 0);
+    std::vector<double> buf(commonLayout.size(), 0.);
+    if (layout.size() > 0) {
+        commonLayout.pack(ne, &buf[0]);
+    }
+    itsComms.sumToRoot(&buf[0], buf.size(), 0, 0);
+    if (rank == 0) {
+        commonLayout.unpack(&buf[0], ne);
+    }
+
+    ASKAPLOG_DEBUG_STR(logger, "Reduced " << commonLayout.nParameters() << " parameters ("
+            << buf.size() * sizeof(double) / 1024 / 1024 << " MB) with a flat reduction in "
+            << timer.real() << " seconds");
+    return true;
+}
+
 void MEParallel::writeModel(const std::string &)
 {
 }
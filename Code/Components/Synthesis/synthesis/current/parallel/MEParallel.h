@@ -36,6 +36,7 @@
 #include <askapparallel/AskapParallel.h>
 #include <Common/ParameterSet.h>
 #include <fitting/INormalEquations.h>
+#include <fitting/ImagingNormalEquations.h>
 #include <fitting/Equation.h>
 #include <fitting/Solver.h>
 
@@ -129,6 +130,35 @@ namespace askap
                 // @return a shared pointer, pointing to the received normal equations
                 askap::scimath::INormalEquations::ShPtr receiveNormalEquations(int source);
 
+                // Point-to-point send of imaging normal equations, parameter by parameter
+                // @details Only a small header with parameter names and shapes is
+                // serialised, the vectors are sent directly from their storage with
+                // non-blocking MPI. It must be matched by receiveAndMergeNormalEquations
+                // on the destination rank.
+                // @param[in] ne    normal equations to send
+                // @param[in] dest  rank of process to send normal equations to
+                void sendNormalEquations(const askap::scimath::ImagingNormalEquations &ne, int dest);
+
+                // Point-to-point receive of imaging normal equations, merged on the fly
+                // @details Each parameter is merged into the given normal equations as
+                // soon as it arrives, while the transfer of the next parameter is already
+                // in progress (double buffering). Only two parameters worth of buffers are
+                // needed rather than a complete copy of the incoming normal equations.
+                // @param[in] ne    normal equations to merge the received ones into
+                // @param[in] source    rank of the process from which normal
+                // equations will be received
+                void receiveAndMergeNormalEquations(askap::scimath::ImagingNormalEquations &ne, int source);
+
+                // Reduce imaging normal equations to the master with a single MPI_Reduce
+                // @details All ranks pack their normal equations into a flat buffer of
+                // doubles and the buffers are summed by MPI. This is a collective call,
+                // all ranks must take part. It only works if the normal equations of all
+                // ranks holding data have the same layout (ranks with empty normal equations
+                // are allowed), otherwise nothing is done and false is returned on all ranks.
+                // @param[in] ne    normal equations to reduce, replaced by the sum on the master
+                // @return true if the reduction has been done, false if the layouts differ
+                bool reduceFlatNormalEquations(askap::scimath::ImagingNormalEquations &ne);
+
 				/// Holder for the normal equations
 				askap::scimath::INormalEquations::ShPtr itsNe;
 
@@ -137,6 +167,10 @@ namespace askap
 				
 				/// Holder for the equation
 				askap::scimath::Equation::ShPtr itsEquation;
+
+            private:
+                /// @brief true if normal equations are reduced via a flat buffer and MPI_Reduce
+                bool itsFlatReduction;
 		};
 
 	}
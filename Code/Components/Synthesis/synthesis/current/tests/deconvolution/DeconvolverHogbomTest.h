@@ -31,6 +31,7 @@
 #include <cppunit/extensions/HelperMacros.h>
 
 #include <casa/BasicSL/Complex.h>
+#include <casa/Arrays/ArrayMath.h>
 
 #include <boost/shared_ptr.hpp>
 
@@ -48,6 +49,7 @@ class DeconvolverHogbomTest : public CppUnit::TestFixture
   CPPUNIT_TEST(testDeconvolveCenter);
   CPPUNIT_TEST(testDeconvolveCorner);
   CPPUNIT_TEST(testDeconvolveZero);
+  CPPUNIT_TEST(testDeconvolveTwoComponents);
   CPPUNIT_TEST_EXCEPTION(testWrongShape, casa::ArrayShapeError);
   CPPUNIT_TEST_EXCEPTION(testDeconvolveOffsetPSF, AskapError);
   CPPUNIT_TEST_SUITE_END();
@@ -121,6 +123,18 @@ public:
     CPPUNIT_ASSERT(itsDB->deconvolve());
     CPPUNIT_ASSERT(itsDB->control()->terminationCause()==DeconvolverControl<Float>::CONVERGED);
   }
+  void testDeconvolveTwoComponents() {
+    itsDB->dirty().set(0.0);
+    itsDB->dirty()(IPosition(2,30,20))=1.0;
+    itsDB->dirty()(IPosition(2,10,70))=-2.0;
+    CPPUNIT_ASSERT(itsDB->deconvolve());
+    CPPUNIT_ASSERT(itsDB->control()->terminationCause()==DeconvolverControl<Float>::CONVERGED);
+    // the strongest (negative) component is found first
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(-2.0, itsDB->model()(IPosition(2,10,70)), 1e-6);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0, itsDB->model()(IPosition(2,30,20)), 1e-6);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(-1.0, itsDB->state()->totalFlux(), 1e-6);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0, max(abs(itsDB->dirty())), 1e-6);
+  }
    
 private:
 
@@ -0,0 +1,128 @@
+/// @file
+///
+/// Unit test for the persistent cache of convolution functions
+///
+///
+/// @copyright (c) 2007 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+
+#include <gridding/CFCacheFile.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <casa/Arrays/Matrix.h>
+#include <casa/BasicSL/Complex.h>
+
+#include <boost/shared_ptr.hpp>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <utility>
+
+namespace askap {
+
+namespace synthesis {
+
+class CFCacheFileTest : public CppUnit::TestFixture 
+{
+   CPPUNIT_TEST_SUITE(CFCacheFileTest);
+   CPPUNIT_TEST(testRoundTrip);
+   CPPUNIT_TEST(testKeyMismatch);
+   CPPUNIT_TEST(testMissingFile);
+   CPPUNIT_TEST(testFileName);
+   CPPUNIT_TEST_SUITE_END();
+public:
+   void setUp() {
+      itsFileName = "tgridding_test.cfcache";
+      itsKey = "WProject: test key";
+      // planes of different sizes and one unused plane
+      itsCFs.resize(3);
+      itsCFs[0].resize(7,7);
+      itsCFs[2].resize(5,3);
+      for (size_t plane = 0; plane < itsCFs.size(); ++plane) {
+           for (casa::uInt row = 0; row < itsCFs[plane].nrow(); ++row) {
+                for (casa::uInt col = 0; col < itsCFs[plane].ncolumn(); ++col) {
+                     itsCFs[plane](row,col) = casa::Complex(float(plane + row), float(col) - 0.5);
+                }
+           }
+      }
+      itsOffsets.push_back(std::pair<int,int>(1,-2));
+      itsOffsets.push_back(std::pair<int,int>(0,3));
+   }
+
+   void tearDown() {
+      std::remove(itsFileName.c_str());
+   }
+
+   void testRoundTrip() {
+      CPPUNIT_ASSERT(CFCacheFile::write(itsFileName, itsKey, itsCFs, itsOffsets, 3));
+      const boost::shared_ptr<CFCacheFile> cache = CFCacheFile::open(itsFileName, itsKey);
+      CPPUNIT_ASSERT(cache);
+      CPPUNIT_ASSERT_EQUAL(itsCFs.size(), cache->nPlanes());
+      CPPUNIT_ASSERT_EQUAL(itsOffsets.size(), cache->nOffsets());
+      CPPUNIT_ASSERT_EQUAL(3, cache->support());
+      for (size_t plane = 0; plane < itsCFs.size(); ++plane) {
+           const casa::Matrix<casa::Complex> cf = cache->plane(plane);
+           CPPUNIT_ASSERT(cf.shape() == itsCFs[plane].shape());
+           for (casa::uInt row = 0; row < cf.nrow(); ++row) {
+                for (casa::uInt col = 0; col < cf.ncolumn(); ++col) {
+                     CPPUNIT_ASSERT(cf(row,col) == itsCFs[plane](row,col));
+                }
+           }
+      }
+      for (size_t plane = 0; plane < itsOffsets.size(); ++plane) {
+           CPPUNIT_ASSERT_EQUAL(itsOffsets[plane].first, cache->offset(plane).first);
+           CPPUNIT_ASSERT_EQUAL(itsOffsets[plane].second, cache->offset(plane).second);
+      }
+   }
+
+   void testKeyMismatch() {
+      CPPUNIT_ASSERT(CFCacheFile::write(itsFileName, itsKey, itsCFs, itsOffsets, 3));
+      CPPUNIT_ASSERT(!CFCacheFile::open(itsFileName, itsKey + " with different parameters"));
+      CPPUNIT_ASSERT(!CFCacheFile::open(itsFileName, "WProject"));
+   }
+
+   void testMissingFile() {
+      CPPUNIT_ASSERT(!CFCacheFile::open(itsFileName, itsKey));
+   }
+
+   void testFileName() {
+      const std::string name1 = CFCacheFile::fileName("/tmp", "WProject", itsKey);
+      const std::string name2 = CFCacheFile::fileName("/tmp/", "WProject", itsKey);
+      CPPUNIT_ASSERT_EQUAL(name1, name2);
+      CPPUNIT_ASSERT_EQUAL(std::string("/tmp/WProject-"), name1.substr(0,14));
+      CPPUNIT_ASSERT(name1 != CFCacheFile::fileName("/tmp", "WProject", itsKey + "x"));
+      CPPUNIT_ASSERT(CFCacheFile::fileName("", "WProject", itsKey).find('/') == std::string::npos);
+   }
+
+private:
+   std::string itsFileName;
+   std::string itsKey;
+   std::vector<casa::Matrix<casa::Complex> > itsCFs;
+   std::vector<std::pair<int,int> > itsOffsets;
+};
+
+} // namespace synthesis
+
+} // namespace askap
+
@@ -0,0 +1,147 @@
+/// @file
+///
+/// Unit test for the gridding kernels
+///
+///
+/// @copyright (c) 2007 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+
+#include <gridding/GridKernel.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <casa/Arrays/Matrix.h>
+#include <casa/BasicSL/Complex.h>
+
+#include <cstdlib>
+
+namespace askap {
+
+namespace synthesis {
+
+class GridKernelTest : public CppUnit::TestFixture 
+{
+   CPPUNIT_TEST_SUITE(GridKernelTest);
+   CPPUNIT_TEST(testGrid);
+   CPPUNIT_TEST(testDegrid);
+   CPPUNIT_TEST(testInfo);
+   CPPUNIT_TEST_SUITE_END();
+public:
+   void setUp() {
+      itsGrid.resize(64,64);
+      for (casa::uInt row = 0; row < itsGrid.nrow(); ++row) {
+           for (casa::uInt col = 0; col < itsGrid.ncolumn(); ++col) {
+                itsGrid(row,col) = casa::Complex(uniform(), uniform());
+           }
+      }
+      itsVis = casa::Complex(0.3,-1.2);
+      itsInitialImpl = GridKernel::implementation();
+   }
+
+   void tearDown() {
+      GridKernel::selectImplementation(itsInitialImpl);
+   }
+
+   void testGrid() {
+      // supports giving both odd and even number of elements (including tail processing)
+      for (int support = 1; support < 12; ++support) {
+           const casa::Matrix<casa::Complex> cf = makeCF(support);
+           casa::Matrix<casa::Complex> expected = itsGrid.copy();
+           for (int v = -support; v < support; ++v) {
+                for (int u = -support; u < support; ++u) {
+                     expected(30 + u, 31 + v) += itsVis * cf(u + support, v + support);
+                }
+           }
+           for (int impl = 0; impl < int(GridKernel::N_IMPLEMENTATIONS); ++impl) {
+                if (!GridKernel::isSupported(GridKernel::Implementation(impl))) {
+                    continue;
+                }
+                GridKernel::selectImplementation(GridKernel::Implementation(impl));
+                casa::Matrix<casa::Complex> grid = itsGrid.copy();
+                casa::Matrix<casa::Complex> cfCopy = cf.copy();
+                GridKernel::grid(grid, cfCopy, itsVis, 30, 31, support);
+                for (casa::uInt row = 0; row < grid.nrow(); ++row) {
+                     for (casa::uInt col = 0; col < grid.ncolumn(); ++col) {
+                          CPPUNIT_ASSERT_DOUBLES_EQUAL(0., casa::abs(grid(row,col) - expected(row,col)), 1e-5);
+                     }
+                }
+           }
+      }
+   }
+
+   void testDegrid() {
+      for (int support = 1; support < 12; ++support) {
+           const casa::Matrix<casa::Complex> cf = makeCF(support);
+           casa::Complex expected(0.,0.);
+           for (int v = -support; v < support; ++v) {
+                for (int u = -support; u < support; ++u) {
+                     expected += cf(u + support, v + support) * conj(itsGrid(30 + u, 31 + v));
+                }
+           }
+           for (int impl = 0; impl < int(GridKernel::N_IMPLEMENTATIONS); ++impl) {
+                if (!GridKernel::isSupported(GridKernel::Implementation(impl))) {
+                    continue;
+                }
+                GridKernel::selectImplementation(GridKernel::Implementation(impl));
+                casa::Complex result;
+                GridKernel::degrid(result, cf, itsGrid, 30, 31, support);
+                CPPUNIT_ASSERT_DOUBLES_EQUAL(0., casa::abs(result - expected), 1e-4);
+           }
+      }
+   }
+
+   void testInfo() {
+      CPPUNIT_ASSERT(GridKernel::isSupported(GridKernel::SCALAR));
+      CPPUNIT_ASSERT(GridKernel::isSupported(GridKernel::implementation()));
+      CPPUNIT_ASSERT(GridKernel::info().size() > 0);
+      CPPUNIT_ASSERT(GridKernel::name(GridKernel::SCALAR) == "scalar");
+   }
+
+protected:
+   /// @return uniform random number in [-0.5,0.5]
+   static float uniform() {
+      return float(rand()) / float(RAND_MAX) - 0.5;
+   }
+
+   /// @brief make a random convolution function
+   /// @param[in] support support size
+   /// @return CF with the shape (2*support+1,2*support+1)
+   static casa::Matrix<casa::Complex> makeCF(const int support) {
+      casa::Matrix<casa::Complex> cf(2 * support + 1, 2 * support + 1);
+      for (casa::uInt row = 0; row < cf.nrow(); ++row) {
+           for (casa::uInt col = 0; col < cf.ncolumn(); ++col) {
+                cf(row,col) = casa::Complex(uniform(), uniform());
+           }
+      }
+      return cf;
+   }
+
+private:
+   casa::Matrix<casa::Complex> itsGrid;
+   casa::Complex itsVis;
+   GridKernel::Implementation itsInitialImpl;
+};
+
+} // namespace synthesis
+
+} // namespace askap
+
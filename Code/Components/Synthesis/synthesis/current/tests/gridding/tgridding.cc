@@ -32,6 +32,8 @@
 #include <SupportSearcherTest.h>
 #include <FrequencyMapperTest.h>
 #include <NonLinearWSamplingTest.h>
+#include <GridKernelTest.h>
+#include <CFCacheFileTest.h>
 
 int main(int argc, char *argv[])
 {
@@ -41,6 +43,8 @@ int main(int argc, char *argv[])
     runner.addTest( askap::synthesis::SupportSearcherTest::suite());
     runner.addTest( askap::synthesis::FrequencyMapperTest::suite());
     runner.addTest( askap::synthesis::NonLinearWSamplingTest::suite());
+    runner.addTest( askap::synthesis::GridKernelTest::suite());
+    runner.addTest( askap::synthesis::CFCacheFileTest::suite());
 
     bool wasSucessful = runner.run();
 
@@ -0,0 +1,106 @@
+/// @file
+/// 
+/// @brief Unit tests for the channel block bookkeeping of BPCalibratorParallel
+/// @details BPCalibratorParallel can accumulate a number of adjacent channels in
+/// one pass over the data. These tests check that the blocks cover all channels
+/// exactly once, including the case where the last block is shorter.
+/// 
+/// @copyright (c) 2015 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author Max Voronkov <maxim.voronkov@csiro.au>
+
+#ifndef SYNTHESIS_BP_CALIBRATOR_PARALLEL_TEST_H
+#define SYNTHESIS_BP_CALIBRATOR_PARALLEL_TEST_H
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <parallel/BPCalibratorParallel.h>
+
+namespace askap
+{
+  namespace synthesis
+  {
+    
+    class BPCalibratorParallelTest : public CppUnit::TestFixture
+    {
+      CPPUNIT_TEST_SUITE(BPCalibratorParallelTest);
+      CPPUNIT_TEST(testOneChannelPerPass);
+      CPPUNIT_TEST(testEvenSplit);
+      CPPUNIT_TEST(testShortLastBlock);
+      CPPUNIT_TEST(testBlockLargerThanBand);
+      CPPUNIT_TEST_SUITE_END();
+    public:
+       
+      void testOneChannelPerPass() {
+         CPPUNIT_ASSERT_EQUAL(304u, BPCalibratorParallel::nChanBlocks(304u, 1u));
+         CPPUNIT_ASSERT_EQUAL(1u, BPCalibratorParallel::nChanInPass(304u, 1u, 0u));
+         CPPUNIT_ASSERT_EQUAL(1u, BPCalibratorParallel::nChanInPass(304u, 1u, 303u));
+         checkCoverage(304u, 1u);
+      }
+
+      void testEvenSplit() {
+         CPPUNIT_ASSERT_EQUAL(19u, BPCalibratorParallel::nChanBlocks(304u, 16u));
+         CPPUNIT_ASSERT_EQUAL(16u, BPCalibratorParallel::nChanInPass(304u, 16u, 0u));
+         CPPUNIT_ASSERT_EQUAL(16u, BPCalibratorParallel::nChanInPass(304u, 16u, 288u));
+         checkCoverage(304u, 16u);
+      }
+
+      void testShortLastBlock() {
+         CPPUNIT_ASSERT_EQUAL(11u, BPCalibratorParallel::nChanBlocks(304u, 30u));
+         CPPUNIT_ASSERT_EQUAL(30u, BPCalibratorParallel::nChanInPass(304u, 30u, 270u));
+         CPPUNIT_ASSERT_EQUAL(4u, BPCalibratorParallel::nChanInPass(304u, 30u, 300u));
+         checkCoverage(304u, 30u);
+         checkCoverage(7u, 2u);
+      }
+
+      void testBlockLargerThanBand() {
+         CPPUNIT_ASSERT_EQUAL(1u, BPCalibratorParallel::nChanBlocks(5u, 8u));
+         CPPUNIT_ASSERT_EQUAL(5u, BPCalibratorParallel::nChanInPass(5u, 8u, 0u));
+         checkCoverage(5u, 8u);
+      }
+
+    protected:
+      /// @brief check that the blocks cover every channel exactly once
+      /// @param[in] nChan total number of channels
+      /// @param[in] nChanPerPass number of channels per block
+      static void checkCoverage(const casa::uInt nChan, const casa::uInt nChanPerPass) {
+         const casa::uInt nBlocks = BPCalibratorParallel::nChanBlocks(nChan, nChanPerPass);
+         casa::uInt expectedStart = 0;
+         for (casa::uInt block = 0; block < nBlocks; ++block) {
+              // this is how the first channel of the block is obtained from the work unit cursor
+              const casa::uInt startChan = block * nChanPerPass;
+              CPPUNIT_ASSERT_EQUAL(expectedStart, startChan);
+              CPPUNIT_ASSERT(startChan < nChan);
+              const casa::uInt nChanThisPass = BPCalibratorParallel::nChanInPass(nChan, nChanPerPass, startChan);
+              CPPUNIT_ASSERT(nChanThisPass > 0);
+              CPPUNIT_ASSERT(nChanThisPass <= nChanPerPass);
+              expectedStart += nChanThisPass;
+         }
+         CPPUNIT_ASSERT_EQUAL(nChan, expectedStart);
+      }
+    };
+    
+  } // namespace synthesis
+} // namespace askap
+
+#endif // #ifndef SYNTHESIS_BP_CALIBRATOR_PARALLEL_TEST_H
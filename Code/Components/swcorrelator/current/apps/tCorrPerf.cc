@@ -0,0 +1,112 @@
+/// @file 
+///
+/// @brief throughput benchmark for the correlator engine
+/// @details This application correlates random data for a given number of 
+/// antennas with MultiBaselineCorrelator (and, for reference, with
+/// Simple3BaselineCorrelator for each antenna triangle) and reports the 
+/// achieved rates. Usage: tCorrPerf [nAnt] [nSamples] [nIterations]
+///
+/// @copyright (c) 2015 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+
+#include <casa/OS/Timer.h>
+
+#include <swcorrelator/MultiBaselineCorrelator.h>
+#include <swcorrelator/SimpleCorrelator.h>
+
+#include <stdexcept>
+#include <iostream>
+#include <vector>
+#include <complex>
+#include <cstdlib>
+
+using namespace std;
+using namespace askap;
+using namespace askap::swcorrelator;
+
+// Main function
+int main(int argc, const char** argv)
+{
+    try {
+       const int nAnt = argc > 1 ? atoi(argv[1]) : 12;
+       const int size = argc > 2 ? atoi(argv[2]) : 1048576;
+       const int nIter = argc > 3 ? atoi(argv[3]) : 10;
+       if ((nAnt < 3) || (size <= 0) || (nIter <= 0)) {
+           throw std::invalid_argument("Usage: tCorrPerf [nAnt>=3] [nSamples] [nIterations]");
+       }
+       const int nBaselines = nAnt * (nAnt - 1) / 2;
+       cout<<"Correlating "<<nAnt<<" antennas ("<<nBaselines<<" baselines), "<<size<<
+             " samples per buffer, "<<nIter<<" iterations"<<endl;
+
+       // 8-bit like random data, same for all iterations
+       std::vector<std::vector<std::complex<float> > > buffers(nAnt, std::vector<std::complex<float> >(size));
+       std::vector<const std::complex<float>*> streams(nAnt);
+       for (int ant = 0; ant < nAnt; ++ant) {
+            for (int i = 0; i < size; ++i) {
+                 buffers[ant][i] = std::complex<float>(float(rand() % 256 - 128), float(rand() % 256 - 128));
+            }
+            streams[ant] = &buffers[ant][0];
+       }
+       std::vector<int> delays(nAnt, 0);
+       for (int ant = 0; ant < nAnt; ++ant) {
+            delays[ant] = ant % 3;
+       }
+       
+       casa::Timer timer;
+       MultiBaselineCorrelator<std::complex<float>, int> mbc(nAnt);
+       timer.mark();
+       for (int iter = 0; iter < nIter; ++iter) {
+            mbc.reset(delays);
+            mbc.accumulate(streams, size);
+       }
+       const double mbcTime = timer.real();
+       
+       // reference: 3-baseline correlator for the triangles covering all baselines (some are done more than once)
+       Simple3BaselineCorrelator<std::complex<float>, int> s3bc;
+       timer.mark();
+       int nTriangles = 0;
+       for (int iter = 0; iter < nIter; ++iter) {
+            for (int ant1 = 0; ant1 + 2 < nAnt; ++ant1) {
+                 for (int ant2 = ant1 + 1; ant2 + 1 < nAnt; ant2 += 2) {
+                      s3bc.reset(delays[ant1], delays[ant2], delays[ant2 + 1]);
+                      s3bc.accumulate(streams[ant1], streams[ant2], streams[ant2 + 1], size);
+                      ++nTriangles;
+                 }
+            }
+       }
+       const double s3bcTime = timer.real();
+       
+       const double totalSamples = double(size) * nIter;
+       cout<<"MultiBaselineCorrelator: "<<mbcTime<<" s, "<<totalSamples / mbcTime<<" samples/s, "<<
+             totalSamples * nBaselines / mbcTime<<" baseline-samples/s"<<endl;
+       cout<<"Simple3BaselineCorrelator: "<<s3bcTime<<" s, "<<double(size) * 3 * nTriangles / s3bcTime<<
+             " baseline-samples/s"<<endl;
+       if (nAnt == 3) {
+           cout<<"Check: vis(0,1) = "<<mbc.getVis(0,1)<<" vs "<<s3bc.getVis12()<<endl;
+       }
+    } catch (const std::exception& x) {
+        cerr << "Unexpected exception in " << argv[0] << ": " << x.what() << endl;
+        return 1;
+    }
+    return 0;
+}
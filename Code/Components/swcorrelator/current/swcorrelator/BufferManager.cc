@@ -199,6 +199,38 @@ BufferManager::BufferSet BufferManager::getFilledBuffers() const
   return result;
 }
 
+/// @brief get filled buffers of all antennas for a matching channel + beam
+/// @details This method is similar to getFilledBuffers, but returns the buffers
+/// of all antennas at once for the correlator which processes all baselines
+/// in one pass. The calling thread is blocked until a suitable set is available.
+/// If the 2nd antenna is duplicated, the last element refers to the same buffer
+/// as the 2nd one.
+/// @return vector with buffer IDs, one per antenna
+casa::Vector<int> BufferManager::getFilledBufferGroup() const
+{
+  boost::unique_lock<boost::mutex> lock(itsStatusCVMutex);
+  std::pair<int,int> index;
+  while (findCompleteSet(index)) {  
+     itsStatusCV.wait(lock);
+  }
+  ASKAPDEBUGASSERT(itsReadyBuffers.nrow() >= 3);
+  // copy, as the ready buffers are reset below
+  casa::Vector<int> result = readyBuffers(index).copy();
+  if (itsDuplicate2nd) {
+      result[result.nelements() - 1] = result[1];
+  }
+  // remove buffers for the given channel/beam pair, so the next complete set should correspond to a different one
+  const casa::uInt nAntToIterate = itsDuplicate2nd ? itsReadyBuffers.nrow() - 1 : itsReadyBuffers.nrow();    
+  for (casa::uInt ant = 0; ant < nAntToIterate; ++ant) {
+       const int id = itsReadyBuffers(ant, index.first, index.second);
+       ASKAPDEBUGASSERT(id >= 0);
+       ASKAPDEBUGASSERT(id < itsNBuf);
+       itsStatus[id] = BUF_BEING_PROCESSED;      
+       itsReadyBuffers(ant, index.first, index.second) = -1;
+  }
+  return result;
+}
+
 /// @brief find a complete set of data 
 /// @details We process all antennas simultaneously (for speed). This method
 /// finds channel/beam numbers which are ready to be correlated
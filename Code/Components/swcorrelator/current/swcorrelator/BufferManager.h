@@ -130,6 +130,15 @@ public:
    /// is available for correlation.
    /// @return a set of buffers ready for correlation
    virtual BufferSet getFilledBuffers() const;
+
+   /// @brief get filled buffers of all antennas for a matching channel + beam
+   /// @details This method is similar to getFilledBuffers, but returns the buffers
+   /// of all antennas at once for the correlator which processes all baselines
+   /// in one pass. The calling thread is blocked until a suitable set is available.
+   /// If the 2nd antenna is duplicated, the last element refers to the same buffer
+   /// as the 2nd one.
+   /// @return vector with buffer IDs, one per antenna
+   casa::Vector<int> getFilledBufferGroup() const;
    
    /// @brief get one filled buffer
    /// @details This method is only used with the capture, correlation
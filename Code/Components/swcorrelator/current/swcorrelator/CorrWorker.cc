@@ -32,12 +32,15 @@
 /// @author Max Voronkov <maxim.voronkov@csiro.au>
 
 #include <swcorrelator/CorrWorker.h>
-#include <swcorrelator/SimpleCorrelator.h>
+#include <swcorrelator/MultiBaselineCorrelator.h>
 #include <askap/AskapError.h>
 #include <askap_swcorrelator.h>
 #include <askap/AskapLogging.h>
 #include <boost/thread.hpp>
 
+#include <vector>
+#include <complex>
+
 ASKAP_LOGGER(logger, ".corrworker");
 
 namespace askap {
@@ -62,82 +65,90 @@ void CorrWorker::operator()()
   try {
     ASKAPDEBUGASSERT(itsFiller);
     ASKAPDEBUGASSERT(itsBufferManager);
-    Simple3BaselineCorrelator<std::complex<float>, int> s3bc;
+    const int nAnt = int(itsFiller->nAnt());
+    MultiBaselineCorrelator<std::complex<float>, int> mbc(nAnt);
+    const bool duplicate2nd = itsBufferManager->is2ndDuplicated();
     // buffer size in complex floats
     const int size = (itsBufferManager->bufferSize() - int(sizeof(BufferHeader))) / sizeof(float) / 2;
+    std::vector<const std::complex<float>*> streams(nAnt);
+    std::vector<int> delays(nAnt);
+    std::vector<int> frames(nAnt);
+    std::vector<int> baselines(nAnt * nAnt, -1);
     while (true) {
-       // extract the first complete set of buffers
-       BufferManager::BufferSet ids = itsBufferManager->getFilledBuffers();
-       const BufferHeader& hdrAnt1 = itsBufferManager->header(ids.itsAnt1); 
-       const BufferHeader& hdrAnt2 = itsBufferManager->header(ids.itsAnt2); 
-       const BufferHeader& hdrAnt3 = itsBufferManager->header(ids.itsAnt3); 
+       // extract the complete set of buffers for all antennas
+       const casa::Vector<int> ids = itsBufferManager->getFilledBufferGroup();
+       ASKAPDEBUGASSERT(int(ids.nelements()) == nAnt);
+       const BufferHeader& hdrAnt1 = itsBufferManager->header(ids[0]); 
        const uint64_t bat = hdrAnt1.bat;
        const int beam = hdrAnt1.beam;
        const int chan = hdrAnt1.freqId;
-       // consistency checks
-       ASKAPDEBUGASSERT(beam == int(hdrAnt2.beam));
-       ASKAPDEBUGASSERT(beam == int(hdrAnt3.beam));
-       ASKAPDEBUGASSERT(chan == int(hdrAnt2.freqId));
-       ASKAPDEBUGASSERT(chan == int(hdrAnt3.freqId));
-       ASKAPDEBUGASSERT(bat == hdrAnt2.bat);
-       ASKAPDEBUGASSERT(bat == hdrAnt3.bat);
-       const int frameOff_01 = int(hdrAnt1.frame) - int(hdrAnt2.frame);
-       const int frameOff_12 = int(hdrAnt2.frame) - int(hdrAnt3.frame);
-       const int frameOff_02 = int(hdrAnt1.frame) - int(hdrAnt3.frame);
-       // for debugging
-       if ((chan == 0) || (chan == 8)) {
-          ASKAPLOG_INFO_STR(logger, "Frame difference (ant"<<hdrAnt1.antenna<<" - ant"<<hdrAnt2.antenna<<") is "<<
-                            frameOff_01<<" for chan="<<chan);
-          ASKAPLOG_INFO_STR(logger, "                 (ant"<<hdrAnt2.antenna<<" - ant"<<hdrAnt3.antenna<<") is "<<
-                            frameOff_12<<" for chan="<<chan);
-          ASKAPLOG_INFO_STR(logger, "                 (ant"<<hdrAnt1.antenna<<" - ant"<<hdrAnt3.antenna<<") is "<<
-                            frameOff_02<<" for chan="<<chan);
+       bool sameControl = true;
+       for (int ant = 0; ant < nAnt; ++ant) {
+            const BufferHeader& hdr = itsBufferManager->header(ids[ant]); 
+            // consistency checks
+            ASKAPDEBUGASSERT(beam == int(hdr.beam));
+            ASKAPDEBUGASSERT(chan == int(hdr.freqId));
+            ASKAPDEBUGASSERT(bat == hdr.bat);
+            frames[ant] = int(hdr.frame);
+            // derive offsets from frame differences
+            delays[ant] = int(hdrAnt1.frame) - frames[ant];
+            streams[ant] = itsBufferManager->data(ids[ant]);
+            sameControl = sameControl && (hdr.control == hdrAnt1.control);
+            // for debugging
+            if ((ant > 0) && ((chan == 0) || (chan == 8))) {
+                ASKAPLOG_INFO_STR(logger, "Frame difference (ant"<<hdrAnt1.antenna<<" - ant"<<hdr.antenna<<") is "<<
+                                  delays[ant]<<" for chan="<<chan);
+            }
        }
        // run correlation
-       //s3bc.reset(0,0,0); // zero delays for now
-       //s3bc.reset(0,0,+1); // for testing
-       s3bc.reset(0,frameOff_01,frameOff_02); // derive offsets from frame differences
-       //s3bc.reset(0,frameOff_01,frameOff_02+3); // derive offsets from frame differences
-       //s3bc.reset(0,frameOff_01-1,frameOff_02-1); // derive offsets from frame differences
-       //s3bc.reset(0,frameOff_01 + 1,frameOff_02 - (chan-8)); // derive offsets from frame differences
-       s3bc.accumulate(itsBufferManager->data(ids.itsAnt1), itsBufferManager->data(ids.itsAnt2), 
-                       itsBufferManager->data(ids.itsAnt3), size);
+       mbc.reset(delays);
+       mbc.accumulate(streams, size);
        // store the result
        CorrProducts& cp = itsFiller->productsBuffer(beam, bat);
        cp.itsBAT = bat;
-       const int baseline0 = cp.baseline(hdrAnt1.antenna, hdrAnt2.antenna);
-       const int baseline1 = itsBufferManager->is2ndDuplicated() ? 1 : cp.baseline(hdrAnt2.antenna, hdrAnt3.antenna);
-       const int baseline2 = itsBufferManager->is2ndDuplicated() ? 2 : cp.baseline(hdrAnt1.antenna, hdrAnt3.antenna);
-       ASKAPDEBUGASSERT(baseline0 < int(cp.nBaseline()));
-       ASKAPDEBUGASSERT(baseline1 < int(cp.nBaseline()));
-       ASKAPDEBUGASSERT(baseline2 < int(cp.nBaseline()));
+       // nothing is correlated if any delay exceeds the buffer, the data are invalid for all baselines then
+       const bool noSamples = (mbc.nSamples() == 0);
+       if (noSamples) {
+           ASKAPLOG_WARN_STR(logger, "No samples correlated for beam="<<beam<<" chan="<<chan<<
+                             ", delays exceed the buffer size of "<<size<<" samples; all baselines are flagged");
+       }
        
        if (chan==0) {
-          ASKAPDEBUGASSERT(hdrAnt1.antenna < cp.itsControl.nelements());
-          ASKAPDEBUGASSERT(hdrAnt2.antenna < cp.itsControl.nelements());
-          ASKAPDEBUGASSERT(hdrAnt3.antenna < cp.itsControl.nelements());          
-          cp.itsControl[hdrAnt1.antenna] = hdrAnt1.control;
-          cp.itsControl[hdrAnt2.antenna] = hdrAnt2.control;
-          cp.itsControl[hdrAnt3.antenna] = hdrAnt3.control;
+          for (int ant = 0; ant < nAnt; ++ant) {
+               const BufferHeader& hdr = itsBufferManager->header(ids[ant]); 
+               ASKAPDEBUGASSERT(hdr.antenna < cp.itsControl.nelements());
+               cp.itsControl[hdr.antenna] = hdr.control;
+          }
        }
-       // unflag this channel if frame offset is less than 100 by absolute value (it should be within a few steps); false is good here
-          //cp.itsFlag.column(chan).set(false);
-          cp.itsFlag(baseline0,chan) = (abs(frameOff_01) >= 100);
-          cp.itsFlag(baseline1,chan) = (abs(frameOff_12) >= 100);
-          cp.itsFlag(baseline2,chan) = (abs(frameOff_02) >= 100);
-       //
-       // flag if control is different. We do it in the filler anyway, but it is handy to also do it earlier as it would be more
-       // clear from the logs when this condition took place.
-       if ((hdrAnt1.control != hdrAnt2.control) || (hdrAnt1.control != hdrAnt3.control) || (hdrAnt2.control != hdrAnt3.control)) {
-           cp.itsFlag(baseline0,chan) = true;
-           cp.itsFlag(baseline1,chan) = true;
-           cp.itsFlag(baseline2,chan) = true;
+       for (int ant1 = 0; ant1 < nAnt; ++ant1) {
+            for (int ant2 = ant1 + 1; ant2 < nAnt; ++ant2) {
+                 // the 3rd antenna is a copy of the 2nd in the duplicate mode, keep the baseline order of
+                 // the 3-antenna case
+                 const int baseline = duplicate2nd ? (ant2 - ant1 == 1 ? ant1 : 2) : 
+                       cp.baseline(itsBufferManager->header(ids[ant1]).antenna, itsBufferManager->header(ids[ant2]).antenna);
+                 ASKAPDEBUGASSERT(baseline < int(cp.nBaseline()));
+                 baselines[ant1 * nAnt + ant2] = baseline;
+                 // unflag this channel if frame offset is less than 100 by absolute value (it should be within a few steps); false is good here
+                 // flag if control is different. We do it in the filler anyway, but it is handy to also do it earlier as it would be more
+                 // clear from the logs when this condition took place. Also flag if nothing has been correlated.
+                 cp.itsFlag(baseline,chan) = (abs(frames[ant1] - frames[ant2]) >= 100) || !sameControl || noSamples;
+            }
+       }
+       if (duplicate2nd) {
+           // don't release the same buffer twice
+           casa::Vector<int> idsToRelease = ids.copy();
+           idsToRelease[nAnt - 1] = -1;
+           itsBufferManager->releaseBuffers(idsToRelease);
+       } else {
+           itsBufferManager->releaseBuffers(ids);
        }
-       itsBufferManager->releaseBuffers(ids);
        //
-       cp.itsVisibility(baseline0,chan) = s3bc.getVis12() / float(s3bc.nSamples12()!=0 ? s3bc.nSamples12() : 1.);
-       cp.itsVisibility(baseline1,chan) = s3bc.getVis23() / float(s3bc.nSamples23()!=0 ? s3bc.nSamples23() : 1.);
-       cp.itsVisibility(baseline2,chan) = s3bc.getVis13() / float(s3bc.nSamples13()!=0 ? s3bc.nSamples13() : 1.);       
+       const float nSamples = float(mbc.nSamples() != 0 ? mbc.nSamples() : 1.);
+       for (int ant1 = 0; ant1 < nAnt; ++ant1) {
+            for (int ant2 = ant1 + 1; ant2 < nAnt; ++ant2) {
+                 cp.itsVisibility(baselines[ant1 * nAnt + ant2],chan) = mbc.getVis(ant1, ant2) / nSamples;
+            }
+       }
        itsFiller->notifyProductsReady(beam);
     }
   } catch (const boost::thread_interrupted &) { 
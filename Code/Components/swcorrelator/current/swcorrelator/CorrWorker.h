@@ -2,9 +2,9 @@
 ///
 /// @brief Thread which does correlation
 /// @details This class holds shared pointers to the filler and the buffer
-/// manager. The parallel thread extracts data corresponding to all three 
-/// baselines, some spectral channel and beam, correlates them and passes
-/// to the filler for writing. The filler and buffer manager manage 
+/// manager. The parallel thread extracts data of all antennas for some 
+/// spectral channel and beam, correlates all baselines in one pass and passes
+/// the result to the filler for writing. The filler and buffer manager manage 
 /// synchronisation.
 ///
 /// @copyright (c) 2007 CSIRO
@@ -44,9 +44,9 @@ namespace swcorrelator {
 
 /// @brief Thread which does correlation
 /// @details This class holds shared pointers to the filler and the buffer
-/// manager. The parallel thread extracts data corresponding to all three 
-/// baselines, some spectral channel and beam, correlates them and passes
-/// to the filler for writing. The filler and buffer manager manage 
+/// manager. The parallel thread extracts data of all antennas for some 
+/// spectral channel and beam, correlates all baselines in one pass and passes
+/// the result to the filler for writing. The filler and buffer manager manage 
 /// synchronisation.
 /// @ingroup swcorrelator
 struct CorrWorker {
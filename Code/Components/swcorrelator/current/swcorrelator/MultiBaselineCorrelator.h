@@ -0,0 +1,174 @@
+/// @file 
+///
+/// @brief X-step of a correlator for an arbitrary number of antennas
+/// @details This templated class correlates all baselines formed by a set of
+/// antenna streams in a single pass. Unlike SimpleCorrelator and 
+/// Simple3BaselineCorrelator, it is not limited to 3 antennas and is written to
+/// be vectorised by the compiler.
+///
+/// @copyright (c) 2015 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+
+#ifndef MULTI_BASELINE_CORRELATOR_H
+#define MULTI_BASELINE_CORRELATOR_H
+
+// for SUBTRACT_DC
+#include <swcorrelator/SimpleCorrelator.h>
+
+#include <stdexcept>
+#include <vector>
+#include <complex>
+
+namespace askap {
+
+namespace swcorrelator {
+
+/// @brief correlator for all baselines of an arbitrary number of antennas, single delay step
+/// @details The streams are correlated in blocks of samples small enough to stay in 
+/// cache. Each block is unpacked into separate arrays of real and imaginary parts, so
+/// the inner loop over samples for every baseline is a simple multiply-add on 
+/// contiguous data which the compiler can vectorise. Partial sums are kept for a number
+/// of lanes to allow this without relaxing floating point semantics. Each antenna may 
+/// have its own integer delay (in samples). Only the samples available for all 
+/// antennas are correlated, so the number of samples is the same for all baselines.
+///
+/// Template parameters:
+///    AccType - type of the accumulated values (a complex type, may be different from
+///              the input data type to allow overflow)
+///    IndexType - type of the sample index 
+/// @ingroup swcorrelator
+template<typename AccType = std::complex<float>, typename IndexType = int>         
+class MultiBaselineCorrelator {
+public:
+  /// @brief constructor
+  /// @details All delays are set to zero
+  /// @param[in] nAnt number of antennas (should be at least 2)
+  explicit MultiBaselineCorrelator(const IndexType nAnt);
+  
+  /// @brief reset accumulator, adjust delays
+  /// @details 
+  /// @param[in] delays delays (in samples) for every antenna, the vector should
+  /// have nAnt elements
+  /// @note the buffers are treated as parts of the continuous
+  /// stream. Incomplete buffers are ignored for simplicity.
+  void reset(const std::vector<IndexType> &delays);
+  
+  /// @brief just reset accumulator
+  /// @details This method can be used to move to the next integration cycle
+  void reset();
+  
+  /// @brief obtain the number of antennas
+  /// @return number of antennas
+  inline IndexType nAnt() const { return itsNAnt; }
+
+  /// @brief obtain the number of baselines
+  /// @return number of baselines (excluding auto-correlations)
+  inline IndexType nBaseline() const { return itsNAnt * (itsNAnt - 1) / 2; }
+  
+  /// @brief obtain accumulated visibility
+  /// @details If SUBTRACT_DC is defined, the product of the means is subtracted
+  /// the same way as in Simple3BaselineCorrelator. The result should be divided by 
+  /// nSamples() to get the average.
+  /// @param[in] ant1 index of the first antenna
+  /// @param[in] ant2 index of the second antenna (should be different from ant1)
+  /// @return sum over samples of the first stream times conjugated second stream
+  AccType getVis(const IndexType ant1, const IndexType ant2) const;
+  
+#ifdef SUBTRACT_DC
+  /// @brief obtain sum of samples
+  /// @param[in] ant antenna index
+  /// @return sum of all correlated samples for the given antenna
+  inline AccType getSum(const IndexType ant) const { return itsSums[ant]; }
+#endif
+
+  /// @return obtain number of accumulated samples (the same for all baselines)
+  inline IndexType nSamples() const { return itsSamples; }
+
+  /// @brief accumulate buffers
+  /// @details 
+  /// The parameter of the template is as follows.
+  ///    Iter - type of the read-only random-access iterator to read the data buffer
+  ///           (it could be just an ordinary pointer)
+  /// @param[in] streams start iterators of the streams, one per antenna
+  /// @param[in] size number of samples in each stream
+  /// @note Nothing is accumulated if any delay is not less than size, the caller
+  /// should check nSamples() and flag the data in this case
+  template<typename Iter>
+  void accumulate(const std::vector<Iter> &streams, const IndexType size);
+
+private:
+  /// @brief type of the real and imaginary parts
+  typedef typename AccType::value_type RealType;
+  
+  /// @brief block parameters
+  /// @details BlockSize is the number of samples unpacked per antenna at a time. It 
+  /// is a multiple of NLanes, the number of independent partial sums per baseline.
+  enum { 
+     BlockSize = 256, 
+     NLanes = 8
+  };
+  
+  /// @brief index of the baseline for a pair of antennas
+  /// @param[in] ant1 index of the first antenna
+  /// @param[in] ant2 index of the second antenna, should be greater than ant1
+  /// @return index into itsVis
+  inline IndexType baselineIndex(const IndexType ant1, const IndexType ant2) const 
+     { return ant1 * (2 * itsNAnt - ant1 - 1) / 2 + ant2 - ant1 - 1; }
+  
+  /// @brief correlate one block of unpacked samples for all baselines
+  /// @param[in] nPadded number of samples in the block rounded up to a multiple of NLanes
+  void correlateBlock(const IndexType nPadded);
+  
+  /// @brief number of antennas
+  IndexType itsNAnt;
+  
+  /// @brief delays (in samples) for all antennas
+  /// @details The smallest delay is subtracted, so all elements are non-negative
+  std::vector<IndexType> itsDelays;
+  
+  /// @brief accumulators for all baselines
+  /// @details baselines are ordered 0-1, 0-2, ..., 0-(nAnt-1), 1-2, ...
+  std::vector<AccType> itsVis;
+  
+  /// @brief number of accumulated samples
+  IndexType itsSamples;
+
+#ifdef SUBTRACT_DC
+  /// @brief sum of samples for every antenna
+  std::vector<AccType> itsSums;
+#endif
+
+  /// @brief real parts of the current block, BlockSize samples per antenna
+  std::vector<RealType> itsRe;
+
+  /// @brief imaginary parts of the current block, BlockSize samples per antenna
+  std::vector<RealType> itsIm;
+};
+
+} // namespace swcorrelator
+
+} // namespace askap
+
+#include <swcorrelator/MultiBaselineCorrelator.tcc>
+
+#endif // #ifndef MULTI_BASELINE_CORRELATOR_H
@@ -0,0 +1,230 @@
+/// @file 
+///
+/// @brief X-step of a correlator for an arbitrary number of antennas
+/// @details This templated class correlates all baselines formed by a set of
+/// antenna streams in a single pass. Unlike SimpleCorrelator and 
+/// Simple3BaselineCorrelator, it is not limited to 3 antennas and is written to
+/// be vectorised by the compiler.
+///
+/// @copyright (c) 2015 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+
+#ifndef MULTI_BASELINE_CORRELATOR_TCC
+#define MULTI_BASELINE_CORRELATOR_TCC
+
+#include <algorithm>
+
+namespace askap {
+
+namespace swcorrelator {
+
+/// @brief constructor
+/// @details All delays are set to zero
+/// @param[in] nAnt number of antennas (should be at least 2)
+template<typename AccType, typename IndexType>         
+MultiBaselineCorrelator<AccType, IndexType>::MultiBaselineCorrelator(const IndexType nAnt) :
+         itsNAnt(nAnt), itsDelays(nAnt, IndexType(0)), itsVis(nAnt * (nAnt - 1) / 2, AccType(0)),
+         itsSamples(0),
+#ifdef SUBTRACT_DC
+         itsSums(nAnt, AccType(0)),
+#endif
+         itsRe(nAnt * BlockSize, RealType(0)), itsIm(nAnt * BlockSize, RealType(0))
+{
+  if (nAnt < 2) {
+      throw std::invalid_argument("MultiBaselineCorrelator requires at least 2 antennas");
+  }
+}
+
+/// @brief reset accumulator, adjust delays
+/// @details 
+/// @param[in] delays delays (in samples) for every antenna, the vector should
+/// have nAnt elements
+/// @note the buffers are treated as parts of the continuous
+/// stream. Incomplete buffers are ignored for simplicity.
+template<typename AccType, typename IndexType>         
+void MultiBaselineCorrelator<AccType, IndexType>::reset(const std::vector<IndexType> &delays)
+{
+  if (IndexType(delays.size()) != itsNAnt) {
+      throw std::invalid_argument("MultiBaselineCorrelator::reset - one delay per antenna is expected");
+  }
+  const IndexType minDelay = *std::min_element(delays.begin(), delays.end());
+  for (IndexType ant = 0; ant < itsNAnt; ++ant) {
+       itsDelays[ant] = delays[ant] - minDelay;
+  }
+  reset();
+}
+
+/// @brief just reset accumulator
+/// @details This method can be used to move to the next integration cycle
+template<typename AccType, typename IndexType>         
+void MultiBaselineCorrelator<AccType, IndexType>::reset()
+{
+  std::fill(itsVis.begin(), itsVis.end(), AccType(0));
+  itsSamples = IndexType(0);
+#ifdef SUBTRACT_DC
+  std::fill(itsSums.begin(), itsSums.end(), AccType(0));
+#endif
+}
+
+/// @brief obtain accumulated visibility
+/// @details If SUBTRACT_DC is defined, the product of the means is subtracted
+/// the same way as in Simple3BaselineCorrelator. The result should be divided by 
+/// nSamples() to get the average.
+/// @param[in] ant1 index of the first antenna
+/// @param[in] ant2 index of the second antenna (should be different from ant1)
+/// @return sum over samples of the first stream times conjugated second stream
+template<typename AccType, typename IndexType>         
+AccType MultiBaselineCorrelator<AccType, IndexType>::getVis(const IndexType ant1, const IndexType ant2) const
+{
+  if ((ant1 == ant2) || (ant1 < 0) || (ant2 < 0) || (ant1 >= itsNAnt) || (ant2 >= itsNAnt)) {
+      throw std::invalid_argument("MultiBaselineCorrelator::getVis - invalid antenna pair");
+  }
+  if (ant1 > ant2) {
+      return conj(getVis(ant2, ant1));
+  }
+#ifdef SUBTRACT_DC
+  return itsVis[baselineIndex(ant1, ant2)] - itsSums[ant1] * conj(itsSums[ant2]) / 
+         float(itsSamples != 0 ? itsSamples : 1);
+#else
+  return itsVis[baselineIndex(ant1, ant2)];
+#endif
+}
+
+/// @brief accumulate buffers
+/// @details 
+/// The parameter of the template is as follows.
+///    Iter - type of the read-only random-access iterator to read the data buffer
+///           (it could be just an ordinary pointer)
+/// @param[in] streams start iterators of the streams, one per antenna
+/// @param[in] size number of samples in each stream
+/// @note Nothing is accumulated if any delay is not less than size, the caller
+/// should check nSamples() and flag the data in this case
+template<typename AccType, typename IndexType>         
+template<typename Iter>
+void MultiBaselineCorrelator<AccType, IndexType>::accumulate(const std::vector<Iter> &streams, 
+            const IndexType size)
+{
+  if (IndexType(streams.size()) != itsNAnt) {
+      throw std::invalid_argument("MultiBaselineCorrelator::accumulate - one stream per antenna is expected");
+  }
+  const IndexType largestDelay = *std::max_element(itsDelays.begin(), itsDelays.end());
+  if (largestDelay >= size) {
+      return;
+  }
+  const IndexType nSamples = size - largestDelay;
+  for (IndexType start = 0; start < nSamples; start += BlockSize) {
+       const IndexType nInBlock = std::min(IndexType(BlockSize), nSamples - start);
+       const IndexType nPadded = (nInBlock + NLanes - 1) / NLanes * NLanes;
+       // unpack the block, padding with zeros up to a multiple of NLanes
+       for (IndexType ant = 0; ant < itsNAnt; ++ant) {
+            Iter it = streams[ant] + itsDelays[ant] + start;
+            RealType *re = &itsRe[ant * BlockSize];
+            RealType *im = &itsIm[ant * BlockSize];
+            for (IndexType i = 0; i < nInBlock; ++i, ++it) {
+                 const AccType val(*it);
+                 re[i] = real(val);
+                 im[i] = imag(val);
+            }
+            for (IndexType i = nInBlock; i < nPadded; ++i) {
+                 re[i] = RealType(0);
+                 im[i] = RealType(0);
+            }
+#ifdef SUBTRACT_DC
+            // independent partial sums, the same way as in correlateBlock
+            RealType sumRe[NLanes];
+            RealType sumIm[NLanes];
+            for (int lane = 0; lane < NLanes; ++lane) {
+                 sumRe[lane] = RealType(0);
+                 sumIm[lane] = RealType(0);
+            }
+            for (IndexType i = 0; i < nPadded; i += NLanes) {
+                 // the unroll pragma is only known to GCC 8 and later
+#if defined(__GNUC__) && __GNUC__ >= 8
+#pragma GCC unroll 1
+#endif
+                 for (int lane = 0; lane < NLanes; ++lane) {
+                      sumRe[lane] += re[i + lane];
+                      sumIm[lane] += im[i + lane];
+                 }
+            }
+            for (int lane = 0; lane < NLanes; ++lane) {
+                 itsSums[ant] += AccType(sumRe[lane], sumIm[lane]);
+            }
+#endif
+       }
+       correlateBlock(nPadded);
+  }
+  itsSamples += nSamples;
+}
+
+/// @brief correlate one block of unpacked samples for all baselines
+/// @param[in] nPadded number of samples in the block rounded up to a multiple of NLanes
+template<typename AccType, typename IndexType>         
+void MultiBaselineCorrelator<AccType, IndexType>::correlateBlock(const IndexType nPadded)
+{
+  typename std::vector<AccType>::iterator visIt = itsVis.begin();
+  for (IndexType ant1 = 0; ant1 < itsNAnt; ++ant1) {
+       const RealType *re1 = &itsRe[ant1 * BlockSize];
+       const RealType *im1 = &itsIm[ant1 * BlockSize];
+       for (IndexType ant2 = ant1 + 1; ant2 < itsNAnt; ++ant2, ++visIt) {
+            const RealType *re2 = &itsRe[ant2 * BlockSize];
+            const RealType *im2 = &itsIm[ant2 * BlockSize];
+            // independent partial sums, the inner loop maps onto vector registers
+            RealType accRe[NLanes];
+            RealType accIm[NLanes];
+            for (int lane = 0; lane < NLanes; ++lane) {
+                 accRe[lane] = RealType(0);
+                 accIm[lane] = RealType(0);
+            }
+            for (IndexType i = 0; i < nPadded; i += NLanes) {
+                 const RealType *r1 = re1 + i;
+                 const RealType *i1 = im1 + i;
+                 const RealType *r2 = re2 + i;
+                 const RealType *i2 = im2 + i;
+                 // keep the lane loop rolled, so it is vectorised as a whole rather than
+                 // unrolled and vectorised across the outer loop (which is much slower).
+                 // The unroll pragma is only known to GCC 8 and later
+#if defined(__GNUC__) && __GNUC__ >= 8
+#pragma GCC unroll 1
+#endif
+                 for (int lane = 0; lane < NLanes; ++lane) {
+                      accRe[lane] += r1[lane] * r2[lane] + i1[lane] * i2[lane];
+                      accIm[lane] += i1[lane] * r2[lane] - r1[lane] * i2[lane];
+                 }
+            }
+            RealType sumRe = RealType(0);
+            RealType sumIm = RealType(0);
+            for (int lane = 0; lane < NLanes; ++lane) {
+                 sumRe += accRe[lane];
+                 sumIm += accIm[lane];
+            }
+            *visIt += AccType(sumRe, sumIm);
+       }
+  }
+}
+
+} // namespace swcorrelator
+
+} // namespace askap
+
+#endif // #ifndef MULTI_BASELINE_CORRELATOR_TCC
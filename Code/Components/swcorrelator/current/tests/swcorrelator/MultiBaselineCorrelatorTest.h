@@ -0,0 +1,175 @@
+/// @file
+///
+/// @brief Test of the MultiBaselineCorrelator class
+///
+/// @copyright (c) 2015 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+
+#ifndef ASKAP_SWCORRELATOR_MULTI_BASELINE_CORRELATOR_TEST_H
+#define ASKAP_SWCORRELATOR_MULTI_BASELINE_CORRELATOR_TEST_H
+
+#include <cppunit/extensions/HelperMacros.h>
+
+// Class under test
+#include <swcorrelator/MultiBaselineCorrelator.h>
+#include <swcorrelator/SimpleCorrelator.h>
+
+#include <vector>
+#include <complex>
+#include <cstdlib>
+#include <stdexcept>
+
+namespace askap {
+
+namespace swcorrelator {
+
+class MultiBaselineCorrelatorTest : public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(MultiBaselineCorrelatorTest);
+  CPPUNIT_TEST(testCompareWith3Baseline);
+  CPPUNIT_TEST(testManyAntennas);
+  CPPUNIT_TEST(testLargeDelay);
+  CPPUNIT_TEST_EXCEPTION(testTooFewAntennas, std::invalid_argument);
+  CPPUNIT_TEST_SUITE_END();
+public:
+  
+  void setUp() {
+     // the size is not a multiple of the block size to test incomplete blocks
+     const int size = 1000;
+     itsStreams.resize(7);
+     srand(12345);
+     for (size_t ant = 0; ant < itsStreams.size(); ++ant) {
+          itsStreams[ant].resize(size);
+          for (int i = 0; i < size; ++i) {
+               // 8-bit like integers, so the sums are exact
+               itsStreams[ant][i] = std::complex<float>(float(rand() % 15 - 7), float(rand() % 15 - 7));
+          }
+     }
+  }
+  
+  void testCompareWith3Baseline() {
+     const int size = int(itsStreams[0].size());
+     Simple3BaselineCorrelator<std::complex<float>, int> s3bc(0, 2, 5);
+     s3bc.accumulate(&itsStreams[0][0], &itsStreams[1][0], &itsStreams[2][0], size);
+     
+     MultiBaselineCorrelator<std::complex<float>, int> mbc(3);
+     CPPUNIT_ASSERT_EQUAL(3, mbc.nAnt());
+     CPPUNIT_ASSERT_EQUAL(3, mbc.nBaseline());
+     std::vector<int> delays(3);
+     // only relative delays matter
+     delays[0] = 1;
+     delays[1] = 3;
+     delays[2] = 6;
+     mbc.reset(delays);
+     mbc.accumulate(streams(3), size);
+     CPPUNIT_ASSERT_EQUAL(s3bc.nSamples12(), mbc.nSamples());
+     compare(s3bc.getVis12(), mbc.getVis(0, 1));
+     compare(s3bc.getVis23(), mbc.getVis(1, 2));
+     compare(s3bc.getVis13(), mbc.getVis(0, 2));
+     // reverse order gives the conjugate
+     compare(conj(s3bc.getVis13()), mbc.getVis(2, 0));
+     
+     // the next integration cycle
+     mbc.reset();
+     CPPUNIT_ASSERT_EQUAL(0, mbc.nSamples());
+     compare(std::complex<float>(0., 0.), mbc.getVis(0, 1));
+  }
+  
+  void testManyAntennas() {
+     const int nAnt = int(itsStreams.size());
+     const int size = int(itsStreams[0].size());
+     MultiBaselineCorrelator<std::complex<float>, int> mbc(nAnt);
+     CPPUNIT_ASSERT_EQUAL(nAnt * (nAnt - 1) / 2, mbc.nBaseline());
+     std::vector<int> delays(nAnt);
+     for (int ant = 0; ant < nAnt; ++ant) {
+          delays[ant] = (ant * 3) % 5;
+     }
+     mbc.reset(delays);
+     mbc.accumulate(streams(nAnt), size);
+     const int nSamples = size - 4;
+     CPPUNIT_ASSERT_EQUAL(nSamples, mbc.nSamples());
+     for (int ant1 = 0; ant1 < nAnt; ++ant1) {
+          for (int ant2 = ant1 + 1; ant2 < nAnt; ++ant2) {
+               // brute force calculation
+               std::complex<float> vis(0., 0.);
+               std::complex<float> sum1(0., 0.);
+               std::complex<float> sum2(0., 0.);
+               for (int i = 0; i < nSamples; ++i) {
+                    const std::complex<float> val1 = itsStreams[ant1][i + delays[ant1]];
+                    const std::complex<float> val2 = itsStreams[ant2][i + delays[ant2]];
+                    vis += val1 * conj(val2);
+                    sum1 += val1;
+                    sum2 += val2;
+               }
+#ifdef SUBTRACT_DC
+               vis -= sum1 * conj(sum2) / float(nSamples);
+#endif
+               compare(vis, mbc.getVis(ant1, ant2));
+          }
+     }
+  }
+  
+  void testLargeDelay() {
+     const int size = int(itsStreams[0].size());
+     MultiBaselineCorrelator<std::complex<float>, int> mbc(3);
+     std::vector<int> delays(3, 0);
+     delays[1] = size;
+     mbc.reset(delays);
+     // nothing overlaps, the data are ignored
+     mbc.accumulate(streams(3), size);
+     CPPUNIT_ASSERT_EQUAL(0, mbc.nSamples());
+     compare(std::complex<float>(0., 0.), mbc.getVis(0, 1));
+  }
+  
+  void testTooFewAntennas() {
+     // exception is expected here
+     MultiBaselineCorrelator<std::complex<float>, int> mbc(1);
+  }
+  
+protected:
+  /// @brief start iterators of the first nAnt test streams
+  std::vector<const std::complex<float>*> streams(const int nAnt) const {
+     std::vector<const std::complex<float>*> result(nAnt);
+     for (int ant = 0; ant < nAnt; ++ant) {
+          result[ant] = &itsStreams[ant][0];
+     }
+     return result;
+  }
+  
+  /// @brief compare two complex numbers with the relative tolerance
+  static void compare(const std::complex<float> &expected, const std::complex<float> &obtained) {
+     const float tolerance = 1e-5 * (1. + abs(expected));
+     CPPUNIT_ASSERT_DOUBLES_EQUAL(real(expected), real(obtained), tolerance);
+     CPPUNIT_ASSERT_DOUBLES_EQUAL(imag(expected), imag(obtained), tolerance);
+  }
+  
+private:
+  /// @brief test data, one stream per antenna
+  std::vector<std::vector<std::complex<float> > > itsStreams;
+};
+
+} // namespace swcorrelator
+
+} // namespace askap
+
+#endif // #ifndef ASKAP_SWCORRELATOR_MULTI_BASELINE_CORRELATOR_TEST_H
+
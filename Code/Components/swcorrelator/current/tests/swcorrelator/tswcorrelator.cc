@@ -28,6 +28,7 @@
 #include <askap_swcorrelator.h>
 #include <FillerMSSinkTest.h>
 #include <CorrProductsTest.h>
+#include <MultiBaselineCorrelatorTest.h>
 
 
 int main(int argc, char *argv[])
@@ -36,6 +37,7 @@ int main(int argc, char *argv[])
 
     runner.addTest(askap::swcorrelator::FillerMSSinkTest::suite());
     runner.addTest(askap::swcorrelator::CorrProductsTest::suite());
+    runner.addTest(askap::swcorrelator::MultiBaselineCorrelatorTest::suite());
 
     bool wasSucessful = runner.run();
 